@@ -0,0 +1,327 @@
+/* bench-aio.c
+ *
+ * Copyright 2026 Christian Hergert
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of the
+ * License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#include "config.h"
+
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <glib/gstdio.h>
+
+#include "bench-util.h"
+
+#include "dex-aio-backend-private.h"
+#include "dex-posix-aio-backend-private.h"
+#ifdef HAVE_LIBURING
+# include "dex-uring-aio-backend-private.h"
+#endif
+
+/* Reads a file which is already in the page cache sequentially with a
+ * number of reads in flight, once for each aio backend available. Both
+ * backends get their own aio context attached to the main context rather
+ * than relying on whichever dex_aio_backend_get_default() picked.
+ *
+ * The io_uring backend is skipped when libdex was built without it or
+ * when the kernel does not support it.
+ *
+ * Then, using the default backend from fibers:
+ *
+ *  - "random-read" has a number of fibers issue 4 KiB reads at random
+ *    offsets, so the cost is dominated by per-request overhead. It is
+ *    run again with the file and buffers registered with the aio
+ *    context, which has no effect unless the io_uring backend is used.
+ *  - "read-latency" has a single fiber issue one 4 KiB read at a time
+ *    and records each round trip. The main scheduler waits on the aio
+ *    eventfd from its GMainContext while thread pool workers reap
+ *    completions directly, so it is run on both.
+ */
+
+#define FILE_SIZE    (16 * 1024 * 1024)
+#define DEPTH        16
+#define BLOCK_SIZE   4096
+#define RANDOM_DEPTH 32
+
+typedef struct _Reader
+{
+  int      fd;
+  guint8  *buffer;
+  guint    n_reads;
+  guint32  seed;
+  gint64  *samples;
+} Reader;
+
+static const gsize block_sizes[] = { 4096, 65536 };
+
+static int
+create_file (void)
+{
+  g_autoptr(GError) error = NULL;
+  g_autofree char *path = NULL;
+  gsize block_size = block_sizes[G_N_ELEMENTS (block_sizes) - 1];
+  g_autofree guint8 *block = g_malloc (block_size);
+  int fd;
+
+  if (-1 == (fd = g_file_open_tmp ("libdex-bench-aio-XXXXXX", &path, &error)))
+    g_error ("%s", error->message);
+
+  /* We only need the fd from here on */
+  g_unlink (path);
+
+  for (gsize i = 0; i < FILE_SIZE / block_size; i++)
+    {
+      memset (block, i & 0xFF, block_size);
+
+      if (write (fd, block, block_size) != (gssize)block_size)
+        g_error ("%s", g_strerror (errno));
+    }
+
+  return fd;
+}
+
+static void
+bench_read (const char    *backend_name,
+            DexAioBackend *aio_backend,
+            int            fd,
+            guint          n_reads)
+{
+  DexAioContext *aio_context;
+
+  if (!(aio_context = dex_aio_backend_create_context (aio_backend)))
+    g_error ("Failed to create aio context for %s", backend_name);
+
+  g_source_attach ((GSource *)aio_context, NULL);
+
+  for (guint b = 0; b < G_N_ELEMENTS (block_sizes); b++)
+    {
+      gsize block_size = block_sizes[b];
+      guint n_blocks = FILE_SIZE / block_size;
+      guint n_rounds = MAX (1, n_reads / DEPTH);
+      g_autofree guint8 *buffers = g_malloc (block_size * DEPTH);
+      g_autofree char *name = NULL;
+      DexFuture *futures[DEPTH];
+      guint next_block = 0;
+      gint64 begin;
+
+      /* Warm the page cache */
+      for (guint i = 0; i < n_blocks; i++)
+        {
+          if (pread (fd, buffers, block_size, (goffset)i * block_size) != (gssize)block_size)
+            g_error ("%s", g_strerror (errno));
+        }
+
+      begin = g_get_monotonic_time ();
+
+      for (guint r = 0; r < n_rounds; r++)
+        {
+          for (guint i = 0; i < DEPTH; i++)
+            {
+              futures[i] = dex_aio_backend_read (aio_backend, aio_context, fd,
+                                                 buffers + (i * block_size), block_size,
+                                                 (goffset)next_block * block_size);
+              next_block = (next_block + 1) % n_blocks;
+            }
+
+          dex_bench_run (dex_future_allv (futures, DEPTH));
+
+          for (guint i = 0; i < DEPTH; i++)
+            {
+              const GValue *value = dex_future_get_value (futures[i], NULL);
+
+              if (g_value_get_int64 (value) != (gint64)block_size)
+                g_error ("Short read of %"G_GINT64_FORMAT" bytes", g_value_get_int64 (value));
+
+              dex_unref (futures[i]);
+            }
+        }
+
+      name = g_strdup_printf ("%s-read-%"G_GSIZE_FORMAT"k", backend_name, block_size / 1024);
+      dex_bench_report (name, (guint64)n_rounds * DEPTH, g_get_monotonic_time () - begin);
+    }
+
+  g_source_destroy ((GSource *)aio_context);
+  g_source_unref ((GSource *)aio_context);
+}
+
+static DexFuture *
+random_reader_fiber (gpointer user_data)
+{
+  Reader *reader = user_data;
+  g_autoptr(GRand) rand = g_rand_new_with_seed (reader->seed);
+  GError *error = NULL;
+
+  for (guint i = 0; i < reader->n_reads; i++)
+    {
+      goffset offset = (goffset)g_rand_int_range (rand, 0, FILE_SIZE / BLOCK_SIZE) * BLOCK_SIZE;
+      gint64 len;
+
+      len = dex_await_int64 (dex_aio_read (NULL, reader->fd, reader->buffer, BLOCK_SIZE, offset), &error);
+
+      if (error != NULL)
+        return dex_future_new_for_error (error);
+
+      if (len != BLOCK_SIZE)
+        return dex_future_new_reject (G_IO_ERROR,
+                                      G_IO_ERROR_FAILED,
+                                      "Short read of %"G_GINT64_FORMAT" bytes",
+                                      len);
+    }
+
+  return dex_future_new_true ();
+}
+
+static void
+bench_random_read (int      fd,
+                   gboolean registered,
+                   guint    n_reads)
+{
+  g_autofree guint8 *buffers = g_malloc (RANDOM_DEPTH * BLOCK_SIZE);
+  g_autofree DexFuture **futures = g_new0 (DexFuture *, RANDOM_DEPTH);
+  g_autofree Reader *readers = g_new0 (Reader, RANDOM_DEPTH);
+  guint n_per_reader = MAX (1, n_reads / RANDOM_DEPTH);
+  int read_fd = fd;
+  gint64 begin;
+
+  if (registered)
+    {
+      g_autoptr(GError) error = NULL;
+      GInputVector vectors[RANDOM_DEPTH];
+
+      for (guint i = 0; i < RANDOM_DEPTH; i++)
+        {
+          vectors[i].buffer = buffers + (i * BLOCK_SIZE);
+          vectors[i].size = BLOCK_SIZE;
+        }
+
+      /* Only requests using the handle go through the registered file */
+      if (!dex_aio_register_files (NULL, &fd, 1, &read_fd, &error) ||
+          !dex_aio_register_buffers (NULL, vectors, RANDOM_DEPTH, &error))
+        g_error ("%s", error->message);
+    }
+
+  begin = g_get_monotonic_time ();
+
+  for (guint i = 0; i < RANDOM_DEPTH; i++)
+    {
+      readers[i].fd = read_fd;
+      readers[i].buffer = buffers + (i * BLOCK_SIZE);
+      readers[i].n_reads = n_per_reader;
+      readers[i].seed = i;
+
+      futures[i] = dex_scheduler_spawn (NULL, 0, random_reader_fiber, &readers[i], NULL);
+    }
+
+  dex_bench_run (dex_future_allv (futures, RANDOM_DEPTH));
+
+  dex_bench_report (registered ? "random-read-registered" : "random-read",
+                    (guint64)n_per_reader * RANDOM_DEPTH,
+                    g_get_monotonic_time () - begin);
+
+  for (guint i = 0; i < RANDOM_DEPTH; i++)
+    dex_unref (futures[i]);
+
+  if (registered)
+    {
+      dex_aio_register_buffers (NULL, NULL, 0, NULL);
+      dex_aio_register_files (NULL, NULL, 0, NULL, NULL);
+    }
+}
+
+static DexFuture *
+latency_reader_fiber (gpointer user_data)
+{
+  Reader *reader = user_data;
+  GError *error = NULL;
+
+  for (guint i = 0; i < reader->n_reads; i++)
+    {
+      gint64 begin = g_get_monotonic_time ();
+      gint64 len;
+
+      len = dex_await_int64 (dex_aio_read (NULL, reader->fd, reader->buffer, BLOCK_SIZE, 0), &error);
+
+      reader->samples[i] = g_get_monotonic_time () - begin;
+
+      if (error != NULL)
+        return dex_future_new_for_error (error);
+
+      if (len != BLOCK_SIZE)
+        return dex_future_new_reject (G_IO_ERROR,
+                                      G_IO_ERROR_FAILED,
+                                      "Short read of %"G_GINT64_FORMAT" bytes",
+                                      len);
+    }
+
+  return dex_future_new_true ();
+}
+
+static void
+bench_read_latency (const char   *name,
+                    DexScheduler *scheduler,
+                    int           fd,
+                    guint         n_reads)
+{
+  g_autofree guint8 *buffer = g_malloc (BLOCK_SIZE);
+  g_autofree gint64 *samples = g_new0 (gint64, n_reads);
+  Reader reader = { fd, buffer, n_reads, 0, samples };
+
+  dex_bench_run (dex_scheduler_spawn (scheduler, 0, latency_reader_fiber, &reader, NULL));
+  dex_bench_report_samples (name, samples, n_reads);
+}
+
+int
+main (int   argc,
+      char *argv[])
+{
+  DexAioBackend *aio_backend;
+  guint n_reads;
+  int fd;
+
+  dex_bench_init (&argc, &argv, "aio", NULL);
+
+  n_reads = dex_bench_scale (100000);
+  fd = create_file ();
+
+  aio_backend = dex_posix_aio_backend_new ();
+  bench_read ("posix", aio_backend, fd, n_reads);
+  dex_unref (aio_backend);
+
+#ifdef HAVE_LIBURING
+  if ((aio_backend = dex_uring_aio_backend_new ()))
+    {
+      bench_read ("uring", aio_backend, fd, n_reads);
+      dex_unref (aio_backend);
+    }
+  else
+    {
+      g_printerr ("io_uring is not available, skipping\n");
+    }
+#endif
+
+  bench_random_read (fd, FALSE, dex_bench_scale (500000));
+  bench_random_read (fd, TRUE, dex_bench_scale (500000));
+
+  bench_read_latency ("read-latency-main", dex_scheduler_get_default (), fd, dex_bench_scale (100000));
+  bench_read_latency ("read-latency-thread-pool", dex_thread_pool_scheduler_get_default (), fd, dex_bench_scale (100000));
+
+  close (fd);
+
+  return dex_bench_finish ();
+}
@@ -0,0 +1,118 @@
+/* bench-channel.c
+ *
+ * Copyright 2026 Christian Hergert
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of the
+ * License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#include "config.h"
+
+#include "bench-util.h"
+
+/* A producer fiber sends integers through a channel to a consumer fiber
+ * which receives them until the channel is closed. This is run with both
+ * fibers on the main scheduler, and again with the producer on the
+ * thread pool so that every item crosses threads.
+ */
+
+#define CAPACITY 64
+
+typedef struct _Pipe
+{
+  DexChannel *channel;
+  guint       n_items;
+} Pipe;
+
+static DexFuture *
+producer_fiber (gpointer user_data)
+{
+  Pipe *pipe = user_data;
+  GError *error = NULL;
+
+  for (guint i = 0; i < pipe->n_items; i++)
+    {
+      if (!dex_await (dex_channel_send (pipe->channel, dex_future_new_for_int (i)), &error))
+        return dex_future_new_for_error (error);
+    }
+
+  dex_channel_close_send (pipe->channel);
+
+  return dex_future_new_true ();
+}
+
+static DexFuture *
+consumer_fiber (gpointer user_data)
+{
+  Pipe *pipe = user_data;
+  guint n_received = 0;
+
+  for (;;)
+    {
+      GError *error = NULL;
+
+      dex_await_int (dex_channel_receive (pipe->channel), &error);
+
+      if (error != NULL)
+        {
+          /* The producer closed the channel */
+          if (g_error_matches (error, DEX_ERROR, DEX_ERROR_CHANNEL_CLOSED))
+            {
+              g_error_free (error);
+              break;
+            }
+
+          return dex_future_new_for_error (error);
+        }
+
+      n_received++;
+    }
+
+  if (n_received != pipe->n_items)
+    return dex_future_new_reject (G_IO_ERROR, G_IO_ERROR_FAILED,
+                                  "Received %u of %u items",
+                                  n_received, pipe->n_items);
+
+  return dex_future_new_true ();
+}
+
+static void
+bench_pipe (const char   *name,
+            DexScheduler *producer_scheduler,
+            guint         n_items)
+{
+  Pipe pipe = { dex_channel_new (CAPACITY), n_items };
+  gint64 begin = g_get_monotonic_time ();
+
+  dex_bench_run (dex_future_all (dex_scheduler_spawn (producer_scheduler, 0, producer_fiber, &pipe, NULL),
+                                 dex_scheduler_spawn (NULL, 0, consumer_fiber, &pipe, NULL),
+                                 NULL));
+
+  dex_bench_report (name, n_items, g_get_monotonic_time () - begin);
+
+  dex_unref (pipe.channel);
+}
+
+int
+main (int   argc,
+      char *argv[])
+{
+  dex_bench_init (&argc, &argv, "channel", NULL);
+
+  bench_pipe ("same-thread", NULL, dex_bench_scale (1000000));
+  bench_pipe ("cross-thread", dex_thread_pool_scheduler_get_default (), dex_bench_scale (200000));
+
+  return dex_bench_finish ();
+}
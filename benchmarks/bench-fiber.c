@@ -0,0 +1,173 @@
+/* bench-fiber.c
+ *
+ * Copyright 2026 Christian Hergert
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of the
+ * License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#include "config.h"
+
+#include "bench-util.h"
+
+/* Measures the latency of dex_await() from fibers on the main scheduler:
+ *
+ *  - awaiting a future which is already resolved, which never suspends
+ *  - two fibers taking turns with dex_fiber_yield(), where every yield
+ *    is a switch to the scheduler and into the other fiber
+ *  - spawning a fiber and awaiting it, which suspends the caller until
+ *    the new fiber has run to completion
+ *  - two fibers passing a value back and forth through a pair of
+ *    channels, where every receive suspends the fiber
+ *
+ * Compare results between -Dfiber-context=ucontext and -Dfiber-context=asm.
+ */
+
+static guint n_ops;
+
+typedef struct _PingPong
+{
+  DexChannel *ping;
+  DexChannel *pong;
+} PingPong;
+
+static DexFuture *
+await_resolved_fiber (gpointer user_data)
+{
+  GError *error = NULL;
+
+  for (guint i = 0; i < n_ops; i++)
+    {
+      if (!dex_await (dex_future_new_true (), &error))
+        return dex_future_new_for_error (error);
+    }
+
+  return dex_future_new_true ();
+}
+
+static DexFuture *
+yield_fiber (gpointer user_data)
+{
+  GError *error = NULL;
+
+  for (guint i = 0; i < n_ops; i++)
+    {
+      if (!dex_fiber_yield (&error))
+        return dex_future_new_for_error (error);
+    }
+
+  return dex_future_new_true ();
+}
+
+static DexFuture *
+nop_fiber (gpointer user_data)
+{
+  return dex_future_new_true ();
+}
+
+static DexFuture *
+await_spawn_fiber (gpointer user_data)
+{
+  GError *error = NULL;
+
+  for (guint i = 0; i < n_ops; i++)
+    {
+      if (!dex_await (dex_scheduler_spawn (NULL, 0, nop_fiber, NULL, NULL), &error))
+        return dex_future_new_for_error (error);
+    }
+
+  return dex_future_new_true ();
+}
+
+static DexFuture *
+pinger_fiber (gpointer user_data)
+{
+  PingPong *state = user_data;
+
+  for (guint i = 0; i < n_ops; i++)
+    {
+      GError *error = NULL;
+
+      if (!dex_await (dex_channel_send (state->ping, dex_future_new_for_int (i)), &error) ||
+          (guint)dex_await_int (dex_channel_receive (state->pong), &error) != i)
+        {
+          if (error == NULL)
+            error = g_error_new (G_IO_ERROR, G_IO_ERROR_FAILED, "Unexpected value");
+          return dex_future_new_for_error (error);
+        }
+    }
+
+  return dex_future_new_true ();
+}
+
+static DexFuture *
+ponger_fiber (gpointer user_data)
+{
+  PingPong *state = user_data;
+
+  for (guint i = 0; i < n_ops; i++)
+    {
+      GError *error = NULL;
+      int value;
+
+      value = dex_await_int (dex_channel_receive (state->ping), &error);
+
+      if (error != NULL ||
+          !dex_await (dex_channel_send (state->pong, dex_future_new_for_int (value)), &error))
+        return dex_future_new_for_error (error);
+    }
+
+  return dex_future_new_true ();
+}
+
+int
+main (int   argc,
+      char *argv[])
+{
+  PingPong state;
+  gint64 begin;
+
+  dex_bench_init (&argc, &argv, "fiber", NULL);
+
+  n_ops = dex_bench_scale (1000000);
+  begin = g_get_monotonic_time ();
+  dex_bench_run (dex_scheduler_spawn (NULL, 0, await_resolved_fiber, NULL, NULL));
+  dex_bench_report ("await-resolved", n_ops, g_get_monotonic_time () - begin);
+
+  n_ops = dex_bench_scale (500000);
+  begin = g_get_monotonic_time ();
+  dex_bench_run (dex_future_all (dex_scheduler_spawn (NULL, 0, yield_fiber, NULL, NULL),
+                                 dex_scheduler_spawn (NULL, 0, yield_fiber, NULL, NULL),
+                                 NULL));
+  dex_bench_report ("yield", (guint64)n_ops * 2, g_get_monotonic_time () - begin);
+
+  n_ops = dex_bench_scale (100000);
+  begin = g_get_monotonic_time ();
+  dex_bench_run (dex_scheduler_spawn (NULL, 0, await_spawn_fiber, NULL, NULL));
+  dex_bench_report ("await-spawn", n_ops, g_get_monotonic_time () - begin);
+
+  n_ops = dex_bench_scale (500000);
+  state.ping = dex_channel_new (1);
+  state.pong = dex_channel_new (1);
+  begin = g_get_monotonic_time ();
+  dex_bench_run (dex_future_all (dex_scheduler_spawn (NULL, 0, pinger_fiber, &state, NULL),
+                                 dex_scheduler_spawn (NULL, 0, ponger_fiber, &state, NULL),
+                                 NULL));
+  dex_bench_report ("ping-pong", n_ops, g_get_monotonic_time () - begin);
+  dex_unref (state.ping);
+  dex_unref (state.pong);
+
+  return dex_bench_finish ();
+}
@@ -0,0 +1,212 @@
+/* bench-future.c
+ *
+ * Copyright 2026 Christian Hergert
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of the
+ * License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#include "config.h"
+
+#include "bench-util.h"
+
+#include "dex-future-private.h"
+#include "dex-object-private.h"
+
+/* Measures the cost of the most common operations on futures without any
+ * fibers involved:
+ *
+ *  - creating a static future and releasing it
+ *  - creating a promise, resolving it and releasing it
+ *  - building a chain of dex_future_then() on a promise and passing a
+ *    value from one end to the other, either forwarding the completed
+ *    future or creating a new one at every hop
+ *  - the same with one very deep chain, along with how many objects
+ *    were taken from the slab and how many chained futures had to be
+ *    allocated on the heap per hop
+ *  - waiting on a large number of futures at once with dex_future_allv()
+ */
+
+#define CHAIN_DEPTH      1000
+#define DEEP_CHAIN_DEPTH 100000
+#define ALL_WIDTH        1000
+
+static DexFuture *
+forward_cb (DexFuture *completed,
+            gpointer   user_data)
+{
+  return dex_ref (completed);
+}
+
+static DexFuture *
+increment_cb (DexFuture *completed,
+              gpointer   user_data)
+{
+  const GValue *value = dex_future_get_value (completed, NULL);
+  return dex_future_new_for_int64 (g_value_get_int64 (value) + 1);
+}
+
+/* Only counts types which have the slab enabled */
+static guint64
+count_objects (void)
+{
+  guint64 n_allocated;
+  guint64 n_reused;
+
+  dex_object_get_slab_stats (&n_allocated, &n_reused);
+
+  return n_allocated + n_reused;
+}
+
+static DexFuture *
+build_chain (DexPromise        *promise,
+             DexFutureCallback  callback,
+             guint              depth)
+{
+  DexFuture *future = dex_ref (promise);
+
+  for (guint i = 0; i < depth; i++)
+    future = dex_future_then (future, callback, NULL, NULL);
+
+  return future;
+}
+
+static void
+bench_static_new (guint n_ops)
+{
+  gint64 begin = g_get_monotonic_time ();
+
+  for (guint i = 0; i < n_ops; i++)
+    dex_unref (dex_future_new_for_int (i));
+
+  dex_bench_report ("static-new", n_ops, g_get_monotonic_time () - begin);
+}
+
+static void
+bench_promise_resolve (guint n_ops)
+{
+  gint64 begin = g_get_monotonic_time ();
+
+  for (guint i = 0; i < n_ops; i++)
+    {
+      DexPromise *promise = dex_promise_new ();
+      dex_promise_resolve_int (promise, i);
+      dex_unref (promise);
+    }
+
+  dex_bench_report ("promise-resolve", n_ops, g_get_monotonic_time () - begin);
+}
+
+static void
+bench_then_chain (const char        *name,
+                  DexFutureCallback  callback,
+                  guint              n_rounds)
+{
+  gint64 begin = g_get_monotonic_time ();
+
+  for (guint r = 0; r < n_rounds; r++)
+    {
+      DexPromise *promise = dex_promise_new ();
+      DexFuture *future = build_chain (promise, callback, CHAIN_DEPTH);
+
+      dex_promise_resolve_int64 (promise, 0);
+      dex_unref (promise);
+
+      dex_bench_run (future);
+    }
+
+  dex_bench_report (name, (guint64)n_rounds * CHAIN_DEPTH, g_get_monotonic_time () - begin);
+}
+
+static void
+bench_deep_chain (void)
+{
+  DexPromise *promise;
+  DexFuture *future;
+  guint64 n_objects;
+  guint64 n_chained;
+  gint64 begin;
+
+  n_objects = count_objects ();
+  n_chained = dex_future_get_n_chained_allocated ();
+  begin = g_get_monotonic_time ();
+
+  promise = dex_promise_new ();
+  future = build_chain (promise, increment_cb, DEEP_CHAIN_DEPTH);
+
+  dex_promise_resolve_int64 (promise, 0);
+  dex_unref (promise);
+
+  dex_bench_run (dex_ref (future));
+
+  dex_bench_report ("then-chain-deep", DEEP_CHAIN_DEPTH, g_get_monotonic_time () - begin);
+  dex_bench_report_metric ("then-chain-deep-objects",
+                           (count_objects () - n_objects) / (double)DEEP_CHAIN_DEPTH,
+                           "objects/hop");
+  dex_bench_report_metric ("then-chain-deep-chained-allocs",
+                           (dex_future_get_n_chained_allocated () - n_chained) / (double)DEEP_CHAIN_DEPTH,
+                           "allocs/hop");
+
+  g_assert_cmpint (g_value_get_int64 (dex_future_get_value (future, NULL)), ==, DEEP_CHAIN_DEPTH);
+
+  dex_unref (future);
+}
+
+static void
+bench_all (guint n_rounds)
+{
+  g_autofree DexFuture **futures = g_new0 (DexFuture *, ALL_WIDTH);
+  g_autofree DexPromise **promises = g_new0 (DexPromise *, ALL_WIDTH);
+  gint64 begin = g_get_monotonic_time ();
+
+  for (guint r = 0; r < n_rounds; r++)
+    {
+      DexFuture *future;
+
+      for (guint i = 0; i < ALL_WIDTH; i++)
+        {
+          promises[i] = dex_promise_new ();
+          futures[i] = DEX_FUTURE (promises[i]);
+        }
+
+      future = dex_future_allv (futures, ALL_WIDTH);
+
+      for (guint i = 0; i < ALL_WIDTH; i++)
+        {
+          dex_promise_resolve_int (promises[i], i);
+          dex_unref (promises[i]);
+        }
+
+      dex_bench_run (future);
+    }
+
+  dex_bench_report ("all", (guint64)n_rounds * ALL_WIDTH, g_get_monotonic_time () - begin);
+}
+
+int
+main (int   argc,
+      char *argv[])
+{
+  dex_bench_init (&argc, &argv, "future", NULL);
+
+  bench_static_new (dex_bench_scale (1000000));
+  bench_promise_resolve (dex_bench_scale (1000000));
+  bench_then_chain ("then-chain", forward_cb, dex_bench_scale (1000));
+  bench_then_chain ("then-chain-int64", increment_cb, dex_bench_scale (1000));
+  bench_deep_chain ();
+  bench_all (dex_bench_scale (1000));
+
+  return dex_bench_finish ();
+}
@@ -0,0 +1,118 @@
+/* bench-semaphore.c
+ *
+ * Copyright 2026 Christian Hergert
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of the
+ * License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#include "config.h"
+
+#include "bench-util.h"
+
+#include "dex-semaphore-private.h"
+
+/* A number of fibers on the thread pool repeatedly acquire and release
+ * a DexSemaphore, and then a DexLimiter, which allow fewer holders than
+ * there are fibers so that most acquisitions have to wait.
+ */
+
+#define N_FIBERS  32
+#define N_PERMITS 4
+
+typedef struct _Contention
+{
+  DexSemaphore *semaphore;
+  DexLimiter   *limiter;
+  guint         n_ops;
+} Contention;
+
+static DexFuture *
+semaphore_fiber (gpointer user_data)
+{
+  Contention *contention = user_data;
+  GError *error = NULL;
+
+  for (guint i = 0; i < contention->n_ops; i++)
+    {
+      if (!dex_await (dex_semaphore_wait (contention->semaphore), &error))
+        return dex_future_new_for_error (error);
+
+      dex_semaphore_post (contention->semaphore);
+    }
+
+  return dex_future_new_true ();
+}
+
+static DexFuture *
+limiter_fiber (gpointer user_data)
+{
+  Contention *contention = user_data;
+  GError *error = NULL;
+
+  for (guint i = 0; i < contention->n_ops; i++)
+    {
+      if (!dex_await (dex_limiter_acquire (contention->limiter), &error))
+        return dex_future_new_for_error (error);
+
+      dex_limiter_release (contention->limiter);
+    }
+
+  return dex_future_new_true ();
+}
+
+static void
+bench_contention (const char   *name,
+                  Contention   *contention,
+                  DexFiberFunc  fiber_func)
+{
+  DexScheduler *thread_pool = dex_thread_pool_scheduler_get_default ();
+  DexFuture *futures[N_FIBERS];
+  gint64 begin = g_get_monotonic_time ();
+
+  for (guint i = 0; i < N_FIBERS; i++)
+    futures[i] = dex_scheduler_spawn (thread_pool, 0, fiber_func, contention, NULL);
+
+  dex_bench_run (dex_future_allv (futures, N_FIBERS));
+
+  dex_bench_report (name, (guint64)contention->n_ops * N_FIBERS, g_get_monotonic_time () - begin);
+
+  for (guint i = 0; i < N_FIBERS; i++)
+    dex_unref (futures[i]);
+}
+
+int
+main (int   argc,
+      char *argv[])
+{
+  Contention contention = {0};
+
+  dex_bench_init (&argc, &argv, "semaphore", NULL);
+
+  contention.n_ops = dex_bench_scale (20000);
+
+  contention.semaphore = dex_semaphore_new ();
+  dex_semaphore_post_many (contention.semaphore, N_PERMITS);
+  bench_contention ("semaphore", &contention, semaphore_fiber);
+  dex_semaphore_close (contention.semaphore);
+  dex_clear (&contention.semaphore);
+
+  contention.limiter = dex_limiter_new (N_PERMITS);
+  bench_contention ("limiter", &contention, limiter_fiber);
+  dex_limiter_close (contention.limiter);
+  dex_clear (&contention.limiter);
+
+  return dex_bench_finish ();
+}
@@ -0,0 +1,276 @@
+/* bench-thread-pool.c
+ *
+ * Copyright 2026 Christian Hergert
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of the
+ * License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#include "config.h"
+
+#include <glib.h>
+
+#ifdef G_OS_UNIX
+# include <sys/resource.h>
+#endif
+
+#include "bench-util.h"
+
+/* Measures how quickly work submitted from the main thread starts on a
+ * thread pool:
+ *
+ *  - "push" is the time from dex_scheduler_push() on the default thread
+ *    pool scheduler until the work item runs. Items are pushed one at a
+ *    time so every sample includes waking an idle worker.
+ *  - "push-burst" pushes many items at once and waits for all of them,
+ *    which is the rate the workers can drain the global queue.
+ *  - "spawn-await" is the round trip of spawning a fiber on the thread
+ *    pool scheduler until the main thread sees it complete.
+ *  - "submit-await" is the same round trip for dex_thread_pool_submit().
+ *
+ * It also measures the two sides of how workers wait for work on a pool
+ * of their own:
+ *
+ *  - "idle-cpu" is the CPU time used by the process while the pool is
+ *    left alone, which should be close to zero once the workers sleep.
+ *  - "steal-wakeup" is the time until a burst of items pushed to one
+ *    worker's own queue runs, after its peers had time to go to sleep.
+ *    That worker keeps busy, so the items can only be run by a sleeping
+ *    peer which was woken to steal them.
+ */
+
+#define N_WORKERS        4
+#define IDLE_SECONDS     2
+#define BURST_SIZE       8
+#define BURST_GAP_MSEC 250
+
+typedef struct _Burst
+{
+  guint   n_bursts;
+  gint64 *samples;
+  guint   n_done;
+} Burst;
+
+typedef struct _BurstItem
+{
+  gint64  pushed_at;
+  gint64 *sample;
+  guint  *n_done;
+} BurstItem;
+
+typedef struct _Sample
+{
+  gint64 submitted;
+  gint64 latency;
+  guint  ran;
+} Sample;
+
+static void
+sample_func (gpointer user_data)
+{
+  Sample *sample = user_data;
+
+  sample->latency = g_get_monotonic_time () - sample->submitted;
+  g_atomic_int_set (&sample->ran, TRUE);
+}
+
+static void
+count_func (gpointer user_data)
+{
+  guint *n_run = user_data;
+  g_atomic_int_inc (n_run);
+}
+
+static DexFuture *
+nop_func (gpointer user_data)
+{
+  return dex_future_new_true ();
+}
+
+static void
+bench_push (guint n_samples)
+{
+  DexScheduler *thread_pool = dex_thread_pool_scheduler_get_default ();
+  g_autofree gint64 *samples = g_new0 (gint64, n_samples);
+
+  for (guint i = 0; i < n_samples; i++)
+    {
+      Sample sample = {0};
+
+      /* Give the workers a chance to go idle */
+      g_usleep (50);
+
+      sample.submitted = g_get_monotonic_time ();
+      dex_scheduler_push (thread_pool, sample_func, &sample);
+
+      while (!g_atomic_int_get (&sample.ran))
+        g_thread_yield ();
+
+      samples[i] = sample.latency;
+    }
+
+  dex_bench_report_samples ("push", samples, n_samples);
+}
+
+static void
+bench_push_burst (guint n_items)
+{
+  DexScheduler *thread_pool = dex_thread_pool_scheduler_get_default ();
+  guint n_run = 0;
+  gint64 begin = g_get_monotonic_time ();
+
+  for (guint i = 0; i < n_items; i++)
+    dex_scheduler_push (thread_pool, count_func, &n_run);
+
+  while ((guint)g_atomic_int_get (&n_run) < n_items)
+    g_thread_yield ();
+
+  dex_bench_report ("push-burst", n_items, g_get_monotonic_time () - begin);
+}
+
+static void
+bench_spawn_await (guint n_samples)
+{
+  DexScheduler *thread_pool = dex_thread_pool_scheduler_get_default ();
+  g_autofree gint64 *samples = g_new0 (gint64, n_samples);
+
+  for (guint i = 0; i < n_samples; i++)
+    {
+      gint64 begin = g_get_monotonic_time ();
+
+      dex_bench_run (dex_scheduler_spawn (thread_pool, 0, nop_func, NULL, NULL));
+      samples[i] = g_get_monotonic_time () - begin;
+    }
+
+  dex_bench_report_samples ("spawn-await", samples, n_samples);
+}
+
+static void
+bench_submit_await (guint n_samples)
+{
+  g_autoptr(DexThreadPool) pool = dex_thread_pool_new (MAX (1, g_get_num_processors () / 2));
+  g_autofree gint64 *samples = g_new0 (gint64, n_samples);
+
+  for (guint i = 0; i < n_samples; i++)
+    {
+      gint64 begin = g_get_monotonic_time ();
+
+      dex_bench_run (dex_thread_pool_submit (pool, NULL, nop_func, NULL, NULL));
+      samples[i] = g_get_monotonic_time () - begin;
+    }
+
+  dex_bench_report_samples ("submit-await", samples, n_samples);
+
+  dex_bench_run (dex_thread_pool_close (pool, DEX_THREAD_POOL_SHUTDOWN_DRAIN));
+}
+
+#ifdef G_OS_UNIX
+static gint64
+get_cpu_usec (void)
+{
+  struct rusage usage;
+
+  getrusage (RUSAGE_SELF, &usage);
+
+  return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * G_USEC_PER_SEC +
+         usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+}
+
+static void
+bench_idle_cpu (void)
+{
+  g_autoptr(DexScheduler) thread_pool = dex_thread_pool_scheduler_new_full (N_WORKERS, N_WORKERS);
+  gint64 begin;
+
+  /* Workers spin briefly after running out of work before they sleep */
+  g_usleep (G_USEC_PER_SEC / 2);
+
+  begin = get_cpu_usec ();
+  g_usleep (IDLE_SECONDS * G_USEC_PER_SEC);
+
+  dex_bench_report_metric ("idle-cpu",
+                           (get_cpu_usec () - begin) / (double)IDLE_SECONDS,
+                           "usec/sec");
+}
+#endif
+
+static void
+burst_item_func (gpointer user_data)
+{
+  BurstItem *item = user_data;
+
+  *item->sample = g_get_monotonic_time () - item->pushed_at;
+  g_atomic_int_inc (item->n_done);
+}
+
+static DexFuture *
+burst_fiber (gpointer user_data)
+{
+  Burst *burst = user_data;
+  DexScheduler *scheduler = dex_scheduler_get_thread_default ();
+  BurstItem items[BURST_SIZE];
+
+  for (guint i = 0; i < burst->n_bursts; i++)
+    {
+      guint target = (i + 1) * BURST_SIZE;
+
+      /* Give the other workers time to go to sleep */
+      dex_await (dex_timeout_new_msec (BURST_GAP_MSEC), NULL);
+
+      for (guint j = 0; j < BURST_SIZE; j++)
+        {
+          items[j].pushed_at = g_get_monotonic_time ();
+          items[j].sample = &burst->samples[i * BURST_SIZE + j];
+          items[j].n_done = &burst->n_done;
+
+          dex_scheduler_push (scheduler, burst_item_func, &items[j]);
+        }
+
+      /* Keep this worker busy so the items must be stolen by a peer */
+      while ((guint)g_atomic_int_get (&burst->n_done) < target)
+        g_thread_yield ();
+    }
+
+  return dex_future_new_true ();
+}
+
+static void
+bench_steal_wakeup (guint n_bursts)
+{
+  g_autoptr(DexScheduler) thread_pool = dex_thread_pool_scheduler_new_full (N_WORKERS, N_WORKERS);
+  g_autofree gint64 *samples = g_new0 (gint64, n_bursts * BURST_SIZE);
+  Burst burst = { n_bursts, samples, 0 };
+
+  dex_bench_run (dex_scheduler_spawn (thread_pool, 0, burst_fiber, &burst, NULL));
+  dex_bench_report_samples ("steal-wakeup", samples, n_bursts * BURST_SIZE);
+}
+
+int
+main (int   argc,
+      char *argv[])
+{
+  dex_bench_init (&argc, &argv, "thread-pool", NULL);
+
+  bench_push (dex_bench_scale (10000));
+  bench_push_burst (dex_bench_scale (1000000));
+  bench_spawn_await (dex_bench_scale (10000));
+  bench_submit_await (dex_bench_scale (10000));
+#ifdef G_OS_UNIX
+  bench_idle_cpu ();
+#endif
+  bench_steal_wakeup (dex_bench_scale (20));
+
+  return dex_bench_finish ();
+}
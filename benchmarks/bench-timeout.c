@@ -0,0 +1,189 @@
+/* bench-timeout.c
+ *
+ * Copyright 2026 Christian Hergert
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of the
+ * License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#include "config.h"
+
+#include "bench-util.h"
+
+/* Measures the churn of timeouts on the main scheduler:
+ *
+ *  - "create" makes a timeout which is never awaited and so never armed
+ *  - "guard" wraps a promise with dex_future_with_timeout_msec() and then
+ *    resolves it, which arms and disarms a timeout as a server would for
+ *    every request that completes in time
+ *  - "iterate" is an iteration of the main context while many timeouts
+ *    are pending, which should not depend on how many there are
+ *  - "postpone" moves the deadline of many pending timeouts
+ *  - "expire" lets many armed timeouts fire at once
+ *  - "spread-wakeups" is how many main context wakeups it takes to expire
+ *    timeouts spread evenly over one second. Use --slack to see how many
+ *    of those are coalesced.
+ */
+
+#define N_PENDING    10000
+#define N_ITERATIONS 10000
+
+static DexFuture *
+done_cb (DexFuture *completed,
+         gpointer   user_data)
+{
+  gboolean *done = user_data;
+  *done = TRUE;
+  return NULL;
+}
+
+static void
+bench_create (guint n_ops)
+{
+  gint64 begin = g_get_monotonic_time ();
+
+  for (guint i = 0; i < n_ops; i++)
+    dex_unref (dex_timeout_new_seconds (60));
+
+  dex_bench_report ("create", n_ops, g_get_monotonic_time () - begin);
+}
+
+static void
+bench_guard (guint n_ops)
+{
+  gint64 begin = g_get_monotonic_time ();
+
+  for (guint i = 0; i < n_ops; i++)
+    {
+      DexPromise *promise = dex_promise_new ();
+      DexFuture *future = dex_future_with_timeout_msec (dex_ref (promise), 60000);
+
+      dex_promise_resolve_int (promise, i);
+      dex_unref (promise);
+      dex_unref (future);
+
+      /* Let the main context catch up now and then */
+      if (i % N_PENDING == 0)
+        g_main_context_iteration (NULL, FALSE);
+    }
+
+  dex_bench_report ("guard", n_ops, g_get_monotonic_time () - begin);
+}
+
+static void
+bench_postpone_expire (guint n_rounds)
+{
+  g_autofree DexFuture **timeouts = g_new0 (DexFuture *, N_PENDING);
+  gint64 iterate_usec = 0;
+  gint64 postpone_usec = 0;
+  gint64 expire_usec = 0;
+
+  for (guint r = 0; r < n_rounds; r++)
+    {
+      DexFuture *future;
+      gint64 begin;
+      gint64 now;
+
+      now = g_get_monotonic_time ();
+      for (guint i = 0; i < N_PENDING; i++)
+        timeouts[i] = dex_timeout_new_deadline (now + G_USEC_PER_SEC * 60 + i);
+
+      /* Awaiting them arms all of them */
+      future = dex_future_allv (timeouts, N_PENDING);
+
+      begin = g_get_monotonic_time ();
+      for (guint i = 0; i < N_ITERATIONS; i++)
+        g_main_context_iteration (NULL, FALSE);
+      iterate_usec += g_get_monotonic_time () - begin;
+
+      now = begin = g_get_monotonic_time ();
+      for (guint i = 0; i < N_PENDING; i++)
+        dex_timeout_postpone_until (DEX_TIMEOUT (timeouts[i]), now + G_USEC_PER_SEC * 120 - i);
+      postpone_usec += g_get_monotonic_time () - begin;
+
+      now = begin = g_get_monotonic_time ();
+      for (guint i = 0; i < N_PENDING; i++)
+        dex_timeout_postpone_until (DEX_TIMEOUT (timeouts[i]), now);
+
+      /* Every timeout rejects, so look at the individual timeouts instead
+       * of letting dex_bench_run() abort.
+       */
+      while (dex_future_is_pending (future))
+        g_main_context_iteration (NULL, TRUE);
+      expire_usec += g_get_monotonic_time () - begin;
+
+      g_assert (dex_future_is_rejected (timeouts[N_PENDING - 1]));
+
+      dex_unref (future);
+      for (guint i = 0; i < N_PENDING; i++)
+        dex_clear (&timeouts[i]);
+    }
+
+  dex_bench_report ("iterate", (guint64)n_rounds * N_ITERATIONS, iterate_usec);
+  dex_bench_report ("postpone", (guint64)n_rounds * N_PENDING, postpone_usec);
+  dex_bench_report ("expire", (guint64)n_rounds * N_PENDING, expire_usec);
+}
+
+static void
+bench_spread (guint slack_msec)
+{
+  g_autofree DexFuture **timeouts = g_new0 (DexFuture *, N_PENDING);
+  DexFuture *future;
+  gboolean done = FALSE;
+  guint n_wakeups = 0;
+  gint64 now;
+
+  now = g_get_monotonic_time ();
+  for (guint i = 0; i < N_PENDING; i++)
+    {
+      timeouts[i] = dex_timeout_new_deadline (now + ((gint64)G_USEC_PER_SEC * i / N_PENDING));
+      dex_timeout_set_slack (DEX_TIMEOUT (timeouts[i]), slack_msec * 1000);
+    }
+
+  future = dex_future_allv (timeouts, N_PENDING);
+  future = dex_future_finally (future, done_cb, &done, NULL);
+
+  while (!done)
+    {
+      g_main_context_iteration (NULL, TRUE);
+      n_wakeups++;
+    }
+
+  dex_bench_report_metric ("spread-wakeups", n_wakeups, "wakeups");
+
+  dex_unref (future);
+  for (guint i = 0; i < N_PENDING; i++)
+    dex_unref (timeouts[i]);
+}
+
+int
+main (int   argc,
+      char *argv[])
+{
+  int slack = 0;
+  GOptionEntry entries[] = {
+    { "slack", 0, 0, G_OPTION_ARG_INT, &slack, "Slack for spread timeouts in msec.", "MSEC" },
+    { NULL }
+  };
+
+  dex_bench_init (&argc, &argv, "timeout", entries);
+
+  bench_create (dex_bench_scale (1000000));
+  bench_guard (dex_bench_scale (500000));
+  bench_postpone_expire (dex_bench_scale (20));
+  bench_spread (MAX (0, slack));
+
+  return dex_bench_finish ();
+}
@@ -0,0 +1,286 @@
+/* bench-util.h
+ *
+ * Copyright 2026 Christian Hergert
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of the
+ * License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#pragma once
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <libdex.h>
+
+G_BEGIN_DECLS
+
+/* Each benchmark prints a single JSON document to stdout so that CI may
+ * collect results and track them over time:
+ *
+ *   {
+ *     "suite": "future",
+ *     "version": "1.2.beta",
+ *     "n_processors": 8,
+ *     "results": [
+ *       {
+ *         "name": "promise-resolve",
+ *         "n_ops": 1000000,
+ *         "usec": 41234,
+ *         "nsec_per_op": 41.234,
+ *         "ops_per_sec": 24251831.3
+ *       }
+ *     ]
+ *   }
+ *
+ * Results recorded from individual samples additionally contain
+ * "min_usec", "p50_usec", "p99_usec" and "max_usec". Measurements which
+ * are not a rate, such as memory use, only contain "value" and "unit".
+ *
+ * A human readable summary is written to stderr. Use --output to write
+ * the JSON to a file instead and --scale to shrink or grow the number of
+ * operations, such as --scale=0.1 for a quick smoke test.
+ */
+
+typedef struct _DexBench
+{
+  const char *suite;
+  GString    *results;
+  char       *output;
+  double      scale;
+} DexBench;
+
+static DexBench dex_bench;
+
+static inline void
+dex_bench_init (int           *argc,
+                char        ***argv,
+                const char    *suite,
+                GOptionEntry  *extra_entries)
+{
+  g_autoptr(GOptionContext) context = NULL;
+  g_autoptr(GError) error = NULL;
+  g_autofree char *description = NULL;
+  GOptionEntry entries[] = {
+    { "output", 'o', 0, G_OPTION_ARG_FILENAME, &dex_bench.output, "Write JSON results to FILE.", "FILE" },
+    { "scale", 's', 0, G_OPTION_ARG_DOUBLE, &dex_bench.scale, "Multiply the number of operations by SCALE.", "SCALE" },
+    { NULL }
+  };
+
+  dex_bench.suite = suite;
+  dex_bench.results = g_string_new (NULL);
+  dex_bench.scale = 1.;
+
+  description = g_strdup_printf ("- %s benchmark", suite);
+  context = g_option_context_new (description);
+  g_option_context_add_main_entries (context, entries, NULL);
+  if (extra_entries != NULL)
+    g_option_context_add_main_entries (context, extra_entries, NULL);
+
+  if (!g_option_context_parse (context, argc, argv, &error))
+    {
+      g_printerr ("%s\n", error->message);
+      exit (EXIT_FAILURE);
+    }
+
+  if (dex_bench.scale <= 0)
+    dex_bench.scale = 1.;
+
+  dex_init ();
+}
+
+/* Scales the default number of operations by --scale */
+static inline guint
+dex_bench_scale (guint n_ops)
+{
+  return MAX (1, (guint)(n_ops * dex_bench.scale));
+}
+
+static inline void
+_dex_bench_append_double (const char *key,
+                          double      value)
+{
+  char buf[G_ASCII_DTOSTR_BUF_SIZE];
+
+  /* Must not be affected by the locale's decimal separator */
+  g_ascii_formatd (buf, sizeof buf, "%.3f", value);
+  g_string_append_printf (dex_bench.results, ", \"%s\": %s", key, buf);
+}
+
+static inline void
+_dex_bench_begin_result (const char *name,
+                         guint64     n_ops,
+                         gint64      usec)
+{
+  double nsec_per_op = usec * 1000. / MAX (1, n_ops);
+  double ops_per_sec = n_ops * (double)G_USEC_PER_SEC / MAX (1, usec);
+
+  if (dex_bench.results->len > 0)
+    g_string_append (dex_bench.results, ",\n");
+
+  g_string_append_printf (dex_bench.results,
+                          "    { \"name\": \"%s\", \"n_ops\": %"G_GUINT64_FORMAT", \"usec\": %"G_GINT64_FORMAT,
+                          name, n_ops, usec);
+  _dex_bench_append_double ("nsec_per_op", nsec_per_op);
+  _dex_bench_append_double ("ops_per_sec", ops_per_sec);
+
+  g_printerr ("%-24s: %10"G_GUINT64_FORMAT" ops in %10.3lf msec (%10.1lf nsec/op, %12.0lf ops/sec)\n",
+              name, n_ops, usec / 1000., nsec_per_op, ops_per_sec);
+}
+
+/* Records @n_ops operations having taken @usec microseconds in total */
+static inline void
+dex_bench_report (const char *name,
+                  guint64     n_ops,
+                  gint64      usec)
+{
+  _dex_bench_begin_result (name, n_ops, usec);
+  g_string_append (dex_bench.results, " }");
+}
+
+/* Records a single measurement which is not a rate, such as the number
+ * of bytes held by a queue or the CPU time used while idle.
+ */
+static inline void
+dex_bench_report_metric (const char *name,
+                         double      value,
+                         const char *unit)
+{
+  if (dex_bench.results->len > 0)
+    g_string_append (dex_bench.results, ",\n");
+
+  g_string_append_printf (dex_bench.results, "    { \"name\": \"%s\"", name);
+  _dex_bench_append_double ("value", value);
+  g_string_append_printf (dex_bench.results, ", \"unit\": \"%s\" }", unit);
+
+  g_printerr ("%-24s: %10.3lf %s\n", name, value, unit);
+}
+
+static inline int
+_dex_bench_compare_samples (gconstpointer a,
+                            gconstpointer b)
+{
+  gint64 sa = *(const gint64 *)a;
+  gint64 sb = *(const gint64 *)b;
+
+  return sa < sb ? -1 : sa > sb;
+}
+
+/* Records the per-operation latency of @n_samples operations. @samples
+ * is sorted in place.
+ */
+static inline void
+dex_bench_report_samples (const char *name,
+                          gint64     *samples,
+                          guint       n_samples)
+{
+  gint64 total = 0;
+
+  g_return_if_fail (n_samples > 0);
+
+  qsort (samples, n_samples, sizeof *samples, _dex_bench_compare_samples);
+
+  for (guint i = 0; i < n_samples; i++)
+    total += samples[i];
+
+  _dex_bench_begin_result (name, n_samples, total);
+  g_string_append_printf (dex_bench.results,
+                          ", \"min_usec\": %"G_GINT64_FORMAT
+                          ", \"p50_usec\": %"G_GINT64_FORMAT
+                          ", \"p99_usec\": %"G_GINT64_FORMAT
+                          ", \"max_usec\": %"G_GINT64_FORMAT" }",
+                          samples[0],
+                          samples[n_samples / 2],
+                          samples[(gsize)n_samples * 99 / 100],
+                          samples[n_samples - 1]);
+
+  g_printerr ("%-24s: min %"G_GINT64_FORMAT" usec, p50 %"G_GINT64_FORMAT" usec, "
+              "p99 %"G_GINT64_FORMAT" usec, max %"G_GINT64_FORMAT" usec\n",
+              "", samples[0], samples[n_samples / 2],
+              samples[(gsize)n_samples * 99 / 100], samples[n_samples - 1]);
+}
+
+static inline DexFuture *
+_dex_bench_complete (DexFuture *completed,
+                     gpointer   user_data)
+{
+  return dex_ref (completed);
+}
+
+/* Iterates the default main context until @future completes and aborts
+ * the benchmark if it was rejected. The block ensures the main context
+ * is woken up even when @future completes on another thread.
+ */
+static inline void
+dex_bench_run (DexFuture *future)
+{
+  g_autoptr(GError) error = NULL;
+
+  future = dex_future_finally (future, _dex_bench_complete, NULL, NULL);
+
+  while (dex_future_is_pending (future))
+    g_main_context_iteration (NULL, TRUE);
+
+  if (!dex_future_get_value (future, &error))
+    g_error ("%s: %s", dex_bench.suite, error->message);
+
+  dex_unref (future);
+}
+
+/* Prints the JSON document and returns the exit status for main() */
+static inline int
+dex_bench_finish (void)
+{
+  g_autoptr(GString) json = g_string_new (NULL);
+  g_autoptr(GError) error = NULL;
+
+  g_string_append_printf (json,
+                          "{\n"
+                          "  \"suite\": \"%s\",\n"
+                          "  \"version\": \"%s\",\n"
+                          "  \"n_processors\": %u,\n"
+                          "  \"results\": [\n"
+                          "%s\n"
+                          "  ]\n"
+                          "}\n",
+                          dex_bench.suite,
+                          PACKAGE_VERSION,
+                          g_get_num_processors (),
+                          dex_bench.results->str);
+
+  g_string_free (g_steal_pointer (&dex_bench.results), TRUE);
+
+  if (dex_bench.output != NULL)
+    {
+      gboolean ret = g_file_set_contents (dex_bench.output, json->str, json->len, &error);
+
+      g_clear_pointer (&dex_bench.output, g_free);
+
+      if (!ret)
+        {
+          g_printerr ("%s\n", error->message);
+          return EXIT_FAILURE;
+        }
+    }
+  else
+    {
+      fputs (json->str, stdout);
+      fflush (stdout);
+    }
+
+  return EXIT_SUCCESS;
+}
+
+G_END_DECLS
@@ -0,0 +1,151 @@
+/* bench-work-queue.c
+ *
+ * Copyright 2026 Christian Hergert
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of the
+ * License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#include "config.h"
+
+#include "bench-util.h"
+
+#include "dex-work-queue-private.h"
+
+/* Measures push/pop throughput of the global work queue, which is what
+ * threads outside of the thread pool submit work to. Producers push as
+ * fast as they can while a fixed number of consumers pop. This is run
+ * with a growing number of producers to show how the queue behaves
+ * under contention.
+ */
+
+#define MAX_PRODUCERS 64
+
+typedef struct _Round
+{
+  DexWorkQueue *work_queue;
+  guint         n_items;
+  guint         n_producers;
+  guint         n_producers_done;
+} Round;
+
+static void
+nop_func (gpointer data)
+{
+}
+
+static gpointer
+producer_thread (gpointer data)
+{
+  Round *round = data;
+  DexWorkItem work_item = { nop_func, NULL };
+
+  for (guint i = 0; i < round->n_items; i++)
+    dex_work_queue_push (round->work_queue, work_item);
+
+  g_atomic_int_inc (&round->n_producers_done);
+
+  return NULL;
+}
+
+static gpointer
+consumer_thread (gpointer data)
+{
+  Round *round = data;
+  gsize popped = 0;
+
+  for (;;)
+    {
+      DexWorkItem work_item;
+
+      if (dex_work_queue_try_pop (round->work_queue, &work_item))
+        {
+          dex_work_item_invoke (&work_item);
+          popped++;
+          continue;
+        }
+
+      /* Producers are finished, drain anything left behind */
+      if ((guint)g_atomic_int_get (&round->n_producers_done) == round->n_producers)
+        {
+          while (dex_work_queue_try_pop (round->work_queue, &work_item))
+            {
+              dex_work_item_invoke (&work_item);
+              popped++;
+            }
+
+          break;
+        }
+    }
+
+  return GSIZE_TO_POINTER (popped);
+}
+
+static void
+bench_push_pop (DexWorkQueue *work_queue,
+                guint         n_producers,
+                guint         n_consumers,
+                guint         n_items)
+{
+  g_autofree GThread **producers = g_new0 (GThread *, n_producers);
+  g_autofree GThread **consumers = g_new0 (GThread *, n_consumers);
+  g_autofree char *name = NULL;
+  Round round = { work_queue, n_items, n_producers, 0 };
+  guint64 n_popped = 0;
+  gint64 begin;
+
+  begin = g_get_monotonic_time ();
+
+  for (guint i = 0; i < n_consumers; i++)
+    consumers[i] = g_thread_new ("consumer", consumer_thread, &round);
+  for (guint i = 0; i < n_producers; i++)
+    producers[i] = g_thread_new ("producer", producer_thread, &round);
+
+  for (guint i = 0; i < n_producers; i++)
+    g_thread_join (producers[i]);
+  for (guint i = 0; i < n_consumers; i++)
+    n_popped += GPOINTER_TO_SIZE (g_thread_join (consumers[i]));
+
+  g_assert_cmpint (n_popped, ==, (guint64)n_items * n_producers);
+
+  name = g_strdup_printf ("push-pop-%up", n_producers);
+  dex_bench_report (name, n_popped, g_get_monotonic_time () - begin);
+}
+
+int
+main (int   argc,
+      char *argv[])
+{
+  DexWorkQueue *work_queue;
+  int n_consumers = 0;
+  GOptionEntry entries[] = {
+    { "consumers", 'c', 0, G_OPTION_ARG_INT, &n_consumers, "Number of consumer threads.", "THREADS" },
+    { NULL }
+  };
+
+  dex_bench_init (&argc, &argv, "work-queue", entries);
+
+  if (n_consumers <= 0)
+    n_consumers = MAX (1, g_get_num_processors () / 2);
+
+  work_queue = dex_work_queue_new ();
+
+  for (guint n_producers = 1; n_producers <= MAX_PRODUCERS; n_producers *= 2)
+    bench_push_pop (work_queue, n_producers, n_consumers, dex_bench_scale (100000));
+
+  dex_unref (work_queue);
+
+  return dex_bench_finish ();
+}
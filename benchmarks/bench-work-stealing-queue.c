@@ -0,0 +1,253 @@
+/* bench-work-stealing-queue.c
+ *
+ * Copyright 2026 Christian Hergert
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of the
+ * License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#include "config.h"
+
+#include "bench-util.h"
+
+#include "dex-work-stealing-queue-private.h"
+
+/* Measures the work-stealing queue on its own, without any scheduler:
+ *
+ *  - the owner pushing and popping with nobody stealing
+ *  - the owner pushing while thieves steal one item at a time
+ *  - the same with thieves stealing half of the queue at a time
+ *  - the owner pushing one large burst before popping it while thieves
+ *    steal half of the queue at a time
+ *
+ * The latter three report the rate at which items were run by anyone.
+ * The burst also reports the memory held by the queue at its peak, once
+ * drained, and once trimmed. Retired arrays may only be reclaimed while
+ * no thief is looking, so the drained figure depends on how busy the
+ * thieves are.
+ */
+
+#define CAPACITY 32
+#define BATCH    256
+
+typedef struct _Steal
+{
+  DexWorkStealingQueue *victim;
+  guint                 n_run;
+  guint                 done;
+  guint                 half : 1;
+} Steal;
+
+static void
+count_func (gpointer data)
+{
+  Steal *steal = data;
+  g_atomic_int_inc (&steal->n_run);
+}
+
+static void
+nop_func (gpointer data)
+{
+}
+
+static gpointer
+thief_thread (gpointer data)
+{
+  Steal *steal = data;
+  DexWorkStealingQueue *local = dex_work_stealing_queue_new (CAPACITY);
+  DexWorkItem work_item;
+
+  while (!g_atomic_int_get (&steal->done))
+    {
+      if (steal->half)
+        {
+          if (dex_work_stealing_queue_steal_half (steal->victim, local, &work_item))
+            dex_work_item_invoke (&work_item);
+
+          while (dex_work_stealing_queue_pop (local, &work_item))
+            dex_work_item_invoke (&work_item);
+        }
+      else
+        {
+          if (dex_work_stealing_queue_steal (steal->victim, &work_item))
+            dex_work_item_invoke (&work_item);
+        }
+    }
+
+  dex_work_stealing_queue_unref (local);
+
+  return NULL;
+}
+
+static gsize
+array_size (gint64 capacity)
+{
+  return sizeof (DexWorkStealingArray) + (capacity * sizeof (DexWorkItem));
+}
+
+static gsize
+retained_size (DexWorkStealingQueue *work_stealing_queue)
+{
+  gsize size = array_size (dex_work_stealing_queue_capacity (work_stealing_queue));
+
+  for (guint i = 0; i < work_stealing_queue->garbage->len; i++)
+    {
+      DexWorkStealingArray *array = g_ptr_array_index (work_stealing_queue->garbage, i);
+      size += array_size (dex_work_stealing_array_capacity (array));
+    }
+
+  return size;
+}
+
+static void
+bench_push_pop (guint n_items)
+{
+  DexWorkStealingQueue *queue = dex_work_stealing_queue_new (CAPACITY);
+  DexWorkItem work_item = { nop_func, NULL };
+  guint n_batches = MAX (1, n_items / BATCH);
+  gint64 begin = g_get_monotonic_time ();
+
+  for (guint i = 0; i < n_batches; i++)
+    {
+      for (guint j = 0; j < BATCH; j++)
+        dex_work_stealing_queue_push (queue, work_item);
+
+      while (dex_work_stealing_queue_pop (queue, &work_item))
+        dex_work_item_invoke (&work_item);
+    }
+
+  dex_bench_report ("push-pop", (guint64)n_batches * BATCH, g_get_monotonic_time () - begin);
+
+  dex_work_stealing_queue_unref (queue);
+}
+
+static void
+bench_steal (const char *name,
+             guint       n_items,
+             guint       n_thieves,
+             gboolean    half)
+{
+  g_autofree GThread **thieves = g_new0 (GThread *, n_thieves);
+  Steal steal = {0};
+  DexWorkItem work_item = { count_func, &steal };
+  gint64 begin;
+
+  steal.victim = dex_work_stealing_queue_new (CAPACITY);
+  steal.half = !!half;
+
+  for (guint i = 0; i < n_thieves; i++)
+    thieves[i] = g_thread_new ("thief", thief_thread, &steal);
+
+  begin = g_get_monotonic_time ();
+
+  for (guint i = 0; i < n_items; i++)
+    {
+      dex_work_stealing_queue_push (steal.victim, work_item);
+
+      /* Keep the owner busy too, as a worker would be */
+      if (i % BATCH == 0)
+        {
+          DexWorkItem popped;
+
+          if (dex_work_stealing_queue_pop (steal.victim, &popped))
+            dex_work_item_invoke (&popped);
+        }
+    }
+
+  while (dex_work_stealing_queue_pop (steal.victim, &work_item))
+    dex_work_item_invoke (&work_item);
+
+  while ((guint)g_atomic_int_get (&steal.n_run) < n_items)
+    g_thread_yield ();
+
+  dex_bench_report (name, n_items, g_get_monotonic_time () - begin);
+
+  g_atomic_int_set (&steal.done, TRUE);
+
+  for (guint i = 0; i < n_thieves; i++)
+    g_thread_join (thieves[i]);
+
+  dex_work_stealing_queue_unref (steal.victim);
+}
+
+static void
+bench_burst (guint n_items,
+             guint n_thieves)
+{
+  g_autofree GThread **thieves = g_new0 (GThread *, n_thieves);
+  Steal steal = {0};
+  DexWorkItem work_item = { count_func, &steal };
+  gsize peak;
+  gsize drained;
+  gint64 begin;
+
+  steal.victim = dex_work_stealing_queue_new (CAPACITY);
+  steal.half = TRUE;
+
+  for (guint i = 0; i < n_thieves; i++)
+    thieves[i] = g_thread_new ("thief", thief_thread, &steal);
+
+  begin = g_get_monotonic_time ();
+
+  for (guint i = 0; i < n_items; i++)
+    dex_work_stealing_queue_push (steal.victim, work_item);
+
+  peak = retained_size (steal.victim);
+
+  while (dex_work_stealing_queue_pop (steal.victim, &work_item))
+    dex_work_item_invoke (&work_item);
+
+  while ((guint)g_atomic_int_get (&steal.n_run) < n_items)
+    g_thread_yield ();
+
+  dex_bench_report ("burst", n_items, g_get_monotonic_time () - begin);
+
+  drained = retained_size (steal.victim);
+  dex_work_stealing_queue_trim (steal.victim);
+
+  dex_bench_report_metric ("burst-peak", peak, "bytes");
+  dex_bench_report_metric ("burst-drained", drained, "bytes");
+  dex_bench_report_metric ("burst-trimmed", retained_size (steal.victim), "bytes");
+
+  g_atomic_int_set (&steal.done, TRUE);
+
+  for (guint i = 0; i < n_thieves; i++)
+    g_thread_join (thieves[i]);
+
+  dex_work_stealing_queue_unref (steal.victim);
+}
+
+int
+main (int   argc,
+      char *argv[])
+{
+  int n_thieves = 0;
+  GOptionEntry entries[] = {
+    { "thieves", 't', 0, G_OPTION_ARG_INT, &n_thieves, "Number of thief threads.", "THREADS" },
+    { NULL }
+  };
+
+  dex_bench_init (&argc, &argv, "work-stealing-queue", entries);
+
+  if (n_thieves <= 0)
+    n_thieves = CLAMP (g_get_num_processors () - 1, 1, 8);
+
+  bench_push_pop (dex_bench_scale (10000000));
+  bench_steal ("steal", dex_bench_scale (2000000), n_thieves, FALSE);
+  bench_steal ("steal-half", dex_bench_scale (2000000), n_thieves, TRUE);
+  bench_burst (dex_bench_scale (1000000), n_thieves);
+
+  return dex_bench_finish ();
+}
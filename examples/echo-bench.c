@@ -20,8 +20,27 @@
 
 #include "config.h"
 
+#include <sys/socket.h>
+#include <unistd.h>
+
 #include <libdex.h>
 
+/* By default clients use dex_aio_connect(), dex_aio_send() and
+ * dex_aio_recv() on raw file descriptors. Pass --gio to use
+ * GSocketClient and GIOStream instead for comparison.
+ *
+ * Every GIO operation wrapped by libdex needs a GCancellable. To measure
+ * the cost of creating one per operation, compare --gio runs with and
+ * without DEX_CANCELLABLE_POOL_SIZE=0 in the environment:
+ *
+ *   ./tcp-echo &
+ *   ./echo-bench -a 127.0.0.1:8080 -d 30 --gio
+ *   DEX_CANCELLABLE_POOL_SIZE=0 ./echo-bench -a 127.0.0.1:8080 -d 30 --gio
+ *
+ * The pool size in use is printed along with the other parameters so
+ * that the results can be told apart.
+ */
+
 typedef struct _Worker
 {
   gint64 conn_attempts;
@@ -41,6 +60,8 @@ static Worker *workers;
 static guint n_workers;
 static gboolean in_shutdown;
 static GTimer *timer;
+static struct sockaddr_storage native_address;
+static socklen_t native_address_len;
 
 static DexFuture *
 worker_fiber (gpointer user_data)
@@ -85,6 +106,80 @@ worker_fiber (gpointer user_data)
   return NULL;
 }
 
+static DexFuture *
+aio_worker_fiber (gpointer user_data)
+{
+  Worker *worker = user_data;
+  g_autofree char *inbuf = g_malloc (buflen);
+
+  while (!g_atomic_int_get (&in_shutdown))
+    {
+      gint64 len;
+      int fd;
+
+      worker->conn_attempts++;
+
+      if (-1 == (fd = socket (native_address.ss_family, SOCK_STREAM | SOCK_CLOEXEC, 0)))
+        {
+          worker->conn_failures++;
+          break;
+        }
+
+      if (!dex_await (dex_aio_connect (NULL, fd, (struct sockaddr *)&native_address, native_address_len), NULL))
+        {
+          worker->conn_failures++;
+          close (fd);
+          break;
+        }
+
+      worker->conn_success++;
+
+      if ((len = dex_await_int64 (dex_aio_send (NULL, fd, buf, buflen, MSG_NOSIGNAL), NULL)) <= 0)
+        {
+          close (fd);
+          break;
+        }
+      worker->bytes_sent += len;
+
+      if ((len = dex_await_int64 (dex_aio_recv (NULL, fd, inbuf, buflen, 0), NULL)) <= 0)
+        {
+          close (fd);
+          break;
+        }
+      worker->bytes_received += len;
+
+      dex_await (dex_aio_close (NULL, fd), NULL);
+    }
+
+  return NULL;
+}
+
+static gboolean
+resolve_native_address (GError **error)
+{
+  g_autoptr(GSocketAddressEnumerator) enumerator = NULL;
+  g_autoptr(GSocketAddress) address = NULL;
+
+  enumerator = g_socket_connectable_enumerate (socket_address);
+
+  if (!(address = g_socket_address_enumerator_next (enumerator, NULL, error)))
+    {
+      if (error != NULL && *error == NULL)
+        g_set_error_literal (error,
+                             G_IO_ERROR,
+                             G_IO_ERROR_NOT_FOUND,
+                             "No address found");
+      return FALSE;
+    }
+
+  if (!g_socket_address_to_native (address, &native_address, sizeof native_address, error))
+    return FALSE;
+
+  native_address_len = g_socket_address_get_native_size (address);
+
+  return TRUE;
+}
+
 static DexFuture *
 shutdown_cb (DexFuture *completed,
              gpointer   user_data)
@@ -153,6 +248,7 @@ main (int   argc,
   g_autoptr(GError) error = NULL;
   g_autofree char *address = NULL;
   g_autofree char *message = NULL;
+  gboolean use_gio = FALSE;
   int length = 0;
   int duration = 0;
   int number = 0;
@@ -163,6 +259,7 @@ main (int   argc,
     { "duration", 'd', 0, G_OPTION_ARG_INT, &duration, "Test duration in seconds.", "SECONDS" },
     { "number", 'c', 0, G_OPTION_ARG_INT, &number, "Number of concurrent connections.", "CONNECTIONS" },
     { "message", 'm', 0, G_OPTION_ARG_STRING, &message, "A custom message to send.", "MSG" },
+    { "gio", 0, 0, G_OPTION_ARG_NONE, &use_gio, "Use GSocketClient and GIOStream instead of dex_aio.", NULL },
     { NULL }
   };
 
@@ -190,6 +287,13 @@ main (int   argc,
   if (length <= 0)
     length = 512;
 
+  /* Resolve once up front for the raw socket path */
+  if (!use_gio && !resolve_native_address (&error))
+    {
+      g_printerr ("%s\n", error->message);
+      return EXIT_FAILURE;
+    }
+
   /* Rewrite the address to show the user what we think we parsed */
   g_free (address);
   address = g_socket_connectable_to_string (socket_address);
@@ -214,7 +318,15 @@ main (int   argc,
     }
 
   g_printerr ("Benchmarking: %s\n", address);
-  g_printerr ("%u clients, running %u bytes, %u sec.\n", number, length, duration);
+  g_printerr ("%u clients, running %u bytes, %u sec. (%s)\n",
+              number, length, duration, use_gio ? "gio" : "aio");
+  if (use_gio)
+    {
+      const char *pool_size = g_getenv ("DEX_CANCELLABLE_POOL_SIZE");
+
+      g_printerr ("DEX_CANCELLABLE_POOL_SIZE=%s\n",
+                  pool_size != NULL ? pool_size : "(default)");
+    }
 
   /* Space for the workers to track information */
   n_workers = number;
@@ -231,7 +343,9 @@ main (int   argc,
   fibers = g_ptr_array_new_with_free_func (dex_unref);
   for (int i = 0; i < number; i++)
     g_ptr_array_add (fibers,
-                     dex_scheduler_spawn (thread_pool, 0, worker_fiber, &workers[i], NULL));
+                     dex_scheduler_spawn (thread_pool, 0,
+                                          use_gio ? worker_fiber : aio_worker_fiber,
+                                          &workers[i], NULL));
 
   /* After @duration seconds, reject */
   future = dex_timeout_new_seconds (duration);
@@ -20,8 +20,20 @@
 
 #include "config.h"
 
+#include <errno.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
 #include <libdex.h>
 
+/* By default connections are serviced with dex_aio_accept(), dex_aio_recv()
+ * and dex_aio_send() on raw file descriptors which, when available, are
+ * submitted to io_uring on the thread pool worker running the fiber.
+ *
+ * Pass --gio to use GSocketListener and GIOStream instead for comparison.
+ */
+
 static DexScheduler *thread_pool;
 
 static DexFuture *
@@ -86,6 +98,104 @@ socket_listener_fiber (gpointer user_data)
   return NULL;
 }
 
+static DexFuture *
+aio_connection_fiber (gpointer user_data)
+{
+  int fd = GPOINTER_TO_INT (user_data);
+  GError *error = NULL;
+  guint8 buffer[1024];
+
+  for (;;)
+    {
+      gint64 n_read;
+      gint64 to_write;
+      gint64 n_written = 0;
+
+      n_read = dex_await_int64 (dex_aio_recv (NULL, fd, buffer, sizeof buffer, 0), &error);
+      if (n_read <= 0)
+        break;
+
+      for (to_write = n_read; to_write > 0; to_write -= n_written)
+        {
+          n_written = dex_await_int64 (dex_aio_send (NULL, fd, &buffer[n_read-to_write], to_write, MSG_NOSIGNAL), &error);
+          if (n_written <= 0)
+            break;
+        }
+
+      if (n_written <= 0)
+        break;
+    }
+
+  dex_future_disown (dex_aio_close (NULL, fd));
+
+  return error ? dex_future_new_for_error (error) : NULL;
+}
+
+static DexFuture *
+aio_listener_fiber (gpointer user_data)
+{
+  int listen_fd = GPOINTER_TO_INT (user_data);
+
+  for (;;)
+    {
+      g_autoptr(DexFuture) fiber = NULL;
+      g_autoptr(GError) error = NULL;
+      int fd;
+
+      /* Accept an incoming connection */
+      if (-1 == (fd = dex_await_fd (dex_aio_accept (NULL, listen_fd, NULL, NULL, SOCK_CLOEXEC), &error)))
+        return dex_future_new_for_error (g_steal_pointer (&error));
+
+      /* Spawn a fiber to handle connection on thread pool */
+      fiber = dex_scheduler_spawn (thread_pool, 0,
+                                   aio_connection_fiber,
+                                   GINT_TO_POINTER (fd),
+                                   NULL);
+    }
+
+  return NULL;
+}
+
+static int
+create_listen_socket (guint    port,
+                      GError **error)
+{
+  struct sockaddr_in addr = {0};
+  int one = 1;
+  int fd;
+
+  /* Non-blocking so the posix fallback can poll() for connections */
+  if (-1 == (fd = socket (AF_INET, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0)))
+    goto failure;
+
+  setsockopt (fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof one);
+
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl (INADDR_ANY);
+  addr.sin_port = htons (port);
+
+  if (bind (fd, (struct sockaddr *)&addr, sizeof addr) != 0 ||
+      listen (fd, SOMAXCONN) != 0)
+    goto failure;
+
+  return fd;
+
+failure:
+  {
+    int errsv = errno;
+
+    if (fd != -1)
+      close (fd);
+
+    g_set_error_literal (error,
+                         G_IO_ERROR,
+                         g_io_error_from_errno (errsv),
+                         g_strerror (errsv));
+
+    return -1;
+  }
+}
+
 static DexFuture *
 quit_cb (DexFuture *completed,
          gpointer   user_data)
@@ -99,29 +209,67 @@ int
 main (int   argc,
       char *argv[])
 {
+  g_autoptr(GOptionContext) context = NULL;
   g_autoptr(GSocketListener) socket_listener = NULL;
   g_autoptr(GMainLoop) main_loop = NULL;
   g_autoptr(DexFuture) future = NULL;
   g_autoptr(GError) error = NULL;
-  guint port = 8080;
+  gboolean use_gio = FALSE;
+  int port = 0;
+
+  GOptionEntry entries[] = {
+    { "port", 'p', 0, G_OPTION_ARG_INT, &port, "Port to listen on.", "8080" },
+    { "gio", 0, 0, G_OPTION_ARG_NONE, &use_gio, "Use GSocketListener and GIOStream instead of dex_aio.", NULL },
+    { NULL }
+  };
+
+  context = g_option_context_new ("- Simple echo server");
+  g_option_context_add_main_entries (context, entries, NULL);
+
+  if (!g_option_context_parse (context, &argc, &argv, &error))
+    {
+      g_printerr ("%s\n", error->message);
+      return EXIT_FAILURE;
+    }
+
+  if (port <= 0 || port > G_MAXUINT16)
+    port = 8080;
 
   dex_init ();
 
   main_loop = g_main_loop_new (NULL, FALSE);
   thread_pool = dex_thread_pool_scheduler_new ();
-  socket_listener = g_socket_listener_new ();
 
-  /* Try to listen on configured port, or bail */
-  if (!g_socket_listener_add_inet_port (socket_listener, port, NULL, &error))
-    g_error ("Failed to listen on port %u: %s", port, error->message);
+  if (use_gio)
+    {
+      socket_listener = g_socket_listener_new ();
+
+      /* Try to listen on configured port, or bail */
+      if (!g_socket_listener_add_inet_port (socket_listener, port, NULL, &error))
+        g_error ("Failed to listen on port %u: %s", port, error->message);
+
+      /* Spawn a fiber on current thread for socket loop */
+      future = dex_scheduler_spawn (NULL, 0,
+                                    socket_listener_fiber,
+                                    g_object_ref (socket_listener),
+                                    g_object_unref);
+    }
+  else
+    {
+      int listen_fd;
 
-  g_print ("Listening on 0.0.0.0:%u\n", port);
+      /* Try to listen on configured port, or bail */
+      if (-1 == (listen_fd = create_listen_socket (port, &error)))
+        g_error ("Failed to listen on port %u: %s", port, error->message);
+
+      /* Spawn a fiber on current thread for socket loop */
+      future = dex_scheduler_spawn (NULL, 0,
+                                    aio_listener_fiber,
+                                    GINT_TO_POINTER (listen_fd),
+                                    NULL);
+    }
 
-  /* Spawn a fiber on current thread for socket loop */
-  future = dex_scheduler_spawn (NULL, 0,
-                                socket_listener_fiber,
-                                g_object_ref (socket_listener),
-                                g_object_unref);
+  g_print ("Listening on 0.0.0.0:%u (%s)\n", port, use_gio ? "gio" : "aio");
 
   /* When it completes, call quit_cb to quit main loop */
   future = dex_future_finally (future,
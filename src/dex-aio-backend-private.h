@@ -20,6 +20,8 @@
 
 #pragma once
 
+#include "dex-aio.h"
+#include "dex-channel.h"
 #include "dex-object-private.h"
 #include "dex-future.h"
 
@@ -44,27 +46,144 @@ struct _DexAioBackendClass
 {
   DexObjectClass parent_class;
 
-  DexAioContext *(*create_context) (DexAioBackend *aio_backend);
-  DexFuture     *(*close)          (DexAioBackend *aio_backend,
-                                    DexAioContext *aio_context,
-                                    int            fd);
-  DexFuture     *(*open)           (DexAioBackend *aio_backend,
-                                    DexAioContext *aio_context,
-                                    const char    *path,
-                                    int            flags,
-                                    int            mode);
-  DexFuture     *(*read)           (DexAioBackend *aio_backend,
-                                    DexAioContext *aio_context,
-                                    int            fd,
-                                    gpointer       buffer,
-                                    gsize          count,
-                                    goffset        offset);
-  DexFuture     *(*write)          (DexAioBackend *aio_backend,
-                                    DexAioContext *aio_context,
-                                    int            fd,
-                                    gconstpointer  buffer,
-                                    gsize          count,
-                                    goffset        offset);
+  DexAioContext *(*create_context)   (DexAioBackend          *aio_backend);
+  DexFuture     *(*close)            (DexAioBackend          *aio_backend,
+                                      DexAioContext          *aio_context,
+                                      int                     fd);
+  DexFuture     *(*open)             (DexAioBackend          *aio_backend,
+                                      DexAioContext          *aio_context,
+                                      const char             *path,
+                                      int                     flags,
+                                      int                     mode);
+  DexFuture     *(*read)             (DexAioBackend          *aio_backend,
+                                      DexAioContext          *aio_context,
+                                      int                     fd,
+                                      gpointer                buffer,
+                                      gsize                   count,
+                                      goffset                 offset);
+  DexFuture     *(*write)            (DexAioBackend          *aio_backend,
+                                      DexAioContext          *aio_context,
+                                      int                     fd,
+                                      gconstpointer           buffer,
+                                      gsize                   count,
+                                      goffset                 offset);
+  DexFuture     *(*fsync)            (DexAioBackend          *aio_backend,
+                                      DexAioContext          *aio_context,
+                                      int                     fd,
+                                      gboolean                datasync);
+  DexFuture     *(*statx)            (DexAioBackend          *aio_backend,
+                                      DexAioContext          *aio_context,
+                                      int                     dirfd,
+                                      const char             *path,
+                                      int                     flags,
+                                      guint                   mask,
+                                      struct statx           *statxbuf);
+  DexFuture     *(*fallocate)        (DexAioBackend          *aio_backend,
+                                      DexAioContext          *aio_context,
+                                      int                     fd,
+                                      int                     mode,
+                                      goffset                 offset,
+                                      goffset                 length);
+  DexFuture     *(*readv)            (DexAioBackend          *aio_backend,
+                                      DexAioContext          *aio_context,
+                                      int                     fd,
+                                      GInputVector           *vectors,
+                                      guint                   n_vectors,
+                                      goffset                 offset);
+  DexFuture     *(*writev)           (DexAioBackend          *aio_backend,
+                                      DexAioContext          *aio_context,
+                                      int                     fd,
+                                      const GOutputVector    *vectors,
+                                      guint                   n_vectors,
+                                      goffset                 offset);
+  DexFuture     *(*splice)           (DexAioBackend          *aio_backend,
+                                      DexAioContext          *aio_context,
+                                      int                     fd_in,
+                                      goffset                 offset_in,
+                                      int                     fd_out,
+                                      goffset                 offset_out,
+                                      gsize                   length,
+                                      guint                   flags);
+  DexFuture     *(*renameat)         (DexAioBackend          *aio_backend,
+                                      DexAioContext          *aio_context,
+                                      int                     old_dirfd,
+                                      const char             *old_path,
+                                      int                     new_dirfd,
+                                      const char             *new_path,
+                                      guint                   flags);
+  DexFuture     *(*unlinkat)         (DexAioBackend          *aio_backend,
+                                      DexAioContext          *aio_context,
+                                      int                     dirfd,
+                                      const char             *path,
+                                      int                     flags);
+  DexFuture     *(*mkdirat)          (DexAioBackend          *aio_backend,
+                                      DexAioContext          *aio_context,
+                                      int                     dirfd,
+                                      const char             *path,
+                                      int                     mode);
+  gboolean       (*register_files)   (DexAioBackend          *aio_backend,
+                                      DexAioContext          *aio_context,
+                                      const int              *fds,
+                                      guint                   n_fds,
+                                      int                    *fixed_fds,
+                                      GError                **error);
+  gboolean       (*register_buffers) (DexAioBackend          *aio_backend,
+                                      DexAioContext          *aio_context,
+                                      const GInputVector     *buffers,
+                                      guint                   n_buffers,
+                                      GError                **error);
+  int            (*poll)             (DexAioBackend          *aio_backend,
+                                      DexAioContext          *aio_context,
+                                      GPollFD                *fds,
+                                      guint                   n_fds,
+                                      int                     timeout);
+#ifdef G_OS_UNIX
+  DexFuture     *(*accept)           (DexAioBackend          *aio_backend,
+                                      DexAioContext          *aio_context,
+                                      int                     fd,
+                                      struct sockaddr        *addr,
+                                      socklen_t              *addrlen,
+                                      int                     flags);
+  DexFuture     *(*connect)          (DexAioBackend          *aio_backend,
+                                      DexAioContext          *aio_context,
+                                      int                     fd,
+                                      const struct sockaddr  *addr,
+                                      socklen_t               addrlen);
+  DexFuture     *(*recv)             (DexAioBackend          *aio_backend,
+                                      DexAioContext          *aio_context,
+                                      int                     fd,
+                                      gpointer                buffer,
+                                      gsize                   count,
+                                      int                     flags);
+  DexFuture     *(*send)             (DexAioBackend          *aio_backend,
+                                      DexAioContext          *aio_context,
+                                      int                     fd,
+                                      gconstpointer           buffer,
+                                      gsize                   count,
+                                      int                     flags);
+  DexFuture     *(*recvmsg)          (DexAioBackend          *aio_backend,
+                                      DexAioContext          *aio_context,
+                                      int                     fd,
+                                      struct msghdr          *msg,
+                                      int                     flags);
+  DexFuture     *(*sendmsg)          (DexAioBackend          *aio_backend,
+                                      DexAioContext          *aio_context,
+                                      int                     fd,
+                                      const struct msghdr    *msg,
+                                      int                     flags);
+  DexFuture     *(*accept_stream)    (DexAioBackend          *aio_backend,
+                                      DexAioContext          *aio_context,
+                                      int                     fd,
+                                      int                     flags,
+                                      DexChannel             *channel);
+  DexFuture     *(*recv_stream)      (DexAioBackend          *aio_backend,
+                                      DexAioContext          *aio_context,
+                                      int                     fd,
+                                      gsize                   buffer_size,
+                                      guint                   n_buffers,
+                                      int                     flags,
+                                      DexChannel             *channel);
+#endif
 };
 
 struct _DexAioContext
@@ -74,28 +193,145 @@ struct _DexAioContext
   /*< private >*/
 };
 
-GType          dex_aio_backend_get_type       (void);
-DexAioBackend *dex_aio_backend_get_default    (void);
-DexAioContext *dex_aio_backend_create_context (DexAioBackend *aio_backend);
-DexFuture     *dex_aio_backend_close          (DexAioBackend *aio_backend,
-                                               DexAioContext *aio_context,
-                                               int            fd);
-DexFuture     *dex_aio_backend_open           (DexAioBackend *aio_backend,
-                                               DexAioContext *aio_context,
-                                               const char    *path,
-                                               int            flags,
-                                               int            mode);
-DexFuture     *dex_aio_backend_read           (DexAioBackend *aio_backend,
-                                               DexAioContext *aio_context,
-                                               int            fd,
-                                               gpointer       buffer,
-                                               gsize          count,
-                                               goffset        offset);
-DexFuture     *dex_aio_backend_write          (DexAioBackend *aio_backend,
-                                               DexAioContext *aio_context,
-                                               int            fd,
-                                               gconstpointer  buffer,
-                                               gsize          count,
-                                               goffset        offset);
+GType          dex_aio_backend_get_type         (void);
+DexAioBackend *dex_aio_backend_get_default      (void);
+DexAioContext *dex_aio_backend_create_context   (DexAioBackend          *aio_backend);
+DexFuture     *dex_aio_backend_close            (DexAioBackend          *aio_backend,
+                                                 DexAioContext          *aio_context,
+                                                 int                     fd);
+DexFuture     *dex_aio_backend_open             (DexAioBackend          *aio_backend,
+                                                 DexAioContext          *aio_context,
+                                                 const char             *path,
+                                                 int                     flags,
+                                                 int                     mode);
+DexFuture     *dex_aio_backend_read             (DexAioBackend          *aio_backend,
+                                                 DexAioContext          *aio_context,
+                                                 int                     fd,
+                                                 gpointer                buffer,
+                                                 gsize                   count,
+                                                 goffset                 offset);
+DexFuture     *dex_aio_backend_write            (DexAioBackend          *aio_backend,
+                                                 DexAioContext          *aio_context,
+                                                 int                     fd,
+                                                 gconstpointer           buffer,
+                                                 gsize                   count,
+                                                 goffset                 offset);
+DexFuture     *dex_aio_backend_fsync            (DexAioBackend          *aio_backend,
+                                                 DexAioContext          *aio_context,
+                                                 int                     fd,
+                                                 gboolean                datasync);
+DexFuture     *dex_aio_backend_statx            (DexAioBackend          *aio_backend,
+                                                 DexAioContext          *aio_context,
+                                                 int                     dirfd,
+                                                 const char             *path,
+                                                 int                     flags,
+                                                 guint                   mask,
+                                                 struct statx           *statxbuf);
+DexFuture     *dex_aio_backend_fallocate        (DexAioBackend          *aio_backend,
+                                                 DexAioContext          *aio_context,
+                                                 int                     fd,
+                                                 int                     mode,
+                                                 goffset                 offset,
+                                                 goffset                 length);
+DexFuture     *dex_aio_backend_readv            (DexAioBackend          *aio_backend,
+                                                 DexAioContext          *aio_context,
+                                                 int                     fd,
+                                                 GInputVector           *vectors,
+                                                 guint                   n_vectors,
+                                                 goffset                 offset);
+DexFuture     *dex_aio_backend_writev           (DexAioBackend          *aio_backend,
+                                                 DexAioContext          *aio_context,
+                                                 int                     fd,
+                                                 const GOutputVector    *vectors,
+                                                 guint                   n_vectors,
+                                                 goffset                 offset);
+DexFuture     *dex_aio_backend_splice           (DexAioBackend          *aio_backend,
+                                                 DexAioContext          *aio_context,
+                                                 int                     fd_in,
+                                                 goffset                 offset_in,
+                                                 int                     fd_out,
+                                                 goffset                 offset_out,
+                                                 gsize                   length,
+                                                 guint                   flags);
+DexFuture     *dex_aio_backend_renameat         (DexAioBackend          *aio_backend,
+                                                 DexAioContext          *aio_context,
+                                                 int                     old_dirfd,
+                                                 const char             *old_path,
+                                                 int                     new_dirfd,
+                                                 const char             *new_path,
+                                                 guint                   flags);
+DexFuture     *dex_aio_backend_unlinkat         (DexAioBackend          *aio_backend,
+                                                 DexAioContext          *aio_context,
+                                                 int                     dirfd,
+                                                 const char             *path,
+                                                 int                     flags);
+DexFuture     *dex_aio_backend_mkdirat          (DexAioBackend          *aio_backend,
+                                                 DexAioContext          *aio_context,
+                                                 int                     dirfd,
+                                                 const char             *path,
+                                                 int                     mode);
+gboolean       dex_aio_backend_register_files   (DexAioBackend          *aio_backend,
+                                                 DexAioContext          *aio_context,
+                                                 const int              *fds,
+                                                 guint                   n_fds,
+                                                 int                    *fixed_fds,
+                                                 GError                **error);
+gboolean       dex_aio_backend_register_buffers (DexAioBackend          *aio_backend,
+                                                 DexAioContext          *aio_context,
+                                                 const GInputVector     *buffers,
+                                                 guint                   n_buffers,
+                                                 GError                **error);
+int            dex_aio_backend_poll             (DexAioBackend          *aio_backend,
+                                                 DexAioContext          *aio_context,
+                                                 GPollFD                *fds,
+                                                 guint                   n_fds,
+                                                 int                     timeout);
+#ifdef G_OS_UNIX
+DexFuture     *dex_aio_backend_accept           (DexAioBackend          *aio_backend,
+                                                 DexAioContext          *aio_context,
+                                                 int                     fd,
+                                                 struct sockaddr        *addr,
+                                                 socklen_t              *addrlen,
+                                                 int                     flags);
+DexFuture     *dex_aio_backend_connect          (DexAioBackend          *aio_backend,
+                                                 DexAioContext          *aio_context,
+                                                 int                     fd,
+                                                 const struct sockaddr  *addr,
+                                                 socklen_t               addrlen);
+DexFuture     *dex_aio_backend_recv             (DexAioBackend          *aio_backend,
+                                                 DexAioContext          *aio_context,
+                                                 int                     fd,
+                                                 gpointer                buffer,
+                                                 gsize                   count,
+                                                 int                     flags);
+DexFuture     *dex_aio_backend_send             (DexAioBackend          *aio_backend,
+                                                 DexAioContext          *aio_context,
+                                                 int                     fd,
+                                                 gconstpointer           buffer,
+                                                 gsize                   count,
+                                                 int                     flags);
+DexFuture     *dex_aio_backend_recvmsg          (DexAioBackend          *aio_backend,
+                                                 DexAioContext          *aio_context,
+                                                 int                     fd,
+                                                 struct msghdr          *msg,
+                                                 int                     flags);
+DexFuture     *dex_aio_backend_sendmsg          (DexAioBackend          *aio_backend,
+                                                 DexAioContext          *aio_context,
+                                                 int                     fd,
+                                                 const struct msghdr    *msg,
+                                                 int                     flags);
+DexFuture     *dex_aio_backend_accept_stream    (DexAioBackend          *aio_backend,
+                                                 DexAioContext          *aio_context,
+                                                 int                     fd,
+                                                 int                     flags,
+                                                 DexChannel             *channel);
+DexFuture     *dex_aio_backend_recv_stream      (DexAioBackend          *aio_backend,
+                                                 DexAioContext          *aio_context,
+                                                 int                     fd,
+                                                 gsize                   buffer_size,
+                                                 guint                   n_buffers,
+                                                 int                     flags,
+                                                 DexChannel             *channel);
+#endif
 
 G_END_DECLS
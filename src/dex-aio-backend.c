@@ -20,9 +20,13 @@
 
 #include "config.h"
 
+#include <string.h>
+
 #include <gio/gio.h>
 
 #include "dex-aio-backend-private.h"
+#include "dex-channel.h"
+#include "dex-scheduler.h"
 
 #ifdef HAVE_LIBURING
 # include "dex-uring-aio-backend-private.h"
@@ -32,9 +36,221 @@
 
 DEX_DEFINE_ABSTRACT_TYPE (DexAioBackend, dex_aio_backend, DEX_TYPE_OBJECT)
 
+/* Registration is only an optimization, so backends which have no use
+ * for it accept it and hand back the file descriptors as handles.
+ */
+static gboolean
+dex_aio_backend_real_register_files (DexAioBackend  *aio_backend,
+                                     DexAioContext  *aio_context,
+                                     const int      *fds,
+                                     guint           n_fds,
+                                     int            *fixed_fds,
+                                     GError        **error)
+{
+  if (fixed_fds != NULL && n_fds > 0)
+    memcpy (fixed_fds, fds, sizeof (int) * n_fds);
+
+  return TRUE;
+}
+
+static gboolean
+dex_aio_backend_real_register_buffers (DexAioBackend       *aio_backend,
+                                       DexAioContext       *aio_context,
+                                       const GInputVector  *buffers,
+                                       guint                n_buffers,
+                                       GError             **error)
+{
+  return TRUE;
+}
+
+static int
+dex_aio_backend_real_poll (DexAioBackend *aio_backend,
+                           DexAioContext *aio_context,
+                           GPollFD       *fds,
+                           guint          n_fds,
+                           int            timeout)
+{
+  return g_poll (fds, n_fds, timeout);
+}
+
+#ifdef G_OS_UNIX
+typedef struct _DexAioStream
+{
+  DexAioBackend *aio_backend;
+  DexAioContext *aio_context;
+  DexChannel    *channel;
+  int            fd;
+  int            flags;
+  gsize          buffer_size;
+} DexAioStream;
+
+static void
+dex_aio_stream_free (DexAioStream *stream)
+{
+  dex_clear (&stream->aio_backend);
+  dex_clear (&stream->channel);
+  g_clear_pointer ((GSource **)&stream->aio_context, g_source_unref);
+  g_free (stream);
+}
+
+static DexAioStream *
+dex_aio_stream_new (DexAioBackend *aio_backend,
+                    DexAioContext *aio_context,
+                    DexChannel    *channel,
+                    int            fd,
+                    int            flags,
+                    gsize          buffer_size)
+{
+  DexAioStream *stream;
+
+  stream = g_new0 (DexAioStream, 1);
+  stream->aio_backend = dex_ref (aio_backend);
+  stream->aio_context = (DexAioContext *)g_source_ref ((GSource *)aio_context);
+  stream->channel = dex_ref (channel);
+  stream->fd = fd;
+  stream->flags = flags;
+  stream->buffer_size = buffer_size;
+
+  return stream;
+}
+
+static gboolean
+dex_aio_stream_is_open (DexAioStream *stream)
+{
+  return dex_channel_can_send (stream->channel) &&
+         dex_channel_can_receive (stream->channel);
+}
+
+static DexFuture *
+dex_aio_stream_finish (DexAioStream *stream,
+                       GError       *error)
+{
+  dex_channel_close_send (stream->channel);
+
+  if (error != NULL)
+    return dex_future_new_for_error (error);
+
+  return dex_future_new_true ();
+}
+
+static DexFuture *
+dex_aio_backend_accept_stream_fiber (gpointer user_data)
+{
+  DexAioStream *stream = user_data;
+  GError *error = NULL;
+
+  while (dex_aio_stream_is_open (stream))
+    {
+      DexFuture *accepted;
+      int fd;
+
+      fd = dex_await_fd (dex_aio_backend_accept (stream->aio_backend,
+                                                 stream->aio_context,
+                                                 stream->fd,
+                                                 NULL, NULL,
+                                                 stream->flags),
+                         &error);
+
+      if (fd == -1)
+        break;
+
+      /* Waiting for the send to complete is what keeps us from accepting
+       * faster than the receiver can keep up with.
+       */
+      accepted = dex_future_new_for_fd (fd);
+      if (!dex_await (dex_channel_send (stream->channel, accepted), NULL))
+        break;
+    }
+
+  return dex_aio_stream_finish (stream, error);
+}
+
+static DexFuture *
+dex_aio_backend_real_accept_stream (DexAioBackend *aio_backend,
+                                    DexAioContext *aio_context,
+                                    int            fd,
+                                    int            flags,
+                                    DexChannel    *channel)
+{
+  DexScheduler *scheduler;
+
+  if (!(scheduler = dex_scheduler_get_thread_default ()))
+    scheduler = dex_scheduler_get_default ();
+
+  return dex_scheduler_spawn (scheduler, 0,
+                              dex_aio_backend_accept_stream_fiber,
+                              dex_aio_stream_new (aio_backend, aio_context, channel, fd, flags, 0),
+                              (GDestroyNotify)dex_aio_stream_free);
+}
+
+static DexFuture *
+dex_aio_backend_recv_stream_fiber (gpointer user_data)
+{
+  DexAioStream *stream = user_data;
+  g_autofree guint8 *buffer = g_malloc (stream->buffer_size);
+  GError *error = NULL;
+
+  while (dex_aio_stream_is_open (stream))
+    {
+      DexFuture *received;
+      gint64 n_read;
+
+      n_read = dex_await_int64 (dex_aio_backend_recv (stream->aio_backend,
+                                                      stream->aio_context,
+                                                      stream->fd,
+                                                      buffer,
+                                                      stream->buffer_size,
+                                                      stream->flags),
+                                &error);
+
+      /* Zero means the peer performed an orderly shutdown */
+      if (n_read <= 0)
+        break;
+
+      /* Same as accepting, don't receive more until the channel has room
+       * so that the rest stays in the socket buffer.
+       */
+      received = dex_future_new_take_boxed (G_TYPE_BYTES, g_bytes_new (buffer, n_read));
+      if (!dex_await (dex_channel_send (stream->channel, received), NULL))
+        break;
+    }
+
+  return dex_aio_stream_finish (stream, error);
+}
+
+static DexFuture *
+dex_aio_backend_real_recv_stream (DexAioBackend *aio_backend,
+                                  DexAioContext *aio_context,
+                                  int            fd,
+                                  gsize          buffer_size,
+                                  guint          n_buffers,
+                                  int            flags,
+                                  DexChannel    *channel)
+{
+  DexScheduler *scheduler;
+
+  if (!(scheduler = dex_scheduler_get_thread_default ()))
+    scheduler = dex_scheduler_get_default ();
+
+  /* Only a single buffer is in flight at a time so @n_buffers is unused */
+  return dex_scheduler_spawn (scheduler, 0,
+                              dex_aio_backend_recv_stream_fiber,
+                              dex_aio_stream_new (aio_backend, aio_context, channel, fd, flags, buffer_size),
+                              (GDestroyNotify)dex_aio_stream_free);
+}
+#endif
+
 static void
 dex_aio_backend_class_init (DexAioBackendClass *aio_backend_class)
 {
+  aio_backend_class->register_files = dex_aio_backend_real_register_files;
+  aio_backend_class->register_buffers = dex_aio_backend_real_register_buffers;
+  aio_backend_class->poll = dex_aio_backend_real_poll;
+
+#ifdef G_OS_UNIX
+  aio_backend_class->accept_stream = dex_aio_backend_real_accept_stream;
+  aio_backend_class->recv_stream = dex_aio_backend_real_recv_stream;
+#endif
 }
 
 static void
@@ -57,7 +273,7 @@ dex_aio_backend_close (DexAioBackend *aio_backend,
 {
   dex_return_error_if_fail (DEX_IS_AIO_BACKEND (aio_backend));
   dex_return_error_if_fail (aio_context != NULL);
-  dex_return_error_if_fail (fd > -1);
+  dex_return_error_if_fail (fd != -1);
 
   return DEX_AIO_BACKEND_GET_CLASS (aio_backend)->close (aio_backend, aio_context, fd);
 }
@@ -105,6 +321,333 @@ dex_aio_backend_write (DexAioBackend *aio_backend,
   return DEX_AIO_BACKEND_GET_CLASS (aio_backend)->write (aio_backend, aio_context, fd, buffer, count, offset);
 }
 
+DexFuture *
+dex_aio_backend_fsync (DexAioBackend *aio_backend,
+                       DexAioContext *aio_context,
+                       int            fd,
+                       gboolean       datasync)
+{
+  dex_return_error_if_fail (DEX_IS_AIO_BACKEND (aio_backend));
+  dex_return_error_if_fail (aio_context != NULL);
+
+  return DEX_AIO_BACKEND_GET_CLASS (aio_backend)->fsync (aio_backend, aio_context, fd, !!datasync);
+}
+
+DexFuture *
+dex_aio_backend_statx (DexAioBackend *aio_backend,
+                       DexAioContext *aio_context,
+                       int            dirfd,
+                       const char    *path,
+                       int            flags,
+                       guint          mask,
+                       struct statx  *statxbuf)
+{
+  dex_return_error_if_fail (DEX_IS_AIO_BACKEND (aio_backend));
+  dex_return_error_if_fail (aio_context != NULL);
+  dex_return_error_if_fail (path != NULL);
+  dex_return_error_if_fail (statxbuf != NULL);
+
+  return DEX_AIO_BACKEND_GET_CLASS (aio_backend)->statx (aio_backend, aio_context,
+                                                         dirfd, path, flags, mask, statxbuf);
+}
+
+DexFuture *
+dex_aio_backend_fallocate (DexAioBackend *aio_backend,
+                           DexAioContext *aio_context,
+                           int            fd,
+                           int            mode,
+                           goffset        offset,
+                           goffset        length)
+{
+  dex_return_error_if_fail (DEX_IS_AIO_BACKEND (aio_backend));
+  dex_return_error_if_fail (aio_context != NULL);
+  dex_return_error_if_fail (offset >= 0);
+  dex_return_error_if_fail (length > 0);
+
+  return DEX_AIO_BACKEND_GET_CLASS (aio_backend)->fallocate (aio_backend, aio_context,
+                                                             fd, mode, offset, length);
+}
+
+DexFuture *
+dex_aio_backend_readv (DexAioBackend *aio_backend,
+                       DexAioContext *aio_context,
+                       int            fd,
+                       GInputVector  *vectors,
+                       guint          n_vectors,
+                       goffset        offset)
+{
+  dex_return_error_if_fail (DEX_IS_AIO_BACKEND (aio_backend));
+  dex_return_error_if_fail (aio_context != NULL);
+  dex_return_error_if_fail (vectors != NULL || n_vectors == 0);
+
+  return DEX_AIO_BACKEND_GET_CLASS (aio_backend)->readv (aio_backend, aio_context,
+                                                         fd, vectors, n_vectors, offset);
+}
+
+DexFuture *
+dex_aio_backend_writev (DexAioBackend       *aio_backend,
+                        DexAioContext       *aio_context,
+                        int                  fd,
+                        const GOutputVector *vectors,
+                        guint                n_vectors,
+                        goffset              offset)
+{
+  dex_return_error_if_fail (DEX_IS_AIO_BACKEND (aio_backend));
+  dex_return_error_if_fail (aio_context != NULL);
+  dex_return_error_if_fail (vectors != NULL || n_vectors == 0);
+
+  return DEX_AIO_BACKEND_GET_CLASS (aio_backend)->writev (aio_backend, aio_context,
+                                                          fd, vectors, n_vectors, offset);
+}
+
+DexFuture *
+dex_aio_backend_splice (DexAioBackend *aio_backend,
+                        DexAioContext *aio_context,
+                        int            fd_in,
+                        goffset        offset_in,
+                        int            fd_out,
+                        goffset        offset_out,
+                        gsize          length,
+                        guint          flags)
+{
+  dex_return_error_if_fail (DEX_IS_AIO_BACKEND (aio_backend));
+  dex_return_error_if_fail (aio_context != NULL);
+
+  return DEX_AIO_BACKEND_GET_CLASS (aio_backend)->splice (aio_backend, aio_context,
+                                                          fd_in, offset_in,
+                                                          fd_out, offset_out,
+                                                          length, flags);
+}
+
+DexFuture *
+dex_aio_backend_renameat (DexAioBackend *aio_backend,
+                          DexAioContext *aio_context,
+                          int            old_dirfd,
+                          const char    *old_path,
+                          int            new_dirfd,
+                          const char    *new_path,
+                          guint          flags)
+{
+  dex_return_error_if_fail (DEX_IS_AIO_BACKEND (aio_backend));
+  dex_return_error_if_fail (aio_context != NULL);
+  dex_return_error_if_fail (old_path != NULL);
+  dex_return_error_if_fail (new_path != NULL);
+
+  return DEX_AIO_BACKEND_GET_CLASS (aio_backend)->renameat (aio_backend, aio_context,
+                                                            old_dirfd, old_path,
+                                                            new_dirfd, new_path,
+                                                            flags);
+}
+
+DexFuture *
+dex_aio_backend_unlinkat (DexAioBackend *aio_backend,
+                          DexAioContext *aio_context,
+                          int            dirfd,
+                          const char    *path,
+                          int            flags)
+{
+  dex_return_error_if_fail (DEX_IS_AIO_BACKEND (aio_backend));
+  dex_return_error_if_fail (aio_context != NULL);
+  dex_return_error_if_fail (path != NULL);
+
+  return DEX_AIO_BACKEND_GET_CLASS (aio_backend)->unlinkat (aio_backend, aio_context,
+                                                            dirfd, path, flags);
+}
+
+DexFuture *
+dex_aio_backend_mkdirat (DexAioBackend *aio_backend,
+                         DexAioContext *aio_context,
+                         int            dirfd,
+                         const char    *path,
+                         int            mode)
+{
+  dex_return_error_if_fail (DEX_IS_AIO_BACKEND (aio_backend));
+  dex_return_error_if_fail (aio_context != NULL);
+  dex_return_error_if_fail (path != NULL);
+
+  return DEX_AIO_BACKEND_GET_CLASS (aio_backend)->mkdirat (aio_backend, aio_context,
+                                                           dirfd, path, mode);
+}
+
+gboolean
+dex_aio_backend_register_files (DexAioBackend  *aio_backend,
+                                DexAioContext  *aio_context,
+                                const int      *fds,
+                                guint           n_fds,
+                                int            *fixed_fds,
+                                GError        **error)
+{
+  g_return_val_if_fail (DEX_IS_AIO_BACKEND (aio_backend), FALSE);
+  g_return_val_if_fail (aio_context != NULL, FALSE);
+  g_return_val_if_fail (fds != NULL || n_fds == 0, FALSE);
+
+  return DEX_AIO_BACKEND_GET_CLASS (aio_backend)->register_files (aio_backend, aio_context,
+                                                                  fds, n_fds, fixed_fds, error);
+}
+
+gboolean
+dex_aio_backend_register_buffers (DexAioBackend       *aio_backend,
+                                  DexAioContext       *aio_context,
+                                  const GInputVector  *buffers,
+                                  guint                n_buffers,
+                                  GError             **error)
+{
+  g_return_val_if_fail (DEX_IS_AIO_BACKEND (aio_backend), FALSE);
+  g_return_val_if_fail (aio_context != NULL, FALSE);
+  g_return_val_if_fail (buffers != NULL || n_buffers == 0, FALSE);
+
+  return DEX_AIO_BACKEND_GET_CLASS (aio_backend)->register_buffers (aio_backend, aio_context,
+                                                                    buffers, n_buffers, error);
+}
+
+/*
+ * dex_aio_backend_poll:
+ *
+ * Used in place of g_poll() by thread pool workers so that a backend
+ * which can wait on completions and file descriptors at once may do so
+ * from a single system call. Must be called from the thread owning
+ * @aio_context.
+ */
+int
+dex_aio_backend_poll (DexAioBackend *aio_backend,
+                      DexAioContext *aio_context,
+                      GPollFD       *fds,
+                      guint          n_fds,
+                      int            timeout)
+{
+  g_return_val_if_fail (DEX_IS_AIO_BACKEND (aio_backend), -1);
+  g_return_val_if_fail (aio_context != NULL, -1);
+
+  return DEX_AIO_BACKEND_GET_CLASS (aio_backend)->poll (aio_backend, aio_context, fds, n_fds, timeout);
+}
+
+#ifdef G_OS_UNIX
+DexFuture *
+dex_aio_backend_accept (DexAioBackend   *aio_backend,
+                        DexAioContext   *aio_context,
+                        int              fd,
+                        struct sockaddr *addr,
+                        socklen_t       *addrlen,
+                        int              flags)
+{
+  dex_return_error_if_fail (DEX_IS_AIO_BACKEND (aio_backend));
+  dex_return_error_if_fail (aio_context != NULL);
+
+  return DEX_AIO_BACKEND_GET_CLASS (aio_backend)->accept (aio_backend, aio_context,
+                                                          fd, addr, addrlen, flags);
+}
+
+DexFuture *
+dex_aio_backend_connect (DexAioBackend         *aio_backend,
+                         DexAioContext         *aio_context,
+                         int                    fd,
+                         const struct sockaddr *addr,
+                         socklen_t              addrlen)
+{
+  dex_return_error_if_fail (DEX_IS_AIO_BACKEND (aio_backend));
+  dex_return_error_if_fail (aio_context != NULL);
+  dex_return_error_if_fail (addr != NULL);
+
+  return DEX_AIO_BACKEND_GET_CLASS (aio_backend)->connect (aio_backend, aio_context,
+                                                           fd, addr, addrlen);
+}
+
+DexFuture *
+dex_aio_backend_recv (DexAioBackend *aio_backend,
+                      DexAioContext *aio_context,
+                      int            fd,
+                      gpointer       buffer,
+                      gsize          count,
+                      int            flags)
+{
+  dex_return_error_if_fail (DEX_IS_AIO_BACKEND (aio_backend));
+  dex_return_error_if_fail (aio_context != NULL);
+
+  return DEX_AIO_BACKEND_GET_CLASS (aio_backend)->recv (aio_backend, aio_context,
+                                                        fd, buffer, count, flags);
+}
+
+DexFuture *
+dex_aio_backend_send (DexAioBackend *aio_backend,
+                      DexAioContext *aio_context,
+                      int            fd,
+                      gconstpointer  buffer,
+                      gsize          count,
+                      int            flags)
+{
+  dex_return_error_if_fail (DEX_IS_AIO_BACKEND (aio_backend));
+  dex_return_error_if_fail (aio_context != NULL);
+
+  return DEX_AIO_BACKEND_GET_CLASS (aio_backend)->send (aio_backend, aio_context,
+                                                        fd, buffer, count, flags);
+}
+
+DexFuture *
+dex_aio_backend_recvmsg (DexAioBackend *aio_backend,
+                         DexAioContext *aio_context,
+                         int            fd,
+                         struct msghdr *msg,
+                         int            flags)
+{
+  dex_return_error_if_fail (DEX_IS_AIO_BACKEND (aio_backend));
+  dex_return_error_if_fail (aio_context != NULL);
+  dex_return_error_if_fail (msg != NULL);
+
+  return DEX_AIO_BACKEND_GET_CLASS (aio_backend)->recvmsg (aio_backend, aio_context,
+                                                           fd, msg, flags);
+}
+
+DexFuture *
+dex_aio_backend_sendmsg (DexAioBackend       *aio_backend,
+                         DexAioContext       *aio_context,
+                         int                  fd,
+                         const struct msghdr *msg,
+                         int                  flags)
+{
+  dex_return_error_if_fail (DEX_IS_AIO_BACKEND (aio_backend));
+  dex_return_error_if_fail (aio_context != NULL);
+  dex_return_error_if_fail (msg != NULL);
+
+  return DEX_AIO_BACKEND_GET_CLASS (aio_backend)->sendmsg (aio_backend, aio_context,
+                                                           fd, msg, flags);
+}
+
+DexFuture *
+dex_aio_backend_accept_stream (DexAioBackend *aio_backend,
+                               DexAioContext *aio_context,
+                               int            fd,
+                               int            flags,
+                               DexChannel    *channel)
+{
+  dex_return_error_if_fail (DEX_IS_AIO_BACKEND (aio_backend));
+  dex_return_error_if_fail (aio_context != NULL);
+  dex_return_error_if_fail (DEX_IS_CHANNEL (channel));
+
+  return DEX_AIO_BACKEND_GET_CLASS (aio_backend)->accept_stream (aio_backend, aio_context,
+                                                                 fd, flags, channel);
+}
+
+DexFuture *
+dex_aio_backend_recv_stream (DexAioBackend *aio_backend,
+                             DexAioContext *aio_context,
+                             int            fd,
+                             gsize          buffer_size,
+                             guint          n_buffers,
+                             int            flags,
+                             DexChannel    *channel)
+{
+  dex_return_error_if_fail (DEX_IS_AIO_BACKEND (aio_backend));
+  dex_return_error_if_fail (aio_context != NULL);
+  dex_return_error_if_fail (buffer_size > 0);
+  dex_return_error_if_fail (n_buffers > 0);
+  dex_return_error_if_fail (DEX_IS_CHANNEL (channel));
+
+  return DEX_AIO_BACKEND_GET_CLASS (aio_backend)->recv_stream (aio_backend, aio_context,
+                                                               fd, buffer_size, n_buffers,
+                                                               flags, channel);
+}
+#endif
+
 DexAioBackend *
 dex_aio_backend_get_default (void)
 {
@@ -27,6 +27,9 @@
 #include "dex-scheduler-private.h"
 #include "dex-thread-storage-private.h"
 
+#define DEFAULT_RECV_BUFFER_SIZE 4096
+#define DEFAULT_RECV_N_BUFFERS   64
+
 static DexAioContext *
 dex_aio_context_current (void)
 {
@@ -49,6 +52,9 @@ dex_aio_context_current (void)
  * An asynchronous `close()` wrapper.
  *
  * This function takes ownership of @fd and will close it asynchronously.
+ * If @fd is registered with @aio_context, it is unregistered first and may
+ * be given either as the file descriptor or as the handle returned from
+ * dex_aio_register_files().
  *
  * Generally you want to provide `NULL` for the @aio_context as that
  * will get the default aio context for your scheduler.
@@ -62,7 +68,7 @@ DexFuture *
 dex_aio_close (DexAioContext *aio_context,
                int            fd)
 {
-  dex_return_error_if_fail (fd > -1);
+  dex_return_error_if_fail (fd != -1);
 
   if (aio_context == NULL)
     aio_context = dex_aio_context_current ();
@@ -161,3 +167,705 @@ dex_aio_write (DexAioContext *aio_context,
   return dex_aio_backend_write (aio_context->aio_backend, aio_context,
                                 fd, buffer, count, offset);
 }
+
+/**
+ * dex_aio_fsync:
+ * @aio_context: (nullable):
+ * @fd: the file descriptor to flush
+ *
+ * An asynchronous `fsync()` wrapper.
+ *
+ * Generally you want to provide `NULL` for the @aio_context as that
+ * will get the default aio context for your scheduler.
+ *
+ * Returns: (transfer full): a future that will resolve to %TRUE when the
+ *   data and metadata of @fd have been flushed or rejects with error.
+ *
+ * Since: 1.2
+ */
+DexFuture *
+dex_aio_fsync (DexAioContext *aio_context,
+               int            fd)
+{
+  if (aio_context == NULL)
+    aio_context = dex_aio_context_current ();
+
+  return dex_aio_backend_fsync (aio_context->aio_backend, aio_context, fd, FALSE);
+}
+
+/**
+ * dex_aio_fdatasync:
+ * @aio_context: (nullable):
+ * @fd: the file descriptor to flush
+ *
+ * An asynchronous `fdatasync()` wrapper.
+ *
+ * Unlike [func@Dex.aio_fsync], metadata which is not needed to read
+ * the data back, such as modification times, may not be flushed.
+ *
+ * Returns: (transfer full): a future that will resolve to %TRUE when the
+ *   data of @fd has been flushed or rejects with error.
+ *
+ * Since: 1.2
+ */
+DexFuture *
+dex_aio_fdatasync (DexAioContext *aio_context,
+                   int            fd)
+{
+  if (aio_context == NULL)
+    aio_context = dex_aio_context_current ();
+
+  return dex_aio_backend_fsync (aio_context->aio_backend, aio_context, fd, TRUE);
+}
+
+/**
+ * dex_aio_statx: (skip)
+ * @aio_context: (nullable):
+ * @dirfd: a directory file descriptor or `AT_FDCWD`
+ * @path: the path relative to @dirfd
+ * @flags: flags for `statx()` such as `AT_SYMLINK_NOFOLLOW`
+ * @mask: the `STATX_*` fields that are requested
+ * @statxbuf: (out caller-allocates): location for the result
+ *
+ * An asynchronous `statx()` wrapper.
+ *
+ * @statxbuf must remain valid until the future completes.
+ *
+ * Returns: (transfer full): a future that will resolve to %TRUE when
+ *   @statxbuf has been filled or rejects with error.
+ *
+ * Since: 1.2
+ */
+DexFuture *
+dex_aio_statx (DexAioContext *aio_context,
+               int            dirfd,
+               const char    *path,
+               int            flags,
+               guint          mask,
+               struct statx  *statxbuf)
+{
+  dex_return_error_if_fail (path != NULL);
+  dex_return_error_if_fail (statxbuf != NULL);
+
+  if (aio_context == NULL)
+    aio_context = dex_aio_context_current ();
+
+  return dex_aio_backend_statx (aio_context->aio_backend, aio_context,
+                                dirfd, path, flags, mask, statxbuf);
+}
+
+/**
+ * dex_aio_fallocate:
+ * @aio_context: (nullable):
+ * @fd: the file descriptor to allocate space for
+ * @mode: the `fallocate()` mode, or 0
+ * @offset: the offset of the range
+ * @length: the length of the range
+ *
+ * An asynchronous `fallocate()` wrapper.
+ *
+ * Where `fallocate()` is unavailable, only a @mode of 0 is supported.
+ *
+ * Returns: (transfer full): a future that will resolve to %TRUE when the
+ *   range has been allocated or rejects with error.
+ *
+ * Since: 1.2
+ */
+DexFuture *
+dex_aio_fallocate (DexAioContext *aio_context,
+                   int            fd,
+                   int            mode,
+                   goffset        offset,
+                   goffset        length)
+{
+  if (aio_context == NULL)
+    aio_context = dex_aio_context_current ();
+
+  return dex_aio_backend_fallocate (aio_context->aio_backend, aio_context,
+                                    fd, mode, offset, length);
+}
+
+/**
+ * dex_aio_readv:
+ * @aio_context: (nullable):
+ * @fd: the file descriptor to read from
+ * @vectors: (array length=n_vectors): the buffers to read into
+ * @n_vectors: the number of elements in @vectors
+ * @offset: the positioned offset within @fd to read from, or -1
+ *
+ * An asynchronous `preadv()` wrapper.
+ *
+ * The buffers pointed to by @vectors must remain valid until the
+ * future completes. @vectors itself is copied.
+ *
+ * Returns: (transfer full): a future that will resolve to the number of
+ *   bytes read or rejects with error.
+ *
+ * Since: 1.2
+ */
+DexFuture *
+dex_aio_readv (DexAioContext *aio_context,
+               int            fd,
+               GInputVector  *vectors,
+               guint          n_vectors,
+               goffset        offset)
+{
+  if (aio_context == NULL)
+    aio_context = dex_aio_context_current ();
+
+  return dex_aio_backend_readv (aio_context->aio_backend, aio_context,
+                                fd, vectors, n_vectors, offset);
+}
+
+/**
+ * dex_aio_writev:
+ * @aio_context: (nullable):
+ * @fd: the file descriptor to write to
+ * @vectors: (array length=n_vectors): the buffers to write
+ * @n_vectors: the number of elements in @vectors
+ * @offset: the positioned offset within @fd to write at, or -1
+ *
+ * An asynchronous `pwritev()` wrapper.
+ *
+ * The buffers pointed to by @vectors must remain valid until the
+ * future completes. @vectors itself is copied.
+ *
+ * Returns: (transfer full): a future that will resolve to the number of
+ *   bytes written or rejects with error.
+ *
+ * Since: 1.2
+ */
+DexFuture *
+dex_aio_writev (DexAioContext       *aio_context,
+                int                  fd,
+                const GOutputVector *vectors,
+                guint                n_vectors,
+                goffset              offset)
+{
+  if (aio_context == NULL)
+    aio_context = dex_aio_context_current ();
+
+  return dex_aio_backend_writev (aio_context->aio_backend, aio_context,
+                                 fd, vectors, n_vectors, offset);
+}
+
+/**
+ * dex_aio_splice:
+ * @aio_context: (nullable):
+ * @fd_in: the file descriptor to read from
+ * @offset_in: the offset within @fd_in, or -1 to use the file position
+ * @fd_out: the file descriptor to write to
+ * @offset_out: the offset within @fd_out, or -1 to use the file position
+ * @length: the number of bytes to move
+ * @flags: `SPLICE_F_*` flags
+ *
+ * An asynchronous `splice()` wrapper.
+ *
+ * One of @fd_in or @fd_out must be a pipe. This is only supported on
+ * Linux.
+ *
+ * Returns: (transfer full): a future that will resolve to the number of
+ *   bytes moved or rejects with error.
+ *
+ * Since: 1.2
+ */
+DexFuture *
+dex_aio_splice (DexAioContext *aio_context,
+                int            fd_in,
+                goffset        offset_in,
+                int            fd_out,
+                goffset        offset_out,
+                gsize          length,
+                guint          flags)
+{
+  if (aio_context == NULL)
+    aio_context = dex_aio_context_current ();
+
+  return dex_aio_backend_splice (aio_context->aio_backend, aio_context,
+                                 fd_in, offset_in, fd_out, offset_out,
+                                 length, flags);
+}
+
+/**
+ * dex_aio_renameat:
+ * @aio_context: (nullable):
+ * @old_dirfd: a directory file descriptor or `AT_FDCWD`
+ * @old_path: the path to rename relative to @old_dirfd
+ * @new_dirfd: a directory file descriptor or `AT_FDCWD`
+ * @new_path: the new path relative to @new_dirfd
+ * @flags: `RENAME_*` flags as supported by `renameat2()`, or 0
+ *
+ * An asynchronous `renameat2()` wrapper.
+ *
+ * Returns: (transfer full): a future that will resolve to %TRUE when the
+ *   rename completes or rejects with error.
+ *
+ * Since: 1.2
+ */
+DexFuture *
+dex_aio_renameat (DexAioContext *aio_context,
+                  int            old_dirfd,
+                  const char    *old_path,
+                  int            new_dirfd,
+                  const char    *new_path,
+                  guint          flags)
+{
+  dex_return_error_if_fail (old_path != NULL);
+  dex_return_error_if_fail (new_path != NULL);
+
+  if (aio_context == NULL)
+    aio_context = dex_aio_context_current ();
+
+  return dex_aio_backend_renameat (aio_context->aio_backend, aio_context,
+                                   old_dirfd, old_path, new_dirfd, new_path,
+                                   flags);
+}
+
+/**
+ * dex_aio_unlinkat:
+ * @aio_context: (nullable):
+ * @dirfd: a directory file descriptor or `AT_FDCWD`
+ * @path: the path to remove relative to @dirfd
+ * @flags: `AT_REMOVEDIR` to remove a directory, or 0
+ *
+ * An asynchronous `unlinkat()` wrapper.
+ *
+ * Returns: (transfer full): a future that will resolve to %TRUE when the
+ *   path has been removed or rejects with error.
+ *
+ * Since: 1.2
+ */
+DexFuture *
+dex_aio_unlinkat (DexAioContext *aio_context,
+                  int            dirfd,
+                  const char    *path,
+                  int            flags)
+{
+  dex_return_error_if_fail (path != NULL);
+
+  if (aio_context == NULL)
+    aio_context = dex_aio_context_current ();
+
+  return dex_aio_backend_unlinkat (aio_context->aio_backend, aio_context,
+                                   dirfd, path, flags);
+}
+
+/**
+ * dex_aio_mkdirat:
+ * @aio_context: (nullable):
+ * @dirfd: a directory file descriptor or `AT_FDCWD`
+ * @path: the path to create relative to @dirfd
+ * @mode: permissions to use when creating the directory
+ *
+ * An asynchronous `mkdirat()` wrapper.
+ *
+ * Returns: (transfer full): a future that will resolve to %TRUE when the
+ *   directory has been created or rejects with error.
+ *
+ * Since: 1.2
+ */
+DexFuture *
+dex_aio_mkdirat (DexAioContext *aio_context,
+                 int            dirfd,
+                 const char    *path,
+                 int            mode)
+{
+  dex_return_error_if_fail (path != NULL);
+
+  if (aio_context == NULL)
+    aio_context = dex_aio_context_current ();
+
+  return dex_aio_backend_mkdirat (aio_context->aio_backend, aio_context,
+                                  dirfd, path, mode);
+}
+
+/**
+ * dex_aio_register_files: (skip)
+ * @aio_context: (nullable):
+ * @fds: (array length=n_fds) (nullable): the file descriptors to register
+ * @n_fds: the number of elements in @fds
+ * @fixed_fds: (array length=n_fds) (nullable): location for the handle
+ *   of each registered file
+ * @error: a location for a #GError
+ *
+ * Registers @fds with @aio_context so that requests on them can skip
+ * looking up the file every time. This replaces any previously
+ * registered file descriptors, and passing zero for @n_fds unregisters
+ * them all.
+ *
+ * Only requests given a handle from @fixed_fds in place of the file
+ * descriptor use the registered file. Handles work with dex_aio_read(),
+ * dex_aio_write(), dex_aio_readv(), dex_aio_writev(), dex_aio_fsync(),
+ * dex_aio_fallocate() and dex_aio_close(), and only on @aio_context.
+ * The plain file descriptors keep referring to whatever file has that
+ * number, so they are never redirected to a registered file.
+ *
+ * Closing a registered file with dex_aio_close(), by either its file
+ * descriptor or its handle, unregisters it. It must not be closed by
+ * other means while registered. Requests given the handle of a closed
+ * file, or a handle from an earlier registration, fail.
+ *
+ * This must be called from the thread @aio_context belongs to. Backends
+ * which have no use for registration ignore it and use the file
+ * descriptors themselves as handles.
+ *
+ * Returns: %TRUE if successful; otherwise %FALSE and @error is set.
+ *
+ * Since: 1.2
+ */
+gboolean
+dex_aio_register_files (DexAioContext  *aio_context,
+                        const int      *fds,
+                        guint           n_fds,
+                        int            *fixed_fds,
+                        GError        **error)
+{
+  g_return_val_if_fail (fds != NULL || n_fds == 0, FALSE);
+
+  if (aio_context == NULL)
+    aio_context = dex_aio_context_current ();
+
+  return dex_aio_backend_register_files (aio_context->aio_backend, aio_context,
+                                         fds, n_fds, fixed_fds, error);
+}
+
+/**
+ * dex_aio_register_buffers: (skip)
+ * @aio_context: (nullable):
+ * @buffers: (array length=n_buffers) (nullable): the buffers to register
+ * @n_buffers: the number of elements in @buffers
+ * @error: a location for a #GError
+ *
+ * Registers @buffers with @aio_context so that the kernel can keep their
+ * pages mapped rather than pinning them for every request. Reads and
+ * writes whose buffer falls entirely within a registered buffer use it
+ * automatically. This replaces any previously registered buffers, and
+ * passing zero for @n_buffers unregisters them all.
+ *
+ * The memory described by @buffers must remain valid while registered.
+ *
+ * This must be called from the thread @aio_context belongs to. Backends
+ * which have no use for registration ignore it.
+ *
+ * Returns: %TRUE if successful; otherwise %FALSE and @error is set.
+ *
+ * Since: 1.2
+ */
+gboolean
+dex_aio_register_buffers (DexAioContext       *aio_context,
+                          const GInputVector  *buffers,
+                          guint                n_buffers,
+                          GError             **error)
+{
+  g_return_val_if_fail (buffers != NULL || n_buffers == 0, FALSE);
+
+  if (aio_context == NULL)
+    aio_context = dex_aio_context_current ();
+
+  return dex_aio_backend_register_buffers (aio_context->aio_backend, aio_context,
+                                           buffers, n_buffers, error);
+}
+
+#ifdef G_OS_UNIX
+/**
+ * dex_aio_accept: (skip)
+ * @aio_context: (nullable):
+ * @fd: a listening socket
+ * @addr: (nullable): location for the peer address
+ * @addrlen: (nullable) (inout): the size of @addr
+ * @flags: flags for `accept4()` such as `SOCK_CLOEXEC`
+ *
+ * An asynchronous `accept4()` wrapper.
+ *
+ * If provided, @addr and @addrlen must remain valid until the future
+ * completes.
+ *
+ * Returns: (transfer full): a future that will resolve to a #DexFD
+ *   containing the accepted socket or rejects with error.
+ *
+ * Since: 1.2
+ */
+DexFuture *
+dex_aio_accept (DexAioContext   *aio_context,
+                int              fd,
+                struct sockaddr *addr,
+                socklen_t       *addrlen,
+                int              flags)
+{
+  dex_return_error_if_fail (fd >= 0);
+  dex_return_error_if_fail (addr == NULL || addrlen != NULL);
+
+  if (aio_context == NULL)
+    aio_context = dex_aio_context_current ();
+
+  return dex_aio_backend_accept (aio_context->aio_backend, aio_context,
+                                 fd, addr, addrlen, flags);
+}
+
+/**
+ * dex_aio_connect: (skip)
+ * @aio_context: (nullable):
+ * @fd: a socket
+ * @addr: the address to connect to
+ * @addrlen: the size of @addr
+ *
+ * An asynchronous `connect()` wrapper.
+ *
+ * @addr is copied and need not remain valid after calling this function.
+ *
+ * Returns: (transfer full): a future that will resolve to %TRUE when the
+ *   connection has been established or rejects with error.
+ *
+ * Since: 1.2
+ */
+DexFuture *
+dex_aio_connect (DexAioContext         *aio_context,
+                 int                    fd,
+                 const struct sockaddr *addr,
+                 socklen_t              addrlen)
+{
+  dex_return_error_if_fail (fd >= 0);
+  dex_return_error_if_fail (addr != NULL);
+  dex_return_error_if_fail (addrlen > 0);
+
+  if (aio_context == NULL)
+    aio_context = dex_aio_context_current ();
+
+  return dex_aio_backend_connect (aio_context->aio_backend, aio_context,
+                                  fd, addr, addrlen);
+}
+
+/**
+ * dex_aio_recv: (skip)
+ * @aio_context: (nullable):
+ * @fd: a socket
+ * @buffer: the buffer to receive into
+ * @count: the size of @buffer
+ * @flags: flags for `recv()` such as `MSG_WAITALL`
+ *
+ * An asynchronous `recv()` wrapper.
+ *
+ * @buffer must remain valid until the future completes.
+ *
+ * Returns: (transfer full): a future that will resolve to a gint64
+ *   containing the number of bytes received or rejects with error.
+ *   Zero indicates the peer has performed an orderly shutdown.
+ *
+ * Since: 1.2
+ */
+DexFuture *
+dex_aio_recv (DexAioContext *aio_context,
+              int            fd,
+              gpointer       buffer,
+              gsize          count,
+              int            flags)
+{
+  dex_return_error_if_fail (fd >= 0);
+  dex_return_error_if_fail (buffer != NULL || count == 0);
+
+  if (aio_context == NULL)
+    aio_context = dex_aio_context_current ();
+
+  return dex_aio_backend_recv (aio_context->aio_backend, aio_context,
+                               fd, buffer, count, flags);
+}
+
+/**
+ * dex_aio_send: (skip)
+ * @aio_context: (nullable):
+ * @fd: a socket
+ * @buffer: the data to send
+ * @count: the number of bytes in @buffer
+ * @flags: flags for `send()` such as `MSG_NOSIGNAL`
+ *
+ * An asynchronous `send()` wrapper.
+ *
+ * @buffer must remain valid until the future completes.
+ *
+ * Returns: (transfer full): a future that will resolve to a gint64
+ *   containing the number of bytes sent or rejects with error.
+ *
+ * Since: 1.2
+ */
+DexFuture *
+dex_aio_send (DexAioContext *aio_context,
+              int            fd,
+              gconstpointer  buffer,
+              gsize          count,
+              int            flags)
+{
+  dex_return_error_if_fail (fd >= 0);
+  dex_return_error_if_fail (buffer != NULL || count == 0);
+
+  if (aio_context == NULL)
+    aio_context = dex_aio_context_current ();
+
+  return dex_aio_backend_send (aio_context->aio_backend, aio_context,
+                               fd, buffer, count, flags);
+}
+
+/**
+ * dex_aio_recvmsg: (skip)
+ * @aio_context: (nullable):
+ * @fd: a socket
+ * @msg: the message header describing where to receive into
+ * @flags: flags for `recvmsg()`
+ *
+ * An asynchronous `recvmsg()` wrapper.
+ *
+ * @msg and everything it points to must remain valid until the future
+ * completes.
+ *
+ * Returns: (transfer full): a future that will resolve to a gint64
+ *   containing the number of bytes received or rejects with error.
+ *
+ * Since: 1.2
+ */
+DexFuture *
+dex_aio_recvmsg (DexAioContext *aio_context,
+                 int            fd,
+                 struct msghdr *msg,
+                 int            flags)
+{
+  dex_return_error_if_fail (fd >= 0);
+  dex_return_error_if_fail (msg != NULL);
+
+  if (aio_context == NULL)
+    aio_context = dex_aio_context_current ();
+
+  return dex_aio_backend_recvmsg (aio_context->aio_backend, aio_context,
+                                  fd, msg, flags);
+}
+
+/**
+ * dex_aio_sendmsg: (skip)
+ * @aio_context: (nullable):
+ * @fd: a socket
+ * @msg: the message header describing the data to send
+ * @flags: flags for `sendmsg()` such as `MSG_NOSIGNAL`
+ *
+ * An asynchronous `sendmsg()` wrapper.
+ *
+ * @msg and everything it points to must remain valid until the future
+ * completes.
+ *
+ * Returns: (transfer full): a future that will resolve to a gint64
+ *   containing the number of bytes sent or rejects with error.
+ *
+ * Since: 1.2
+ */
+DexFuture *
+dex_aio_sendmsg (DexAioContext       *aio_context,
+                 int                  fd,
+                 const struct msghdr *msg,
+                 int                  flags)
+{
+  dex_return_error_if_fail (fd >= 0);
+  dex_return_error_if_fail (msg != NULL);
+
+  if (aio_context == NULL)
+    aio_context = dex_aio_context_current ();
+
+  return dex_aio_backend_sendmsg (aio_context->aio_backend, aio_context,
+                                  fd, msg, flags);
+}
+
+/**
+ * dex_aio_accept_stream:
+ * @aio_context: (nullable):
+ * @fd: a listening socket
+ * @flags: flags for `accept4()` such as `SOCK_CLOEXEC`
+ * @channel: a [class@Dex.Channel] to deliver connections to
+ *
+ * Accepts connections on @fd until the stream is stopped, sending each
+ * accepted connection to @channel as a future resolving to the new file
+ * descriptor. Use [method@Dex.Future.await_fd] on the received futures to
+ * take ownership of them.
+ *
+ * When supported by the backend, a single multishot accept is submitted
+ * to the kernel rather than one request per connection.
+ *
+ * No more connections are accepted while @channel is at capacity. They
+ * are left in the listen backlog until a receiver has caught up.
+ *
+ * The stream stops when either side of @channel is closed or when
+ * accepting fails. The send side of @channel is closed when the stream
+ * stops so that receivers are notified.
+ *
+ * Returns: (transfer full): a future that resolves to %TRUE once the
+ *   stream has stopped because @channel was closed, or rejects with
+ *   error if accepting failed.
+ *
+ * Since: 1.2
+ */
+DexFuture *
+dex_aio_accept_stream (DexAioContext *aio_context,
+                       int            fd,
+                       int            flags,
+                       DexChannel    *channel)
+{
+  dex_return_error_if_fail (fd >= 0);
+  dex_return_error_if_fail (DEX_IS_CHANNEL (channel));
+
+  if (aio_context == NULL)
+    aio_context = dex_aio_context_current ();
+
+  return dex_aio_backend_accept_stream (aio_context->aio_backend, aio_context,
+                                        fd, flags, channel);
+}
+
+/**
+ * dex_aio_recv_stream:
+ * @aio_context: (nullable):
+ * @fd: a connected socket
+ * @buffer_size: the size of each receive buffer, or 0 for the default
+ * @n_buffers: the number of receive buffers, or 0 for the default
+ * @flags: flags for `recv()`
+ * @channel: a [class@Dex.Channel] to deliver received data to
+ *
+ * Receives from @fd until the peer shuts down the connection, sending
+ * each chunk of data to @channel as a future resolving to a [struct@GLib.Bytes]
+ * of at most @buffer_size bytes.
+ *
+ * When supported by the backend, a single multishot receive is submitted
+ * to the kernel which picks from a ring of @n_buffers buffers owned by the
+ * stream. The data is copied out of the ring before being delivered so
+ * that buffers are returned to the kernel immediately.
+ *
+ * No more data is received while @channel is at capacity. It is left in
+ * the socket buffer until a receiver has caught up.
+ *
+ * The stream stops at end-of-file, when either side of @channel is closed,
+ * or when receiving fails. The send side of @channel is closed when the
+ * stream stops so that receivers are notified.
+ *
+ * Returns: (transfer full): a future that resolves to %TRUE once the
+ *   stream has stopped at end-of-file or because @channel was closed,
+ *   or rejects with error if receiving failed.
+ *
+ * Since: 1.2
+ */
+DexFuture *
+dex_aio_recv_stream (DexAioContext *aio_context,
+                     int            fd,
+                     gsize          buffer_size,
+                     guint          n_buffers,
+                     int            flags,
+                     DexChannel    *channel)
+{
+  dex_return_error_if_fail (fd >= 0);
+  dex_return_error_if_fail (DEX_IS_CHANNEL (channel));
+
+  if (aio_context == NULL)
+    aio_context = dex_aio_context_current ();
+
+  if (buffer_size == 0)
+    buffer_size = DEFAULT_RECV_BUFFER_SIZE;
+
+  if (n_buffers == 0)
+    n_buffers = DEFAULT_RECV_N_BUFFERS;
+
+  return dex_aio_backend_recv_stream (aio_context->aio_backend, aio_context,
+                                      fd, buffer_size, n_buffers, flags, channel);
+}
+#endif
@@ -20,12 +20,21 @@
 
 #pragma once
 
+#include <gio/gio.h>
+
+#ifdef G_OS_UNIX
+# include <sys/socket.h>
+#endif
+
+#include "dex-channel.h"
 #include "dex-future.h"
 
 G_BEGIN_DECLS
 
 typedef struct _DexAioContext DexAioContext;
 
+struct statx;
+
 DEX_AVAILABLE_IN_1_2
 DexFuture *dex_aio_close (DexAioContext *aio_context,
                           int            fd)
@@ -50,5 +59,140 @@ DexFuture *dex_aio_write (DexAioContext *aio_context,
                           gsize          count,
                           goffset        offset)
   G_GNUC_WARN_UNUSED_RESULT;
+DEX_AVAILABLE_IN_1_2
+DexFuture *dex_aio_fsync     (DexAioContext       *aio_context,
+                              int                  fd)
+  G_GNUC_WARN_UNUSED_RESULT;
+DEX_AVAILABLE_IN_1_2
+DexFuture *dex_aio_fdatasync (DexAioContext       *aio_context,
+                              int                  fd)
+  G_GNUC_WARN_UNUSED_RESULT;
+DEX_AVAILABLE_IN_1_2
+DexFuture *dex_aio_statx     (DexAioContext       *aio_context,
+                              int                  dirfd,
+                              const char          *path,
+                              int                  flags,
+                              guint                mask,
+                              struct statx        *statxbuf)
+  G_GNUC_WARN_UNUSED_RESULT;
+DEX_AVAILABLE_IN_1_2
+DexFuture *dex_aio_fallocate (DexAioContext       *aio_context,
+                              int                  fd,
+                              int                  mode,
+                              goffset              offset,
+                              goffset              length)
+  G_GNUC_WARN_UNUSED_RESULT;
+DEX_AVAILABLE_IN_1_2
+DexFuture *dex_aio_readv     (DexAioContext       *aio_context,
+                              int                  fd,
+                              GInputVector        *vectors,
+                              guint                n_vectors,
+                              goffset              offset)
+  G_GNUC_WARN_UNUSED_RESULT;
+DEX_AVAILABLE_IN_1_2
+DexFuture *dex_aio_writev    (DexAioContext       *aio_context,
+                              int                  fd,
+                              const GOutputVector *vectors,
+                              guint                n_vectors,
+                              goffset              offset)
+  G_GNUC_WARN_UNUSED_RESULT;
+DEX_AVAILABLE_IN_1_2
+DexFuture *dex_aio_splice    (DexAioContext       *aio_context,
+                              int                  fd_in,
+                              goffset              offset_in,
+                              int                  fd_out,
+                              goffset              offset_out,
+                              gsize                length,
+                              guint                flags)
+  G_GNUC_WARN_UNUSED_RESULT;
+DEX_AVAILABLE_IN_1_2
+DexFuture *dex_aio_renameat  (DexAioContext       *aio_context,
+                              int                  old_dirfd,
+                              const char          *old_path,
+                              int                  new_dirfd,
+                              const char          *new_path,
+                              guint                flags)
+  G_GNUC_WARN_UNUSED_RESULT;
+DEX_AVAILABLE_IN_1_2
+DexFuture *dex_aio_unlinkat  (DexAioContext       *aio_context,
+                              int                  dirfd,
+                              const char          *path,
+                              int                  flags)
+  G_GNUC_WARN_UNUSED_RESULT;
+DEX_AVAILABLE_IN_1_2
+DexFuture *dex_aio_mkdirat   (DexAioContext       *aio_context,
+                              int                  dirfd,
+                              const char          *path,
+                              int                  mode)
+  G_GNUC_WARN_UNUSED_RESULT;
+
+DEX_AVAILABLE_IN_1_2
+gboolean dex_aio_register_files   (DexAioContext       *aio_context,
+                                   const int           *fds,
+                                   guint                n_fds,
+                                   int                 *fixed_fds,
+                                   GError             **error);
+DEX_AVAILABLE_IN_1_2
+gboolean dex_aio_register_buffers (DexAioContext       *aio_context,
+                                   const GInputVector  *buffers,
+                                   guint                n_buffers,
+                                   GError             **error);
+
+#ifdef G_OS_UNIX
+DEX_AVAILABLE_IN_1_2
+DexFuture *dex_aio_accept    (DexAioContext         *aio_context,
+                              int                    fd,
+                              struct sockaddr       *addr,
+                              socklen_t             *addrlen,
+                              int                    flags)
+  G_GNUC_WARN_UNUSED_RESULT;
+DEX_AVAILABLE_IN_1_2
+DexFuture *dex_aio_connect   (DexAioContext         *aio_context,
+                              int                    fd,
+                              const struct sockaddr *addr,
+                              socklen_t              addrlen)
+  G_GNUC_WARN_UNUSED_RESULT;
+DEX_AVAILABLE_IN_1_2
+DexFuture *dex_aio_recv      (DexAioContext         *aio_context,
+                              int                    fd,
+                              gpointer               buffer,
+                              gsize                  count,
+                              int                    flags)
+  G_GNUC_WARN_UNUSED_RESULT;
+DEX_AVAILABLE_IN_1_2
+DexFuture *dex_aio_send      (DexAioContext         *aio_context,
+                              int                    fd,
+                              gconstpointer          buffer,
+                              gsize                  count,
+                              int                    flags)
+  G_GNUC_WARN_UNUSED_RESULT;
+DEX_AVAILABLE_IN_1_2
+DexFuture *dex_aio_recvmsg   (DexAioContext         *aio_context,
+                              int                    fd,
+                              struct msghdr         *msg,
+                              int                    flags)
+  G_GNUC_WARN_UNUSED_RESULT;
+DEX_AVAILABLE_IN_1_2
+DexFuture *dex_aio_sendmsg   (DexAioContext         *aio_context,
+                              int                    fd,
+                              const struct msghdr   *msg,
+                              int                    flags)
+  G_GNUC_WARN_UNUSED_RESULT;
+
+DEX_AVAILABLE_IN_1_2
+DexFuture *dex_aio_accept_stream (DexAioContext *aio_context,
+                                  int            fd,
+                                  int            flags,
+                                  DexChannel    *channel)
+  G_GNUC_WARN_UNUSED_RESULT;
+DEX_AVAILABLE_IN_1_2
+DexFuture *dex_aio_recv_stream   (DexAioContext *aio_context,
+                                  int            fd,
+                                  gsize          buffer_size,
+                                  guint          n_buffers,
+                                  int            flags,
+                                  DexChannel    *channel)
+  G_GNUC_WARN_UNUSED_RESULT;
+#endif
 
 G_END_DECLS
@@ -34,6 +34,10 @@ typedef struct _DexAsyncPair
   gpointer instance;
   GCancellable *cancellable;
   DexAsyncPairInfo *info;
+  /* Set once @cancellable was handed out by
+   * dex_async_pair_get_cancellable() after which it is never recycled.
+   */
+  gboolean cancellable_exposed;
   guint cancel_on_discard : 1;
 } DexAsyncPair;
 
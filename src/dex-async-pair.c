@@ -24,6 +24,7 @@
 #include <gio/gio.h>
 
 #include "dex-async-pair-private.h"
+#include "dex-cancellable-private.h"
 #include "dex-error.h"
 
 DEX_DEFINE_FINAL_TYPE (DexAsyncPair, dex_async_pair, DEX_TYPE_FUTURE)
@@ -46,7 +47,10 @@ dex_async_pair_finalize (DexObject *object)
   DexAsyncPair *async_pair = DEX_ASYNC_PAIR (object);
 
   g_clear_object (&async_pair->instance);
-  g_clear_object (&async_pair->cancellable);
+  if (g_atomic_int_get (&async_pair->cancellable_exposed))
+    g_clear_object (&async_pair->cancellable);
+  else
+    g_clear_pointer (&async_pair->cancellable, dex_cancellable_pool_release);
   g_clear_pointer (&async_pair->info, g_free);
 
   DEX_OBJECT_CLASS (dex_async_pair_parent_class)->finalize (object);
@@ -66,7 +70,7 @@ dex_async_pair_class_init (DexAsyncPairClass *async_pair_class)
 static void
 dex_async_pair_init (DexAsyncPair *async_pair)
 {
-  async_pair->cancellable = g_cancellable_new ();
+  async_pair->cancellable = dex_cancellable_pool_acquire ();
   async_pair->cancel_on_discard = TRUE;
 }
 
@@ -230,6 +234,9 @@ dex_async_pair_get_cancellable (DexAsyncPair *async_pair)
 {
   g_return_val_if_fail (DEX_IS_ASYNC_PAIR (async_pair), NULL);
 
+  /* See dex_promise_get_cancellable() */
+  g_atomic_int_set (&async_pair->cancellable_exposed, TRUE);
+
   return async_pair->cancellable;
 }
 
@@ -245,6 +245,7 @@ dex_block_class_init (DexBlockClass *block_class)
   DexFutureClass *future_class = DEX_FUTURE_CLASS (block_class);
 
   object_class->finalize = dex_block_finalize;
+  dex_object_class_enable_slab (object_class);
 
   future_class->propagate = dex_block_propagate;
 }
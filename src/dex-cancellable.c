@@ -23,7 +23,7 @@
 
 #include <gio/gio.h>
 
-#include "dex-cancellable.h"
+#include "dex-cancellable-private.h"
 #include "dex-future-private.h"
 
 /**
@@ -170,3 +170,100 @@ dex_cancellable_cancel (DexCancellable *cancellable)
                                             G_IO_ERROR_CANCELLED,
                                             "Operation cancelled"));
 }
+
+/* Every DexAsyncPair and cancellable DexPromise needs a GCancellable up
+ * front because GIO takes it when the operation is started, yet nearly
+ * all of them complete without ever being cancelled. Untouched
+ * cancellables are returned to a small per-thread pool and handed out
+ * again rather than creating a new GObject for each operation.
+ *
+ * Callers only release cancellables here which never left libdex, as
+ * anything else may have qdata or weak references attached which we
+ * can't see. Of those, a cancellable is only recycled when we hold the
+ * last reference, it was never cancelled, and nothing is still connected
+ * to it. Anything else is simply released.
+ *
+ * Set DEX_CANCELLABLE_POOL_SIZE=0 to disable the pool.
+ */
+
+#define DEFAULT_POOL_SIZE 32
+
+typedef struct _DexCancellablePool
+{
+  guint         n_items;
+  GCancellable *items[];
+} DexCancellablePool;
+
+static void dex_cancellable_pool_free (gpointer data);
+
+static GPrivate pool_key = G_PRIVATE_INIT (dex_cancellable_pool_free);
+static guint pool_size = DEFAULT_POOL_SIZE;
+static guint cancelled_signal;
+
+static void
+dex_cancellable_pool_free (gpointer data)
+{
+  DexCancellablePool *pool = data;
+
+  for (guint i = 0; i < pool->n_items; i++)
+    g_object_unref (pool->items[i]);
+
+  g_free (pool);
+}
+
+GCancellable *
+dex_cancellable_pool_acquire (void)
+{
+  DexCancellablePool *pool = g_private_get (&pool_key);
+
+  if (pool != NULL && pool->n_items > 0)
+    return g_steal_pointer (&pool->items[--pool->n_items]);
+
+  return g_cancellable_new ();
+}
+
+void
+dex_cancellable_pool_release (GCancellable *cancellable)
+{
+  static gsize initialized;
+  DexCancellablePool *pool;
+
+  if (cancellable == NULL)
+    return;
+
+  if (g_once_init_enter (&initialized))
+    {
+      const char *str = g_getenv ("DEX_CANCELLABLE_POOL_SIZE");
+      guint64 value;
+
+      if (str != NULL &&
+          g_ascii_string_to_unsigned (str, 10, 0, G_MAXUINT16, &value, NULL))
+        pool_size = value;
+
+      cancelled_signal = g_signal_lookup ("cancelled", G_TYPE_CANCELLABLE);
+
+      g_once_init_leave (&initialized, TRUE);
+    }
+
+  if (pool_size == 0 ||
+      g_atomic_int_get (&G_OBJECT (cancellable)->ref_count) != 1 ||
+      g_cancellable_is_cancelled (cancellable) ||
+      g_signal_has_handler_pending (cancellable, cancelled_signal, 0, TRUE))
+    goto release;
+
+  if (!(pool = g_private_get (&pool_key)))
+    {
+      pool = g_malloc (sizeof *pool + (pool_size * sizeof (GCancellable *)));
+      pool->n_items = 0;
+      g_private_set (&pool_key, pool);
+    }
+
+  if (pool->n_items < pool_size)
+    {
+      pool->items[pool->n_items++] = cancellable;
+      return;
+    }
+
+release:
+  g_object_unref (cancellable);
+}
@@ -21,6 +21,9 @@
 
 #include "config.h"
 
+#include <stdatomic.h>
+#include <string.h>
+
 #include <gio/gio.h>
 
 #include "dex-error.h"
@@ -29,6 +32,10 @@
 #include "dex-object-private.h"
 #include "dex-promise.h"
 
+#ifndef DEX_CACHELINE_SIZE
+# define DEX_CACHELINE_SIZE 64
+#endif
+
 static GError channel_closed_error;
 static GValue success_value;
 
@@ -38,10 +45,21 @@ typedef enum _DexChannelStateFlags
   DEX_CHANNEL_STATE_CAN_RECEIVE = 1 << 1,
 } DexChannelStateFlags;
 
+typedef struct _DexChannelSelect DexChannelSelect;
+
 typedef struct _DexChannelReceiver
 {
   DexFuture parent_instance;
   GList link;
+
+  /* Set when waiting in @recvq on behalf of dex_channel_select_receive() */
+  DexChannelSelect *select;
+  guint arm;
+
+  /* Set once nothing awaits the receiver anymore. Value channels skip
+   * such waiters rather than spending a wakeup on them.
+   */
+  _Atomic(gboolean) discarded;
 } DexChannelReceiver;
 
 typedef struct _DexChannelReceiverClass
@@ -55,6 +73,31 @@ GType dex_channel_receiver_get_type (void);
 
 DEX_DEFINE_FINAL_TYPE (DexChannelReceiver, dex_channel_receiver, DEX_TYPE_FUTURE)
 
+/*
+ * Value channels with a single consumer use a lock-free ring. Positions
+ * are free running counters which are masked to find the slot, so the
+ * ring is sized to a power of two at least as large as the capacity.
+ *
+ * With a single producer, @tail is only written by the producer and
+ * @head only by the consumer. With multiple producers, a range of slots
+ * is claimed by advancing @tail and each slot is published by storing
+ * its position + 1 into @seqs once the value has been copied in.
+ *
+ * The object lock is only taken to park or wake waiters. Before parking,
+ * a side sets its waiting flag and checks the ring again. After moving
+ * values, the other side checks the flag, with a full fence between
+ * the two so one of them will always notice the other.
+ */
+typedef struct _DexChannelRing
+{
+  _Alignas(DEX_CACHELINE_SIZE) _Atomic(guint)     tail;
+  _Alignas(DEX_CACHELINE_SIZE) _Atomic(guint)     head;
+  _Alignas(DEX_CACHELINE_SIZE) _Atomic(gboolean)  send_waiting;
+                               _Atomic(gboolean)  recv_waiting;
+                               _Atomic(guint)    *seqs;
+                               guint              mask;
+} DexChannelRing;
+
 static inline guint
 steal_uint (guint *value)
 {
@@ -73,9 +116,23 @@ steal_queue (GQueue *queue)
   };
 }
 
+static void
+dex_channel_receiver_discard (DexFuture *future)
+{
+  DexChannelReceiver *channel_receiver = (DexChannelReceiver *)future;
+
+  atomic_store_explicit (&channel_receiver->discarded, TRUE, memory_order_release);
+}
+
 static void
 dex_channel_receiver_class_init (DexChannelReceiverClass *channel_receiver_class)
 {
+  DexFutureClass *future_class = DEX_FUTURE_CLASS (channel_receiver_class);
+
+  dex_object_class_enable_slab (DEX_OBJECT_CLASS (channel_receiver_class));
+
+  future_class->discard = dex_channel_receiver_discard;
+
   success_value = (GValue) {G_TYPE_BOOLEAN, {{.v_int = TRUE}}};
 }
 
@@ -94,6 +151,12 @@ dex_channel_receiver_complete (DexChannelReceiver *channel_receiver,
                        success ? NULL : g_error_copy (&channel_closed_error));
 }
 
+static inline gboolean
+dex_channel_receiver_is_discarded (DexChannelReceiver *channel_receiver)
+{
+  return atomic_load_explicit (&channel_receiver->discarded, memory_order_acquire);
+}
+
 static inline DexChannelReceiver *
 dex_channel_receiver_new (void)
 {
@@ -124,8 +187,25 @@ struct _DexChannel
    */
   guint capacity;
 
-  /* Flags indicating what sides of the channel are open/closed */
-  DexChannelStateFlags flags : 2;
+  /* Channels created with dex_channel_new_for_values() copy values into
+   * this preallocated ring of @capacity elements rather than using @queue.
+   * Both @sendq and @recvq then contain DexChannelReceiver which are only
+   * created when a caller needs to wait for space or values.
+   */
+  guint8 *ring;
+  gsize element_size;
+  guint ring_head;
+  guint ring_length;
+
+  /* Set for value channels with a single consumer, in which case
+   * @ring_head and @ring_length are unused.
+   */
+  DexChannelRing *lockfree;
+
+  /* Flags indicating what sides of the channel are open/closed. These
+   * are read without the lock from @lockfree channels.
+   */
+  guint flags;
 };
 
 typedef struct _DexChannelClass
@@ -143,21 +223,57 @@ typedef struct _DexChannelItem
 
   /* The future which was sent with dex_channel_send(). */
   DexFuture *future;
+
+  /* Set when waiting in @sendq on behalf of dex_channel_select_send() */
+  DexChannelSelect *select;
+  guint arm;
 } DexChannelItem;
 
 typedef struct _DexChannelSendResolve
 {
   DexPromise *promise;
   guint qlen;
+  DexChannelSelect *select;
 } DexChannelSendResolve;
 
+/*
+ * A select has a waiter queued in each of its channels, either a
+ * receiver in @recvq or an item in @sendq. Whichever channel claims the
+ * select first completes it and then withdraws the remaining waiters.
+ * A channel may also come across a waiter that lost before it has been
+ * withdrawn, in which case it is dropped.
+ *
+ * Each queued waiter holds a reference to the select so that channels
+ * may look at it without holding any other lock. The waiters belong to
+ * the select, except for the item which won a dex_channel_select_send()
+ * as that is moved into @queue like any other item.
+ */
+typedef struct _DexChannelSelectArm
+{
+  DexWeakRef channel_wr;
+  gpointer   waiter;
+  gboolean   queued;
+} DexChannelSelectArm;
+
+struct _DexChannelSelect
+{
+  gatomicrefcount      ref_count;
+  int                  claimed;
+  guint                winner;
+  guint                is_send : 1;
+  DexFuture           *result;
+  guint                n_arms;
+  DexChannelSelectArm  arms[];
+};
+
 DEX_DEFINE_FINAL_TYPE (DexChannel, dex_channel, DEX_TYPE_OBJECT)
 
 #undef DEX_TYPE_CHANNEL
 #define DEX_TYPE_CHANNEL dex_channel_type
 
-static void dex_channel_unset_state_flags (DexChannel           *channel,
-                                           DexChannelStateFlags  flags);
+static void  dex_channel_unset_state_flags     (DexChannel           *channel,
+                                               DexChannelStateFlags  flags);
+static guint dex_channel_lockfree_n_receivable (DexChannel           *channel);
 
 static DexChannelItem *
 dex_channel_item_new (DexFuture *future)
@@ -189,6 +305,257 @@ dex_channel_item_free (DexChannelItem *item)
   g_free (item);
 }
 
+static DexChannelSelect *
+dex_channel_select_new (DexChannel * const *channels,
+                        guint               n_channels,
+                        DexFuture          *future)
+{
+  DexChannelSelect *select;
+
+  select = g_malloc0 (sizeof *select + (n_channels * sizeof (DexChannelSelectArm)));
+  g_atomic_ref_count_init (&select->ref_count);
+  select->winner = G_MAXUINT;
+  select->is_send = future != NULL;
+  select->n_arms = n_channels;
+
+  if (select->is_send)
+    select->result = DEX_FUTURE (dex_promise_new ());
+  else
+    select->result = DEX_FUTURE (dex_channel_receiver_new ());
+
+  for (guint i = 0; i < n_channels; i++)
+    {
+      DexChannelSelectArm *arm = &select->arms[i];
+
+      dex_weak_ref_init (&arm->channel_wr, channels[i]);
+
+      if (select->is_send)
+        {
+          DexChannelItem *item = g_new0 (DexChannelItem, 1);
+
+          item->link.data = item;
+          item->future = dex_ref (future);
+          item->send = dex_ref (select->result);
+          item->select = select;
+          item->arm = i;
+
+          arm->waiter = item;
+        }
+      else
+        {
+          DexChannelReceiver *recv = dex_channel_receiver_new ();
+
+          recv->select = select;
+          recv->arm = i;
+
+          arm->waiter = recv;
+        }
+    }
+
+  return select;
+}
+
+static void
+dex_channel_select_unref (DexChannelSelect *select)
+{
+  if (!g_atomic_ref_count_dec (&select->ref_count))
+    return;
+
+  for (guint i = 0; i < select->n_arms; i++)
+    {
+      DexChannelSelectArm *arm = &select->arms[i];
+
+      g_assert (!arm->queued);
+
+      dex_weak_ref_clear (&arm->channel_wr);
+
+      if (!select->is_send)
+        dex_unref (arm->waiter);
+      else if (i != select->winner)
+        dex_channel_item_free (arm->waiter);
+    }
+
+  dex_clear (&select->result);
+  g_free (select);
+}
+
+/* Must be called with the lock held for the channel that @arm is queued
+ * in, or was about to be queued in. Returns %TRUE if the caller is now
+ * responsible for completing the select.
+ */
+static inline gboolean
+dex_channel_select_claim_locked (DexChannelSelect *select,
+                                 guint             arm)
+{
+  select->arms[arm].queued = FALSE;
+
+  if (!g_atomic_int_compare_and_exchange (&select->claimed, FALSE, TRUE))
+    return FALSE;
+
+  select->winner = arm;
+
+  return TRUE;
+}
+
+/* Withdraws the waiters which lost from their channels. Must be called
+ * by whoever claimed the select, without any channel locks held.
+ */
+static void
+dex_channel_select_finish (DexChannelSelect *select)
+{
+  g_assert (select->winner < select->n_arms);
+
+  for (guint i = 0; i < select->n_arms; i++)
+    {
+      DexChannelSelectArm *arm = &select->arms[i];
+      DexChannel *channel;
+      gboolean unlinked = FALSE;
+
+      /* A channel that is being disposed will drop the waiter itself */
+      if (i == select->winner ||
+          !(channel = dex_weak_ref_get (&arm->channel_wr)))
+        continue;
+
+      dex_object_lock (channel);
+
+      if (arm->queued)
+        {
+          if (select->is_send)
+            g_queue_unlink (&channel->sendq, &((DexChannelItem *)arm->waiter)->link);
+          else
+            g_queue_unlink (&channel->recvq, &((DexChannelReceiver *)arm->waiter)->link);
+
+          arm->queued = FALSE;
+          unlinked = TRUE;
+        }
+
+      dex_object_unlock (channel);
+
+      dex_unref (channel);
+
+      if (unlinked)
+        dex_channel_select_unref (select);
+    }
+}
+
+static void
+dex_channel_drop_lost_receivers (GQueue *lost)
+{
+  while (lost->length > 0)
+    {
+      DexChannelReceiver *recv = g_queue_pop_head_link (lost)->data;
+      dex_channel_select_unref (recv->select);
+    }
+}
+
+static void
+dex_channel_drop_lost_items (GQueue *lost)
+{
+  while (lost->length > 0)
+    {
+      DexChannelItem *item = g_queue_pop_head_link (lost)->data;
+      dex_channel_select_unref (item->select);
+    }
+}
+
+/* Claims the selects of receivers removed from @recvq so they may be
+ * completed once the lock is released. Those that lost are moved
+ * to @lost.
+ */
+static void
+dex_channel_claim_receivers_locked (GQueue *receivers,
+                                    GQueue *lost)
+{
+  GList *iter = receivers->head;
+
+  while (iter != NULL)
+    {
+      DexChannelReceiver *recv = iter->data;
+
+      iter = iter->next;
+
+      if (recv->select != NULL &&
+          !dex_channel_select_claim_locked (recv->select, recv->arm))
+        {
+          g_queue_unlink (receivers, &recv->link);
+          g_queue_push_tail_link (lost, &recv->link);
+        }
+    }
+}
+
+static void
+dex_channel_claim_items_locked (GQueue *items,
+                                GQueue *lost)
+{
+  GList *iter = items->head;
+
+  while (iter != NULL)
+    {
+      DexChannelItem *item = iter->data;
+
+      iter = iter->next;
+
+      if (item->select != NULL &&
+          !dex_channel_select_claim_locked (item->select, item->arm))
+        {
+          g_queue_unlink (items, &item->link);
+          g_queue_push_tail_link (lost, &item->link);
+        }
+    }
+}
+
+/* Pops the next item from @sendq that may be moved into @queue. If that
+ * item completes a select, @claimed is set so that it may be finished
+ * after the lock is released.
+ */
+static DexChannelItem *
+dex_channel_pop_sendq_locked (DexChannel        *channel,
+                              GQueue            *lost,
+                              DexChannelSelect **claimed)
+{
+  while (channel->sendq.length > 0)
+    {
+      DexChannelItem *item = g_queue_pop_head_link (&channel->sendq)->data;
+      DexChannelSelect *select = item->select;
+
+      if (select == NULL)
+        return item;
+
+      if (dex_channel_select_claim_locked (select, item->arm))
+        {
+          item->select = NULL;
+          *claimed = select;
+          return item;
+        }
+
+      g_queue_push_tail_link (lost, &item->link);
+    }
+
+  return NULL;
+}
+
+static void
+dex_channel_reject_receivers (GQueue *receivers)
+{
+  while (receivers->length > 0)
+    {
+      DexChannelReceiver *recv = g_queue_pop_head_link (receivers)->data;
+      DexChannelSelect *select = recv->select;
+
+      if (select == NULL)
+        {
+          dex_channel_receiver_complete (recv, FALSE);
+          dex_unref (recv);
+        }
+      else
+        {
+          dex_channel_receiver_complete ((DexChannelReceiver *)select->result, FALSE);
+          dex_channel_select_finish (select);
+          dex_channel_select_unref (select);
+        }
+    }
+}
+
 static void
 dex_channel_finalize (DexObject *object)
 {
@@ -203,6 +570,14 @@ dex_channel_finalize (DexObject *object)
   g_assert (channel->recvq.length == 0);
   g_assert (channel->flags == 0);
 
+  g_clear_pointer (&channel->ring, g_free);
+
+  if (channel->lockfree != NULL)
+    {
+      g_free (channel->lockfree->seqs);
+      g_aligned_free (g_steal_pointer (&channel->lockfree));
+    }
+
   DEX_OBJECT_CLASS (dex_channel_parent_class)->finalize (object);
 }
 
@@ -262,12 +637,32 @@ has_capacity_locked (DexChannel *channel)
   return channel->sendq.length == 0 && channel->queue.length < channel->capacity;
 }
 
+static inline gboolean
+can_receive_locked (DexChannel *channel)
+{
+  if ((channel->flags & DEX_CHANNEL_STATE_CAN_RECEIVE) == 0)
+    return FALSE;
+
+  /* If no more items can be sent, and there are no items immediately
+   * to fulfill this request, then we have to reject as it can never
+   * be fulfilled.
+   */
+  if ((channel->flags & DEX_CHANNEL_STATE_CAN_SEND) == 0 &&
+      channel->queue.length + channel->sendq.length <= channel->recvq.length)
+    return FALSE;
+
+  return TRUE;
+}
+
 static void
 dex_channel_one_receive_and_unlock (DexChannel *channel)
 {
   DexChannelItem *item = NULL;
   DexChannelReceiver *recv = NULL;
+  DexChannelSelect *claimed = NULL;
   DexPromise *to_resolve = NULL;
+  GQueue lost_receivers = G_QUEUE_INIT;
+  GQueue lost_items = G_QUEUE_INIT;
   guint qlen = 0;
 
   g_assert (DEX_IS_CHANNEL (channel));
@@ -279,23 +674,37 @@ dex_channel_one_receive_and_unlock (DexChannel *channel)
    * (which itself still may not be ready, but we must preserve ordering).
    */
 
-  if (channel->queue.length > 0 && channel->recvq.length > 0)
+  while (channel->queue.length > 0 && channel->recvq.length > 0)
     {
+      DexChannelItem *sendq_item;
+
       recv = g_queue_pop_head_link (&channel->recvq)->data;
-      item = g_queue_pop_head_link (&channel->queue)->data;
 
       g_assert (DEX_IS_CHANNEL_RECEIVER (recv));
+
+      /* Skip receivers of a select that completed elsewhere */
+      if (recv->select != NULL &&
+          !dex_channel_select_claim_locked (recv->select, recv->arm))
+        {
+          g_queue_push_tail_link (&lost_receivers, &recv->link);
+          recv = NULL;
+          continue;
+        }
+
+      item = g_queue_pop_head_link (&channel->queue)->data;
+
       g_assert (item != NULL);
 
       /* Try to advance a @sendq item into @queue */
-      if (channel->sendq.length > 0 && channel->queue.length < channel->capacity)
+      if (channel->queue.length < channel->capacity &&
+          (sendq_item = dex_channel_pop_sendq_locked (channel, &lost_items, &claimed)))
         {
-          DexChannelItem *sendq_item = g_queue_peek_head (&channel->sendq);
-          g_queue_unlink (&channel->sendq, &sendq_item->link);
           g_queue_push_tail_link (&channel->queue, &sendq_item->link);
           qlen = channel->queue.length;
           to_resolve = dex_ref (sendq_item->send);
         }
+
+      break;
     }
 
   dex_object_unlock (channel);
@@ -304,9 +713,21 @@ dex_channel_one_receive_and_unlock (DexChannel *channel)
 
   if (item != NULL)
     {
-      dex_future_chain (item->future, DEX_FUTURE (recv));
+      if (recv->select != NULL)
+        {
+          DexChannelSelect *select = recv->select;
+
+          dex_future_chain (item->future, select->result);
+          dex_channel_select_finish (select);
+          dex_channel_select_unref (select);
+        }
+      else
+        {
+          dex_future_chain (item->future, DEX_FUTURE (recv));
+          dex_unref (recv);
+        }
+
       dex_channel_item_free (item);
-      dex_unref (recv);
     }
 
   if (to_resolve != NULL)
@@ -314,6 +735,15 @@ dex_channel_one_receive_and_unlock (DexChannel *channel)
       dex_promise_resolve_uint (to_resolve, qlen);
       dex_unref (to_resolve);
     }
+
+  if (claimed != NULL)
+    {
+      dex_channel_select_finish (claimed);
+      dex_channel_select_unref (claimed);
+    }
+
+  dex_channel_drop_lost_receivers (&lost_receivers);
+  dex_channel_drop_lost_items (&lost_items);
 }
 
 /**
@@ -332,6 +762,9 @@ dex_channel_one_receive_and_unlock (DexChannel *channel)
  * If the send side of the channel is closed, the returned [class@Dex.Future] will be
  * rejected with %DEX_ERROR_CHANNEL_CLOSED.
  *
+ * Channels created with [ctor@Dex.Channel.new_for_values] reject with
+ * %DEX_ERROR_TYPE_NOT_SUPPORTED.
+ *
  * Returns: (transfer full): a [class@Dex.Future]
  */
 DexFuture *
@@ -345,6 +778,14 @@ dex_channel_send (DexChannel *channel,
   g_return_val_if_fail (DEX_IS_CHANNEL (channel), NULL);
   g_return_val_if_fail (DEX_IS_FUTURE (future), NULL);
 
+  if G_UNLIKELY (channel->ring != NULL)
+    {
+      dex_unref (future);
+      return dex_future_new_reject (DEX_ERROR,
+                                    DEX_ERROR_TYPE_NOT_SUPPORTED,
+                                    "Channel only carries values");
+    }
+
   item = dex_channel_item_new (g_steal_pointer (&future));
 
   dex_object_lock (channel);
@@ -387,6 +828,9 @@ dex_channel_send (DexChannel *channel,
  * The resulting future will resolve or reject when an item is available
  * to the channel or when send side has closed (in that order).
  *
+ * Channels created with [ctor@Dex.Channel.new_for_values] reject with
+ * %DEX_ERROR_TYPE_NOT_SUPPORTED.
+ *
  * Returns: (transfer full): a [class@Dex.Future]
  */
 DexFuture *
@@ -396,23 +840,18 @@ dex_channel_receive (DexChannel *channel)
 
   g_return_val_if_fail (DEX_IS_CHANNEL (channel), NULL);
 
+  if G_UNLIKELY (channel->ring != NULL)
+    return dex_future_new_reject (DEX_ERROR,
+                                  DEX_ERROR_TYPE_NOT_SUPPORTED,
+                                  "Channel only carries values");
+
   recv = dex_channel_receiver_new ();
 
   dex_object_lock (channel);
 
-  if ((channel->flags & DEX_CHANNEL_STATE_CAN_RECEIVE) == 0)
+  if (!can_receive_locked (channel))
     goto reject_receive;
 
-  /* If no more items can be sent, and there are no items immediately
-   * to fulfill this request, then we have to reject as it can never
-   * be fulfilled.
-   */
-  if ((channel->flags & DEX_CHANNEL_STATE_CAN_SEND) == 0)
-    {
-      if (channel->queue.length + channel->sendq.length <= channel->recvq.length)
-        goto reject_receive;
-    }
-
   /* Enqueue this receiver and then flush a queued operation if possible */
   dex_ref (recv);
   g_queue_push_tail_link (&channel->recvq, &recv->link);
@@ -443,6 +882,9 @@ reject_receive:
  * reject when the next item is available in the channel (or the send
  * or receive sides are closed).
  *
+ * Channels created with [ctor@Dex.Channel.new_for_values] reject with
+ * %DEX_ERROR_TYPE_NOT_SUPPORTED.
+ *
  * Returns: (transfer full): a [class@Dex.Future]
  */
 DexFuture *
@@ -451,10 +893,16 @@ dex_channel_receive_all (DexChannel *channel)
   GPtrArray *ret = NULL;
   GArray *send_resolves = NULL;
   GQueue stolen = G_QUEUE_INIT;
+  GQueue lost_items = G_QUEUE_INIT;
   DexFuture *future = NULL;
 
   g_return_val_if_fail (DEX_IS_CHANNEL (channel), NULL);
 
+  if G_UNLIKELY (channel->ring != NULL)
+    return dex_future_new_reject (DEX_ERROR,
+                                  DEX_ERROR_TYPE_NOT_SUPPORTED,
+                                  "Channel only carries values");
+
   ret = g_ptr_array_new_with_free_func (dex_unref);
 
   dex_object_lock (channel);
@@ -473,11 +921,14 @@ dex_channel_receive_all (DexChannel *channel)
       g_ptr_array_add (ret, g_steal_pointer (&item->future));
     }
 
-  while (channel->sendq.length > 0 && channel->queue.length < channel->capacity)
+  while (channel->queue.length < channel->capacity)
     {
-      DexChannelItem *sendq_item = g_queue_peek_head (&channel->sendq);
+      DexChannelSelect *claimed = NULL;
+      DexChannelItem *sendq_item;
+
+      if (!(sendq_item = dex_channel_pop_sendq_locked (channel, &lost_items, &claimed)))
+        break;
 
-      g_queue_unlink (&channel->sendq, &sendq_item->link);
       g_queue_push_tail_link (&channel->queue, &sendq_item->link);
 
       if (send_resolves == NULL)
@@ -487,6 +938,7 @@ dex_channel_receive_all (DexChannel *channel)
                           ((DexChannelSendResolve) {
                             dex_ref (sendq_item->send),
                             channel->queue.length,
+                            claimed,
                           }));
     }
 
@@ -505,9 +957,17 @@ dex_channel_receive_all (DexChannel *channel)
 
           dex_promise_resolve_uint (resolve->promise, resolve->qlen);
           dex_unref (resolve->promise);
+
+          if (resolve->select != NULL)
+            {
+              dex_channel_select_finish (resolve->select);
+              dex_channel_select_unref (resolve->select);
+            }
         }
     }
 
+  dex_channel_drop_lost_items (&lost_items);
+
   future = dex_future_allv ((DexFuture **)ret->pdata, ret->len);
   goto cleanup;
 
@@ -527,58 +987,401 @@ cleanup:
   return future;
 }
 
-static void
-dex_channel_unset_state_flags (DexChannel           *channel,
-                               DexChannelStateFlags  flags)
+static gboolean
+dex_channel_check_select (DexChannel * const  *channels,
+                          guint                n_channels,
+                          GError             **error)
 {
-  GQueue queue = G_QUEUE_INIT;
-  GQueue sendq = G_QUEUE_INIT;
-  GQueue recvq = G_QUEUE_INIT;
-  GQueue trunc = G_QUEUE_INIT;
-
-  g_assert (DEX_IS_CHANNEL (channel));
-
-  dex_object_lock (channel);
-
-  /* If we need to close the send-side, do so now */
-  if (flags & DEX_CHANNEL_STATE_CAN_SEND)
+  if (channels == NULL || n_channels == 0)
     {
-      guint pending = channel->sendq.length + channel->queue.length;
-
-      channel->flags &= ~DEX_CHANNEL_STATE_CAN_SEND;
-
-      while (channel->recvq.length > pending)
-        g_queue_push_head_link (&trunc, g_queue_pop_tail_link (&channel->recvq));
+      g_set_error_literal (error,
+                           G_IO_ERROR,
+                           G_IO_ERROR_INVAL,
+                           "No channels to select from");
+      return FALSE;
     }
 
-  /* If we need to close the receive-side, do so now and steal
-   * all of the items and promises that need to be rejected.
-   */
-  if (flags & DEX_CHANNEL_STATE_CAN_RECEIVE)
+  for (guint i = 0; i < n_channels; i++)
     {
-      channel->flags &= ~DEX_CHANNEL_STATE_CAN_RECEIVE;
+      if (!DEX_IS_CHANNEL (channels[i]))
+        {
+          g_set_error (error,
+                       G_IO_ERROR,
+                       G_IO_ERROR_INVAL,
+                       "Channel at index %u is not a DexChannel",
+                       i);
+          return FALSE;
+        }
 
-      queue = steal_queue (&channel->queue);
-      sendq = steal_queue (&channel->sendq);
-      recvq = steal_queue (&channel->recvq);
+      if (channels[i]->ring != NULL)
+        {
+          g_set_error_literal (error,
+                               DEX_ERROR,
+                               DEX_ERROR_TYPE_NOT_SUPPORTED,
+                               "Channel only carries values");
+          return FALSE;
+        }
     }
 
-  dex_object_unlock (channel);
+  return TRUE;
+}
 
-  while (recvq.length > 0)
-    {
-      DexChannelReceiver *recv = g_queue_pop_head_link (&recvq)->data;
-      dex_channel_receiver_complete (recv, FALSE);
-      dex_unref (recv);
-    }
+/**
+ * dex_channel_select_receive:
+ * @channels: (array length=n_channels): an array of [class@Dex.Channel]
+ * @n_channels: the number of elements in @channels
+ *
+ * Receives the next item from whichever of @channels has one first.
+ *
+ * This is similar to using [func@Dex.Future.first] with a
+ * [method@Dex.Channel.receive] for each channel except that an item
+ * is only ever taken from one of the channels. The others are left
+ * untouched for the next receiver.
+ *
+ * Channels are checked in order, so if more than one of them has an
+ * item ready, the one closest to the start of @channels is used.
+ *
+ * The resulting future will resolve or reject with the received item,
+ * or reject with %DEX_ERROR_CHANNEL_CLOSED if one of the channels is
+ * closed before an item is received. Value channels created with
+ * [ctor@Dex.Channel.new_for_values] are not supported.
+ *
+ * Returns: (transfer full): a [class@Dex.Future]
+ *
+ * Since: 1.2
+ */
+DexFuture *
+dex_channel_select_receive (DexChannel * const *channels,
+                            guint               n_channels)
+{
+  DexChannelSelect *select;
+  DexFuture *ret;
+  GError *error = NULL;
 
-  while (trunc.length > 0)
+  if (!dex_channel_check_select (channels, n_channels, &error))
+    return dex_future_new_for_error (error);
+
+  select = dex_channel_select_new (channels, n_channels, NULL);
+  ret = dex_ref (select->result);
+
+  for (guint i = 0; i < n_channels && !g_atomic_int_get (&select->claimed); i++)
+    {
+      DexChannel *channel = channels[i];
+      DexChannelReceiver *recv = select->arms[i].waiter;
+
+      dex_object_lock (channel);
+
+      /* Another thread may have claimed an earlier arm since we last
+       * looked. Its dex_channel_select_finish() could already be past
+       * this channel and would never withdraw the arm.
+       */
+      if (g_atomic_int_get (&select->claimed))
+        {
+          dex_object_unlock (channel);
+          break;
+        }
+
+      if (!can_receive_locked (channel))
+        {
+          gboolean claimed = dex_channel_select_claim_locked (select, i);
+
+          dex_object_unlock (channel);
+
+          if (claimed)
+            {
+              dex_channel_receiver_complete ((DexChannelReceiver *)select->result, FALSE);
+              dex_channel_select_finish (select);
+            }
+
+          break;
+        }
+
+      g_atomic_ref_count_inc (&select->ref_count);
+      select->arms[i].queued = TRUE;
+      g_queue_push_tail_link (&channel->recvq, &recv->link);
+      dex_channel_one_receive_and_unlock (channel);
+    }
+
+  dex_channel_select_unref (select);
+
+  return ret;
+}
+
+/**
+ * dex_channel_select_send:
+ * @channels: (array length=n_channels): an array of [class@Dex.Channel]
+ * @n_channels: the number of elements in @channels
+ * @future: (transfer full): a [class@Dex.Future]
+ *
+ * Queues @future into whichever of @channels has capacity first.
+ *
+ * @future is only ever queued into one of the channels. Channels are
+ * checked in order, so if more than one of them has capacity, the one
+ * closest to the start of @channels is used.
+ *
+ * The resulting future resolves the same way as one returned from
+ * [method@Dex.Channel.send] for the channel that was used, or rejects
+ * with %DEX_ERROR_CHANNEL_CLOSED if one of the channels is closed
+ * before @future could be queued. Value channels created with
+ * [ctor@Dex.Channel.new_for_values] are not supported.
+ *
+ * Returns: (transfer full): a [class@Dex.Future]
+ *
+ * Since: 1.2
+ */
+DexFuture *
+dex_channel_select_send (DexChannel * const *channels,
+                         guint               n_channels,
+                         DexFuture          *future)
+{
+  const DexChannelStateFlags required = DEX_CHANNEL_STATE_CAN_SEND|DEX_CHANNEL_STATE_CAN_RECEIVE;
+  DexChannelSelect *select;
+  DexFuture *ret;
+  GError *error = NULL;
+
+  g_return_val_if_fail (DEX_IS_FUTURE (future), NULL);
+
+  if (!dex_channel_check_select (channels, n_channels, &error))
     {
-      DexChannelReceiver *recv = g_queue_pop_head_link (&trunc)->data;
-      dex_channel_receiver_complete (recv, FALSE);
-      dex_unref (recv);
+      dex_unref (future);
+      return dex_future_new_for_error (error);
     }
 
+  select = dex_channel_select_new (channels, n_channels, future);
+  ret = dex_ref (select->result);
+  dex_unref (future);
+
+  for (guint i = 0; i < n_channels && !g_atomic_int_get (&select->claimed); i++)
+    {
+      DexChannel *channel = channels[i];
+      DexChannelItem *item = select->arms[i].waiter;
+
+      dex_object_lock (channel);
+
+      /* See dex_channel_select_receive() */
+      if (g_atomic_int_get (&select->claimed))
+        {
+          dex_object_unlock (channel);
+          break;
+        }
+
+      if ((channel->flags & required) != required)
+        {
+          gboolean claimed = dex_channel_select_claim_locked (select, i);
+
+          dex_object_unlock (channel);
+
+          if (claimed)
+            {
+              /* Nothing else owns the winning item in this case */
+              dex_promise_reject (DEX_PROMISE (select->result),
+                                  g_error_copy (&channel_closed_error));
+              item->select = NULL;
+              dex_channel_item_free (item);
+              dex_channel_select_finish (select);
+            }
+
+          break;
+        }
+
+      if (has_capacity_locked (channel))
+        {
+          if (dex_channel_select_claim_locked (select, i))
+            {
+              item->select = NULL;
+              g_queue_push_tail_link (&channel->queue, &item->link);
+              dex_promise_resolve_uint (DEX_PROMISE (select->result), channel->queue.length);
+              dex_channel_one_receive_and_unlock (channel);
+              dex_channel_select_finish (select);
+            }
+          else
+            {
+              dex_object_unlock (channel);
+            }
+
+          break;
+        }
+
+      g_atomic_ref_count_inc (&select->ref_count);
+      select->arms[i].queued = TRUE;
+      g_queue_push_tail_link (&channel->sendq, &item->link);
+      dex_object_unlock (channel);
+    }
+
+  dex_channel_select_unref (select);
+
+  return ret;
+}
+
+/* Takes up to @max_waiters waiters to be woken. Discarded waiters are
+ * taken along with them so they are released, but do not count against
+ * @max_waiters as nothing would receive their wakeup.
+ */
+static inline GQueue
+take_waiters_locked (GQueue *waiters,
+                     guint   max_waiters)
+{
+  GQueue ret = G_QUEUE_INIT;
+
+  if (max_waiters >= waiters->length)
+    return steal_queue (waiters);
+
+  while (max_waiters > 0 && waiters->length > 0)
+    {
+      GList *link = g_queue_pop_head_link (waiters);
+
+      if (!dex_channel_receiver_is_discarded (link->data))
+        max_waiters--;
+
+      g_queue_push_tail_link (&ret, link);
+    }
+
+  return ret;
+}
+
+/* Moves waiters which were discarded before being woken into @discarded
+ * so they do not pile up while nothing is sent or received.
+ */
+static void
+prune_waiters_locked (GQueue *waiters,
+                      GQueue *discarded)
+{
+  for (GList *iter = waiters->head; iter != NULL; )
+    {
+      GList *link = iter;
+
+      iter = iter->next;
+
+      if (dex_channel_receiver_is_discarded (link->data))
+        {
+          g_queue_unlink (waiters, link);
+          g_queue_push_tail_link (discarded, link);
+        }
+    }
+}
+
+static void
+drop_waiters (GQueue *waiters)
+{
+  while (waiters->length > 0)
+    dex_unref (g_queue_pop_head_link (waiters)->data);
+}
+
+static void
+complete_waiters (GQueue   *waiters,
+                  gboolean  success)
+{
+  while (waiters->length > 0)
+    {
+      DexChannelReceiver *waiter = g_queue_pop_head_link (waiters)->data;
+      dex_channel_receiver_complete (waiter, success);
+      dex_unref (waiter);
+    }
+}
+
+static void
+dex_channel_unset_value_state_flags (DexChannel           *channel,
+                                     DexChannelStateFlags  flags)
+{
+  GQueue sendq = G_QUEUE_INIT;
+  GQueue recvq = G_QUEUE_INIT;
+  gboolean has_values;
+
+  g_assert (DEX_IS_CHANNEL (channel));
+  g_assert (channel->ring != NULL);
+
+  dex_object_lock (channel);
+
+  g_atomic_int_and (&channel->flags, ~flags);
+
+  /* Senders can never make progress again. Receivers may still
+   * drain what is left, but will be rejected when they try again.
+   */
+  sendq = steal_queue (&channel->sendq);
+  recvq = steal_queue (&channel->recvq);
+
+  if (channel->lockfree != NULL)
+    {
+      /* Lock-free rings are owned by the consumer, so anything left
+       * behind is not discarded until finalize.
+       */
+      has_values = (channel->flags & DEX_CHANNEL_STATE_CAN_RECEIVE) != 0 &&
+                   dex_channel_lockfree_n_receivable (channel) > 0;
+
+      atomic_store_explicit (&channel->lockfree->send_waiting, FALSE, memory_order_relaxed);
+      atomic_store_explicit (&channel->lockfree->recv_waiting, FALSE, memory_order_relaxed);
+    }
+  else
+    {
+      /* Discard anything that can no longer be received */
+      if (flags & DEX_CHANNEL_STATE_CAN_RECEIVE)
+        channel->ring_head = channel->ring_length = 0;
+
+      has_values = channel->ring_length > 0;
+    }
+
+  dex_object_unlock (channel);
+
+  complete_waiters (&sendq, FALSE);
+  complete_waiters (&recvq, has_values);
+}
+
+static void
+dex_channel_unset_state_flags (DexChannel           *channel,
+                               DexChannelStateFlags  flags)
+{
+  GQueue queue = G_QUEUE_INIT;
+  GQueue sendq = G_QUEUE_INIT;
+  GQueue recvq = G_QUEUE_INIT;
+  GQueue trunc = G_QUEUE_INIT;
+  GQueue lost_receivers = G_QUEUE_INIT;
+  GQueue lost_items = G_QUEUE_INIT;
+
+  g_assert (DEX_IS_CHANNEL (channel));
+
+  if (channel->ring != NULL)
+    {
+      dex_channel_unset_value_state_flags (channel, flags);
+      return;
+    }
+
+  dex_object_lock (channel);
+
+  /* If we need to close the send-side, do so now */
+  if (flags & DEX_CHANNEL_STATE_CAN_SEND)
+    {
+      guint pending = channel->sendq.length + channel->queue.length;
+
+      channel->flags &= ~DEX_CHANNEL_STATE_CAN_SEND;
+
+      while (channel->recvq.length > pending)
+        g_queue_push_head_link (&trunc, g_queue_pop_tail_link (&channel->recvq));
+    }
+
+  /* If we need to close the receive-side, do so now and steal
+   * all of the items and promises that need to be rejected.
+   */
+  if (flags & DEX_CHANNEL_STATE_CAN_RECEIVE)
+    {
+      channel->flags &= ~DEX_CHANNEL_STATE_CAN_RECEIVE;
+
+      queue = steal_queue (&channel->queue);
+      sendq = steal_queue (&channel->sendq);
+      recvq = steal_queue (&channel->recvq);
+    }
+
+  /* Waiters of a select are only rejected if the select is not
+   * already complete, which must be decided with the lock held.
+   */
+  dex_channel_claim_receivers_locked (&recvq, &lost_receivers);
+  dex_channel_claim_receivers_locked (&trunc, &lost_receivers);
+  dex_channel_claim_items_locked (&sendq, &lost_items);
+
+  dex_object_unlock (channel);
+
+  dex_channel_reject_receivers (&recvq);
+  dex_channel_reject_receivers (&trunc);
+
   while (queue.length > 0)
     {
       DexChannelItem *item = g_queue_pop_head_link (&queue)->data;
@@ -588,9 +1391,20 @@ dex_channel_unset_state_flags (DexChannel           *channel,
   while (sendq.length > 0)
     {
       DexChannelItem *item = g_queue_pop_head_link (&sendq)->data;
+      DexChannelSelect *select = g_steal_pointer (&item->select);
+
       dex_promise_reject (item->send, g_error_copy (&channel_closed_error));
       dex_channel_item_free (item);
+
+      if (select != NULL)
+        {
+          dex_channel_select_finish (select);
+          dex_channel_select_unref (select);
+        }
     }
+
+  dex_channel_drop_lost_receivers (&lost_receivers);
+  dex_channel_drop_lost_items (&lost_items);
 }
 
 void
@@ -636,3 +1450,633 @@ dex_channel_can_receive (DexChannel *channel)
 
   return ret;
 }
+
+/**
+ * dex_channel_new_for_values:
+ * @element_size: the size of each value in bytes
+ * @capacity: the number of values the channel can hold
+ * @flags: [flags@Dex.ChannelFlags] describing how the channel is used
+ *
+ * Creates a new [class@Dex.Channel] which carries values of @element_size
+ * bytes, such as pointers or small structures, rather than futures.
+ *
+ * Values are copied into a ring buffer of @capacity elements which is
+ * allocated up front. Sending and receiving values does not allocate,
+ * and a future is only created when a caller has to wait for space or
+ * for values using [method@Dex.Channel.wait_sendable] or
+ * [method@Dex.Channel.wait_receivable].
+ *
+ * Such channels must be used with [method@Dex.Channel.try_send_values],
+ * [method@Dex.Channel.try_receive_values] and related functions rather
+ * than [method@Dex.Channel.send] and [method@Dex.Channel.receive].
+ *
+ * If %DEX_CHANNEL_FLAGS_SINGLE_CONSUMER is set, values are passed through
+ * a lock-free ring and the channel lock is only used to park or wake a
+ * side that has to wait. Combine it with %DEX_CHANNEL_FLAGS_SINGLE_PRODUCER
+ * when only one sender will ever be active at a time. It is a programmer
+ * error to receive (or send) from more than one fiber or thread at a time
+ * when the respective flag is set.
+ *
+ * Returns: (transfer full): a new [class@Dex.Channel]
+ *
+ * Since: 1.2
+ */
+DexChannel *
+dex_channel_new_for_values (gsize           element_size,
+                            guint           capacity,
+                            DexChannelFlags flags)
+{
+  DexChannel *channel;
+  guint n_slots = capacity;
+
+  g_return_val_if_fail (element_size > 0, NULL);
+  g_return_val_if_fail (capacity > 0, NULL);
+  g_return_val_if_fail (capacity <= G_MAXINT32, NULL);
+
+  if (flags & DEX_CHANNEL_FLAGS_SINGLE_CONSUMER)
+    n_slots = 1u << g_bit_storage (capacity - 1);
+
+  g_return_val_if_fail (n_slots <= G_MAXSIZE / element_size, NULL);
+
+  channel = (DexChannel *)dex_object_create_instance (DEX_TYPE_CHANNEL);
+  channel->capacity = capacity;
+  channel->element_size = element_size;
+  channel->ring = g_malloc (element_size * n_slots);
+  channel->flags = DEX_CHANNEL_STATE_CAN_SEND | DEX_CHANNEL_STATE_CAN_RECEIVE;
+
+  if (flags & DEX_CHANNEL_FLAGS_SINGLE_CONSUMER)
+    {
+      channel->lockfree = g_aligned_alloc0 (1, sizeof (DexChannelRing), G_ALIGNOF (DexChannelRing));
+      channel->lockfree->mask = n_slots - 1;
+
+      if (!(flags & DEX_CHANNEL_FLAGS_SINGLE_PRODUCER))
+        channel->lockfree->seqs = g_new0 (_Atomic(guint), n_slots);
+    }
+
+  return channel;
+}
+
+static inline void
+dex_channel_lockfree_copy_in (DexChannel   *channel,
+                              guint         position,
+                              const guint8 *values,
+                              guint         n_values)
+{
+  gsize element_size = channel->element_size;
+  guint slot = position & channel->lockfree->mask;
+  guint first = MIN (n_values, channel->lockfree->mask + 1 - slot);
+
+  memcpy (channel->ring + (slot * element_size), values, first * element_size);
+  memcpy (channel->ring, values + (first * element_size), (n_values - first) * element_size);
+}
+
+static inline void
+dex_channel_lockfree_copy_out (DexChannel *channel,
+                               guint       position,
+                               guint8     *values,
+                               guint       n_values)
+{
+  gsize element_size = channel->element_size;
+  guint slot = position & channel->lockfree->mask;
+  guint first = MIN (n_values, channel->lockfree->mask + 1 - slot);
+
+  memcpy (values, channel->ring + (slot * element_size), first * element_size);
+  memcpy (values + (first * element_size), channel->ring, (n_values - first) * element_size);
+}
+
+static guint
+dex_channel_lockfree_n_sendable (DexChannel *channel)
+{
+  DexChannelRing *lockfree = channel->lockfree;
+  guint head = atomic_load_explicit (&lockfree->head, memory_order_acquire);
+  guint tail = atomic_load_explicit (&lockfree->tail, memory_order_acquire);
+
+  return channel->capacity - MIN (tail - head, channel->capacity);
+}
+
+/* Only accurate when called by the consumer. With multiple producers this
+ * only tells whether the next value has been published.
+ */
+static guint
+dex_channel_lockfree_n_receivable (DexChannel *channel)
+{
+  DexChannelRing *lockfree = channel->lockfree;
+  guint head = atomic_load_explicit (&lockfree->head, memory_order_relaxed);
+
+  if (lockfree->seqs != NULL)
+    return atomic_load_explicit (&lockfree->seqs[head & lockfree->mask], memory_order_acquire) == head + 1;
+
+  return atomic_load_explicit (&lockfree->tail, memory_order_acquire) - head;
+}
+
+static void
+dex_channel_lockfree_wake (DexChannel        *channel,
+                           _Atomic(gboolean) *waiting,
+                           GQueue            *waiters,
+                           guint              max_waiters)
+{
+  GQueue wake;
+
+  /* Pairs with the fence in dex_channel_lockfree_park() */
+  atomic_thread_fence (memory_order_seq_cst);
+
+  if G_LIKELY (!atomic_load_explicit (waiting, memory_order_relaxed))
+    return;
+
+  dex_object_lock (channel);
+  wake = take_waiters_locked (waiters, max_waiters);
+  atomic_store_explicit (waiting, waiters->length > 0, memory_order_relaxed);
+  dex_object_unlock (channel);
+
+  complete_waiters (&wake, TRUE);
+}
+
+/* Must be called with the channel lock held. Returns %FALSE if the ring
+ * changed while registering, in which case the caller should not wait.
+ * Discarded waiters are moved to @discarded to be released by the caller
+ * once the lock is dropped.
+ */
+static gboolean
+dex_channel_lockfree_park (DexChannel         *channel,
+                           _Atomic(gboolean)  *waiting,
+                           GQueue             *waiters,
+                           guint             (*check) (DexChannel *channel),
+                           DexChannelReceiver *waiter,
+                           GQueue             *discarded)
+{
+  atomic_store_explicit (waiting, TRUE, memory_order_relaxed);
+  atomic_thread_fence (memory_order_seq_cst);
+
+  if (check (channel) > 0)
+    {
+      atomic_store_explicit (waiting, waiters->length > 0, memory_order_relaxed);
+      return FALSE;
+    }
+
+  prune_waiters_locked (waiters, discarded);
+  g_queue_push_tail_link (waiters, &waiter->link);
+  dex_ref (waiter);
+
+  return TRUE;
+}
+
+static guint
+dex_channel_lockfree_send (DexChannel   *channel,
+                           const guint8 *values,
+                           guint         n_values)
+{
+  const guint required = DEX_CHANNEL_STATE_CAN_SEND|DEX_CHANNEL_STATE_CAN_RECEIVE;
+  DexChannelRing *lockfree = channel->lockfree;
+  guint n_sent;
+  guint tail;
+
+  if ((g_atomic_int_get (&channel->flags) & required) != required)
+    return 0;
+
+  tail = atomic_load_explicit (&lockfree->tail, memory_order_relaxed);
+
+  if (lockfree->seqs == NULL)
+    {
+      guint head = atomic_load_explicit (&lockfree->head, memory_order_acquire);
+
+      if (!(n_sent = MIN (n_values, channel->capacity - (tail - head))))
+        return 0;
+
+      dex_channel_lockfree_copy_in (channel, tail, values, n_sent);
+      atomic_store_explicit (&lockfree->tail, tail + n_sent, memory_order_release);
+    }
+  else
+    {
+      for (;;)
+        {
+          guint head = atomic_load_explicit (&lockfree->head, memory_order_acquire);
+          guint used = tail - head;
+
+          /* @tail is older than @head, reload it */
+          if G_UNLIKELY (used > channel->capacity)
+            {
+              tail = atomic_load_explicit (&lockfree->tail, memory_order_relaxed);
+              continue;
+            }
+
+          if (!(n_sent = MIN (n_values, channel->capacity - used)))
+            return 0;
+
+          if (atomic_compare_exchange_weak_explicit (&lockfree->tail, &tail, tail + n_sent,
+                                                     memory_order_relaxed,
+                                                     memory_order_relaxed))
+            break;
+        }
+
+      dex_channel_lockfree_copy_in (channel, tail, values, n_sent);
+
+      for (guint i = 0; i < n_sent; i++)
+        atomic_store_explicit (&lockfree->seqs[(tail + i) & lockfree->mask],
+                               tail + i + 1,
+                               memory_order_release);
+    }
+
+  dex_channel_lockfree_wake (channel, &lockfree->recv_waiting, &channel->recvq, n_sent);
+
+  return n_sent;
+}
+
+static guint
+dex_channel_lockfree_receive (DexChannel *channel,
+                              guint8     *values,
+                              guint       n_values)
+{
+  DexChannelRing *lockfree = channel->lockfree;
+  guint n_received = 0;
+  guint head;
+
+  if (!(g_atomic_int_get (&channel->flags) & DEX_CHANNEL_STATE_CAN_RECEIVE))
+    return 0;
+
+  head = atomic_load_explicit (&lockfree->head, memory_order_relaxed);
+
+  if (lockfree->seqs == NULL)
+    {
+      guint tail = atomic_load_explicit (&lockfree->tail, memory_order_acquire);
+      n_received = MIN (n_values, tail - head);
+    }
+  else
+    {
+      while (n_received < n_values &&
+             atomic_load_explicit (&lockfree->seqs[(head + n_received) & lockfree->mask],
+                                   memory_order_acquire) == head + n_received + 1)
+        n_received++;
+    }
+
+  if (n_received == 0)
+    return 0;
+
+  dex_channel_lockfree_copy_out (channel, head, values, n_received);
+  atomic_store_explicit (&lockfree->head, head + n_received, memory_order_release);
+
+  dex_channel_lockfree_wake (channel, &lockfree->send_waiting, &channel->sendq, n_received);
+
+  return n_received;
+}
+
+static void
+dex_channel_ring_push_locked (DexChannel   *channel,
+                              const guint8 *values,
+                              guint         n_values)
+{
+  gsize element_size = channel->element_size;
+  guint tail = (channel->ring_head + channel->ring_length) % channel->capacity;
+  guint first = MIN (n_values, channel->capacity - tail);
+
+  memcpy (channel->ring + (tail * element_size), values, first * element_size);
+  memcpy (channel->ring, values + (first * element_size), (n_values - first) * element_size);
+
+  channel->ring_length += n_values;
+}
+
+static void
+dex_channel_ring_pop_locked (DexChannel *channel,
+                             guint8     *values,
+                             guint       n_values)
+{
+  gsize element_size = channel->element_size;
+  guint head = channel->ring_head;
+  guint first = MIN (n_values, channel->capacity - head);
+
+  memcpy (values, channel->ring + (head * element_size), first * element_size);
+  memcpy (values + (first * element_size), channel->ring, (n_values - first) * element_size);
+
+  channel->ring_head = (head + n_values) % channel->capacity;
+  channel->ring_length -= n_values;
+}
+
+/**
+ * dex_channel_try_send_values:
+ * @channel: a [class@Dex.Channel] created with [ctor@Dex.Channel.new_for_values]
+ * @values: (array length=n_values) (element-type guint8): the values to send
+ * @n_values: the number of values in @values
+ *
+ * Copies as many of @values into @channel as there is room for without
+ * waiting.
+ *
+ * Returns: the number of values sent, which is zero if the channel is
+ *   full or closed
+ *
+ * Since: 1.2
+ */
+guint
+dex_channel_try_send_values (DexChannel    *channel,
+                             gconstpointer  values,
+                             guint          n_values)
+{
+  const DexChannelStateFlags required = DEX_CHANNEL_STATE_CAN_SEND|DEX_CHANNEL_STATE_CAN_RECEIVE;
+  GQueue waiters = G_QUEUE_INIT;
+  guint n_sent = 0;
+
+  g_return_val_if_fail (DEX_IS_CHANNEL (channel), 0);
+  g_return_val_if_fail (channel->ring != NULL, 0);
+  g_return_val_if_fail (values != NULL || n_values == 0, 0);
+
+  if (channel->lockfree != NULL)
+    return dex_channel_lockfree_send (channel, values, n_values);
+
+  dex_object_lock (channel);
+
+  if ((channel->flags & required) == required)
+    {
+      n_sent = MIN (n_values, channel->capacity - channel->ring_length);
+      dex_channel_ring_push_locked (channel, values, n_sent);
+
+      /* Wake up one waiting receiver for each value */
+      waiters = take_waiters_locked (&channel->recvq, n_sent);
+    }
+
+  dex_object_unlock (channel);
+
+  complete_waiters (&waiters, TRUE);
+
+  return n_sent;
+}
+
+/**
+ * dex_channel_try_receive_values:
+ * @channel: a [class@Dex.Channel] created with [ctor@Dex.Channel.new_for_values]
+ * @values: (array length=n_values) (element-type guint8) (out caller-allocates):
+ *   a location to store up to @n_values values
+ * @n_values: the number of values @values can hold
+ *
+ * Copies as many values out of @channel as are available, up to @n_values,
+ * without waiting.
+ *
+ * Returns: the number of values received, which is zero if the channel
+ *   is empty or the receive side is closed
+ *
+ * Since: 1.2
+ */
+guint
+dex_channel_try_receive_values (DexChannel *channel,
+                                gpointer    values,
+                                guint       n_values)
+{
+  GQueue waiters = G_QUEUE_INIT;
+  guint n_received = 0;
+
+  g_return_val_if_fail (DEX_IS_CHANNEL (channel), 0);
+  g_return_val_if_fail (channel->ring != NULL, 0);
+  g_return_val_if_fail (values != NULL || n_values == 0, 0);
+
+  if (channel->lockfree != NULL)
+    return dex_channel_lockfree_receive (channel, values, n_values);
+
+  dex_object_lock (channel);
+
+  if (channel->flags & DEX_CHANNEL_STATE_CAN_RECEIVE)
+    {
+      n_received = MIN (n_values, channel->ring_length);
+      dex_channel_ring_pop_locked (channel, values, n_received);
+
+      /* Wake up one waiting sender for each slot we freed */
+      waiters = take_waiters_locked (&channel->sendq, n_received);
+    }
+
+  dex_object_unlock (channel);
+
+  complete_waiters (&waiters, TRUE);
+
+  return n_received;
+}
+
+/**
+ * dex_channel_wait_sendable:
+ * @channel: a [class@Dex.Channel] created with [ctor@Dex.Channel.new_for_values]
+ *
+ * Gets a future that resolves when there is room in @channel to send
+ * another value.
+ *
+ * Another sender may take the room before the caller does, in which case
+ * [method@Dex.Channel.try_send_values] will return zero and the caller
+ * should wait again.
+ *
+ * Returns: (transfer full): a [class@Dex.Future] that resolves to %TRUE
+ *   or rejects with %DEX_ERROR_CHANNEL_CLOSED
+ *
+ * Since: 1.2
+ */
+DexFuture *
+dex_channel_wait_sendable (DexChannel *channel)
+{
+  const DexChannelStateFlags required = DEX_CHANNEL_STATE_CAN_SEND|DEX_CHANNEL_STATE_CAN_RECEIVE;
+  GQueue discarded = G_QUEUE_INIT;
+  DexChannelReceiver *waiter;
+  guint n_sendable;
+
+  dex_return_error_if_fail (DEX_IS_CHANNEL (channel));
+  dex_return_error_if_fail (channel->ring != NULL);
+
+  dex_object_lock (channel);
+
+  if ((channel->flags & required) != required)
+    {
+      dex_object_unlock (channel);
+      return dex_future_new_for_error (g_error_copy (&channel_closed_error));
+    }
+
+  if (channel->lockfree != NULL)
+    n_sendable = dex_channel_lockfree_n_sendable (channel);
+  else
+    n_sendable = channel->capacity - channel->ring_length;
+
+  if (n_sendable > 0)
+    {
+      dex_object_unlock (channel);
+      return dex_future_new_true ();
+    }
+
+  waiter = dex_channel_receiver_new ();
+
+  if (channel->lockfree != NULL)
+    {
+      if (!dex_channel_lockfree_park (channel,
+                                      &channel->lockfree->send_waiting,
+                                      &channel->sendq,
+                                      dex_channel_lockfree_n_sendable,
+                                      waiter,
+                                      &discarded))
+        {
+          dex_object_unlock (channel);
+          dex_channel_receiver_complete (waiter, TRUE);
+          return DEX_FUTURE (waiter);
+        }
+    }
+  else
+    {
+      prune_waiters_locked (&channel->sendq, &discarded);
+      g_queue_push_tail_link (&channel->sendq, &waiter->link);
+      dex_ref (waiter);
+    }
+
+  dex_object_unlock (channel);
+
+  drop_waiters (&discarded);
+
+  return DEX_FUTURE (waiter);
+}
+
+/**
+ * dex_channel_wait_receivable:
+ * @channel: a [class@Dex.Channel] created with [ctor@Dex.Channel.new_for_values]
+ *
+ * Gets a future that resolves when there are values in @channel to be
+ * received.
+ *
+ * Another receiver may take the values before the caller does, in which
+ * case [method@Dex.Channel.try_receive_values] will return zero and the
+ * caller should wait again.
+ *
+ * Returns: (transfer full): a [class@Dex.Future] that resolves to %TRUE
+ *   or rejects with %DEX_ERROR_CHANNEL_CLOSED once no more values can
+ *   be received
+ *
+ * Since: 1.2
+ */
+DexFuture *
+dex_channel_wait_receivable (DexChannel *channel)
+{
+  GQueue discarded = G_QUEUE_INIT;
+  DexChannelReceiver *waiter;
+  guint n_receivable;
+
+  dex_return_error_if_fail (DEX_IS_CHANNEL (channel));
+  dex_return_error_if_fail (channel->ring != NULL);
+
+  dex_object_lock (channel);
+
+  if (channel->lockfree != NULL)
+    n_receivable = dex_channel_lockfree_n_receivable (channel);
+  else
+    n_receivable = channel->ring_length;
+
+  if ((channel->flags & DEX_CHANNEL_STATE_CAN_RECEIVE) == 0 ||
+      (n_receivable == 0 && (channel->flags & DEX_CHANNEL_STATE_CAN_SEND) == 0))
+    {
+      dex_object_unlock (channel);
+      return dex_future_new_for_error (g_error_copy (&channel_closed_error));
+    }
+
+  if (n_receivable > 0)
+    {
+      dex_object_unlock (channel);
+      return dex_future_new_true ();
+    }
+
+  waiter = dex_channel_receiver_new ();
+
+  if (channel->lockfree != NULL)
+    {
+      if (!dex_channel_lockfree_park (channel,
+                                      &channel->lockfree->recv_waiting,
+                                      &channel->recvq,
+                                      dex_channel_lockfree_n_receivable,
+                                      waiter,
+                                      &discarded))
+        {
+          dex_object_unlock (channel);
+          dex_channel_receiver_complete (waiter, TRUE);
+          return DEX_FUTURE (waiter);
+        }
+    }
+  else
+    {
+      prune_waiters_locked (&channel->recvq, &discarded);
+      g_queue_push_tail_link (&channel->recvq, &waiter->link);
+      dex_ref (waiter);
+    }
+
+  dex_object_unlock (channel);
+
+  drop_waiters (&discarded);
+
+  return DEX_FUTURE (waiter);
+}
+
+/**
+ * dex_channel_send_values:
+ * @channel: a [class@Dex.Channel] created with [ctor@Dex.Channel.new_for_values]
+ * @values: (array length=n_values) (element-type guint8): the values to send
+ * @n_values: the number of values in @values
+ * @error: a location for a #GError, or %NULL
+ *
+ * Sends all of @values, suspending the calling fiber whenever @channel
+ * is full.
+ *
+ * This may only be called from a [class@Dex.Fiber].
+ *
+ * Returns: %TRUE if all values were sent, otherwise %FALSE and @error is set
+ *
+ * Since: 1.2
+ */
+gboolean
+dex_channel_send_values (DexChannel     *channel,
+                         gconstpointer   values,
+                         guint           n_values,
+                         GError        **error)
+{
+  const guint8 *data = values;
+
+  g_return_val_if_fail (DEX_IS_CHANNEL (channel), FALSE);
+  g_return_val_if_fail (channel->ring != NULL, FALSE);
+  g_return_val_if_fail (values != NULL || n_values == 0, FALSE);
+
+  while (n_values > 0)
+    {
+      guint n_sent = dex_channel_try_send_values (channel, data, n_values);
+
+      data += n_sent * channel->element_size;
+      n_values -= n_sent;
+
+      if (n_values > 0 && !dex_await (dex_channel_wait_sendable (channel), error))
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
+/**
+ * dex_channel_receive_values:
+ * @channel: a [class@Dex.Channel] created with [ctor@Dex.Channel.new_for_values]
+ * @values: (array length=n_values) (element-type guint8) (out caller-allocates):
+ *   a location to store up to @n_values values
+ * @n_values: the number of values @values can hold
+ * @error: a location for a #GError, or %NULL
+ *
+ * Receives up to @n_values values, suspending the calling fiber until at
+ * least one value is available.
+ *
+ * This may only be called from a [class@Dex.Fiber].
+ *
+ * Returns: the number of values received, or zero if no more values
+ *   can be received and @error is set
+ *
+ * Since: 1.2
+ */
+guint
+dex_channel_receive_values (DexChannel  *channel,
+                            gpointer     values,
+                            guint        n_values,
+                            GError     **error)
+{
+  guint n_received;
+
+  g_return_val_if_fail (DEX_IS_CHANNEL (channel), 0);
+  g_return_val_if_fail (channel->ring != NULL, 0);
+  g_return_val_if_fail (values != NULL, 0);
+  g_return_val_if_fail (n_values > 0, 0);
+
+  while (!(n_received = dex_channel_try_receive_values (channel, values, n_values)))
+    {
+      if (!dex_await (dex_channel_wait_receivable (channel), error))
+        return 0;
+    }
+
+  return n_received;
+}
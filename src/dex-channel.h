@@ -32,24 +32,57 @@ G_BEGIN_DECLS
 typedef struct _DexChannel DexChannel;
 
 DEX_AVAILABLE_IN_ALL
-GType       dex_channel_get_type      (void);
+GType       dex_channel_get_type           (void);
 DEX_AVAILABLE_IN_ALL
-DexChannel *dex_channel_new           (guint       capacity) G_GNUC_WARN_UNUSED_RESULT;
+DexChannel *dex_channel_new                (guint           capacity) G_GNUC_WARN_UNUSED_RESULT;
+DEX_AVAILABLE_IN_1_2
+DexChannel *dex_channel_new_for_values     (gsize           element_size,
+                                            guint           capacity,
+                                            DexChannelFlags flags) G_GNUC_WARN_UNUSED_RESULT;
 DEX_AVAILABLE_IN_ALL
-DexFuture  *dex_channel_send          (DexChannel *channel,
-                                       DexFuture  *future) G_GNUC_WARN_UNUSED_RESULT;
+DexFuture  *dex_channel_send               (DexChannel     *channel,
+                                            DexFuture      *future) G_GNUC_WARN_UNUSED_RESULT;
 DEX_AVAILABLE_IN_ALL
-DexFuture  *dex_channel_receive       (DexChannel *channel) G_GNUC_WARN_UNUSED_RESULT;
+DexFuture  *dex_channel_receive            (DexChannel     *channel) G_GNUC_WARN_UNUSED_RESULT;
 DEX_AVAILABLE_IN_ALL
-DexFuture  *dex_channel_receive_all   (DexChannel *channel) G_GNUC_WARN_UNUSED_RESULT;
+DexFuture  *dex_channel_receive_all        (DexChannel     *channel) G_GNUC_WARN_UNUSED_RESULT;
+DEX_AVAILABLE_IN_1_2
+guint       dex_channel_try_send_values    (DexChannel     *channel,
+                                            gconstpointer   values,
+                                            guint           n_values);
+DEX_AVAILABLE_IN_1_2
+guint       dex_channel_try_receive_values (DexChannel     *channel,
+                                            gpointer        values,
+                                            guint           n_values);
+DEX_AVAILABLE_IN_1_2
+gboolean    dex_channel_send_values        (DexChannel     *channel,
+                                            gconstpointer   values,
+                                            guint           n_values,
+                                            GError        **error);
+DEX_AVAILABLE_IN_1_2
+guint       dex_channel_receive_values     (DexChannel     *channel,
+                                            gpointer        values,
+                                            guint           n_values,
+                                            GError        **error);
+DEX_AVAILABLE_IN_1_2
+DexFuture  *dex_channel_wait_sendable      (DexChannel     *channel) G_GNUC_WARN_UNUSED_RESULT;
+DEX_AVAILABLE_IN_1_2
+DexFuture  *dex_channel_wait_receivable    (DexChannel     *channel) G_GNUC_WARN_UNUSED_RESULT;
+DEX_AVAILABLE_IN_1_2
+DexFuture  *dex_channel_select_receive     (DexChannel * const *channels,
+                                            guint               n_channels) G_GNUC_WARN_UNUSED_RESULT;
+DEX_AVAILABLE_IN_1_2
+DexFuture  *dex_channel_select_send        (DexChannel * const *channels,
+                                            guint               n_channels,
+                                            DexFuture          *future) G_GNUC_WARN_UNUSED_RESULT;
 DEX_AVAILABLE_IN_ALL
-void        dex_channel_close_send    (DexChannel *channel);
+void        dex_channel_close_send         (DexChannel     *channel);
 DEX_AVAILABLE_IN_ALL
-void        dex_channel_close_receive (DexChannel *channel);
+void        dex_channel_close_receive      (DexChannel     *channel);
 DEX_AVAILABLE_IN_ALL
-gboolean    dex_channel_can_send      (DexChannel *channel);
+gboolean    dex_channel_can_send           (DexChannel     *channel);
 DEX_AVAILABLE_IN_ALL
-gboolean    dex_channel_can_receive   (DexChannel *channel);
+gboolean    dex_channel_can_receive        (DexChannel     *channel);
 
 G_DEFINE_AUTOPTR_CLEANUP_FUNC (DexChannel, dex_unref)
 
@@ -84,6 +84,21 @@ G_PASTE(type_name, _get_type) (void) \
   } \
   return g_define_type__static; \
 }
+# define G_DEFINE_FLAGS_TYPE(TypeName, type_name, ...) \
+GType \
+G_PASTE(type_name, _get_type) (void) \
+{ \
+  static gsize g_define_type__static = 0; \
+  if (g_once_init_enter (&g_define_type__static)) { \
+    static const GFlagsValue flags_values[] = { \
+      __VA_ARGS__ , \
+      { 0, NULL, NULL }, \
+    }; \
+    GType g_define_type = g_flags_register_static (g_intern_static_string (G_STRINGIFY (TypeName)), flags_values); \
+    g_once_init_leave (&g_define_type__static, g_define_type); \
+  } \
+  return g_define_type__static; \
+}
 #endif
 
 #if !GLIB_CHECK_VERSION(2, 72, 0)
@@ -35,5 +35,6 @@ DexCoroutine          *dex_coroutine_new                (DexCoroutineFunc
 DexCoroutineScheduler *dex_coroutine_scheduler_new      (void);
 void                   dex_coroutine_scheduler_register (DexCoroutineScheduler *scheduler,
                                                          DexCoroutine          *coroutine);
+gboolean               dex_coroutine_scheduler_is_empty (DexCoroutineScheduler *scheduler);
 
 G_END_DECLS
@@ -590,6 +590,22 @@ dex_coroutine_scheduler_register (DexCoroutineScheduler *scheduler,
     g_main_context_wakeup (g_source_get_context ((GSource *)scheduler));
 }
 
+/* May be called from any thread, see dex_fiber_scheduler_is_empty() */
+gboolean
+dex_coroutine_scheduler_is_empty (DexCoroutineScheduler *scheduler)
+{
+  gboolean ret;
+
+  g_return_val_if_fail (scheduler != NULL, FALSE);
+
+  g_mutex_lock (&scheduler->mutex);
+  ret = scheduler->runnable.length == 0 &&
+        scheduler->blocked.length == 0;
+  g_mutex_unlock (&scheduler->mutex);
+
+  return ret;
+}
+
 static void
 dex_coroutine_discard (DexFuture *future)
 {
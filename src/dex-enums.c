@@ -28,3 +28,8 @@ G_DEFINE_ENUM_TYPE (DexFutureStatus, dex_future_status,
                     G_DEFINE_ENUM_VALUE (DEX_FUTURE_STATUS_PENDING, "pending"),
                     G_DEFINE_ENUM_VALUE (DEX_FUTURE_STATUS_RESOLVED, "resolved"),
                     G_DEFINE_ENUM_VALUE (DEX_FUTURE_STATUS_REJECTED, "rejected"))
+
+G_DEFINE_FLAGS_TYPE (DexChannelFlags, dex_channel_flags,
+                     G_DEFINE_ENUM_VALUE (DEX_CHANNEL_FLAGS_NONE, "none"),
+                     G_DEFINE_ENUM_VALUE (DEX_CHANNEL_FLAGS_SINGLE_PRODUCER, "single-producer"),
+                     G_DEFINE_ENUM_VALUE (DEX_CHANNEL_FLAGS_SINGLE_CONSUMER, "single-consumer"))
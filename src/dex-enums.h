@@ -43,4 +43,27 @@ typedef enum _DexFutureStatus
 DEX_AVAILABLE_IN_ALL
 GType dex_future_status_get_type (void);
 
+#define DEX_TYPE_CHANNEL_FLAGS (dex_channel_flags_get_type())
+
+/**
+ * DexChannelFlags:
+ * @DEX_CHANNEL_FLAGS_NONE: no flags
+ * @DEX_CHANNEL_FLAGS_SINGLE_PRODUCER: only one fiber or thread sends at a time
+ * @DEX_CHANNEL_FLAGS_SINGLE_CONSUMER: only one fiber or thread receives at a time
+ *
+ * Flags describing how a value channel will be used, allowing a more
+ * efficient implementation to be selected.
+ *
+ * Since: 1.2
+ */
+typedef enum _DexChannelFlags
+{
+  DEX_CHANNEL_FLAGS_NONE            = 0,
+  DEX_CHANNEL_FLAGS_SINGLE_PRODUCER = 1 << 0,
+  DEX_CHANNEL_FLAGS_SINGLE_CONSUMER = 1 << 1,
+} DexChannelFlags;
+
+DEX_AVAILABLE_IN_1_2
+GType dex_channel_flags_get_type (void);
+
 G_END_DECLS
@@ -29,7 +29,7 @@
 #include "dex-platform.h"
 #include "dex-stack-private.h"
 
-#ifdef G_OS_UNIX
+#if defined(G_OS_UNIX) && !defined(HAVE_FIBER_CONTEXT_ASM)
 # include "dex-ucontext-private.h"
 #endif
 
@@ -45,7 +45,95 @@ typedef struct _DexFiberContextStart
   gpointer  data;
 } DexFiberContextStart;
 
-#ifdef G_OS_UNIX
+#if defined(HAVE_FIBER_CONTEXT_ASM)
+/* Hand-written context switching (see dex-fiber-context.S) which only
+ * saves the callee-saved registers onto the stack of the fiber being
+ * switched away from. Unlike swapcontext() it does not save and restore
+ * the signal mask, which is a system call on every switch.
+ *
+ * The context is simply the stack pointer to resume from.
+ */
+typedef gpointer DexFiberContext;
+
+void dex_fiber_context_asm_switch     (DexFiberContext *old_context,
+                                       DexFiberContext  new_context);
+void dex_fiber_context_asm_trampoline (void);
+
+static inline void
+dex_fiber_context_init (DexFiberContext      *context,
+                        DexStack             *stack,
+                        DexFiberContextStart *start)
+{
+  gpointer *frame;
+  guintptr top;
+
+  /* If stack is NULL, then this is a context used to save state
+   * such as from the original stack in the fiber scheduler.
+   */
+  if (stack == NULL)
+    {
+      *context = NULL;
+      return;
+    }
+
+  top = (GPOINTER_TO_SIZE (stack->ptr) + stack->size) & ~(guintptr)15;
+
+#if defined(__x86_64__)
+  {
+    guint32 mxcsr;
+    guint16 fpucw;
+
+    __asm__ volatile ("stmxcsr %0" : "=m" (mxcsr));
+    __asm__ volatile ("fnstcw %0" : "=m" (fpucw));
+
+    /* x87 control word, MXCSR, r15, r14, r13, r12, rbx, rbp, return address */
+    frame = (gpointer *)(top - (9 * sizeof (gpointer)));
+    memset (frame, 0, 9 * sizeof (gpointer));
+    memcpy (&frame[0], &fpucw, sizeof fpucw);
+    memcpy (&frame[1], &mxcsr, sizeof mxcsr);
+    frame[5] = (gpointer)start->func;  /* r12 */
+    frame[4] = start->data;            /* r13 */
+    frame[8] = (gpointer)dex_fiber_context_asm_trampoline;
+  }
+#elif defined(__aarch64__)
+  /* d8-d15, x19-x28, x29, x30 */
+  frame = (gpointer *)(top - (20 * sizeof (gpointer)));
+  memset (frame, 0, 20 * sizeof (gpointer));
+  frame[8] = (gpointer)start->func;    /* x19 */
+  frame[9] = start->data;              /* x20 */
+  frame[19] = (gpointer)dex_fiber_context_asm_trampoline;
+#else
+# error "HAVE_FIBER_CONTEXT_ASM is not supported on this architecture"
+#endif
+
+  *context = frame;
+}
+
+static inline void
+dex_fiber_context_clear (DexFiberContext *context)
+{
+  *context = NULL;
+}
+
+static inline void
+dex_fiber_context_init_main (DexFiberContext *context)
+{
+  dex_fiber_context_init (context, NULL, NULL);
+}
+
+static inline void
+dex_fiber_context_clear_main (DexFiberContext *context)
+{
+  dex_fiber_context_clear (context);
+}
+
+static inline void
+dex_fiber_context_switch (DexFiberContext *old_context,
+                          DexFiberContext *new_context)
+{
+  dex_fiber_context_asm_switch (old_context, *new_context);
+}
+#elif defined(G_OS_UNIX)
 /* If the system we're on has an alignment requirement of > sizeof(void*)
  * then we will allocate aligned memory for the ucontext_t instead of
  * including it inline. Otherwise, g_type_create_instance() (which only will
@@ -128,5 +128,6 @@ DexFiber          *dex_fiber_new                (DexFiberFunc       func,
                                                  gsize              stack_size);
 void               dex_fiber_scheduler_register (DexFiberScheduler *fiber_scheduler,
                                                  DexFiber          *fiber);
+gboolean           dex_fiber_scheduler_is_empty (DexFiberScheduler *fiber_scheduler);
 
 G_END_DECLS
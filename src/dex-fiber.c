@@ -516,9 +516,9 @@ dex_fiber_scheduler_finalize (GSource *source)
  * into and schedule runnable `DexFiber`.
  *
  * A `DexScheduler` should have one of these `GSource` attached to its
- * `GMainContext` so that fibers can be executed there. When a thread
- * exits, its fibers may need to be migrated. Currently that is not
- * implemented as we do not yet destroy `DexThreadPoolWorker`.
+ * `GMainContext` so that fibers can be executed there. Fibers are never
+ * migrated, so a `DexThreadPoolWorker` is only destroyed once its fiber
+ * scheduler is empty (see dex_fiber_scheduler_is_empty()).
  *
  * Stability: Private
  */
@@ -536,7 +536,7 @@ dex_fiber_scheduler_new (void)
   fiber_scheduler = (DexFiberScheduler *)g_source_new (&funcs, sizeof *fiber_scheduler);
   _g_source_set_static_name ((GSource *)fiber_scheduler, "[dex-fiber-scheduler]");
   g_mutex_init (&fiber_scheduler->mutex);
-  fiber_scheduler->stack_pool = dex_stack_pool_new (0, 0, 0);
+  fiber_scheduler->stack_pool = dex_stack_pool_new (0, 0, -1);
 
   return fiber_scheduler;
 }
@@ -570,6 +570,25 @@ dex_fiber_scheduler_register (DexFiberScheduler *fiber_scheduler,
     g_main_context_wakeup (g_source_get_context ((GSource *)fiber_scheduler));
 }
 
+/* May be called from any thread. Fibers are only ever registered from a
+ * thread which is holding a reference to the scheduler owning
+ * @fiber_scheduler, so the result is stable as long as nobody else does.
+ */
+gboolean
+dex_fiber_scheduler_is_empty (DexFiberScheduler *fiber_scheduler)
+{
+  gboolean ret;
+
+  g_assert (fiber_scheduler != NULL);
+
+  g_mutex_lock (&fiber_scheduler->mutex);
+  ret = fiber_scheduler->runnable.length == 0 &&
+        fiber_scheduler->blocked.length == 0;
+  g_mutex_unlock (&fiber_scheduler->mutex);
+
+  return ret;
+}
+
 static DexFiber *
 dex_fiber_current (void)
 {
@@ -35,15 +35,29 @@ G_BEGIN_DECLS
 
 typedef struct _DexScheduler DexScheduler;
 
+typedef struct _DexChainedFuture
+{
+  GList      link;
+  DexWeakRef wr;
+  gpointer   where_future_was;
+  guint      awaiting : 1;
+} DexChainedFuture;
+
 typedef struct _DexFuture
 {
   DexObject parent_instance;
   GValue resolved;
   GError *rejected;
   GQueue chained;
+  /* Most futures only ever have a single future chained to them, so the
+   * first one is stored here rather than allocated. It is linked into
+   * @chained like any other while in use.
+   */
+  DexChainedFuture first_chained;
   GList task_group_link;
   const char *name;
   DexFutureStatus status : 2;
+  guint first_chained_in_use : 1;
 } DexFuture;
 
 typedef struct _DexFutureClass
@@ -53,8 +67,62 @@ typedef struct _DexFutureClass
   gboolean (*propagate) (DexFuture *future,
                          DexFuture *completed);
   void     (*discard)   (DexFuture *future);
+  void     (*chained)   (DexFuture *future);
 } DexFutureClass;
 
+/* Fundamental types which are stored entirely within the GValue and
+ * have no copy or free semantics. These are copied with a plain
+ * assignment rather than through the GTypeValueTable, which adds up
+ * when a result is propagated through a long chain of futures.
+ *
+ * DEX_TYPE_FD is not included as copying it must dup() the descriptor.
+ */
+static inline gboolean
+dex_value_is_scalar (const GValue *value)
+{
+  switch (G_VALUE_TYPE (value))
+    {
+    case G_TYPE_BOOLEAN:
+    case G_TYPE_CHAR:
+    case G_TYPE_UCHAR:
+    case G_TYPE_INT:
+    case G_TYPE_UINT:
+    case G_TYPE_LONG:
+    case G_TYPE_ULONG:
+    case G_TYPE_INT64:
+    case G_TYPE_UINT64:
+    case G_TYPE_FLOAT:
+    case G_TYPE_DOUBLE:
+    case G_TYPE_POINTER:
+      return TRUE;
+
+    default:
+      return FALSE;
+    }
+}
+
+static inline void
+dex_value_init_copy (GValue       *dest,
+                     const GValue *src)
+{
+  if G_LIKELY (dex_value_is_scalar (src))
+    {
+      *dest = *src;
+    }
+  else
+    {
+      g_value_init (dest, G_VALUE_TYPE (src));
+      g_value_copy (src, dest);
+    }
+}
+
+static inline void
+dex_value_clear (GValue *value)
+{
+  if (G_VALUE_TYPE (value) != G_TYPE_INVALID && !dex_value_is_scalar (value))
+    g_value_unset (value);
+}
+
 void          dex_future_chain         (DexFuture     *future,
                                         DexFuture     *chained);
 void          dex_future_complete      (DexFuture     *future,
@@ -71,5 +139,6 @@ const GValue *dex_await_borrowed       (DexFuture     *future,
                                         GError       **error);
 void          dex_future_disown_full   (DexFuture     *future,
                                         DexScheduler  *scheduler);
+guint64       dex_future_get_n_chained_allocated (void);
 
 G_END_DECLS
@@ -199,6 +199,7 @@ dex_future_set_class_init (DexFutureSetClass *future_set_class)
   DexFutureClass *future_class = DEX_FUTURE_CLASS (future_set_class);
 
   object_class->finalize = dex_future_set_finalize;
+  dex_object_class_enable_slab (object_class);
 
   future_class->propagate = dex_future_set_propagate;
 
@@ -21,6 +21,8 @@
 
 #include "config.h"
 
+#include <stdatomic.h>
+
 #include <gio/gio.h>
 
 #include "dex-block-private.h"
@@ -62,20 +64,29 @@ DEX_DEFINE_DERIVABLE_TYPE (DexFuture, dex_future, DEX_TYPE_OBJECT)
 static gsize      static_booleans_init;
 static DexFuture *static_booleans[2];
 
-typedef struct _DexChainedFuture
-{
-  GList      link;
-  DexWeakRef wr;
-  gpointer   where_future_was;
-  guint      awaiting : 1;
-} DexChainedFuture;
+/* Chained futures which did not fit in the inline slot. They are already
+ * the slow path, so counting them costs nothing worth measuring.
+ */
+static _Atomic(guint64) n_chained_allocated;
 
+/* Must be called with the lock for @future held */
 static DexChainedFuture *
-dex_chained_future_new (gpointer object)
+dex_chained_future_new (DexFuture *future,
+                        gpointer   object)
 {
   DexChainedFuture *cf;
 
-  cf = g_new0 (DexChainedFuture, 1);
+  if G_LIKELY (!future->first_chained_in_use)
+    {
+      future->first_chained_in_use = TRUE;
+      cf = &future->first_chained;
+    }
+  else
+    {
+      cf = g_new0 (DexChainedFuture, 1);
+      atomic_fetch_add_explicit (&n_chained_allocated, 1, memory_order_relaxed);
+    }
+
   cf->link.data = cf;
   cf->awaiting = TRUE;
   cf->where_future_was = object;
@@ -84,8 +95,12 @@ dex_chained_future_new (gpointer object)
   return cf;
 }
 
+/* Must be called without the lock for @future held. The inline slot
+ * is not made available again, see dex_future_discard().
+ */
 static void
-dex_chained_future_free (DexChainedFuture *cf)
+dex_chained_future_free (DexFuture        *future,
+                         DexChainedFuture *cf)
 {
   g_assert (cf != NULL);
   g_assert (cf->link.prev == NULL);
@@ -96,7 +111,22 @@ dex_chained_future_free (DexChainedFuture *cf)
   cf->link.data = NULL;
   cf->where_future_was = NULL;
   cf->awaiting = FALSE;
-  g_free (cf);
+
+  if (cf != &future->first_chained)
+    g_free (cf);
+}
+
+/*
+ * dex_future_get_n_chained_allocated:
+ *
+ * Gets how many chained futures have been allocated on the heap across all
+ * threads as they did not fit in the inline slot of the future they were
+ * chained to.
+ */
+guint64
+dex_future_get_n_chained_allocated (void)
+{
+  return atomic_load_explicit (&n_chained_allocated, memory_order_relaxed);
 }
 
 static void
@@ -134,7 +164,7 @@ dex_future_notify_complete (DexFuture *future,
           dex_unref (chained);
         }
 
-      dex_chained_future_free (cf);
+      dex_chained_future_free (future, cf);
     }
 }
 
@@ -163,8 +193,7 @@ dex_future_complete (DexFuture    *future,
     {
       if (resolved != NULL)
         {
-          g_value_init (&future->resolved, G_VALUE_TYPE (resolved));
-          g_value_copy (resolved, &future->resolved);
+          dex_value_init_copy (&future->resolved, resolved);
           future->status = DEX_FUTURE_STATUS_RESOLVED;
         }
       else
@@ -358,8 +387,7 @@ dex_future_finalize (DexObject *object)
   g_assert (future->chained.head == NULL);
   g_assert (future->chained.tail == NULL);
 
-  if (G_IS_VALUE (&future->resolved))
-    g_value_unset (&future->resolved);
+  dex_value_clear (&future->resolved);
   g_clear_error (&future->rejected);
 
   DEX_OBJECT_CLASS (dex_future_parent_class)->finalize (object);
@@ -427,14 +455,19 @@ dex_future_chain (DexFuture *future,
   dex_object_lock (future);
   if (future->status == DEX_FUTURE_STATUS_PENDING)
     {
-      DexChainedFuture *cf = dex_chained_future_new (chained);
+      DexChainedFuture *cf = dex_chained_future_new (future, chained);
       g_queue_push_tail_link (&future->chained, &cf->link);
       did_chain = TRUE;
     }
   dex_object_unlock (future);
 
+  /* Futures which only need to do work once observed (such as timeouts)
+   * can start now from the thread that is awaiting them.
+   */
   if (!did_chain)
     dex_future_propagate (chained, future);
+  else if (DEX_FUTURE_GET_CLASS (future)->chained)
+    DEX_FUTURE_GET_CLASS (future)->chained (future);
 }
 
 void
@@ -493,8 +526,19 @@ dex_future_discard (DexFuture *future,
   while (discarded.head != NULL)
     {
       DexChainedFuture *cf = discarded.head->data;
+
       g_queue_unlink (&discarded, &cf->link);
-      dex_chained_future_free (cf);
+      dex_chained_future_free (future, cf);
+
+      /* Only now that the weak ref has been released may the inline
+       * slot be used by another chained future.
+       */
+      if (cf == &future->first_chained)
+        {
+          dex_object_lock (future);
+          future->first_chained_in_use = FALSE;
+          dex_object_unlock (future);
+        }
     }
 
   /* If we discarded the chained future and there are no more futures
@@ -843,6 +887,9 @@ DexFuture *
  * first, the returned future rejects with %DEX_ERROR_TIMED_OUT and discards
  * @future.
  *
+ * The returned future is a [class@Dex.Timeout], so you may use
+ * [method@Dex.Timeout.set_slack] when the timeout need not be precise.
+ *
  * Returns: (transfer full): a [class@Dex.Future]
  *
  * Since: 1.2
@@ -1110,15 +1157,8 @@ DexFuture *
 DexFuture *
 (dex_future_new_for_int) (int v_int)
 {
-  GValue value = G_VALUE_INIT;
-  DexFuture *future;
-
-  g_value_init (&value, G_TYPE_INT);
-  g_value_set_int (&value, v_int);
-  future = (dex_future_new_for_value) (&value);
-  g_value_unset (&value);
-
-  return future;
+  GValue value = {G_TYPE_INT, {{.v_int = v_int}, {.v_int = 0}}};
+  return dex_static_future_new_steal (&value);
 }
 
 /**
@@ -1132,15 +1172,8 @@ DexFuture *
 DexFuture *
 (dex_future_new_for_int64) (gint64 v_int64)
 {
-  GValue value = G_VALUE_INIT;
-  DexFuture *future;
-
-  g_value_init (&value, G_TYPE_INT64);
-  g_value_set_int64 (&value, v_int64);
-  future = (dex_future_new_for_value) (&value);
-  g_value_unset (&value);
-
-  return future;
+  GValue value = {G_TYPE_INT64, {{.v_int64 = v_int64}, {.v_int = 0}}};
+  return dex_static_future_new_steal (&value);
 }
 
 /**
@@ -1154,15 +1187,8 @@ DexFuture *
 DexFuture *
 (dex_future_new_for_uint64) (guint64 v_uint64)
 {
-  GValue value = G_VALUE_INIT;
-  DexFuture *future;
-
-  g_value_init (&value, G_TYPE_UINT64);
-  g_value_set_uint64 (&value, v_uint64);
-  future = (dex_future_new_for_value) (&value);
-  g_value_unset (&value);
-
-  return future;
+  GValue value = {G_TYPE_UINT64, {{.v_uint64 = v_uint64}, {.v_int = 0}}};
+  return dex_static_future_new_steal (&value);
 }
 
 /**
@@ -1176,15 +1202,8 @@ DexFuture *
 DexFuture *
 (dex_future_new_for_float) (gfloat v_float)
 {
-  GValue value = G_VALUE_INIT;
-  DexFuture *future;
-
-  g_value_init (&value, G_TYPE_FLOAT);
-  g_value_set_float (&value, v_float);
-  future = (dex_future_new_for_value) (&value);
-  g_value_unset (&value);
-
-  return future;
+  GValue value = {G_TYPE_FLOAT, {{.v_float = v_float}, {.v_int = 0}}};
+  return dex_static_future_new_steal (&value);
 }
 
 /**
@@ -1198,15 +1217,8 @@ DexFuture *
 DexFuture *
 (dex_future_new_for_double) (gdouble v_double)
 {
-  GValue value = G_VALUE_INIT;
-  DexFuture *future;
-
-  g_value_init (&value, G_TYPE_DOUBLE);
-  g_value_set_double (&value, v_double);
-  future = (dex_future_new_for_value) (&value);
-  g_value_unset (&value);
-
-  return future;
+  GValue value = {G_TYPE_DOUBLE, {{.v_double = v_double}, {.v_int = 0}}};
+  return dex_static_future_new_steal (&value);
 }
 
 /**
@@ -1220,15 +1232,8 @@ DexFuture *
 DexFuture *
 (dex_future_new_for_uint) (guint v_uint)
 {
-  GValue value = G_VALUE_INIT;
-  DexFuture *future;
-
-  g_value_init (&value, G_TYPE_UINT);
-  g_value_set_uint (&value, v_uint);
-  future = (dex_future_new_for_value) (&value);
-  g_value_unset (&value);
-
-  return future;
+  GValue value = {G_TYPE_UINT, {{.v_uint = v_uint}, {.v_int = 0}}};
+  return dex_static_future_new_steal (&value);
 }
 
 /**
@@ -1352,15 +1357,8 @@ DexFuture *
 DexFuture *
 (dex_future_new_for_pointer) (gpointer pointer)
 {
-  GValue gvalue = G_VALUE_INIT;
-  DexFuture *ret;
-
-  g_value_init (&gvalue, G_TYPE_POINTER);
-  g_value_set_pointer (&gvalue, pointer);
-  ret = dex_future_new_for_value (&gvalue);
-  g_value_unset (&gvalue);
-
-  return ret;
+  GValue gvalue = {G_TYPE_POINTER, {{.v_pointer = pointer}, {.v_int = 0}}};
+  return dex_static_future_new_steal (&gvalue);
 }
 
 /**
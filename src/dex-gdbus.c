@@ -25,7 +25,7 @@
 #include "dex-cancellable.h"
 #include "dex-future-private.h"
 #include "dex-future-set.h"
-#include "dex-promise.h"
+#include "dex-promise-private.h"
 #include "dex-scheduler.h"
 
 #include "dex-gdbus.h"
@@ -563,7 +563,7 @@ dex_bus_name_acquired_cb (GDBusConnection *connection,
 {
   BusOwnNameData *data = user_data;
 
-  g_cancellable_disconnect (dex_promise_get_cancellable (data->name_acquired),
+  g_cancellable_disconnect (dex_promise_peek_cancellable (data->name_acquired),
                             data->name_acquired_cancelled_id);
   data->name_acquired_cancelled_id = 0;
 
@@ -579,7 +579,7 @@ dex_bus_name_lost_cb (GDBusConnection *connection,
 
   if (dex_future_is_pending (DEX_FUTURE (data->name_acquired)))
     {
-      g_cancellable_disconnect (dex_promise_get_cancellable (data->name_acquired),
+      g_cancellable_disconnect (dex_promise_peek_cancellable (data->name_acquired),
                                 data->name_acquired_cancelled_id);
       data->name_acquired_cancelled_id = 0;
 
@@ -588,7 +588,7 @@ dex_bus_name_lost_cb (GDBusConnection *connection,
                                                "Failed to acquire dbus name"));
     }
 
-  g_cancellable_disconnect (dex_promise_get_cancellable (data->name_lost),
+  g_cancellable_disconnect (dex_promise_peek_cancellable (data->name_lost),
                             data->name_lost_cancelled_id);
   data->name_lost_cancelled_id = 0;
 
@@ -607,17 +607,17 @@ dex_bus_name_cancelled_cb (GCancellable *cancellable,
 
   /* Disconnect the other cancellable. This way, neither will signal anymore, and the remaining one
    * will get cleaned up when the respective future gets cleaned up. */
-  if (dex_promise_get_cancellable (data->name_acquired) != cancellable &&
+  if (dex_promise_peek_cancellable (data->name_acquired) != cancellable &&
       data->name_acquired_cancelled_id)
     {
-      g_cancellable_disconnect (dex_promise_get_cancellable (data->name_acquired),
+      g_cancellable_disconnect (dex_promise_peek_cancellable (data->name_acquired),
                                 data->name_acquired_cancelled_id);
       data->name_acquired_cancelled_id = 0;
     }
-  else if (dex_promise_get_cancellable (data->name_lost) != cancellable &&
+  else if (dex_promise_peek_cancellable (data->name_lost) != cancellable &&
            data->name_lost_cancelled_id)
     {
-      g_cancellable_disconnect (dex_promise_get_cancellable (data->name_lost),
+      g_cancellable_disconnect (dex_promise_peek_cancellable (data->name_lost),
                                 data->name_lost_cancelled_id);
       data->name_lost_cancelled_id = 0;
     }
@@ -673,12 +673,12 @@ dex_bus_own_name_on_connection (GDBusConnection     *connection,
   data->name_lost = dex_promise_new_cancellable ();
 
   data->name_acquired_cancelled_id =
-    g_cancellable_connect (dex_promise_get_cancellable (data->name_acquired),
+    g_cancellable_connect (dex_promise_peek_cancellable (data->name_acquired),
                            G_CALLBACK (dex_bus_name_cancelled_cb),
                            data, NULL);
 
   data->name_lost_cancelled_id =
-    g_cancellable_connect (dex_promise_get_cancellable (data->name_lost),
+    g_cancellable_connect (dex_promise_peek_cancellable (data->name_lost),
                            G_CALLBACK (dex_bus_name_cancelled_cb),
                            data, NULL);
 
@@ -733,7 +733,7 @@ dex_dbus_connection_close (GDBusConnection *connection)
 
   promise = dex_promise_new_cancellable ();
   g_dbus_connection_close (connection,
-                           dex_promise_get_cancellable (promise),
+                           dex_promise_peek_cancellable (promise),
                            dex_dbus_connection_close_cb,
                            dex_ref (promise));
   return DEX_FUTURE (promise);
@@ -29,7 +29,7 @@
 #include "dex-future-private.h"
 #include "dex-future-set.h"
 #include "dex-gio.h"
-#include "dex-promise.h"
+#include "dex-promise-private.h"
 #include "dex-socket-wait-private.h"
 #include "dex-thread-pool-scheduler.h"
 #include "dex-thread.h"
@@ -179,7 +179,7 @@ dex_app_info_launch_uris (GAppInfo          *appinfo,
   g_app_info_launch_uris_async (appinfo,
                                 uris,
                                 context,
-                                dex_promise_get_cancellable (promise),
+                                dex_promise_peek_cancellable (promise),
                                 dex_app_info_launch_uris_cb,
                                 dex_ref (promise));
 
@@ -231,7 +231,7 @@ dex_app_info_get_default_for_type (const char *content_type,
 
   g_app_info_get_default_for_type_async (content_type,
                                          must_support_uris,
-                                         dex_promise_get_cancellable (promise),
+                                         dex_promise_peek_cancellable (promise),
                                          dex_app_info_get_default_for_type_cb,
                                          dex_ref (promise));
 
@@ -280,7 +280,7 @@ dex_app_info_get_default_for_uri_scheme (const char *uri_scheme)
   promise = dex_promise_new_cancellable ();
 
   g_app_info_get_default_for_uri_scheme_async (uri_scheme,
-                                               dex_promise_get_cancellable (promise),
+                                               dex_promise_peek_cancellable (promise),
                                                dex_app_info_get_default_for_uri_scheme_cb,
                                                dex_ref (promise));
 
@@ -329,7 +329,7 @@ dex_app_info_launch_default_for_uri (const char        *uri,
 
   g_app_info_launch_default_for_uri_async (uri,
                                            context,
-                                           dex_promise_get_cancellable (promise),
+                                           dex_promise_peek_cancellable (promise),
                                            dex_app_info_launch_default_for_uri_cb,
                                            dex_ref (promise));
 
@@ -386,7 +386,7 @@ dex_async_initable_new (GType       object_type,
 
   g_async_initable_init_async (G_ASYNC_INITABLE (object),
                                io_priority,
-                               dex_promise_get_cancellable (promise),
+                               dex_promise_peek_cancellable (promise),
                                dex_async_initable_new_cb,
                                dex_ref (promise));
 
@@ -438,7 +438,7 @@ dex_file_new_tmp_dir (const char *tmpl,
 
   g_file_new_tmp_dir_async (tmpl,
                             io_priority,
-                            dex_promise_get_cancellable (promise),
+                            dex_promise_peek_cancellable (promise),
                             dex_file_new_tmp_dir_cb,
                             dex_ref (promise));
 
@@ -491,7 +491,7 @@ dex_buffered_input_stream_fill (GBufferedInputStream *stream,
   g_buffered_input_stream_fill_async (stream,
                                       count,
                                       io_priority,
-                                      dex_promise_get_cancellable (promise),
+                                      dex_promise_peek_cancellable (promise),
                                       dex_buffered_input_stream_fill_cb,
                                       dex_ref (promise));
 
@@ -641,7 +641,7 @@ dex_data_input_stream_read_line (GDataInputStream *stream,
 
   g_data_input_stream_read_line_async (stream,
                                        io_priority,
-                                       dex_promise_get_cancellable (promise),
+                                       dex_promise_peek_cancellable (promise),
                                        dex_data_input_stream_read_line_cb,
                                        dex_ref (promise));
 
@@ -677,7 +677,7 @@ dex_data_input_stream_read_line_utf8 (GDataInputStream *stream,
 
   g_data_input_stream_read_line_async (stream,
                                        io_priority,
-                                       dex_promise_get_cancellable (promise),
+                                       dex_promise_peek_cancellable (promise),
                                        dex_data_input_stream_read_line_utf8_cb,
                                        dex_ref (promise));
 
@@ -719,7 +719,7 @@ dex_data_input_stream_read_upto (GDataInputStream *stream,
                                        stop_chars,
                                        stop_chars_len,
                                        io_priority,
-                                       dex_promise_get_cancellable (promise),
+                                       dex_promise_peek_cancellable (promise),
                                        dex_data_input_stream_read_upto_cb,
                                        dex_ref (promise));
 
@@ -858,7 +858,7 @@ dex_output_stream_writev_all (GOutputStream       *stream,
                                     state->vectors,
                                     n_vectors,
                                     io_priority,
-                                    dex_promise_get_cancellable (promise),
+                                    dex_promise_peek_cancellable (promise),
                                     dex_output_stream_writev_all_cb,
                                     state);
 
@@ -908,7 +908,7 @@ dex_file_create (GFile            *file,
   g_file_create_async (file,
                        flags,
                        io_priority,
-                       dex_promise_get_cancellable (promise),
+                       dex_promise_peek_cancellable (promise),
                        dex_file_create_cb,
                        dex_ref (promise));
   return DEX_FUTURE (promise);
@@ -957,7 +957,7 @@ dex_file_append_to (GFile            *file,
   g_file_append_to_async (file,
                           flags,
                           io_priority,
-                          dex_promise_get_cancellable (promise),
+                          dex_promise_peek_cancellable (promise),
                           dex_file_append_to_cb,
                           dex_ref (promise));
   return DEX_FUTURE (promise);
@@ -1104,7 +1104,7 @@ dex_file_open_readwrite (GFile *file,
   promise = dex_promise_new_cancellable ();
   g_file_open_readwrite_async (file,
                                io_priority,
-                               dex_promise_get_cancellable (promise),
+                               dex_promise_peek_cancellable (promise),
                                dex_file_open_readwrite_cb,
                                dex_ref (promise));
   return DEX_FUTURE (promise);
@@ -1153,7 +1153,7 @@ dex_file_create_readwrite (GFile            *file,
   g_file_create_readwrite_async (file,
                                  flags,
                                  io_priority,
-                                 dex_promise_get_cancellable (promise),
+                                 dex_promise_peek_cancellable (promise),
                                  dex_file_create_readwrite_cb,
                                  dex_ref (promise));
   return DEX_FUTURE (promise);
@@ -1208,7 +1208,7 @@ dex_file_replace_readwrite (GFile            *file,
                                   make_backup,
                                   flags,
                                   io_priority,
-                                  dex_promise_get_cancellable (promise),
+                                  dex_promise_peek_cancellable (promise),
                                   dex_file_replace_readwrite_cb,
                                   dex_ref (promise));
   return DEX_FUTURE (promise);
@@ -1313,7 +1313,7 @@ dex_file_replace_contents (GFile            *file,
                                  etag,
                                  make_backup,
                                  flags,
-                                 dex_promise_get_cancellable (promise),
+                                 dex_promise_peek_cancellable (promise),
                                  dex_file_replace_contents_cb,
                                  state);
 
@@ -1353,7 +1353,7 @@ dex_file_replace_contents_bytes (GFile            *file,
                                        etag,
                                        make_backup,
                                        flags,
-                                       dex_promise_get_cancellable (promise),
+                                       dex_promise_peek_cancellable (promise),
                                        dex_file_replace_contents_bytes_cb,
                                        dex_ref (promise));
 
@@ -1605,7 +1605,7 @@ dex_output_stream_flush (GOutputStream *self,
 
   g_output_stream_flush_async (self,
                                io_priority,
-                               dex_promise_get_cancellable (promise),
+                               dex_promise_peek_cancellable (promise),
                                dex_output_stream_flush_cb,
                                dex_ref (promise));
 
@@ -1808,7 +1808,7 @@ dex_file_query_filesystem_info (GFile      *file,
   g_file_query_filesystem_info_async (file,
                                       attributes,
                                       io_priority,
-                                      dex_promise_get_cancellable (promise),
+                                      dex_promise_peek_cancellable (promise),
                                       dex_file_query_filesystem_info_cb,
                                       dex_ref (promise));
   return DEX_FUTURE (promise);
@@ -1864,7 +1864,7 @@ dex_file_query_file_type (GFile               *file,
                            G_FILE_ATTRIBUTE_STANDARD_TYPE,
                            flags,
                            io_priority,
-                           dex_promise_get_cancellable (promise),
+                           dex_promise_peek_cancellable (promise),
                            dex_file_query_file_type_cb,
                            dex_ref (promise));
   return DEX_FUTURE (promise);
@@ -1910,7 +1910,7 @@ dex_file_query_default_handler (GFile *file,
   promise = dex_promise_new_cancellable ();
   g_file_query_default_handler_async (file,
                                       io_priority,
-                                      dex_promise_get_cancellable (promise),
+                                      dex_promise_peek_cancellable (promise),
                                       dex_file_query_default_handler_cb,
                                       dex_ref (promise));
   return DEX_FUTURE (promise);
@@ -1956,7 +1956,7 @@ dex_file_find_enclosing_mount (GFile *file,
   promise = dex_promise_new_cancellable ();
   g_file_find_enclosing_mount_async (file,
                                      io_priority,
-                                     dex_promise_get_cancellable (promise),
+                                     dex_promise_peek_cancellable (promise),
                                      dex_file_find_enclosing_mount_cb,
                                      dex_ref (promise));
   return DEX_FUTURE (promise);
@@ -2053,7 +2053,7 @@ dex_file_make_symbolic_link (GFile      *file,
   g_file_make_symbolic_link_async (file,
                                    symlink_value,
                                    io_priority,
-                                   dex_promise_get_cancellable (promise),
+                                   dex_promise_peek_cancellable (promise),
                                    dex_file_make_symbolic_link_cb,
                                    dex_ref (promise));
   return DEX_FUTURE (promise);
@@ -2069,7 +2069,7 @@ static void
 dex_file_make_directory_with_parents_worker (gpointer data)
 {
   MakeDirectory *state = data;
-  GCancellable *cancellable = dex_promise_get_cancellable (state->promise);
+  GCancellable *cancellable = dex_promise_peek_cancellable (state->promise);
   GError *error = NULL;
 
   if (!g_file_make_directory_with_parents (state->file, cancellable, &error))
@@ -2283,7 +2283,7 @@ dex_file_enumerator_close (GFileEnumerator *file_enumerator,
 
   g_file_enumerator_close_async (file_enumerator,
                                  io_priority,
-                                 dex_promise_get_cancellable (promise),
+                                 dex_promise_peek_cancellable (promise),
                                  dex_file_enumerator_close_cb,
                                  dex_ref (promise));
 
@@ -2335,7 +2335,7 @@ dex_file_input_stream_query_info (GFileInputStream *stream,
   g_file_input_stream_query_info_async (stream,
                                         attributes,
                                         io_priority,
-                                        dex_promise_get_cancellable (promise),
+                                        dex_promise_peek_cancellable (promise),
                                         dex_file_input_stream_query_info_cb,
                                         dex_ref (promise));
 
@@ -2387,7 +2387,7 @@ dex_file_io_stream_query_info (GFileIOStream *stream,
   g_file_io_stream_query_info_async (stream,
                                      attributes,
                                      io_priority,
-                                     dex_promise_get_cancellable (promise),
+                                     dex_promise_peek_cancellable (promise),
                                      dex_file_io_stream_query_info_cb,
                                      dex_ref (promise));
 
@@ -2439,7 +2439,7 @@ dex_file_output_stream_query_info (GFileOutputStream *stream,
   g_file_output_stream_query_info_async (stream,
                                          attributes,
                                          io_priority,
-                                         dex_promise_get_cancellable (promise),
+                                         dex_promise_peek_cancellable (promise),
                                          dex_file_output_stream_query_info_cb,
                                          dex_ref (promise));
 
@@ -2575,7 +2575,7 @@ dex_file_copy_with_progress (GFile                 *source,
                      destination,
                      flags,
                      io_priority,
-                     dex_promise_get_cancellable (promise),
+                     dex_promise_peek_cancellable (promise),
                      progress_callback,
                      progress_callback_data,
                      dex_file_copy_with_progress_cb,
@@ -2626,7 +2626,7 @@ dex_file_delete (GFile *file,
 
   g_file_delete_async (file,
                        io_priority,
-                       dex_promise_get_cancellable (promise),
+                       dex_promise_peek_cancellable (promise),
                        dex_file_delete_cb,
                        dex_ref (promise));
 
@@ -2672,7 +2672,7 @@ dex_file_trash (GFile *file,
   promise = dex_promise_new_cancellable ();
   g_file_trash_async (file,
                       io_priority,
-                      dex_promise_get_cancellable (promise),
+                      dex_promise_peek_cancellable (promise),
                       dex_file_trash_cb,
                       dex_ref (promise));
   return DEX_FUTURE (promise);
@@ -2840,7 +2840,7 @@ dex_socket_client_connect_to_host (GSocketClient *socket_client,
   g_socket_client_connect_to_host_async (socket_client,
                                          host_and_port,
                                          default_port,
-                                         dex_promise_get_cancellable (promise),
+                                         dex_promise_peek_cancellable (promise),
                                          dex_socket_client_connect_to_host_cb,
                                          dex_ref (promise));
 
@@ -2893,7 +2893,7 @@ dex_socket_client_connect_to_service (GSocketClient *socket_client,
   g_socket_client_connect_to_service_async (socket_client,
                                             domain,
                                             service,
-                                            dex_promise_get_cancellable (promise),
+                                            dex_promise_peek_cancellable (promise),
                                             dex_socket_client_connect_to_service_cb,
                                             dex_ref (promise));
 
@@ -2945,7 +2945,7 @@ dex_socket_client_connect_to_uri (GSocketClient *socket_client,
   g_socket_client_connect_to_uri_async (socket_client,
                                         uri,
                                         default_port,
-                                        dex_promise_get_cancellable (promise),
+                                        dex_promise_peek_cancellable (promise),
                                         dex_socket_client_connect_to_uri_cb,
                                         dex_ref (promise));
 
@@ -2993,7 +2993,7 @@ dex_socket_connection_connect (GSocketConnection *connection,
 
   g_socket_connection_connect_async (connection,
                                      address,
-                                     dex_promise_get_cancellable (promise),
+                                     dex_promise_peek_cancellable (promise),
                                      dex_socket_connection_connect_cb,
                                      dex_ref (promise));
 
@@ -3046,7 +3046,7 @@ dex_socket_address_enumerator_next (GSocketAddressEnumerator *enumerator)
   promise = dex_promise_new_cancellable ();
 
   g_socket_address_enumerator_next_async (enumerator,
-                                          dex_promise_get_cancellable (promise),
+                                          dex_promise_peek_cancellable (promise),
                                           dex_socket_address_enumerator_next_cb,
                                           dex_ref (promise));
 
@@ -3148,7 +3148,7 @@ dex_io_stream_splice (GIOStream           *stream1,
                             stream2,
                             flags,
                             io_priority,
-                            dex_promise_get_cancellable (promise),
+                            dex_promise_peek_cancellable (promise),
                             dex_io_stream_splice_cb,
                             dex_ref (promise));
 
@@ -3198,7 +3198,7 @@ dex_tls_connection_handshake (GTlsConnection *tls_connection,
 
   g_tls_connection_handshake_async (tls_connection,
                                     io_priority,
-                                    dex_promise_get_cancellable (promise),
+                                    dex_promise_peek_cancellable (promise),
                                     dex_tls_connection_handshake_cb,
                                     dex_ref (promise));
 
@@ -3245,7 +3245,7 @@ dex_dtls_connection_handshake (GDtlsConnection *dtls_connection,
 
   g_dtls_connection_handshake_async (dtls_connection,
                                      io_priority,
-                                     dex_promise_get_cancellable (promise),
+                                     dex_promise_peek_cancellable (promise),
                                      dex_dtls_connection_handshake_cb,
                                      dex_ref (promise));
 
@@ -3298,7 +3298,7 @@ dex_dtls_connection_shutdown (GDtlsConnection *dtls_connection,
                                     shutdown_read,
                                     shutdown_write,
                                     io_priority,
-                                    dex_promise_get_cancellable (promise),
+                                    dex_promise_peek_cancellable (promise),
                                     dex_dtls_connection_shutdown_cb,
                                     dex_ref (promise));
 
@@ -3345,7 +3345,7 @@ dex_dtls_connection_close (GDtlsConnection *dtls_connection,
 
   g_dtls_connection_close_async (dtls_connection,
                                  io_priority,
-                                 dex_promise_get_cancellable (promise),
+                                 dex_promise_peek_cancellable (promise),
                                  dex_dtls_connection_close_cb,
                                  dex_ref (promise));
 
@@ -3446,7 +3446,7 @@ dex_resolver_lookup_by_name_with_flags (GResolver                *resolver,
   g_resolver_lookup_by_name_with_flags_async (resolver,
                                               address,
                                               flags,
-                                              dex_promise_get_cancellable (promise),
+                                              dex_promise_peek_cancellable (promise),
                                               dex_resolver_lookup_by_name_with_flags_cb,
                                               dex_ref (promise));
 
@@ -3495,7 +3495,7 @@ dex_resolver_lookup_by_address (GResolver    *resolver,
 
   g_resolver_lookup_by_address_async (resolver,
                                       address,
-                                      dex_promise_get_cancellable (promise),
+                                      dex_promise_peek_cancellable (promise),
                                       dex_resolver_lookup_by_address_cb,
                                       dex_ref (promise));
 
@@ -3554,7 +3554,7 @@ dex_resolver_lookup_service (GResolver  *resolver,
                                    service,
                                    protocol,
                                    domain,
-                                   dex_promise_get_cancellable (promise),
+                                   dex_promise_peek_cancellable (promise),
                                    dex_resolver_lookup_service_cb,
                                    dex_ref (promise));
 
@@ -3608,7 +3608,7 @@ dex_resolver_lookup_records (GResolver           *resolver,
   g_resolver_lookup_records_async (resolver,
                                    rrname,
                                    record_type,
-                                   dex_promise_get_cancellable (promise),
+                                   dex_promise_peek_cancellable (promise),
                                    dex_resolver_lookup_records_cb,
                                    dex_ref (promise));
 
@@ -3656,7 +3656,7 @@ dex_network_monitor_can_reach (GNetworkMonitor    *monitor,
 
   g_network_monitor_can_reach_async (monitor,
                                      connectable,
-                                     dex_promise_get_cancellable (promise),
+                                     dex_promise_peek_cancellable (promise),
                                      dex_network_monitor_can_reach_cb,
                                      dex_ref (promise));
 
@@ -3709,7 +3709,7 @@ dex_proxy_connect (GProxy        *proxy,
   g_proxy_connect_async (proxy,
                          connection,
                          proxy_address,
-                         dex_promise_get_cancellable (promise),
+                         dex_promise_peek_cancellable (promise),
                          dex_proxy_connect_cb,
                          dex_ref (promise));
 
@@ -3758,7 +3758,7 @@ dex_proxy_resolver_lookup (GProxyResolver *resolver,
 
   g_proxy_resolver_lookup_async (resolver,
                                  uri,
-                                 dex_promise_get_cancellable (promise),
+                                 dex_promise_peek_cancellable (promise),
                                  dex_proxy_resolver_lookup_cb,
                                  dex_ref (promise));
 
@@ -3895,7 +3895,7 @@ dex_file_load_partial_contents_bytes (GFile                 *file,
   state->promise = dex_ref (promise);
 
   g_file_load_partial_contents_async (file,
-                                      dex_promise_get_cancellable (promise),
+                                      dex_promise_peek_cancellable (promise),
                                       dex_file_load_partial_contents_read_more_cb,
                                       dex_file_load_partial_contents_bytes_cb,
                                       state);
@@ -3940,7 +3940,7 @@ dex_file_load_bytes (GFile *file)
 
   promise = dex_promise_new_cancellable ();
   g_file_load_bytes_async (file,
-                           dex_promise_get_cancellable (promise),
+                           dex_promise_peek_cancellable (promise),
                            dex_file_load_bytes_cb,
                            dex_ref (promise));
   return DEX_FUTURE (promise);
@@ -3983,7 +3983,7 @@ dex_subprocess_wait (GSubprocess *subprocess)
   promise = dex_promise_new_cancellable ();
 
   g_subprocess_wait_async (subprocess,
-                           dex_promise_get_cancellable (promise),
+                           dex_promise_peek_cancellable (promise),
                            dex_subprocess_wait_cb,
                            dex_ref (promise));
 
@@ -4094,7 +4094,7 @@ dex_tls_database_verify_chain (GTlsDatabase            *database,
                                      identity,
                                      interaction,
                                      flags,
-                                     dex_promise_get_cancellable (promise),
+                                     dex_promise_peek_cancellable (promise),
                                      dex_tls_database_verify_chain_cb,
                                      dex_ref (promise));
 
@@ -4152,7 +4152,7 @@ dex_tls_database_lookup_certificate_for_handle (GTlsDatabase           *database
                                                       handle,
                                                       interaction,
                                                       flags,
-                                                      dex_promise_get_cancellable (promise),
+                                                      dex_promise_peek_cancellable (promise),
                                                       dex_tls_database_lookup_certificate_for_handle_cb,
                                                       dex_ref (promise));
 
@@ -4210,7 +4210,7 @@ dex_tls_database_lookup_certificate_issuer (GTlsDatabase           *database,
                                                   certificate,
                                                   interaction,
                                                   flags,
-                                                  dex_promise_get_cancellable (promise),
+                                                  dex_promise_peek_cancellable (promise),
                                                   dex_tls_database_lookup_certificate_issuer_cb,
                                                   dex_ref (promise));
 
@@ -4268,7 +4268,7 @@ dex_tls_database_lookup_certificates_issued_by (GTlsDatabase           *database
                                                       issuer_raw_dn,
                                                       interaction,
                                                       flags,
-                                                      dex_promise_get_cancellable (promise),
+                                                      dex_promise_peek_cancellable (promise),
                                                       dex_tls_database_lookup_certificates_issued_by_cb,
                                                       dex_ref (promise));
 
@@ -4319,7 +4319,7 @@ dex_tls_interaction_ask_password (GTlsInteraction *interaction,
 
   g_tls_interaction_ask_password_async (interaction,
                                         password,
-                                        dex_promise_get_cancellable (promise),
+                                        dex_promise_peek_cancellable (promise),
                                         dex_tls_interaction_ask_password_cb,
                                         dex_ref (promise));
 
@@ -4373,7 +4373,7 @@ dex_tls_interaction_request_certificate (GTlsInteraction             *interactio
   g_tls_interaction_request_certificate_async (interaction,
                                                connection,
                                                flags,
-                                               dex_promise_get_cancellable (promise),
+                                               dex_promise_peek_cancellable (promise),
                                                dex_tls_interaction_request_certificate_cb,
                                                dex_ref (promise));
 
@@ -4417,7 +4417,7 @@ dex_permission_acquire (GPermission *permission)
   promise = dex_promise_new_cancellable ();
 
   g_permission_acquire_async (permission,
-                              dex_promise_get_cancellable (promise),
+                              dex_promise_peek_cancellable (promise),
                               dex_permission_acquire_cb,
                               dex_ref (promise));
 
@@ -4461,7 +4461,7 @@ dex_permission_release (GPermission *permission)
   promise = dex_promise_new_cancellable ();
 
   g_permission_release_async (permission,
-                              dex_promise_get_cancellable (promise),
+                              dex_promise_peek_cancellable (promise),
                               dex_permission_release_cb,
                               dex_ref (promise));
 
@@ -4506,7 +4506,7 @@ dex_unix_connection_send_credentials (GUnixConnection *connection)
   promise = dex_promise_new_cancellable ();
 
   g_unix_connection_send_credentials_async (connection,
-                                            dex_promise_get_cancellable (promise),
+                                            dex_promise_peek_cancellable (promise),
                                             dex_unix_connection_send_credentials_cb,
                                             dex_ref (promise));
 
@@ -4551,7 +4551,7 @@ dex_unix_connection_receive_credentials (GUnixConnection *connection)
   promise = dex_promise_new_cancellable ();
 
   g_unix_connection_receive_credentials_async (connection,
-                                               dex_promise_get_cancellable (promise),
+                                               dex_promise_peek_cancellable (promise),
                                                dex_unix_connection_receive_credentials_cb,
                                                dex_ref (promise));
 
@@ -4603,7 +4603,7 @@ dex_file_query_exists (GFile *file)
                            G_FILE_ATTRIBUTE_STANDARD_TYPE,
                            G_FILE_QUERY_INFO_NONE,
                            G_PRIORITY_DEFAULT,
-                           dex_promise_get_cancellable (promise),
+                           dex_promise_peek_cancellable (promise),
                            dex_file_query_exists_cb,
                            dex_ref (promise));
   return DEX_FUTURE (promise);
@@ -4649,7 +4649,7 @@ dex_async_initable_init (GAsyncInitable *initable,
   promise = dex_promise_new_cancellable ();
   g_async_initable_init_async (initable,
                                io_priority,
-                               dex_promise_get_cancellable (promise),
+                               dex_promise_peek_cancellable (promise),
                                dex_async_initable_init_cb,
                                dex_ref (promise));
   return DEX_FUTURE (promise);
@@ -4699,7 +4699,7 @@ dex_file_set_display_name (GFile      *file,
   g_file_set_display_name_async (file,
                                  display_name,
                                  io_priority,
-                                 dex_promise_get_cancellable (promise),
+                                 dex_promise_peek_cancellable (promise),
                                  dex_file_set_display_name_cb,
                                  dex_ref (promise));
   return DEX_FUTURE (promise);
@@ -4751,7 +4751,7 @@ dex_file_set_attributes (GFile               *file,
                                file_info,
                                flags,
                                io_priority,
-                               dex_promise_get_cancellable (promise),
+                               dex_promise_peek_cancellable (promise),
                                dex_file_set_attributes_cb,
                                dex_ref (promise));
   return DEX_FUTURE (promise);
@@ -4825,7 +4825,7 @@ dex_file_move (GFile                 *source,
                      destination,
                      flags,
                      io_priority,
-                     dex_promise_get_cancellable (promise),
+                     dex_promise_peek_cancellable (promise),
                      progress_callback,
                      progress_callback_data,
                      dex_file_move_cb,
@@ -62,6 +62,7 @@ typedef struct _DexMainScheduler
   GSource          *fiber_scheduler;
   GSource          *coroutine_scheduler;
   GSource          *work_queue_source;
+  DexTimerQueue    *timer_queue;
   GQueue            work_queue;
 } DexMainScheduler;
 
@@ -166,6 +167,16 @@ dex_main_scheduler_get_aio_context (DexScheduler *scheduler)
   return (DexAioContext *)main_scheduler->aio_context;
 }
 
+static DexTimerQueue *
+dex_main_scheduler_get_timer_queue (DexScheduler *scheduler)
+{
+  DexMainScheduler *main_scheduler = DEX_MAIN_SCHEDULER (scheduler);
+
+  g_assert (DEX_IS_MAIN_SCHEDULER (main_scheduler));
+
+  return main_scheduler->timer_queue;
+}
+
 static void
 dex_main_scheduler_spawn (DexScheduler *scheduler,
                           DexFiber     *fiber)
@@ -218,6 +229,10 @@ dex_main_scheduler_finalize (DexObject *object)
   g_source_destroy (main_scheduler->work_queue_source);
   g_clear_pointer (&main_scheduler->work_queue_source, g_source_unref);
 
+  /* Clear timer queue, releasing any timers still pending */
+  dex_timer_queue_destroy (main_scheduler->timer_queue);
+  g_clear_pointer (&main_scheduler->timer_queue, dex_timer_queue_unref);
+
   /* Release our main context */
   g_clear_pointer (&main_scheduler->main_context, g_main_context_unref);
 
@@ -234,6 +249,7 @@ dex_main_scheduler_class_init (DexMainSchedulerClass *main_scheduler_class)
 
   scheduler_class->get_aio_context = dex_main_scheduler_get_aio_context;
   scheduler_class->get_main_context = dex_main_scheduler_get_main_context;
+  scheduler_class->get_timer_queue = dex_main_scheduler_get_timer_queue;
   scheduler_class->push = dex_main_scheduler_push;
   scheduler_class->spawn = dex_main_scheduler_spawn;
   scheduler_class->spawn_coroutine = dex_main_scheduler_spawn_coroutine;
@@ -274,6 +290,7 @@ dex_main_scheduler_new (GMainContext *main_context)
   work_queue_source->object = DEX_OBJECT (main_scheduler);
   work_queue_source->queue = &main_scheduler->work_queue;
   main_scheduler->work_queue_source = (GSource *)work_queue_source;
+  main_scheduler->timer_queue = dex_timer_queue_new ();
 
   dex_thread_storage_get ()->aio_context = aio_context;
   dex_thread_storage_get ()->scheduler = DEX_SCHEDULER (main_scheduler);
@@ -282,6 +299,7 @@ dex_main_scheduler_new (GMainContext *main_context)
   g_source_attach (main_scheduler->fiber_scheduler, main_context);
   g_source_attach (main_scheduler->coroutine_scheduler, main_context);
   g_source_attach (main_scheduler->work_queue_source, main_context);
+  g_source_attach ((GSource *)main_scheduler->timer_queue, main_context);
 
   return main_scheduler;
 }
@@ -41,6 +41,8 @@ G_BEGIN_DECLS
   G_PASTE(class_name, _class_intern_init) (gpointer klass)                                        \
   {                                                                                               \
     G_PASTE (class_name, _parent_class) = g_type_class_peek_parent (klass);                       \
+    ((DexObjectClass *)klass)->instance_init = (GInstanceInitFunc) G_PASTE(class_name, _init);    \
+    ((DexObjectClass *)klass)->slab_type = NULL;                                                  \
     G_PASTE (class_name, _class_init) ((G_PASTE (ClassName, Class) *)klass);                      \
   }                                                                                               \
                                                                                                   \
@@ -116,13 +118,24 @@ dex_object_unlock (gpointer data)
   g_mutex_unlock (&DEX_OBJECT (data)->mutex);
 }
 
+typedef struct _DexObjectSlabType DexObjectSlabType;
+
 typedef struct _DexObjectClass
 {
   GTypeClass parent_class;
 
+  /* The instance init function of this exact class and, if enabled with
+   * dex_object_class_enable_slab(), the per-thread instance cache.
+   */
+  GInstanceInitFunc  instance_init;
+  DexObjectSlabType *slab_type;
+
   void (*finalize) (DexObject *object);
 } DexObjectClass;
 
-DexObject *dex_object_create_instance (GType instance_type);
+DexObject *dex_object_create_instance   (GType           instance_type);
+void       dex_object_class_enable_slab (DexObjectClass *object_class);
+void       dex_object_get_slab_stats    (guint64        *n_allocated,
+                                         guint64        *n_reused);
 
 G_END_DECLS
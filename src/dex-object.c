@@ -50,6 +50,323 @@ static GType dex_param_spec_object_type = G_TYPE_INVALID;
 
 #define DEX_TYPE_PARAM_OBJECT (dex_param_spec_object_type)
 
+/* Short-lived objects such as blocks and waiters are created and destroyed
+ * several times for every hop through a future chain. Classes may opt in
+ * with dex_object_class_enable_slab() to have their instances recycled
+ * from a per-thread cache instead of going through malloc each time.
+ *
+ * Each instance is preceded by a DexObjectSlabChunk which remembers the
+ * cache of the thread that allocated it. Objects released on that thread
+ * go back to its free list directly. Objects released on another thread
+ * are pushed onto a lock-free remote list which the owner takes back in
+ * a single exchange once its own free list is empty.
+ *
+ * Per-thread caches are never freed. When a thread exits its cache is
+ * abandoned and adopted by the next thread needing one, so memory is
+ * bounded by the peak number of threads.
+ *
+ * Set DEX_OBJECT_SLAB_SIZE=0 to disable caching, such as when looking for
+ * use-after-free with valgrind.
+ */
+
+#define SLAB_MAX_TYPES    32
+#define SLAB_MAX_INITS    8
+#define DEFAULT_SLAB_SIZE 128
+
+typedef struct _DexObjectSlabChunk DexObjectSlabChunk;
+typedef struct _DexObjectSlabCache DexObjectSlabCache;
+typedef struct _DexObjectSlab      DexObjectSlab;
+
+struct _DexObjectSlabType
+{
+  GType instance_type;
+  guint index;
+  gsize instance_size;
+  guint n_inits;
+  struct {
+    GTypeClass        *klass;
+    GInstanceInitFunc  init;
+  } inits[SLAB_MAX_INITS];
+};
+
+struct _DexObjectSlabChunk
+{
+  DexObjectSlabCache *owner;
+  DexObjectSlabChunk *next;
+};
+
+struct _DexObjectSlabCache
+{
+  /* Owned by the thread */
+  DexObjectSlabChunk *free_list;
+  guint               n_free;
+  _Atomic guint64     n_allocated;
+  _Atomic guint64     n_reused;
+
+  /* Pushed to by other threads */
+  _Atomic(DexObjectSlabChunk *) remote_free;
+  _Atomic guint                 n_remote;
+};
+
+struct _DexObjectSlab
+{
+  DexObjectSlab      *next;
+  DexObjectSlab      *next_abandoned;
+  DexObjectSlabCache  caches[SLAB_MAX_TYPES];
+};
+
+G_STATIC_ASSERT (sizeof (DexObjectSlabChunk) % 8 == 0);
+
+static void dex_object_slab_abandon (gpointer data);
+
+static GPrivate slab_key = G_PRIVATE_INIT (dex_object_slab_abandon);
+static GMutex slab_mutex;
+static DexObjectSlab *slabs;
+static DexObjectSlab *abandoned_slabs;
+static guint n_slab_types;
+static guint slab_size = DEFAULT_SLAB_SIZE;
+
+static void
+dex_object_slab_abandon (gpointer data)
+{
+  DexObjectSlab *slab = data;
+
+  g_mutex_lock (&slab_mutex);
+  slab->next_abandoned = abandoned_slabs;
+  abandoned_slabs = slab;
+  g_mutex_unlock (&slab_mutex);
+}
+
+static DexObjectSlab *
+dex_object_slab_get (void)
+{
+  DexObjectSlab *slab = g_private_get (&slab_key);
+
+  if G_UNLIKELY (slab == NULL)
+    {
+      g_mutex_lock (&slab_mutex);
+      if ((slab = abandoned_slabs))
+        {
+          abandoned_slabs = slab->next_abandoned;
+          slab->next_abandoned = NULL;
+        }
+      else
+        {
+          slab = g_new0 (DexObjectSlab, 1);
+          slab->next = slabs;
+          slabs = slab;
+        }
+      g_mutex_unlock (&slab_mutex);
+
+      g_private_set (&slab_key, slab);
+    }
+
+  return slab;
+}
+
+static inline void
+dex_object_slab_count (_Atomic guint64 *counter)
+{
+  /* Only the owning thread writes, readers just want a snapshot */
+  atomic_store_explicit (counter,
+                         atomic_load_explicit (counter, memory_order_relaxed) + 1,
+                         memory_order_relaxed);
+}
+
+static DexObject *
+dex_object_slab_alloc (DexObjectClass *object_class)
+{
+  const DexObjectSlabType *slab_type = object_class->slab_type;
+  DexObjectSlab *slab = dex_object_slab_get ();
+  DexObjectSlabCache *cache = &slab->caches[slab_type->index];
+  DexObjectSlabChunk *chunk;
+  GTypeInstance *instance;
+
+  if (cache->free_list == NULL &&
+      atomic_load_explicit (&cache->remote_free, memory_order_relaxed) != NULL)
+    {
+      cache->free_list = atomic_exchange_explicit (&cache->remote_free, NULL, memory_order_acquire);
+      cache->n_free = atomic_exchange_explicit (&cache->n_remote, 0, memory_order_relaxed);
+    }
+
+  if ((chunk = cache->free_list))
+    {
+      cache->free_list = chunk->next;
+      if (cache->n_free > 0)
+        cache->n_free--;
+      dex_object_slab_count (&cache->n_reused);
+    }
+  else
+    {
+      chunk = g_malloc (sizeof *chunk + slab_type->instance_size);
+      chunk->owner = cache;
+      dex_object_slab_count (&cache->n_allocated);
+    }
+
+  chunk->next = NULL;
+
+  /* Same as g_type_create_instance(), ancestors first */
+  instance = (GTypeInstance *)&chunk[1];
+  memset (instance, 0, slab_type->instance_size);
+  for (guint i = 0; i < slab_type->n_inits; i++)
+    {
+      instance->g_class = slab_type->inits[i].klass;
+      slab_type->inits[i].init (instance, object_class);
+    }
+  instance->g_class = (GTypeClass *)object_class;
+
+  return (DexObject *)instance;
+}
+
+static void
+dex_object_slab_free (DexObject *object)
+{
+  DexObjectSlabChunk *chunk = &((DexObjectSlabChunk *)(gpointer)object)[-1];
+  DexObjectSlabCache *owner = chunk->owner;
+  const DexObjectSlabType *slab_type = DEX_OBJECT_GET_CLASS (object)->slab_type;
+  DexObjectSlab *slab = g_private_get (&slab_key);
+
+  ((GTypeInstance *)object)->g_class = NULL;
+
+  if (slab != NULL && owner == &slab->caches[slab_type->index])
+    {
+      if (owner->n_free < slab_size)
+        {
+          chunk->next = owner->free_list;
+          owner->free_list = chunk;
+          owner->n_free++;
+          return;
+        }
+    }
+  else if (atomic_load_explicit (&owner->n_remote, memory_order_relaxed) < slab_size)
+    {
+      DexObjectSlabChunk *head = atomic_load_explicit (&owner->remote_free, memory_order_relaxed);
+
+      atomic_fetch_add_explicit (&owner->n_remote, 1, memory_order_relaxed);
+
+      /* Only the owner removes items and it always takes the whole list,
+       * so there is no ABA problem here.
+       */
+      do
+        chunk->next = head;
+      while (!atomic_compare_exchange_weak_explicit (&owner->remote_free,
+                                                     &head,
+                                                     chunk,
+                                                     memory_order_release,
+                                                     memory_order_relaxed));
+      return;
+    }
+
+  g_free (chunk);
+}
+
+/*
+ * dex_object_class_enable_slab:
+ * @object_class: a final class deriving from DexObject
+ *
+ * Allows instances of @object_class to be recycled from per-thread
+ * caches. This must be called from the class_init function so that
+ * every instance is allocated the same way.
+ */
+void
+dex_object_class_enable_slab (DexObjectClass *object_class)
+{
+  static gsize initialized;
+  DexObjectSlabType *slab_type;
+  GType instance_type;
+  GTypeQuery query;
+  guint n_inits = 0;
+
+  g_return_if_fail (G_TYPE_CHECK_CLASS_TYPE (object_class, DEX_TYPE_OBJECT));
+  g_return_if_fail (object_class->slab_type == NULL);
+
+  if (g_once_init_enter (&initialized))
+    {
+      const char *str = g_getenv ("DEX_OBJECT_SLAB_SIZE");
+      guint64 value;
+
+      if (str != NULL &&
+          g_ascii_string_to_unsigned (str, 10, 0, G_MAXUINT, &value, NULL))
+        slab_size = value;
+
+      g_once_init_leave (&initialized, TRUE);
+    }
+
+  if (slab_size == 0)
+    return;
+
+  instance_type = G_TYPE_FROM_CLASS (object_class);
+  g_type_query (instance_type, &query);
+
+  slab_type = g_new0 (DexObjectSlabType, 1);
+  slab_type->instance_type = instance_type;
+  slab_type->instance_size = query.instance_size;
+
+  /* Collect instance init functions from DexObject down to @object_class */
+  for (DexObjectClass *klass = object_class;
+       klass != NULL;
+       klass = g_type_class_peek_parent (klass))
+    n_inits++;
+
+  if (n_inits > SLAB_MAX_INITS)
+    {
+      g_free (slab_type);
+      return;
+    }
+
+  slab_type->n_inits = n_inits;
+  for (DexObjectClass *klass = object_class; n_inits > 0; klass = g_type_class_peek_parent (klass))
+    {
+      n_inits--;
+      slab_type->inits[n_inits].klass = (GTypeClass *)klass;
+      slab_type->inits[n_inits].init = klass->instance_init;
+    }
+
+  g_mutex_lock (&slab_mutex);
+  if (n_slab_types < SLAB_MAX_TYPES)
+    {
+      slab_type->index = n_slab_types++;
+      object_class->slab_type = slab_type;
+      slab_type = NULL;
+    }
+  g_mutex_unlock (&slab_mutex);
+
+  g_free (slab_type);
+}
+
+/*
+ * dex_object_get_slab_stats:
+ * @n_allocated: (out): location for the number of instances allocated
+ * @n_reused: (out): location for the number of allocations avoided
+ *
+ * Gets counters across all threads for classes using
+ * dex_object_class_enable_slab().
+ */
+void
+dex_object_get_slab_stats (guint64 *n_allocated,
+                           guint64 *n_reused)
+{
+  guint64 allocated = 0;
+  guint64 reused = 0;
+
+  g_mutex_lock (&slab_mutex);
+  for (const DexObjectSlab *slab = slabs; slab; slab = slab->next)
+    {
+      for (guint i = 0; i < n_slab_types; i++)
+        {
+          allocated += atomic_load_explicit (&slab->caches[i].n_allocated, memory_order_relaxed);
+          reused += atomic_load_explicit (&slab->caches[i].n_reused, memory_order_relaxed);
+        }
+    }
+  g_mutex_unlock (&slab_mutex);
+
+  if (n_allocated != NULL)
+    *n_allocated = allocated;
+
+  if (n_reused != NULL)
+    *n_reused = reused;
+}
+
 static void
 dex_object_finalize (DexObject *object)
 {
@@ -61,7 +378,10 @@ dex_object_finalize (DexObject *object)
   DEX_PROFILER_MARK (SYSPROF_CAPTURE_CURRENT_TIME - object->ctime, DEX_OBJECT_TYPE_NAME (object), "lifetime");
 #endif
 
-  g_type_free_instance ((GTypeInstance *)object);
+  if (DEX_OBJECT_GET_CLASS (object)->slab_type != NULL)
+    dex_object_slab_free (object);
+  else
+    g_type_free_instance ((GTypeInstance *)object);
 }
 
 /**
@@ -169,12 +489,6 @@ dex_unref (gpointer object)
     object_class->finalize (object);
 }
 
-static void
-dex_object_class_init (DexObjectClass *klass)
-{
-  klass->finalize = dex_object_finalize;
-}
-
 static void
 dex_object_init (DexObject      *self,
                  DexObjectClass *object_class)
@@ -191,6 +505,13 @@ dex_object_init (DexObject      *self,
   atomic_init (&self->weak_refs_watermark, 1);
 }
 
+static void
+dex_object_class_init (DexObjectClass *klass)
+{
+  klass->instance_init = (GInstanceInitFunc) dex_object_init;
+  klass->finalize = dex_object_finalize;
+}
+
 static void
 dex_object_add_weak (gpointer    mem_block,
                       DexWeakRef *weak_ref)
@@ -651,6 +972,15 @@ dex_object_get_type (void)
 DexObject *
 dex_object_create_instance (GType instance_type)
 {
+  DexObjectClass *object_class = g_type_class_peek (instance_type);
+
+  /* The class is never released, so keep a reference the first time */
+  if G_UNLIKELY (object_class == NULL)
+    object_class = g_type_class_ref (instance_type);
+
+  if (object_class->slab_type != NULL)
+    return dex_object_slab_alloc (object_class);
+
   return (DexObject *)(gpointer)g_type_create_instance (instance_type);
 }
 
@@ -41,9 +41,9 @@
  * that on Linux it doesn't guarantee support for regular files to
  * return EAGAIN properly.
  *
- * If/when we introduce AIO operations for send()/recv() then those would
- * use g_source_add_unix_fd()/g_source_remove_unix_fd() to poll() within
- * the GMainContext.
+ * Socket operations such as send()/recv() are attempted without blocking
+ * and otherwise use g_source_add_unix_fd()/g_source_remove_unix_fd() to
+ * poll() within the GMainContext so they never tie up an IO worker.
  *
  * This is primarily meant to be a fallback for cases where we cannot
  * support more specific APIs like io_posix or kqueue.
@@ -64,8 +64,15 @@ typedef struct _DexPosixAioContext
   DexAioContext parent;
   GMutex        mutex;
   GQueue        completed;
+  GQueue        pollers;
 } DexPosixAioContext;
 
+typedef struct _DexPosixAioPoller
+{
+  DexPosixAioFuture *future;
+  gpointer           tag;
+} DexPosixAioPoller;
+
 DEX_DEFINE_FINAL_TYPE (DexPosixAioBackend, dex_posix_aio_backend, DEX_TYPE_AIO_BACKEND)
 
 static struct {
@@ -186,6 +193,39 @@ dex_posix_aio_context_dispatch (GSource     *source,
       dex_unref (posix_aio_future);
     }
 
+#ifdef G_OS_UNIX
+  if (aio_context->pollers.length > 0)
+    {
+      GQueue ready = G_QUEUE_INIT;
+      GList *next;
+
+      g_mutex_lock (&aio_context->mutex);
+      for (GList *iter = aio_context->pollers.head; iter; iter = next)
+        {
+          DexPosixAioPoller *poller = iter->data;
+
+          next = iter->next;
+
+          if (g_source_query_unix_fd (source, poller->tag) == 0 ||
+              !dex_posix_aio_future_try_run (poller->future))
+            continue;
+
+          g_source_remove_unix_fd (source, poller->tag);
+          g_queue_delete_link (&aio_context->pollers, iter);
+          g_queue_push_tail (&ready, poller);
+        }
+      g_mutex_unlock (&aio_context->mutex);
+
+      while (ready.length > 0)
+        {
+          DexPosixAioPoller *poller = g_queue_pop_head (&ready);
+          dex_posix_aio_future_complete (poller->future);
+          dex_unref (poller->future);
+          g_free (poller);
+        }
+    }
+#endif
+
   return G_SOURCE_CONTINUE;
 }
 
@@ -200,6 +240,13 @@ dex_posix_aio_context_check (GSource *source)
 
   g_mutex_lock (&aio_context->mutex);
   ret = aio_context->completed.length > 0;
+#ifdef G_OS_UNIX
+  for (const GList *iter = aio_context->pollers.head; !ret && iter; iter = iter->next)
+    {
+      const DexPosixAioPoller *poller = iter->data;
+      ret = g_source_query_unix_fd (source, poller->tag) != 0;
+    }
+#endif
   g_mutex_unlock (&aio_context->mutex);
 
   return ret;
@@ -209,8 +256,19 @@ static gboolean
 dex_posix_aio_context_prepare (GSource *source,
                                int     *timeout)
 {
+  DexPosixAioContext *aio_context = (DexPosixAioContext *)source;
+  gboolean ret;
+
+  /* Only completions matter here, readiness of pollers is not known
+   * until after the GMainContext has poll()ed.
+   */
+  g_mutex_lock (&aio_context->mutex);
+  ret = aio_context->completed.length > 0;
+  g_mutex_unlock (&aio_context->mutex);
+
   *timeout = -1;
-  return dex_posix_aio_context_check (source);
+
+  return ret;
 }
 
 static void
@@ -221,6 +279,7 @@ dex_posix_aio_context_finalize (GSource *source)
   g_assert (aio_context != NULL);
   g_assert (DEX_IS_POSIX_AIO_BACKEND (aio_context->parent.aio_backend));
   g_assert (aio_context->completed.length == 0);
+  g_assert (aio_context->pollers.length == 0);
 
   g_mutex_clear (&aio_context->mutex);
 }
@@ -290,6 +349,210 @@ dex_posix_aio_backend_write (DexAioBackend *aio_backend,
   return dex_posix_aio_backend_enqueue (dex_posix_aio_future_new_write ((DexPosixAioContext *)aio_context, fd, buffer, count, offset));
 }
 
+static DexFuture *
+dex_posix_aio_backend_fsync (DexAioBackend *aio_backend,
+                             DexAioContext *aio_context,
+                             int            fd,
+                             gboolean       datasync)
+{
+  return dex_posix_aio_backend_enqueue (dex_posix_aio_future_new_fsync ((DexPosixAioContext *)aio_context, fd, datasync));
+}
+
+static DexFuture *
+dex_posix_aio_backend_statx (DexAioBackend *aio_backend,
+                             DexAioContext *aio_context,
+                             int            dirfd,
+                             const char    *path,
+                             int            flags,
+                             guint          mask,
+                             struct statx  *statxbuf)
+{
+  return dex_posix_aio_backend_enqueue (dex_posix_aio_future_new_statx ((DexPosixAioContext *)aio_context, dirfd, path, flags, mask, statxbuf));
+}
+
+static DexFuture *
+dex_posix_aio_backend_fallocate (DexAioBackend *aio_backend,
+                                 DexAioContext *aio_context,
+                                 int            fd,
+                                 int            mode,
+                                 goffset        offset,
+                                 goffset        length)
+{
+  return dex_posix_aio_backend_enqueue (dex_posix_aio_future_new_fallocate ((DexPosixAioContext *)aio_context, fd, mode, offset, length));
+}
+
+static DexFuture *
+dex_posix_aio_backend_readv (DexAioBackend *aio_backend,
+                             DexAioContext *aio_context,
+                             int            fd,
+                             GInputVector  *vectors,
+                             guint          n_vectors,
+                             goffset        offset)
+{
+  return dex_posix_aio_backend_enqueue (dex_posix_aio_future_new_readv ((DexPosixAioContext *)aio_context, fd, vectors, n_vectors, offset));
+}
+
+static DexFuture *
+dex_posix_aio_backend_writev (DexAioBackend       *aio_backend,
+                              DexAioContext       *aio_context,
+                              int                  fd,
+                              const GOutputVector *vectors,
+                              guint                n_vectors,
+                              goffset              offset)
+{
+  return dex_posix_aio_backend_enqueue (dex_posix_aio_future_new_writev ((DexPosixAioContext *)aio_context, fd, vectors, n_vectors, offset));
+}
+
+static DexFuture *
+dex_posix_aio_backend_splice (DexAioBackend *aio_backend,
+                              DexAioContext *aio_context,
+                              int            fd_in,
+                              goffset        offset_in,
+                              int            fd_out,
+                              goffset        offset_out,
+                              gsize          length,
+                              guint          flags)
+{
+  return dex_posix_aio_backend_enqueue (dex_posix_aio_future_new_splice ((DexPosixAioContext *)aio_context, fd_in, offset_in, fd_out, offset_out, length, flags));
+}
+
+static DexFuture *
+dex_posix_aio_backend_renameat (DexAioBackend *aio_backend,
+                                DexAioContext *aio_context,
+                                int            old_dirfd,
+                                const char    *old_path,
+                                int            new_dirfd,
+                                const char    *new_path,
+                                guint          flags)
+{
+  return dex_posix_aio_backend_enqueue (dex_posix_aio_future_new_renameat ((DexPosixAioContext *)aio_context, old_dirfd, old_path, new_dirfd, new_path, flags));
+}
+
+static DexFuture *
+dex_posix_aio_backend_unlinkat (DexAioBackend *aio_backend,
+                                DexAioContext *aio_context,
+                                int            dirfd,
+                                const char    *path,
+                                int            flags)
+{
+  return dex_posix_aio_backend_enqueue (dex_posix_aio_future_new_unlinkat ((DexPosixAioContext *)aio_context, dirfd, path, flags));
+}
+
+static DexFuture *
+dex_posix_aio_backend_mkdirat (DexAioBackend *aio_backend,
+                               DexAioContext *aio_context,
+                               int            dirfd,
+                               const char    *path,
+                               int            mode)
+{
+  return dex_posix_aio_backend_enqueue (dex_posix_aio_future_new_mkdirat ((DexPosixAioContext *)aio_context, dirfd, path, mode));
+}
+
+#ifdef G_OS_UNIX
+static DexFuture *
+dex_posix_aio_backend_poll (DexPosixAioFuture *posix_aio_future)
+{
+  DexPosixAioContext *aio_context;
+  DexPosixAioPoller *poller;
+  GIOCondition condition;
+  int fd;
+
+  g_assert (DEX_IS_POSIX_AIO_FUTURE (posix_aio_future));
+
+  /* Try first so that ready sockets never round-trip the main loop */
+  if (dex_posix_aio_future_try_run (posix_aio_future))
+    {
+      dex_posix_aio_future_complete (posix_aio_future);
+      return DEX_FUTURE (posix_aio_future);
+    }
+
+  aio_context = dex_posix_aio_future_get_aio_context (posix_aio_future);
+  fd = dex_posix_aio_future_get_poll_fd (posix_aio_future, &condition);
+
+  poller = g_new0 (DexPosixAioPoller, 1);
+  poller->future = dex_ref (posix_aio_future);
+
+  g_mutex_lock (&aio_context->mutex);
+  poller->tag = g_source_add_unix_fd ((GSource *)aio_context, fd, condition);
+  g_queue_push_tail (&aio_context->pollers, poller);
+  g_mutex_unlock (&aio_context->mutex);
+
+  return DEX_FUTURE (posix_aio_future);
+}
+
+static DexFuture *
+dex_posix_aio_backend_accept (DexAioBackend   *aio_backend,
+                              DexAioContext   *aio_context,
+                              int              fd,
+                              struct sockaddr *addr,
+                              socklen_t       *addrlen,
+                              int              flags)
+{
+  return dex_posix_aio_backend_poll (dex_posix_aio_future_new_accept ((DexPosixAioContext *)aio_context, fd, addr, addrlen, flags));
+}
+
+static DexFuture *
+dex_posix_aio_backend_connect (DexAioBackend         *aio_backend,
+                               DexAioContext         *aio_context,
+                               int                    fd,
+                               const struct sockaddr *addr,
+                               socklen_t              addrlen)
+{
+  DexPosixAioFuture *posix_aio_future;
+  int flags;
+
+  posix_aio_future = dex_posix_aio_future_new_connect ((DexPosixAioContext *)aio_context, fd, addr, addrlen);
+
+  /* connect() on a blocking socket cannot be polled, use an IO worker */
+  if ((flags = fcntl (fd, F_GETFL)) != -1 && !(flags & O_NONBLOCK))
+    return dex_posix_aio_backend_enqueue (posix_aio_future);
+
+  return dex_posix_aio_backend_poll (posix_aio_future);
+}
+
+static DexFuture *
+dex_posix_aio_backend_recv (DexAioBackend *aio_backend,
+                            DexAioContext *aio_context,
+                            int            fd,
+                            gpointer       buffer,
+                            gsize          count,
+                            int            flags)
+{
+  return dex_posix_aio_backend_poll (dex_posix_aio_future_new_recv ((DexPosixAioContext *)aio_context, fd, buffer, count, flags));
+}
+
+static DexFuture *
+dex_posix_aio_backend_send (DexAioBackend *aio_backend,
+                            DexAioContext *aio_context,
+                            int            fd,
+                            gconstpointer  buffer,
+                            gsize          count,
+                            int            flags)
+{
+  return dex_posix_aio_backend_poll (dex_posix_aio_future_new_send ((DexPosixAioContext *)aio_context, fd, buffer, count, flags));
+}
+
+static DexFuture *
+dex_posix_aio_backend_recvmsg (DexAioBackend *aio_backend,
+                               DexAioContext *aio_context,
+                               int            fd,
+                               struct msghdr *msg,
+                               int            flags)
+{
+  return dex_posix_aio_backend_poll (dex_posix_aio_future_new_recvmsg ((DexPosixAioContext *)aio_context, fd, msg, flags));
+}
+
+static DexFuture *
+dex_posix_aio_backend_sendmsg (DexAioBackend       *aio_backend,
+                               DexAioContext       *aio_context,
+                               int                  fd,
+                               const struct msghdr *msg,
+                               int                  flags)
+{
+  return dex_posix_aio_backend_poll (dex_posix_aio_future_new_sendmsg ((DexPosixAioContext *)aio_context, fd, msg, flags));
+}
+#endif
+
 static void
 dex_posix_aio_backend_class_init (DexPosixAioBackendClass *posix_aio_backend_class)
 {
@@ -300,6 +563,23 @@ dex_posix_aio_backend_class_init (DexPosixAioBackendClass *posix_aio_backend_cla
   aio_backend_class->open = dex_posix_aio_backend_open;
   aio_backend_class->read = dex_posix_aio_backend_read;
   aio_backend_class->write = dex_posix_aio_backend_write;
+  aio_backend_class->fsync = dex_posix_aio_backend_fsync;
+  aio_backend_class->statx = dex_posix_aio_backend_statx;
+  aio_backend_class->fallocate = dex_posix_aio_backend_fallocate;
+  aio_backend_class->readv = dex_posix_aio_backend_readv;
+  aio_backend_class->writev = dex_posix_aio_backend_writev;
+  aio_backend_class->splice = dex_posix_aio_backend_splice;
+  aio_backend_class->renameat = dex_posix_aio_backend_renameat;
+  aio_backend_class->unlinkat = dex_posix_aio_backend_unlinkat;
+  aio_backend_class->mkdirat = dex_posix_aio_backend_mkdirat;
+#ifdef G_OS_UNIX
+  aio_backend_class->accept = dex_posix_aio_backend_accept;
+  aio_backend_class->connect = dex_posix_aio_backend_connect;
+  aio_backend_class->recv = dex_posix_aio_backend_recv;
+  aio_backend_class->send = dex_posix_aio_backend_send;
+  aio_backend_class->recvmsg = dex_posix_aio_backend_recvmsg;
+  aio_backend_class->sendmsg = dex_posix_aio_backend_sendmsg;
+#endif
 
   g_type_ensure (DEX_TYPE_POSIX_AIO_FUTURE);
 }
@@ -29,25 +29,102 @@ G_BEGIN_DECLS
 #define DEX_IS_POSIX_AIO_FUTURE(obj) (G_TYPE_CHECK_INSTANCE_TYPE(obj, DEX_TYPE_POSIX_AIO_FUTURE))
 
 GType               dex_posix_aio_future_get_type         (void);
-DexPosixAioFuture  *dex_posix_aio_future_new_close        (DexPosixAioContext *posix_aio_context,
-                                                           int                 fd);
-DexPosixAioFuture  *dex_posix_aio_future_new_open         (DexPosixAioContext *posix_aio_context,
-                                                           const char         *path,
-                                                           int                 flags,
-                                                           int                 mode);
-DexPosixAioFuture  *dex_posix_aio_future_new_read         (DexPosixAioContext *posix_aio_context,
-                                                           int                 fd,
-                                                           gpointer            buffer,
-                                                           gsize               count,
-                                                           goffset             offset);
-DexPosixAioFuture  *dex_posix_aio_future_new_write        (DexPosixAioContext *posix_aio_context,
-                                                           int                 fd,
-                                                           gconstpointer       buffer,
-                                                           gsize               count,
-                                                           goffset             offset);
-void                dex_posix_aio_future_run              (DexPosixAioFuture  *posix_aio_future);
-void                dex_posix_aio_future_complete         (DexPosixAioFuture  *posix_aio_future);
-DexPosixAioContext *dex_posix_aio_future_get_aio_context  (DexPosixAioFuture  *posix_aio_future);
-GMainContext       *dex_posix_aio_future_get_main_context (DexPosixAioFuture  *posix_aio_future);
+DexPosixAioFuture  *dex_posix_aio_future_new_close        (DexPosixAioContext    *posix_aio_context,
+                                                           int                    fd);
+DexPosixAioFuture  *dex_posix_aio_future_new_open         (DexPosixAioContext    *posix_aio_context,
+                                                           const char            *path,
+                                                           int                    flags,
+                                                           int                    mode);
+DexPosixAioFuture  *dex_posix_aio_future_new_read         (DexPosixAioContext    *posix_aio_context,
+                                                           int                    fd,
+                                                           gpointer               buffer,
+                                                           gsize                  count,
+                                                           goffset                offset);
+DexPosixAioFuture  *dex_posix_aio_future_new_write        (DexPosixAioContext    *posix_aio_context,
+                                                           int                    fd,
+                                                           gconstpointer          buffer,
+                                                           gsize                  count,
+                                                           goffset                offset);
+DexPosixAioFuture  *dex_posix_aio_future_new_fsync        (DexPosixAioContext    *posix_aio_context,
+                                                           int                    fd,
+                                                           gboolean               datasync);
+DexPosixAioFuture  *dex_posix_aio_future_new_statx        (DexPosixAioContext    *posix_aio_context,
+                                                           int                    dirfd,
+                                                           const char            *path,
+                                                           int                    flags,
+                                                           guint                  mask,
+                                                           struct statx          *statxbuf);
+DexPosixAioFuture  *dex_posix_aio_future_new_fallocate    (DexPosixAioContext    *posix_aio_context,
+                                                           int                    fd,
+                                                           int                    mode,
+                                                           goffset                offset,
+                                                           goffset                length);
+DexPosixAioFuture  *dex_posix_aio_future_new_readv        (DexPosixAioContext    *posix_aio_context,
+                                                           int                    fd,
+                                                           GInputVector          *vectors,
+                                                           guint                  n_vectors,
+                                                           goffset                offset);
+DexPosixAioFuture  *dex_posix_aio_future_new_writev       (DexPosixAioContext    *posix_aio_context,
+                                                           int                    fd,
+                                                           const GOutputVector   *vectors,
+                                                           guint                  n_vectors,
+                                                           goffset                offset);
+DexPosixAioFuture  *dex_posix_aio_future_new_splice       (DexPosixAioContext    *posix_aio_context,
+                                                           int                    fd_in,
+                                                           goffset                offset_in,
+                                                           int                    fd_out,
+                                                           goffset                offset_out,
+                                                           gsize                  length,
+                                                           guint                  flags);
+DexPosixAioFuture  *dex_posix_aio_future_new_renameat     (DexPosixAioContext    *posix_aio_context,
+                                                           int                    old_dirfd,
+                                                           const char            *old_path,
+                                                           int                    new_dirfd,
+                                                           const char            *new_path,
+                                                           guint                  flags);
+DexPosixAioFuture  *dex_posix_aio_future_new_unlinkat     (DexPosixAioContext    *posix_aio_context,
+                                                           int                    dirfd,
+                                                           const char            *path,
+                                                           int                    flags);
+DexPosixAioFuture  *dex_posix_aio_future_new_mkdirat      (DexPosixAioContext    *posix_aio_context,
+                                                           int                    dirfd,
+                                                           const char            *path,
+                                                           int                    mode);
+#ifdef G_OS_UNIX
+DexPosixAioFuture  *dex_posix_aio_future_new_accept       (DexPosixAioContext    *posix_aio_context,
+                                                           int                    fd,
+                                                           struct sockaddr       *addr,
+                                                           socklen_t             *addrlen,
+                                                           int                    flags);
+DexPosixAioFuture  *dex_posix_aio_future_new_connect      (DexPosixAioContext    *posix_aio_context,
+                                                           int                    fd,
+                                                           const struct sockaddr *addr,
+                                                           socklen_t              addrlen);
+DexPosixAioFuture  *dex_posix_aio_future_new_recv         (DexPosixAioContext    *posix_aio_context,
+                                                           int                    fd,
+                                                           gpointer               buffer,
+                                                           gsize                  count,
+                                                           int                    flags);
+DexPosixAioFuture  *dex_posix_aio_future_new_send         (DexPosixAioContext    *posix_aio_context,
+                                                           int                    fd,
+                                                           gconstpointer          buffer,
+                                                           gsize                  count,
+                                                           int                    flags);
+DexPosixAioFuture  *dex_posix_aio_future_new_recvmsg      (DexPosixAioContext    *posix_aio_context,
+                                                           int                    fd,
+                                                           struct msghdr         *msg,
+                                                           int                    flags);
+DexPosixAioFuture  *dex_posix_aio_future_new_sendmsg      (DexPosixAioContext    *posix_aio_context,
+                                                           int                    fd,
+                                                           const struct msghdr   *msg,
+                                                           int                    flags);
+gboolean            dex_posix_aio_future_try_run          (DexPosixAioFuture     *posix_aio_future);
+int                 dex_posix_aio_future_get_poll_fd      (DexPosixAioFuture     *posix_aio_future,
+                                                           GIOCondition          *condition);
+#endif
+void                dex_posix_aio_future_run              (DexPosixAioFuture     *posix_aio_future);
+void                dex_posix_aio_future_complete         (DexPosixAioFuture     *posix_aio_future);
+DexPosixAioContext *dex_posix_aio_future_get_aio_context  (DexPosixAioFuture     *posix_aio_future);
+GMainContext       *dex_posix_aio_future_get_main_context (DexPosixAioFuture     *posix_aio_future);
 
 G_END_DECLS
@@ -18,10 +18,17 @@
  * SPDX-License-Identifier: LGPL-2.1-or-later
  */
 
+#ifndef _GNU_SOURCE
+# define _GNU_SOURCE
+#endif
+
 #include "config.h"
 
 #include <errno.h>
 #include <fcntl.h>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
 
 #ifdef HAVE_UNISTD_H
 #include <unistd.h>
@@ -29,6 +36,11 @@
 
 #include <gio/gio.h>
 
+#ifdef G_OS_UNIX
+# include <poll.h>
+# include <sys/socket.h>
+#endif
+
 #include "dex-fd-private.h"
 #include "dex-future-private.h"
 #include "dex-posix-aio-backend-private.h"
@@ -40,6 +52,23 @@ typedef enum _DexPosixAioFutureKind
   DEX_POSIX_AIO_FUTURE_OPEN,
   DEX_POSIX_AIO_FUTURE_READ,
   DEX_POSIX_AIO_FUTURE_WRITE,
+  DEX_POSIX_AIO_FUTURE_FSYNC,
+  DEX_POSIX_AIO_FUTURE_STATX,
+  DEX_POSIX_AIO_FUTURE_FALLOCATE,
+  DEX_POSIX_AIO_FUTURE_READV,
+  DEX_POSIX_AIO_FUTURE_WRITEV,
+  DEX_POSIX_AIO_FUTURE_SPLICE,
+  DEX_POSIX_AIO_FUTURE_RENAMEAT,
+  DEX_POSIX_AIO_FUTURE_UNLINKAT,
+  DEX_POSIX_AIO_FUTURE_MKDIRAT,
+#ifdef G_OS_UNIX
+  DEX_POSIX_AIO_FUTURE_ACCEPT,
+  DEX_POSIX_AIO_FUTURE_CONNECT,
+  DEX_POSIX_AIO_FUTURE_RECV,
+  DEX_POSIX_AIO_FUTURE_SEND,
+  DEX_POSIX_AIO_FUTURE_RECVMSG,
+  DEX_POSIX_AIO_FUTURE_SENDMSG,
+#endif
 } DexPosixAioFutureKind;
 
 struct _DexPosixAioFuture
@@ -74,6 +103,111 @@ struct _DexPosixAioFuture
       goffset            offset;
       gssize             res;
     } write;
+    struct {
+      int                fd;
+      gboolean           datasync;
+      int                res;
+    } fsync;
+    struct {
+      int                dirfd;
+      char              *path;
+      int                flags;
+      guint              mask;
+      struct statx      *statxbuf;
+      int                res;
+    } statx;
+    struct {
+      int                fd;
+      int                mode;
+      goffset            offset;
+      goffset            length;
+      int                res;
+    } fallocate;
+    struct {
+      int                fd;
+      struct iovec      *iov;
+      guint              n_iov;
+      goffset            offset;
+      gssize             res;
+    } readv;
+    struct {
+      int                fd;
+      struct iovec      *iov;
+      guint              n_iov;
+      goffset            offset;
+      gssize             res;
+    } writev;
+    struct {
+      int                fd_in;
+      goffset            offset_in;
+      int                fd_out;
+      goffset            offset_out;
+      gsize              length;
+      guint              flags;
+      gssize             res;
+    } splice;
+    struct {
+      int                old_dirfd;
+      char              *old_path;
+      int                new_dirfd;
+      char              *new_path;
+      guint              flags;
+      int                res;
+    } renameat;
+    struct {
+      int                dirfd;
+      char              *path;
+      int                flags;
+      int                res;
+    } unlinkat;
+    struct {
+      int                dirfd;
+      char              *path;
+      int                mode;
+      int                res;
+    } mkdirat;
+#ifdef G_OS_UNIX
+    struct {
+      int                fd;
+      struct sockaddr   *addr;
+      socklen_t         *addrlen;
+      int                flags;
+      int                res;
+    } accept;
+    struct {
+      int                fd;
+      struct sockaddr   *addr;
+      socklen_t          addrlen;
+      guint              in_progress : 1;
+      int                res;
+    } connect;
+    struct {
+      int                fd;
+      gpointer           buffer;
+      gsize              count;
+      int                flags;
+      gssize             res;
+    } recv;
+    struct {
+      int                fd;
+      gconstpointer      buffer;
+      gsize              count;
+      int                flags;
+      gssize             res;
+    } send;
+    struct {
+      int                fd;
+      struct msghdr     *msg;
+      int                flags;
+      gssize             res;
+    } recvmsg;
+    struct {
+      int                fd;
+      const struct msghdr *msg;
+      int                flags;
+      gssize             res;
+    } sendmsg;
+#endif
   };
 };
 
@@ -92,10 +226,55 @@ dex_posix_aio_future_finalize (DexObject *object)
 {
   DexPosixAioFuture *posix_aio_future = DEX_POSIX_AIO_FUTURE (object);
 
-  if (posix_aio_future->kind == DEX_POSIX_AIO_FUTURE_CLOSE)
-    g_clear_pointer (&posix_aio_future->close.fd, dex_fd_free);
-  else if (posix_aio_future->kind == DEX_POSIX_AIO_FUTURE_OPEN)
-    g_clear_pointer (&posix_aio_future->open.path, g_free);
+  switch (posix_aio_future->kind)
+    {
+    case DEX_POSIX_AIO_FUTURE_CLOSE:
+      g_clear_pointer (&posix_aio_future->close.fd, dex_fd_free);
+      break;
+
+    case DEX_POSIX_AIO_FUTURE_OPEN:
+      g_clear_pointer (&posix_aio_future->open.path, g_free);
+      break;
+
+    case DEX_POSIX_AIO_FUTURE_STATX:
+      g_clear_pointer (&posix_aio_future->statx.path, g_free);
+      break;
+
+    case DEX_POSIX_AIO_FUTURE_READV:
+      g_clear_pointer (&posix_aio_future->readv.iov, g_free);
+      break;
+
+    case DEX_POSIX_AIO_FUTURE_WRITEV:
+      g_clear_pointer (&posix_aio_future->writev.iov, g_free);
+      break;
+
+    case DEX_POSIX_AIO_FUTURE_RENAMEAT:
+      g_clear_pointer (&posix_aio_future->renameat.old_path, g_free);
+      g_clear_pointer (&posix_aio_future->renameat.new_path, g_free);
+      break;
+
+    case DEX_POSIX_AIO_FUTURE_UNLINKAT:
+      g_clear_pointer (&posix_aio_future->unlinkat.path, g_free);
+      break;
+
+    case DEX_POSIX_AIO_FUTURE_MKDIRAT:
+      g_clear_pointer (&posix_aio_future->mkdirat.path, g_free);
+      break;
+
+#ifdef G_OS_UNIX
+    case DEX_POSIX_AIO_FUTURE_CONNECT:
+      g_clear_pointer (&posix_aio_future->connect.addr, g_free);
+      break;
+#endif
+
+    case DEX_POSIX_AIO_FUTURE_READ:
+    case DEX_POSIX_AIO_FUTURE_WRITE:
+    case DEX_POSIX_AIO_FUTURE_FSYNC:
+    case DEX_POSIX_AIO_FUTURE_FALLOCATE:
+    case DEX_POSIX_AIO_FUTURE_SPLICE:
+    default:
+      break;
+    }
 
   g_clear_pointer ((GSource **)&posix_aio_future->aio_context, g_source_unref);
   g_clear_pointer (&posix_aio_future->main_context, g_main_context_unref);
@@ -202,6 +381,490 @@ dex_posix_aio_future_new_write (DexPosixAioContext *posix_aio_context,
   return posix_aio_future;
 }
 
+DexPosixAioFuture *
+dex_posix_aio_future_new_fsync (DexPosixAioContext *posix_aio_context,
+                                int                 fd,
+                                gboolean            datasync)
+{
+  DexPosixAioFuture *posix_aio_future;
+
+  posix_aio_future = dex_posix_aio_future_new (DEX_POSIX_AIO_FUTURE_FSYNC, posix_aio_context);
+  posix_aio_future->fsync.fd = fd;
+  posix_aio_future->fsync.datasync = !!datasync;
+  posix_aio_future->fsync.res = -1;
+
+  return posix_aio_future;
+}
+
+DexPosixAioFuture *
+dex_posix_aio_future_new_statx (DexPosixAioContext *posix_aio_context,
+                                int                 dirfd,
+                                const char         *path,
+                                int                 flags,
+                                guint               mask,
+                                struct statx       *statxbuf)
+{
+  DexPosixAioFuture *posix_aio_future;
+
+  posix_aio_future = dex_posix_aio_future_new (DEX_POSIX_AIO_FUTURE_STATX, posix_aio_context);
+  posix_aio_future->statx.dirfd = dirfd;
+  posix_aio_future->statx.path = g_strdup (path);
+  posix_aio_future->statx.flags = flags;
+  posix_aio_future->statx.mask = mask;
+  posix_aio_future->statx.statxbuf = statxbuf;
+  posix_aio_future->statx.res = -1;
+
+  return posix_aio_future;
+}
+
+DexPosixAioFuture *
+dex_posix_aio_future_new_fallocate (DexPosixAioContext *posix_aio_context,
+                                    int                 fd,
+                                    int                 mode,
+                                    goffset             offset,
+                                    goffset             length)
+{
+  DexPosixAioFuture *posix_aio_future;
+
+  posix_aio_future = dex_posix_aio_future_new (DEX_POSIX_AIO_FUTURE_FALLOCATE, posix_aio_context);
+  posix_aio_future->fallocate.fd = fd;
+  posix_aio_future->fallocate.mode = mode;
+  posix_aio_future->fallocate.offset = offset;
+  posix_aio_future->fallocate.length = length;
+  posix_aio_future->fallocate.res = -1;
+
+  return posix_aio_future;
+}
+
+DexPosixAioFuture *
+dex_posix_aio_future_new_readv (DexPosixAioContext *posix_aio_context,
+                                int                 fd,
+                                GInputVector       *vectors,
+                                guint               n_vectors,
+                                goffset             offset)
+{
+  DexPosixAioFuture *posix_aio_future;
+
+  posix_aio_future = dex_posix_aio_future_new (DEX_POSIX_AIO_FUTURE_READV, posix_aio_context);
+  posix_aio_future->readv.fd = fd;
+  posix_aio_future->readv.iov = g_memdup2 (vectors, sizeof (struct iovec) * n_vectors);
+  posix_aio_future->readv.n_iov = n_vectors;
+  posix_aio_future->readv.offset = offset;
+  posix_aio_future->readv.res = -1;
+
+  return posix_aio_future;
+}
+
+DexPosixAioFuture *
+dex_posix_aio_future_new_writev (DexPosixAioContext  *posix_aio_context,
+                                 int                  fd,
+                                 const GOutputVector *vectors,
+                                 guint                n_vectors,
+                                 goffset              offset)
+{
+  DexPosixAioFuture *posix_aio_future;
+
+  posix_aio_future = dex_posix_aio_future_new (DEX_POSIX_AIO_FUTURE_WRITEV, posix_aio_context);
+  posix_aio_future->writev.fd = fd;
+  posix_aio_future->writev.iov = g_memdup2 (vectors, sizeof (struct iovec) * n_vectors);
+  posix_aio_future->writev.n_iov = n_vectors;
+  posix_aio_future->writev.offset = offset;
+  posix_aio_future->writev.res = -1;
+
+  return posix_aio_future;
+}
+
+DexPosixAioFuture *
+dex_posix_aio_future_new_splice (DexPosixAioContext *posix_aio_context,
+                                 int                 fd_in,
+                                 goffset             offset_in,
+                                 int                 fd_out,
+                                 goffset             offset_out,
+                                 gsize               length,
+                                 guint               flags)
+{
+  DexPosixAioFuture *posix_aio_future;
+
+  posix_aio_future = dex_posix_aio_future_new (DEX_POSIX_AIO_FUTURE_SPLICE, posix_aio_context);
+  posix_aio_future->splice.fd_in = fd_in;
+  posix_aio_future->splice.offset_in = offset_in;
+  posix_aio_future->splice.fd_out = fd_out;
+  posix_aio_future->splice.offset_out = offset_out;
+  posix_aio_future->splice.length = length;
+  posix_aio_future->splice.flags = flags;
+  posix_aio_future->splice.res = -1;
+
+  return posix_aio_future;
+}
+
+DexPosixAioFuture *
+dex_posix_aio_future_new_renameat (DexPosixAioContext *posix_aio_context,
+                                   int                 old_dirfd,
+                                   const char         *old_path,
+                                   int                 new_dirfd,
+                                   const char         *new_path,
+                                   guint               flags)
+{
+  DexPosixAioFuture *posix_aio_future;
+
+  posix_aio_future = dex_posix_aio_future_new (DEX_POSIX_AIO_FUTURE_RENAMEAT, posix_aio_context);
+  posix_aio_future->renameat.old_dirfd = old_dirfd;
+  posix_aio_future->renameat.old_path = g_strdup (old_path);
+  posix_aio_future->renameat.new_dirfd = new_dirfd;
+  posix_aio_future->renameat.new_path = g_strdup (new_path);
+  posix_aio_future->renameat.flags = flags;
+  posix_aio_future->renameat.res = -1;
+
+  return posix_aio_future;
+}
+
+DexPosixAioFuture *
+dex_posix_aio_future_new_unlinkat (DexPosixAioContext *posix_aio_context,
+                                   int                 dirfd,
+                                   const char         *path,
+                                   int                 flags)
+{
+  DexPosixAioFuture *posix_aio_future;
+
+  posix_aio_future = dex_posix_aio_future_new (DEX_POSIX_AIO_FUTURE_UNLINKAT, posix_aio_context);
+  posix_aio_future->unlinkat.dirfd = dirfd;
+  posix_aio_future->unlinkat.path = g_strdup (path);
+  posix_aio_future->unlinkat.flags = flags;
+  posix_aio_future->unlinkat.res = -1;
+
+  return posix_aio_future;
+}
+
+DexPosixAioFuture *
+dex_posix_aio_future_new_mkdirat (DexPosixAioContext *posix_aio_context,
+                                  int                 dirfd,
+                                  const char         *path,
+                                  int                 mode)
+{
+  DexPosixAioFuture *posix_aio_future;
+
+  posix_aio_future = dex_posix_aio_future_new (DEX_POSIX_AIO_FUTURE_MKDIRAT, posix_aio_context);
+  posix_aio_future->mkdirat.dirfd = dirfd;
+  posix_aio_future->mkdirat.path = g_strdup (path);
+  posix_aio_future->mkdirat.mode = mode;
+  posix_aio_future->mkdirat.res = -1;
+
+  return posix_aio_future;
+}
+
+#ifdef G_OS_UNIX
+DexPosixAioFuture *
+dex_posix_aio_future_new_accept (DexPosixAioContext *posix_aio_context,
+                                 int                 fd,
+                                 struct sockaddr    *addr,
+                                 socklen_t          *addrlen,
+                                 int                 flags)
+{
+  DexPosixAioFuture *posix_aio_future;
+
+  posix_aio_future = dex_posix_aio_future_new (DEX_POSIX_AIO_FUTURE_ACCEPT, posix_aio_context);
+  posix_aio_future->accept.fd = fd;
+  posix_aio_future->accept.addr = addr;
+  posix_aio_future->accept.addrlen = addrlen;
+  posix_aio_future->accept.flags = flags;
+  posix_aio_future->accept.res = -1;
+
+  return posix_aio_future;
+}
+
+DexPosixAioFuture *
+dex_posix_aio_future_new_connect (DexPosixAioContext    *posix_aio_context,
+                                  int                    fd,
+                                  const struct sockaddr *addr,
+                                  socklen_t              addrlen)
+{
+  DexPosixAioFuture *posix_aio_future;
+
+  posix_aio_future = dex_posix_aio_future_new (DEX_POSIX_AIO_FUTURE_CONNECT, posix_aio_context);
+  posix_aio_future->connect.fd = fd;
+  posix_aio_future->connect.addr = g_memdup2 (addr, addrlen);
+  posix_aio_future->connect.addrlen = addrlen;
+  posix_aio_future->connect.res = -1;
+
+  return posix_aio_future;
+}
+
+DexPosixAioFuture *
+dex_posix_aio_future_new_recv (DexPosixAioContext *posix_aio_context,
+                               int                 fd,
+                               gpointer            buffer,
+                               gsize               count,
+                               int                 flags)
+{
+  DexPosixAioFuture *posix_aio_future;
+
+  posix_aio_future = dex_posix_aio_future_new (DEX_POSIX_AIO_FUTURE_RECV, posix_aio_context);
+  posix_aio_future->recv.fd = fd;
+  posix_aio_future->recv.buffer = buffer;
+  posix_aio_future->recv.count = count;
+  posix_aio_future->recv.flags = flags;
+  posix_aio_future->recv.res = -1;
+
+  return posix_aio_future;
+}
+
+DexPosixAioFuture *
+dex_posix_aio_future_new_send (DexPosixAioContext *posix_aio_context,
+                               int                 fd,
+                               gconstpointer       buffer,
+                               gsize               count,
+                               int                 flags)
+{
+  DexPosixAioFuture *posix_aio_future;
+
+  posix_aio_future = dex_posix_aio_future_new (DEX_POSIX_AIO_FUTURE_SEND, posix_aio_context);
+  posix_aio_future->send.fd = fd;
+  posix_aio_future->send.buffer = buffer;
+  posix_aio_future->send.count = count;
+  posix_aio_future->send.flags = flags;
+  posix_aio_future->send.res = -1;
+
+  return posix_aio_future;
+}
+
+DexPosixAioFuture *
+dex_posix_aio_future_new_recvmsg (DexPosixAioContext *posix_aio_context,
+                                  int                 fd,
+                                  struct msghdr      *msg,
+                                  int                 flags)
+{
+  DexPosixAioFuture *posix_aio_future;
+
+  posix_aio_future = dex_posix_aio_future_new (DEX_POSIX_AIO_FUTURE_RECVMSG, posix_aio_context);
+  posix_aio_future->recvmsg.fd = fd;
+  posix_aio_future->recvmsg.msg = msg;
+  posix_aio_future->recvmsg.flags = flags;
+  posix_aio_future->recvmsg.res = -1;
+
+  return posix_aio_future;
+}
+
+DexPosixAioFuture *
+dex_posix_aio_future_new_sendmsg (DexPosixAioContext  *posix_aio_context,
+                                  int                  fd,
+                                  const struct msghdr *msg,
+                                  int                  flags)
+{
+  DexPosixAioFuture *posix_aio_future;
+
+  posix_aio_future = dex_posix_aio_future_new (DEX_POSIX_AIO_FUTURE_SENDMSG, posix_aio_context);
+  posix_aio_future->sendmsg.fd = fd;
+  posix_aio_future->sendmsg.msg = msg;
+  posix_aio_future->sendmsg.flags = flags;
+  posix_aio_future->sendmsg.res = -1;
+
+  return posix_aio_future;
+}
+
+static int
+dex_posix_aio_future_accept (int              fd,
+                             struct sockaddr *addr,
+                             socklen_t       *addrlen,
+                             int              flags)
+{
+#ifdef HAVE_ACCEPT4
+  return accept4 (fd, addr, addrlen, flags);
+#else
+  int res;
+
+  if ((res = accept (fd, addr, addrlen)) < 0)
+    return res;
+
+#ifdef SOCK_CLOEXEC
+  if (flags & SOCK_CLOEXEC)
+    fcntl (res, F_SETFD, FD_CLOEXEC);
+#endif
+
+#ifdef SOCK_NONBLOCK
+  if (flags & SOCK_NONBLOCK)
+    fcntl (res, F_SETFL, fcntl (res, F_GETFL) | O_NONBLOCK);
+#endif
+
+  return res;
+#endif
+}
+
+static gboolean
+dex_posix_aio_future_is_ready (int   fd,
+                               short events)
+{
+  struct pollfd pfd = { .fd = fd, .events = events };
+
+  return poll (&pfd, 1, 0) != 0;
+}
+
+static gboolean
+would_block (void)
+{
+  return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+}
+
+/*
+ * Socket operations are not run on the IO threads as they may block for
+ * an unbounded amount of time. Instead they are attempted without blocking
+ * and, if that fails with EAGAIN, the aio context polls the descriptor from
+ * its GMainContext and calls this again once it is ready.
+ *
+ * Returns %TRUE if the operation completed (successfully or not).
+ */
+gboolean
+dex_posix_aio_future_try_run (DexPosixAioFuture *posix_aio_future)
+{
+  g_return_val_if_fail (DEX_IS_POSIX_AIO_FUTURE (posix_aio_future), TRUE);
+
+  errno = 0;
+
+  switch (posix_aio_future->kind)
+    {
+    case DEX_POSIX_AIO_FUTURE_ACCEPT:
+      /* There is no MSG_DONTWAIT for accept() so check readiness first */
+      if (!dex_posix_aio_future_is_ready (posix_aio_future->accept.fd, POLLIN))
+        return FALSE;
+
+      posix_aio_future->accept.res =
+        dex_posix_aio_future_accept (posix_aio_future->accept.fd,
+                                     posix_aio_future->accept.addr,
+                                     posix_aio_future->accept.addrlen,
+                                     posix_aio_future->accept.flags);
+      if (posix_aio_future->accept.res < 0 && would_block ())
+        return FALSE;
+      break;
+
+    case DEX_POSIX_AIO_FUTURE_CONNECT:
+      if (!posix_aio_future->connect.in_progress)
+        {
+          posix_aio_future->connect.res =
+            connect (posix_aio_future->connect.fd,
+                     posix_aio_future->connect.addr,
+                     posix_aio_future->connect.addrlen);
+
+          /* An interrupted connect() continues asynchronously too */
+          if (posix_aio_future->connect.res < 0 &&
+              (errno == EINPROGRESS || errno == EINTR))
+            {
+              posix_aio_future->connect.in_progress = TRUE;
+              return FALSE;
+            }
+        }
+      else
+        {
+          socklen_t optlen = sizeof (int);
+          int errsv = 0;
+
+          if (!dex_posix_aio_future_is_ready (posix_aio_future->connect.fd, POLLOUT))
+            return FALSE;
+
+          if (getsockopt (posix_aio_future->connect.fd, SOL_SOCKET, SO_ERROR, &errsv, &optlen) < 0)
+            posix_aio_future->connect.res = -1;
+          else if (errsv != 0)
+            {
+              posix_aio_future->connect.res = -1;
+              errno = errsv;
+            }
+          else
+            posix_aio_future->connect.res = 0;
+        }
+      break;
+
+    case DEX_POSIX_AIO_FUTURE_RECV:
+      posix_aio_future->recv.res =
+        recv (posix_aio_future->recv.fd,
+              posix_aio_future->recv.buffer,
+              posix_aio_future->recv.count,
+              posix_aio_future->recv.flags | MSG_DONTWAIT);
+      if (posix_aio_future->recv.res < 0 && would_block ())
+        return FALSE;
+      break;
+
+    case DEX_POSIX_AIO_FUTURE_SEND:
+      posix_aio_future->send.res =
+        send (posix_aio_future->send.fd,
+              posix_aio_future->send.buffer,
+              posix_aio_future->send.count,
+              posix_aio_future->send.flags | MSG_DONTWAIT);
+      if (posix_aio_future->send.res < 0 && would_block ())
+        return FALSE;
+      break;
+
+    case DEX_POSIX_AIO_FUTURE_RECVMSG:
+      posix_aio_future->recvmsg.res =
+        recvmsg (posix_aio_future->recvmsg.fd,
+                 posix_aio_future->recvmsg.msg,
+                 posix_aio_future->recvmsg.flags | MSG_DONTWAIT);
+      if (posix_aio_future->recvmsg.res < 0 && would_block ())
+        return FALSE;
+      break;
+
+    case DEX_POSIX_AIO_FUTURE_SENDMSG:
+      posix_aio_future->sendmsg.res =
+        sendmsg (posix_aio_future->sendmsg.fd,
+                 posix_aio_future->sendmsg.msg,
+                 posix_aio_future->sendmsg.flags | MSG_DONTWAIT);
+      if (posix_aio_future->sendmsg.res < 0 && would_block ())
+        return FALSE;
+      break;
+
+    default:
+      g_assert_not_reached ();
+    }
+
+  posix_aio_future->errsv = errno;
+
+  return TRUE;
+}
+
+int
+dex_posix_aio_future_get_poll_fd (DexPosixAioFuture *posix_aio_future,
+                                  GIOCondition      *condition)
+{
+  g_return_val_if_fail (DEX_IS_POSIX_AIO_FUTURE (posix_aio_future), -1);
+  g_return_val_if_fail (condition != NULL, -1);
+
+  switch (posix_aio_future->kind)
+    {
+    case DEX_POSIX_AIO_FUTURE_ACCEPT:
+      *condition = G_IO_IN;
+      return posix_aio_future->accept.fd;
+
+    case DEX_POSIX_AIO_FUTURE_CONNECT:
+      *condition = G_IO_OUT;
+      return posix_aio_future->connect.fd;
+
+    case DEX_POSIX_AIO_FUTURE_RECV:
+      *condition = G_IO_IN;
+      return posix_aio_future->recv.fd;
+
+    case DEX_POSIX_AIO_FUTURE_SEND:
+      *condition = G_IO_OUT;
+      return posix_aio_future->send.fd;
+
+    case DEX_POSIX_AIO_FUTURE_RECVMSG:
+      *condition = G_IO_IN;
+      return posix_aio_future->recvmsg.fd;
+
+    case DEX_POSIX_AIO_FUTURE_SENDMSG:
+      *condition = G_IO_OUT;
+      return posix_aio_future->sendmsg.fd;
+
+    default:
+      *condition = 0;
+      return -1;
+    }
+}
+#endif
+
+static int
+dex_posix_aio_future_not_supported (void)
+{
+  errno = ENOSYS;
+  return -1;
+}
+
 void
 dex_posix_aio_future_run (DexPosixAioFuture *posix_aio_future)
 {
@@ -263,6 +926,152 @@ dex_posix_aio_future_run (DexPosixAioFuture *posix_aio_future)
       (void)posix_aio_future->write.res;
       break;
 
+    case DEX_POSIX_AIO_FUTURE_FSYNC:
+#ifdef HAVE_FDATASYNC
+      if (posix_aio_future->fsync.datasync)
+        posix_aio_future->fsync.res = fdatasync (posix_aio_future->fsync.fd);
+      else
+#endif
+        posix_aio_future->fsync.res = fsync (posix_aio_future->fsync.fd);
+      break;
+
+    case DEX_POSIX_AIO_FUTURE_STATX:
+#ifdef HAVE_STATX
+      posix_aio_future->statx.res =
+        statx (posix_aio_future->statx.dirfd,
+               posix_aio_future->statx.path,
+               posix_aio_future->statx.flags,
+               posix_aio_future->statx.mask,
+               posix_aio_future->statx.statxbuf);
+#else
+      posix_aio_future->statx.res = dex_posix_aio_future_not_supported ();
+#endif
+      break;
+
+    case DEX_POSIX_AIO_FUTURE_FALLOCATE:
+#ifdef HAVE_FALLOCATE
+      posix_aio_future->fallocate.res =
+        fallocate (posix_aio_future->fallocate.fd,
+                   posix_aio_future->fallocate.mode,
+                   posix_aio_future->fallocate.offset,
+                   posix_aio_future->fallocate.length);
+#elif defined(HAVE_POSIX_FALLOCATE)
+      if (posix_aio_future->fallocate.mode == 0)
+        {
+          /* posix_fallocate() returns the error rather than setting errno */
+          int errsv = posix_fallocate (posix_aio_future->fallocate.fd,
+                                       posix_aio_future->fallocate.offset,
+                                       posix_aio_future->fallocate.length);
+
+          posix_aio_future->fallocate.res = errsv ? -1 : 0;
+          errno = errsv;
+        }
+      else
+        posix_aio_future->fallocate.res = dex_posix_aio_future_not_supported ();
+#else
+      posix_aio_future->fallocate.res = dex_posix_aio_future_not_supported ();
+#endif
+      break;
+
+    case DEX_POSIX_AIO_FUTURE_READV:
+      if (posix_aio_future->readv.offset >= 0)
+#ifdef HAVE_PREADV
+        posix_aio_future->readv.res =
+          preadv (posix_aio_future->readv.fd,
+                  posix_aio_future->readv.iov,
+                  posix_aio_future->readv.n_iov,
+                  posix_aio_future->readv.offset);
+#else
+        posix_aio_future->readv.res = dex_posix_aio_future_not_supported ();
+#endif
+      else
+        posix_aio_future->readv.res =
+          readv (posix_aio_future->readv.fd,
+                 posix_aio_future->readv.iov,
+                 posix_aio_future->readv.n_iov);
+      break;
+
+    case DEX_POSIX_AIO_FUTURE_WRITEV:
+      if (posix_aio_future->writev.offset >= 0)
+#ifdef HAVE_PWRITEV
+        posix_aio_future->writev.res =
+          pwritev (posix_aio_future->writev.fd,
+                   posix_aio_future->writev.iov,
+                   posix_aio_future->writev.n_iov,
+                   posix_aio_future->writev.offset);
+#else
+        posix_aio_future->writev.res = dex_posix_aio_future_not_supported ();
+#endif
+      else
+        posix_aio_future->writev.res =
+          writev (posix_aio_future->writev.fd,
+                  posix_aio_future->writev.iov,
+                  posix_aio_future->writev.n_iov);
+      break;
+
+    case DEX_POSIX_AIO_FUTURE_SPLICE:
+#ifdef HAVE_SPLICE
+      {
+        loff_t offset_in = posix_aio_future->splice.offset_in;
+        loff_t offset_out = posix_aio_future->splice.offset_out;
+
+        posix_aio_future->splice.res =
+          splice (posix_aio_future->splice.fd_in,
+                  offset_in < 0 ? NULL : &offset_in,
+                  posix_aio_future->splice.fd_out,
+                  offset_out < 0 ? NULL : &offset_out,
+                  posix_aio_future->splice.length,
+                  posix_aio_future->splice.flags);
+      }
+#else
+      posix_aio_future->splice.res = dex_posix_aio_future_not_supported ();
+#endif
+      break;
+
+    case DEX_POSIX_AIO_FUTURE_RENAMEAT:
+      if (posix_aio_future->renameat.flags != 0)
+#ifdef HAVE_RENAMEAT2
+        posix_aio_future->renameat.res =
+          renameat2 (posix_aio_future->renameat.old_dirfd,
+                     posix_aio_future->renameat.old_path,
+                     posix_aio_future->renameat.new_dirfd,
+                     posix_aio_future->renameat.new_path,
+                     posix_aio_future->renameat.flags);
+#else
+        posix_aio_future->renameat.res = dex_posix_aio_future_not_supported ();
+#endif
+      else
+        posix_aio_future->renameat.res =
+          renameat (posix_aio_future->renameat.old_dirfd,
+                    posix_aio_future->renameat.old_path,
+                    posix_aio_future->renameat.new_dirfd,
+                    posix_aio_future->renameat.new_path);
+      break;
+
+    case DEX_POSIX_AIO_FUTURE_UNLINKAT:
+      posix_aio_future->unlinkat.res =
+        unlinkat (posix_aio_future->unlinkat.dirfd,
+                  posix_aio_future->unlinkat.path,
+                  posix_aio_future->unlinkat.flags);
+      break;
+
+    case DEX_POSIX_AIO_FUTURE_MKDIRAT:
+      posix_aio_future->mkdirat.res =
+        mkdirat (posix_aio_future->mkdirat.dirfd,
+                 posix_aio_future->mkdirat.path,
+                 posix_aio_future->mkdirat.mode);
+      break;
+
+#ifdef G_OS_UNIX
+    case DEX_POSIX_AIO_FUTURE_CONNECT:
+      /* Only used for blocking sockets, see dex_posix_aio_backend_connect() */
+      posix_aio_future->connect.res =
+        connect (posix_aio_future->connect.fd,
+                 posix_aio_future->connect.addr,
+                 posix_aio_future->connect.addrlen);
+      break;
+#endif
+
     default:
       g_assert_not_reached ();
     }
@@ -352,6 +1161,68 @@ dex_posix_aio_future_complete (DexPosixAioFuture *posix_aio_future)
       dex_posix_aio_future_complete_int64 (posix_aio_future, posix_aio_future->write.res);
       break;
 
+    case DEX_POSIX_AIO_FUTURE_FSYNC:
+      dex_posix_aio_future_complete_boolean (posix_aio_future, posix_aio_future->fsync.res);
+      break;
+
+    case DEX_POSIX_AIO_FUTURE_STATX:
+      dex_posix_aio_future_complete_boolean (posix_aio_future, posix_aio_future->statx.res);
+      break;
+
+    case DEX_POSIX_AIO_FUTURE_FALLOCATE:
+      dex_posix_aio_future_complete_boolean (posix_aio_future, posix_aio_future->fallocate.res);
+      break;
+
+    case DEX_POSIX_AIO_FUTURE_READV:
+      dex_posix_aio_future_complete_int64 (posix_aio_future, posix_aio_future->readv.res);
+      break;
+
+    case DEX_POSIX_AIO_FUTURE_WRITEV:
+      dex_posix_aio_future_complete_int64 (posix_aio_future, posix_aio_future->writev.res);
+      break;
+
+    case DEX_POSIX_AIO_FUTURE_SPLICE:
+      dex_posix_aio_future_complete_int64 (posix_aio_future, posix_aio_future->splice.res);
+      break;
+
+    case DEX_POSIX_AIO_FUTURE_RENAMEAT:
+      dex_posix_aio_future_complete_boolean (posix_aio_future, posix_aio_future->renameat.res);
+      break;
+
+    case DEX_POSIX_AIO_FUTURE_UNLINKAT:
+      dex_posix_aio_future_complete_boolean (posix_aio_future, posix_aio_future->unlinkat.res);
+      break;
+
+    case DEX_POSIX_AIO_FUTURE_MKDIRAT:
+      dex_posix_aio_future_complete_boolean (posix_aio_future, posix_aio_future->mkdirat.res);
+      break;
+
+#ifdef G_OS_UNIX
+    case DEX_POSIX_AIO_FUTURE_ACCEPT:
+      dex_posix_aio_future_complete_fd (posix_aio_future, posix_aio_future->accept.res);
+      break;
+
+    case DEX_POSIX_AIO_FUTURE_CONNECT:
+      dex_posix_aio_future_complete_boolean (posix_aio_future, posix_aio_future->connect.res);
+      break;
+
+    case DEX_POSIX_AIO_FUTURE_RECV:
+      dex_posix_aio_future_complete_int64 (posix_aio_future, posix_aio_future->recv.res);
+      break;
+
+    case DEX_POSIX_AIO_FUTURE_SEND:
+      dex_posix_aio_future_complete_int64 (posix_aio_future, posix_aio_future->send.res);
+      break;
+
+    case DEX_POSIX_AIO_FUTURE_RECVMSG:
+      dex_posix_aio_future_complete_int64 (posix_aio_future, posix_aio_future->recvmsg.res);
+      break;
+
+    case DEX_POSIX_AIO_FUTURE_SENDMSG:
+      dex_posix_aio_future_complete_int64 (posix_aio_future, posix_aio_future->sendmsg.res);
+      break;
+#endif
+
     default:
       g_assert_not_reached ();
     }
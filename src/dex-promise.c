@@ -25,9 +25,10 @@
 #include <unistd.h>
 #endif
 
+#include "dex-cancellable-private.h"
 #include "dex-fd-private.h"
 #include "dex-future-private.h"
-#include "dex-promise.h"
+#include "dex-promise-private.h"
 
 /**
  * DexPromise:
@@ -43,6 +44,11 @@ typedef struct _DexPromise
 {
   DexFuture parent_instance;
   GCancellable *cancellable;
+
+  /* Set once @cancellable was handed out by dex_promise_get_cancellable()
+   * after which it is never recycled.
+   */
+  gboolean cancellable_exposed;
 } DexPromise;
 
 typedef struct _DexPromiseClass
@@ -68,7 +74,10 @@ dex_promise_finalize (DexObject *object)
 {
   DexPromise *self = (DexPromise *)object;
 
-  g_clear_object (&self->cancellable);
+  if (g_atomic_int_get (&self->cancellable_exposed))
+    g_clear_object (&self->cancellable);
+  else
+    g_clear_pointer (&self->cancellable, dex_cancellable_pool_release);
 
   DEX_OBJECT_CLASS (dex_promise_parent_class)->finalize (object);
 }
@@ -80,6 +89,7 @@ dex_promise_class_init (DexPromiseClass *promise_class)
   DexFutureClass *future_class = DEX_FUTURE_CLASS (promise_class);
 
   object_class->finalize = dex_promise_finalize;
+  dex_object_class_enable_slab (object_class);
 
   future_class->discard = dex_promise_discard;
 }
@@ -119,7 +129,7 @@ DexPromise *
 {
   DexPromise *self = (DexPromise *)dex_object_create_instance (dex_promise_type);
 
-  self->cancellable = g_cancellable_new ();
+  self->cancellable = dex_cancellable_pool_acquire ();
 
   return self;
 }
@@ -143,6 +153,23 @@ dex_promise_get_cancellable (DexPromise *promise)
 {
   g_return_val_if_fail (DEX_IS_PROMISE (promise), NULL);
 
+  /* The caller may attach data or weak references which must not leak
+   * into an unrelated operation, so this one can't be recycled.
+   */
+  g_atomic_int_set (&promise->cancellable_exposed, TRUE);
+
+  return promise->cancellable;
+}
+
+/* Same as dex_promise_get_cancellable() but for use within libdex where
+ * the cancellable is only ever passed along to GIO, so it may still be
+ * recycled once the promise is finalized.
+ */
+GCancellable *
+dex_promise_peek_cancellable (DexPromise *promise)
+{
+  g_return_val_if_fail (DEX_IS_PROMISE (promise), NULL);
+
   return promise->cancellable;
 }
 
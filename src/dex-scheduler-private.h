@@ -26,6 +26,7 @@
 #include "dex-fiber.h"
 #include "dex-object-private.h"
 #include "dex-scheduler.h"
+#include "dex-timer-queue-private.h"
 
 G_BEGIN_DECLS
 
@@ -55,11 +56,13 @@ typedef struct _DexSchedulerClass
                                       DexCoroutine *coroutine);
   GMainContext  *(*get_main_context) (DexScheduler *scheduler);
   DexAioContext *(*get_aio_context)  (DexScheduler *scheduler);
+  DexTimerQueue *(*get_timer_queue)  (DexScheduler *scheduler);
 } DexSchedulerClass;
 
 void           dex_scheduler_set_thread_default (DexScheduler *scheduler);
 void           dex_scheduler_set_default        (DexScheduler *scheduler);
 DexAioContext *dex_scheduler_get_aio_context    (DexScheduler *scheduler);
+DexTimerQueue *dex_scheduler_get_timer_queue    (DexScheduler *scheduler);
 
 static inline void
 dex_work_item_invoke (const DexWorkItem *work_item)
@@ -186,6 +186,23 @@ dex_scheduler_get_aio_context (DexScheduler *scheduler)
   return DEX_SCHEDULER_GET_CLASS (scheduler)->get_aio_context (scheduler);
 }
 
+/**
+ * dex_scheduler_get_timer_queue: (skip)
+ * @scheduler: a [class@Dex.Scheduler]
+ *
+ * Gets the `DexTimerQueue` for the scheduler.
+ *
+ * All timeouts armed on the scheduler share this queue and therefore a
+ * single [struct@GLib.Source] on the scheduler's main context.
+ *
+ * Stability: Private
+ */
+DexTimerQueue *
+dex_scheduler_get_timer_queue (DexScheduler *scheduler)
+{
+  return DEX_SCHEDULER_GET_CLASS (scheduler)->get_timer_queue (scheduler);
+}
+
 /**
  * dex_scheduler_spawn:
  * @scheduler: (nullable): a [class@Dex.Scheduler]
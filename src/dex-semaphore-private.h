@@ -22,6 +22,7 @@
 #pragma once
 
 #include "dex-future.h"
+#include "dex-scheduler.h"
 
 G_BEGIN_DECLS
 
@@ -31,12 +32,18 @@ G_BEGIN_DECLS
 
 typedef struct _DexSemaphore DexSemaphore;
 
-GType         dex_semaphore_get_type  (void);
-DexSemaphore *dex_semaphore_new       (void);
-void          dex_semaphore_post      (DexSemaphore *semaphore);
-void          dex_semaphore_post_many (DexSemaphore *semaphore,
-                                       guint         count);
-DexFuture    *dex_semaphore_wait      (DexSemaphore *semaphore);
-void          dex_semaphore_close     (DexSemaphore *semaphore);
+GType         dex_semaphore_get_type      (void);
+DexSemaphore *dex_semaphore_new           (void);
+void          dex_semaphore_post          (DexSemaphore *semaphore);
+void          dex_semaphore_post_many     (DexSemaphore *semaphore,
+                                           guint         count);
+DexFuture    *dex_semaphore_wait          (DexSemaphore *semaphore);
+DexFuture    *dex_semaphore_wait_many     (DexSemaphore *semaphore,
+                                           guint         max_count);
+guint         dex_semaphore_try_wait_many (DexSemaphore *semaphore,
+                                           guint         max_count);
+void          dex_semaphore_close         (DexSemaphore *semaphore);
+void          dex_semaphore_withdraw      (DexSemaphore *semaphore,
+                                           DexScheduler *scheduler);
 
 G_END_DECLS
@@ -38,7 +38,13 @@
  * we complete waiting futures directly when possible. If a waiter has not yet
  * been registered we queue it and complete it on the next post.
  *
- * We use a DexFuture waiter that is completed when an item is posted.
+ * We use a DexFuture waiter that is completed when an item is posted. No
+ * waiter is created when a token is available up front.
+ *
+ * Waiters from dex_semaphore_wait_many() may take more than one token at
+ * a time. When posting, tokens are spread across the waiters in order
+ * rather than handing them all to the first one, so that a batch of
+ * posts wakes as many waiters as it can keep busy.
  *
  * In the past, we used io_uring/eventfd on Linux but this turns out to be
  * faster simply because we do not enter the kernel. In synthetic benchmarks
@@ -52,6 +58,20 @@ typedef struct _DexSemaphoreWaiter
 {
   DexFuture parent_instance;
   GList link;
+
+  /* The most tokens this waiter may take and how many it was given,
+   * both protected by the semaphore lock.
+   */
+  guint max_count;
+  guint count;
+
+  /* The scheduler the waiter was created on, only used to find the
+   * waiters to withdraw with dex_semaphore_withdraw().
+   */
+  DexScheduler *scheduler;
+
+  /* Resolve to @count rather than %TRUE */
+  guint many : 1;
 } DexSemaphoreWaiter;
 
 typedef struct _DexSemaphoreWaiterClass
@@ -69,6 +89,8 @@ static GValue semaphore_waiter_value;
 static void
 dex_semaphore_waiter_class_init (DexSemaphoreWaiterClass *semaphore_waiter_class)
 {
+  dex_object_class_enable_slab (DEX_OBJECT_CLASS (semaphore_waiter_class));
+
   g_value_init (&semaphore_waiter_value, G_TYPE_BOOLEAN);
   g_value_set_boolean (&semaphore_waiter_value, TRUE);
   semaphore_closed_error = (GError) {
@@ -84,6 +106,23 @@ dex_semaphore_waiter_init (DexSemaphoreWaiter *semaphore_waiter)
   semaphore_waiter->link.data = semaphore_waiter;
 }
 
+static void
+dex_semaphore_waiter_complete (DexSemaphoreWaiter *waiter)
+{
+  if (waiter->many)
+    {
+      GValue value = G_VALUE_INIT;
+
+      g_value_init (&value, G_TYPE_UINT);
+      g_value_set_uint (&value, waiter->count);
+      dex_future_complete (DEX_FUTURE (waiter), &value, NULL);
+    }
+  else
+    {
+      dex_future_complete (DEX_FUTURE (waiter), &semaphore_waiter_value, NULL);
+    }
+}
+
 struct _DexSemaphore
 {
   DexObject parent_instance;
@@ -165,8 +204,13 @@ dex_semaphore_post_many (DexSemaphore *semaphore,
   semaphore->counter += count;
   while (semaphore->counter > 0 && semaphore->waiters.length > 0)
     {
+      DexSemaphoreWaiter *waiter = g_queue_peek_head (&semaphore->waiters);
+      gint64 share = MAX (1, semaphore->counter / semaphore->waiters.length);
+
+      waiter->count = MIN (share, waiter->max_count);
+      semaphore->counter -= waiter->count;
+
       g_queue_push_tail_link (&queue, g_queue_pop_head_link (&semaphore->waiters));
-      semaphore->counter--;
     }
   dex_object_unlock (semaphore);
 
@@ -174,11 +218,33 @@ dex_semaphore_post_many (DexSemaphore *semaphore,
   while (queue.length > 0)
     {
       DexSemaphoreWaiter *waiter = g_queue_pop_head_link (&queue)->data;
-      dex_future_complete (DEX_FUTURE (waiter), &semaphore_waiter_value, NULL);
+      dex_semaphore_waiter_complete (waiter);
       dex_unref (waiter);
     }
 }
 
+/* Takes up to @max_count tokens without waiting, returning how many
+ * were taken which may be zero.
+ */
+guint
+dex_semaphore_try_wait_many (DexSemaphore *semaphore,
+                             guint         max_count)
+{
+  guint count = 0;
+
+  g_return_val_if_fail (DEX_IS_SEMAPHORE (semaphore), 0);
+
+  dex_object_lock (semaphore);
+  if (semaphore->counter > 0)
+    {
+      count = MIN (semaphore->counter, max_count);
+      semaphore->counter -= count;
+    }
+  dex_object_unlock (semaphore);
+
+  return count;
+}
+
 static DexFuture *
 dex_semaphore_wait_on_scheduler (DexFuture *future,
                                  gpointer   user_data)
@@ -186,24 +252,35 @@ dex_semaphore_wait_on_scheduler (DexFuture *future,
   return dex_ref (future);
 }
 
-DexFuture *
-dex_semaphore_wait (DexSemaphore *semaphore)
+static DexFuture *
+dex_semaphore_wait_internal (DexSemaphore *semaphore,
+                             guint         max_count,
+                             gboolean      many)
 {
   DexFuture *ret = NULL;
   DexSemaphoreWaiter *waiter;
   DexScheduler *scheduler;
   DexFuture *block;
+  guint count;
 
-  g_return_val_if_fail (DEX_IS_SEMAPHORE (semaphore), NULL);
+  g_assert (DEX_IS_SEMAPHORE (semaphore));
+  g_assert (max_count > 0);
+
+  /* Only create a waiter if we might actually have to wait */
+  if ((count = dex_semaphore_try_wait_many (semaphore, max_count)))
+    return many ? dex_future_new_for_uint (count) : dex_future_new_true ();
 
   waiter = (DexSemaphoreWaiter *)
     dex_object_create_instance (DEX_TYPE_SEMAPHORE_WAITER);
+  waiter->max_count = max_count;
+  waiter->many = !!many;
 
   dex_object_lock (semaphore);
   if (semaphore->counter > 0)
     {
-      semaphore->counter--;
-      dex_future_complete (DEX_FUTURE (waiter), &semaphore_waiter_value, NULL);
+      waiter->count = MIN (semaphore->counter, max_count);
+      semaphore->counter -= waiter->count;
+      dex_semaphore_waiter_complete (waiter);
       ret = DEX_FUTURE (g_steal_pointer (&waiter));
     }
   else
@@ -213,6 +290,7 @@ dex_semaphore_wait (DexSemaphore *semaphore)
       g_assert (scheduler != NULL);
       g_assert (DEX_IS_SCHEDULER (scheduler));
 
+      waiter->scheduler = scheduler;
       block = dex_block_new (dex_ref (waiter),
                              scheduler,
                              DEX_BLOCK_KIND_FINALLY,
@@ -230,6 +308,27 @@ dex_semaphore_wait (DexSemaphore *semaphore)
   return ret;
 }
 
+DexFuture *
+dex_semaphore_wait (DexSemaphore *semaphore)
+{
+  g_return_val_if_fail (DEX_IS_SEMAPHORE (semaphore), NULL);
+
+  return dex_semaphore_wait_internal (semaphore, 1, FALSE);
+}
+
+/* Waits for at least one token and takes up to @max_count of them. The
+ * future resolves to the number of tokens taken as a guint.
+ */
+DexFuture *
+dex_semaphore_wait_many (DexSemaphore *semaphore,
+                         guint         max_count)
+{
+  g_return_val_if_fail (DEX_IS_SEMAPHORE (semaphore), NULL);
+  g_return_val_if_fail (max_count > 0, NULL);
+
+  return dex_semaphore_wait_internal (semaphore, max_count, TRUE);
+}
+
 void
 dex_semaphore_close (DexSemaphore *semaphore)
 {
@@ -254,3 +353,52 @@ dex_semaphore_close (DexSemaphore *semaphore)
 
   dex_object_unlock (semaphore);
 }
+
+/* Removes the waiters which were created on @scheduler so that they no
+ * longer take tokens meant for somebody else. Waiters from
+ * dex_semaphore_wait_many() resolve to zero, others are rejected as if
+ * the semaphore had been closed.
+ */
+void
+dex_semaphore_withdraw (DexSemaphore *semaphore,
+                        DexScheduler *scheduler)
+{
+  GQueue queue = G_QUEUE_INIT;
+
+  g_return_if_fail (DEX_IS_SEMAPHORE (semaphore));
+  g_return_if_fail (DEX_IS_SCHEDULER (scheduler));
+
+  dex_object_lock (semaphore);
+  for (GList *iter = semaphore->waiters.head; iter; )
+    {
+      DexSemaphoreWaiter *waiter = iter->data;
+
+      iter = iter->next;
+
+      if (waiter->scheduler == scheduler)
+        {
+          g_queue_unlink (&semaphore->waiters, &waiter->link);
+          g_queue_push_tail_link (&queue, &waiter->link);
+        }
+    }
+  dex_object_unlock (semaphore);
+
+  while (queue.length > 0)
+    {
+      DexSemaphoreWaiter *waiter = g_queue_pop_head_link (&queue)->data;
+
+      if (waiter->many)
+        {
+          waiter->count = 0;
+          dex_semaphore_waiter_complete (waiter);
+        }
+      else
+        {
+          dex_future_complete (DEX_FUTURE (waiter),
+                               NULL,
+                               g_error_copy (&semaphore_closed_error));
+        }
+
+      dex_unref (waiter);
+    }
+}
@@ -38,44 +38,53 @@ struct _DexStack
 #endif
 };
 
+/* A DexStackPool is owned by a single thread (the thread of the
+ * DexFiberScheduler it belongs to) and therefore needs no locking.
+ *
+ * Stacks are kept in most-recently-used order and the first @n_resident
+ * of them still have their pages resident. Once more than @watermark
+ * stacks are resident, the coldest of them are lazily released to the
+ * kernel so the stacks about to be reused never pay for page faults.
+ *
+ * When the pool is empty, or has more than @max_pool_size stacks, it
+ * falls back to a process-wide overflow pool shared by all threads.
+ */
 struct _DexStackPool
 {
-  GMutex mutex;
   GQueue stacks;
   gsize  stack_size;
   guint  min_pool_size;
   guint  max_pool_size;
-  guint  mark_unused : 1;
+  guint  watermark;
+  guint  n_resident;
+  guint  use_global : 1;
 };
 
-DexStackPool *dex_stack_pool_new    (gsize         stack_size,
-                                     int           min_pool_size,
-                                     int           max_pool_size);
-void          dex_stack_pool_free   (DexStackPool *stack_pool);
-DexStack     *dex_stack_new         (gsize         size);
-void          dex_stack_free        (DexStack     *stack);
-void          dex_stack_mark_unused (DexStack     *stack);
+DexStackPool *dex_stack_pool_new          (gsize         stack_size,
+                                           int           min_pool_size,
+                                           int           max_pool_size);
+void          dex_stack_pool_free         (DexStackPool *stack_pool);
+DexStack     *dex_stack_pool_acquire_slow (DexStackPool *stack_pool);
+void          dex_stack_pool_release_slow (DexStackPool *stack_pool,
+                                           DexStack     *stack);
+void          dex_stack_pool_trim         (DexStackPool *stack_pool);
+DexStack     *dex_stack_new               (gsize         size);
+void          dex_stack_free              (DexStack     *stack);
+void          dex_stack_mark_unused       (DexStack     *stack);
 
 static inline DexStack *
 dex_stack_pool_acquire (DexStackPool *stack_pool)
 {
-  DexStack *ret;
-
   g_assert (stack_pool != NULL);
 
-  g_mutex_lock (&stack_pool->mutex);
-  if (stack_pool->stacks.length > 0)
-    {
-      ret = g_queue_pop_head_link (&stack_pool->stacks)->data;
-      g_mutex_unlock (&stack_pool->mutex);
-    }
-  else
+  if G_LIKELY (stack_pool->stacks.length > 0)
     {
-      g_mutex_unlock (&stack_pool->mutex);
-      ret = dex_stack_new (stack_pool->stack_size);
+      if (stack_pool->n_resident > 0)
+        stack_pool->n_resident--;
+      return g_queue_pop_head_link (&stack_pool->stacks)->data;
     }
 
-  return ret;
+  return dex_stack_pool_acquire_slow (stack_pool);
 }
 
 static inline void
@@ -87,19 +96,19 @@ dex_stack_pool_release (DexStackPool *stack_pool,
   g_assert (stack->link.prev == NULL);
   g_assert (stack->link.next == NULL);
 
-  g_mutex_lock (&stack_pool->mutex);
-  if (stack_pool->stacks.length > stack_pool->max_pool_size)
-    {
-      g_mutex_unlock (&stack_pool->mutex);
-      dex_stack_free (stack);
-    }
-  else
+  if G_UNLIKELY (stack_pool->max_pool_size == 0)
     {
-      if (stack_pool->mark_unused)
-        dex_stack_mark_unused (stack);
-      g_queue_push_head_link (&stack_pool->stacks, &stack->link);
-      g_mutex_unlock (&stack_pool->mutex);
+      dex_stack_pool_release_slow (stack_pool, stack);
+      return;
     }
+
+  /* The stack was just running so its pages are resident */
+  g_queue_push_head_link (&stack_pool->stacks, &stack->link);
+  stack_pool->n_resident++;
+
+  if G_UNLIKELY (stack_pool->n_resident > stack_pool->watermark ||
+                 stack_pool->stacks.length > stack_pool->max_pool_size)
+    dex_stack_pool_trim (stack_pool);
 }
 
 G_END_DECLS
@@ -33,34 +33,116 @@
 #define DEFAULT_STACK_SIZE (MAX (4096*32, dex_get_min_stack_size()))
 #define DEFAULT_MIN_POOL_SIZE 4
 #define DEFAULT_MAX_POOL_SIZE 16
+#define DEFAULT_GLOBAL_POOL_SIZE 64
+#define DEFAULT_WATERMARK 4
+
+typedef enum _DexStackFlags
+{
+  DEX_STACK_FLAGS_PREFAULT = 1 << 0,
+  DEX_STACK_FLAGS_HUGEPAGE = 1 << 1,
+} DexStackFlags;
+
+typedef struct _DexStackConfig
+{
+  guint max_pool_size;
+  guint global_pool_size;
+  guint watermark;
+  guint flags;
+} DexStackConfig;
+
+static const GDebugKey stack_flag_keys[] = {
+  { "prefault", DEX_STACK_FLAGS_PREFAULT },
+  { "hugepage", DEX_STACK_FLAGS_HUGEPAGE },
+};
+
+static DexStackConfig stack_config;
+static GMutex global_pool_mutex;
+static GQueue global_pool;
+
+static DexStack *dex_stack_new_full (gsize    size,
+                                     gboolean prefault);
+
+static guint
+dex_stack_getenv_uint (const char *name,
+                       guint       default_value)
+{
+  const char *str = g_getenv (name);
+  guint64 value;
+
+  if (str == NULL ||
+      !g_ascii_string_to_unsigned (str, 10, 0, G_MAXUINT, &value, NULL))
+    return default_value;
+
+  return value;
+}
+
+/* The process-wide stack configuration may be tuned from the environment
+ * so that applications with many concurrent fibers can cache more stacks
+ * without needing new API.
+ *
+ *   DEX_STACK_POOL_SIZE         stacks cached per thread
+ *   DEX_STACK_GLOBAL_POOL_SIZE  stacks cached in the shared overflow pool
+ *   DEX_STACK_POOL_WATERMARK    cached stacks per thread kept resident
+ *   DEX_STACK_FLAGS             "prefault" and/or "hugepage"
+ */
+static const DexStackConfig *
+dex_stack_get_config (void)
+{
+  static gsize initialized;
+
+  if (g_once_init_enter (&initialized))
+    {
+      stack_config.max_pool_size = dex_stack_getenv_uint ("DEX_STACK_POOL_SIZE", DEFAULT_MAX_POOL_SIZE);
+      stack_config.global_pool_size = dex_stack_getenv_uint ("DEX_STACK_GLOBAL_POOL_SIZE", DEFAULT_GLOBAL_POOL_SIZE);
+      stack_config.watermark = dex_stack_getenv_uint ("DEX_STACK_POOL_WATERMARK", DEFAULT_WATERMARK);
+      stack_config.flags = g_parse_debug_string (g_getenv ("DEX_STACK_FLAGS"),
+                                                 stack_flag_keys,
+                                                 G_N_ELEMENTS (stack_flag_keys));
+      g_once_init_leave (&initialized, TRUE);
+    }
+
+  return &stack_config;
+}
 
 DexStackPool *
 dex_stack_pool_new (gsize stack_size,
                     int   min_pool_size,
                     int   max_pool_size)
 {
+  const DexStackConfig *config = dex_stack_get_config ();
   DexStackPool *stack_pool;
 
   if (stack_size == 0)
     stack_size = DEFAULT_STACK_SIZE;
 
-  if (min_pool_size < 0)
-    min_pool_size = DEFAULT_MIN_POOL_SIZE;
-
   if (max_pool_size < 0)
-    max_pool_size = DEFAULT_MAX_POOL_SIZE;
+    max_pool_size = config->max_pool_size;
+
+  if (min_pool_size < 0)
+    min_pool_size = MIN (DEFAULT_MIN_POOL_SIZE, max_pool_size);
 
   g_return_val_if_fail (min_pool_size <= max_pool_size, NULL);
 
   stack_pool = g_new0 (DexStackPool, 1);
   stack_pool->min_pool_size = min_pool_size;
   stack_pool->max_pool_size = max_pool_size;
+  stack_pool->watermark = MIN (config->watermark, (guint)max_pool_size);
   stack_pool->stack_size = stack_size;
-  g_mutex_init (&stack_pool->mutex);
+
+  /* Only stacks of the default size are shared between threads */
+  stack_pool->use_global = stack_size == DEFAULT_STACK_SIZE;
+
+  /* Only prefault the stacks that may stay resident. They are created
+   * last so that they end up at the head of the queue.
+   */
+  if ((config->flags & DEX_STACK_FLAGS_PREFAULT) != 0)
+    stack_pool->n_resident = MIN (stack_pool->min_pool_size, stack_pool->watermark);
 
   for (guint i = 0; i < stack_pool->min_pool_size; i++)
     {
-      DexStack *stack = dex_stack_new (stack_size);
+      gboolean prefault = i >= stack_pool->min_pool_size - stack_pool->n_resident;
+      DexStack *stack = dex_stack_new_full (stack_size, prefault);
+
       g_queue_push_head_link (&stack_pool->stacks, &stack->link);
     }
 
@@ -72,22 +154,130 @@ dex_stack_pool_free (DexStackPool *stack_pool)
 {
   g_return_if_fail (stack_pool != NULL);
 
+  /* Give cached stacks to other threads rather than unmapping them */
   while (stack_pool->stacks.length > 0)
     {
       DexStack *stack = g_queue_pop_head_link (&stack_pool->stacks)->data;
-      dex_stack_free (stack);
+      dex_stack_pool_release_slow (stack_pool, stack);
     }
 
-  g_mutex_clear (&stack_pool->mutex);
+  stack_pool->n_resident = 0;
+
   g_free (stack_pool);
 }
 
 DexStack *
-dex_stack_new (gsize size)
+dex_stack_pool_acquire_slow (DexStackPool *stack_pool)
+{
+  DexStack *stack = NULL;
+
+  g_assert (stack_pool != NULL);
+  g_assert (stack_pool->stacks.length == 0);
+
+  if (stack_pool->use_global)
+    {
+      g_mutex_lock (&global_pool_mutex);
+      if (global_pool.length > 0)
+        stack = g_queue_pop_head_link (&global_pool)->data;
+      g_mutex_unlock (&global_pool_mutex);
+    }
+
+  if (stack == NULL)
+    stack = dex_stack_new (stack_pool->stack_size);
+
+  return stack;
+}
+
+void
+dex_stack_pool_release_slow (DexStackPool *stack_pool,
+                             DexStack     *stack)
+{
+  const DexStackConfig *config = dex_stack_get_config ();
+
+  g_assert (stack_pool != NULL);
+  g_assert (stack != NULL);
+  g_assert (stack->link.data == stack);
+
+  if (stack_pool->use_global)
+    {
+      gboolean cached = FALSE;
+
+      /* Pages are released lazily before taking the lock so the
+       * madvise() is not done while other threads wait on us.
+       */
+      dex_stack_mark_unused (stack);
+
+      g_mutex_lock (&global_pool_mutex);
+      if (global_pool.length < config->global_pool_size)
+        {
+          g_queue_push_head_link (&global_pool, &stack->link);
+          cached = TRUE;
+        }
+      g_mutex_unlock (&global_pool_mutex);
+
+      if (cached)
+        return;
+    }
+
+  dex_stack_free (stack);
+}
+
+void
+dex_stack_pool_trim (DexStackPool *stack_pool)
+{
+  g_assert (stack_pool != NULL);
+  g_assert (stack_pool->n_resident <= stack_pool->stacks.length);
+
+  /* Overflow from the cold end so the hot stacks stay with this thread */
+  while (stack_pool->stacks.length > stack_pool->max_pool_size)
+    {
+      DexStack *stack = g_queue_pop_tail_link (&stack_pool->stacks)->data;
+
+      if (stack_pool->n_resident > stack_pool->stacks.length)
+        stack_pool->n_resident = stack_pool->stacks.length;
+
+      dex_stack_pool_release_slow (stack_pool, stack);
+    }
+
+  /* Resident stacks form the head of the queue, so the coldest of them
+   * is always the last one. Release those beyond the watermark, oldest
+   * first, leaving them in place behind the stacks that are still hot.
+   */
+  while (stack_pool->n_resident > stack_pool->watermark)
+    {
+      GList *link = g_queue_peek_nth_link (&stack_pool->stacks,
+                                           stack_pool->n_resident - 1);
+
+      dex_stack_mark_unused (link->data);
+      stack_pool->n_resident--;
+    }
+}
+
+#ifdef G_OS_UNIX
+static void
+dex_stack_prefault (gpointer ptr,
+                    gsize    size)
+{
+  gsize page_size = dex_get_page_size ();
+
+#if defined(HAVE_MADVISE) && defined(MADV_POPULATE_WRITE)
+  if (madvise (ptr, size, MADV_POPULATE_WRITE) == 0)
+    return;
+#endif
+
+  for (gsize offset = 0; offset < size; offset += page_size)
+    ((volatile char *)ptr)[offset] = 0;
+}
+#endif
+
+static DexStack *
+dex_stack_new_full (gsize    size,
+                    gboolean prefault)
 {
   gsize page_size = dex_get_page_size ();
   DexStack *stack;
 #ifdef G_OS_UNIX
+  const DexStackConfig *config = dex_stack_get_config ();
   gpointer map;
   gpointer guard;
   int flags = 0;
@@ -109,6 +299,14 @@ dex_stack_new (gsize size)
 #if defined(__OpenBSD__)
   flags |= MAP_STACK;
 #endif
+#if defined(MAP_POPULATE)
+  /* Huge pages must be requested before the stack is faulted in */
+  if (prefault && (config->flags & DEX_STACK_FLAGS_HUGEPAGE) == 0)
+    {
+      flags |= MAP_POPULATE;
+      prefault = FALSE;
+    }
+#endif
 
   /* mmap() the stack with an extra page for our guard page */
   map = mmap (NULL, size + page_size, PROT_READ|PROT_WRITE, flags, -1, 0);
@@ -119,6 +317,11 @@ dex_stack_new (gsize size)
       g_error ("Failed to allocate stack: %s", g_strerror (errsv));
     }
 
+#if defined(HAVE_MADVISE) && defined(MADV_HUGEPAGE)
+  if ((config->flags & DEX_STACK_FLAGS_HUGEPAGE) != 0)
+    madvise (map, size + page_size, MADV_HUGEPAGE);
+#endif
+
 #ifdef __IA64__
   /* Itanium has a "register stack", see
    * itanium-software-runtime-architecture-guide.pdf for details.
@@ -153,11 +356,25 @@ dex_stack_new (gsize size)
     stack->ptr = (gpointer)((gintptr)map + page_size);
   else
     stack->ptr = map;
+
+  /* Pages are faulted in by the thread creating the stack, which is the
+   * thread that will use it, so first-touch places them on its NUMA node.
+   */
+  if (prefault)
+    dex_stack_prefault (stack->ptr, size);
 #endif
 
   return stack;
 }
 
+DexStack *
+dex_stack_new (gsize size)
+{
+  const DexStackConfig *config = dex_stack_get_config ();
+
+  return dex_stack_new_full (size, (config->flags & DEX_STACK_FLAGS_PREFAULT) != 0);
+}
+
 void
 dex_stack_free (DexStack *stack)
 {
@@ -186,7 +403,14 @@ dex_stack_mark_unused (DexStack *stack)
   g_assert (stack != NULL);
   g_assert (stack->link.data == stack);
 
+  /* Prefer MADV_FREE so the kernel only reclaims the pages under memory
+   * pressure and reusing the stack does not fault when it has not.
+   */
 #ifdef HAVE_MADVISE
+# ifdef MADV_FREE
+  if (madvise (stack->ptr, stack->size, MADV_FREE) == 0)
+    return;
+# endif
   madvise (stack->ptr, stack->size, MADV_DONTNEED);
 #endif
 }
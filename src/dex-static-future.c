@@ -54,6 +54,7 @@ DEX_DEFINE_FINAL_TYPE (DexStaticFuture, dex_static_future, DEX_TYPE_FUTURE)
 static void
 dex_static_future_class_init (DexStaticFutureClass *static_future_class)
 {
+  dex_object_class_enable_slab (DEX_OBJECT_CLASS (static_future_class));
 }
 
 static void
@@ -83,8 +84,7 @@ dex_static_future_new_resolved (const GValue *value)
   g_return_val_if_fail (G_IS_VALUE (value), NULL);
 
   ret = (DexFuture *)dex_object_create_instance (DEX_TYPE_STATIC_FUTURE);
-  g_value_init (&ret->resolved, G_VALUE_TYPE (value));
-  g_value_copy (value, &ret->resolved);
+  dex_value_init_copy (&ret->resolved, value);
   ret->status = DEX_FUTURE_STATUS_RESOLVED;
 
   return DEX_FUTURE (ret);
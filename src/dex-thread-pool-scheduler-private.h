@@ -0,0 +1,31 @@
+/*
+ * dex-thread-pool-scheduler-private.h
+ *
+ * Copyright 2026 Christian Hergert
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#pragma once
+
+#include "dex-thread-pool-scheduler.h"
+
+G_BEGIN_DECLS
+
+guint dex_thread_pool_scheduler_get_n_idle   (DexThreadPoolScheduler *thread_pool_scheduler);
+guint dex_thread_pool_scheduler_get_n_parked (DexThreadPoolScheduler *thread_pool_scheduler);
+
+G_END_DECLS
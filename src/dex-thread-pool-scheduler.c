@@ -24,12 +24,22 @@
 #include <stdatomic.h>
 
 #include "dex-scheduler-private.h"
-#include "dex-thread-pool-scheduler.h"
+#include "dex-thread-pool-scheduler-private.h"
 #include "dex-thread-pool-worker-private.h"
 #include "dex-thread-storage-private.h"
 #include "dex-work-queue-private.h"
 
-#define MAX_WORKERS 32
+/* How often the monitor checks the work queues when the pool is
+ * allowed to grow and shrink.
+ */
+#define MONITOR_INTERVAL_MSEC 50
+
+/* Defaults for the thresholds which may be tuned from the environment,
+ * see dex_thread_pool_scheduler_new_full().
+ */
+#define DEFAULT_GROW_THRESHOLD_MSEC 100
+#define DEFAULT_IDLE_TIMEOUT_MSEC   (10 * 1000)
+#define DEFAULT_RETIRE_TIMEOUT_MSEC (60 * 1000)
 
 /**
  * DexThreadPoolScheduler:
@@ -49,16 +59,57 @@
  * When a worker creates a new work item, it is placed into a work stealing
  * queue owned by the thread. Other worker threads may steal work items when
  * they have exhausted their own work queue.
+ *
+ * Use [ctor@Dex.ThreadPoolScheduler.new_full] to control the number of
+ * workers. If the maximum number of workers is larger than the minimum, the
+ * pool will spawn more workers while work items are backing up and retire
+ * them again once they have been idle for some time.
  */
 
+typedef struct _DexThreadPoolMonitor DexThreadPoolMonitor;
+
 struct _DexThreadPoolScheduler
 {
   DexScheduler            parent_instance;
   DexWorkQueue           *global_work_queue;
   DexThreadPoolWorkerSet *set;
   guint                   fiber_rrobin;
-  guint                   n_workers;
-  DexThreadPoolWorker    *workers[MAX_WORKERS];
+  guint                   min_workers;
+  guint                   max_workers;
+
+  /* Spawn (or unpark) a worker when the global work queue or the queue
+   * of any worker has had items waiting for grow_threshold. Park a worker
+   * when the work queues have been empty for idle_timeout. Exit the thread
+   * of a worker once it has been parked for retire_timeout and nothing is
+   * bound to it anymore. All in microseconds.
+   */
+  gint64                  grow_threshold;
+  gint64                  idle_timeout;
+  gint64                  retire_timeout;
+
+  /* Workers which may be assigned fibers and coroutines. Parked workers
+   * keep running whatever is already bound to them, such as fibers and
+   * blocks, until they are retired by the monitor. Both arrays are only
+   * modified by the monitor, with the writer lock held.
+   */
+  GRWLock                 workers_lock;
+  GPtrArray              *workers;
+  GPtrArray              *parked;
+
+  /* The monitor runs on a thread of its own so that it may still grow
+   * the pool when every worker is blocked.
+   */
+  DexThreadPoolMonitor   *monitor;
+  GThread                *monitor_thread;
+};
+
+struct _DexThreadPoolMonitor
+{
+  GMutex                  mutex;
+  GCond                   cond;
+  DexThreadPoolScheduler *thread_pool_scheduler;
+  gint64                  backlog_since;
+  gint64                  idle_since;
 };
 
 typedef struct _DexThreadPoolSchedulerClass
@@ -112,11 +163,27 @@ dex_thread_pool_scheduler_get_aio_context (DexScheduler *scheduler)
   return dex_scheduler_get_aio_context (dex_scheduler_get_default ());
 }
 
+static DexTimerQueue *
+dex_thread_pool_scheduler_get_timer_queue (DexScheduler *scheduler)
+{
+  DexThreadPoolWorker *worker = DEX_THREAD_POOL_WORKER_CURRENT;
+
+  /* Give the worker's timer queue if we're on a pooled thread */
+  if (worker != NULL)
+    return dex_scheduler_get_timer_queue (DEX_SCHEDULER (worker));
+
+  /* Otherwise give the application default (main thread) timer queue */
+  return dex_scheduler_get_timer_queue (dex_scheduler_get_default ());
+}
+
+/* Must be called with the reader lock held on workers_lock so that
+ * the worker cannot be parked until it has been given the fiber.
+ */
 static inline DexThreadPoolWorker *
 rrobin_next (DexScheduler *scheduler)
 {
   DexThreadPoolScheduler *thread_pool_scheduler = (DexThreadPoolScheduler *)scheduler;
-  guint worker_index = g_atomic_int_add (&thread_pool_scheduler->fiber_rrobin, 1) % thread_pool_scheduler->n_workers;
+  guint worker_index = g_atomic_int_add (&thread_pool_scheduler->fiber_rrobin, 1) % thread_pool_scheduler->workers->len;
 
   /* TODO: This is just doing a dumb round robin for assigning a fiber to a
    * specific thread pool worker. We probably want something more interesting
@@ -124,25 +191,221 @@ rrobin_next (DexScheduler *scheduler)
    * number of them until latency reaches some threshold.
    */
 
-  return thread_pool_scheduler->workers[worker_index];
+  return g_ptr_array_index (thread_pool_scheduler->workers, worker_index);
 }
 
 static void
 dex_thread_pool_scheduler_spawn (DexScheduler *scheduler,
                                  DexFiber     *fiber)
 {
-  DexThreadPoolWorker *worker = rrobin_next (scheduler);
+  DexThreadPoolScheduler *thread_pool_scheduler = (DexThreadPoolScheduler *)scheduler;
+  DexThreadPoolWorker *worker;
 
+  g_rw_lock_reader_lock (&thread_pool_scheduler->workers_lock);
+  worker = rrobin_next (scheduler);
   DEX_SCHEDULER_GET_CLASS (worker)->spawn (DEX_SCHEDULER (worker), fiber);
+  g_rw_lock_reader_unlock (&thread_pool_scheduler->workers_lock);
 }
 
 static void
 dex_thread_pool_scheduler_spawn_coroutine (DexScheduler *scheduler,
                                            DexCoroutine *coroutine)
 {
-  DexThreadPoolWorker *worker = rrobin_next (scheduler);
+  DexThreadPoolScheduler *thread_pool_scheduler = (DexThreadPoolScheduler *)scheduler;
+  DexThreadPoolWorker *worker;
 
+  g_rw_lock_reader_lock (&thread_pool_scheduler->workers_lock);
+  worker = rrobin_next (scheduler);
   DEX_SCHEDULER_GET_CLASS (worker)->spawn_coroutine (DEX_SCHEDULER (worker), coroutine);
+  g_rw_lock_reader_unlock (&thread_pool_scheduler->workers_lock);
+}
+
+static gboolean
+dex_thread_pool_scheduler_grow (DexThreadPoolScheduler *thread_pool_scheduler)
+{
+  DexThreadPoolWorker *thread_pool_worker = NULL;
+
+  g_assert (DEX_IS_THREAD_POOL_SCHEDULER (thread_pool_scheduler));
+
+  if (thread_pool_scheduler->workers->len >= thread_pool_scheduler->max_workers)
+    return FALSE;
+
+  /* Prefer waking up a parked worker over creating a new thread */
+  if (thread_pool_scheduler->parked->len > 0)
+    {
+      g_rw_lock_writer_lock (&thread_pool_scheduler->workers_lock);
+      thread_pool_worker = g_ptr_array_steal_index (thread_pool_scheduler->parked,
+                                                    thread_pool_scheduler->parked->len - 1);
+      g_rw_lock_writer_unlock (&thread_pool_scheduler->workers_lock);
+
+      dex_thread_pool_worker_unpark (thread_pool_worker);
+    }
+  else
+    {
+      thread_pool_worker = dex_thread_pool_worker_new (thread_pool_scheduler->global_work_queue,
+                                                       thread_pool_scheduler->set,
+                                                       FALSE);
+
+      /* We may have hit a resource limit such as the number of io_uring
+       * that may be created. Don't try to grow past this point again.
+       */
+      if (thread_pool_worker == NULL)
+        {
+          thread_pool_scheduler->max_workers = thread_pool_scheduler->workers->len;
+          return FALSE;
+        }
+    }
+
+  g_rw_lock_writer_lock (&thread_pool_scheduler->workers_lock);
+  g_ptr_array_add (thread_pool_scheduler->workers, thread_pool_worker);
+  g_rw_lock_writer_unlock (&thread_pool_scheduler->workers_lock);
+
+  return TRUE;
+}
+
+static gboolean
+dex_thread_pool_scheduler_shrink (DexThreadPoolScheduler *thread_pool_scheduler)
+{
+  DexThreadPoolWorker *thread_pool_worker;
+
+  g_assert (DEX_IS_THREAD_POOL_SCHEDULER (thread_pool_scheduler));
+
+  if (thread_pool_scheduler->workers->len <= thread_pool_scheduler->min_workers)
+    return FALSE;
+
+  g_rw_lock_writer_lock (&thread_pool_scheduler->workers_lock);
+  thread_pool_worker = g_ptr_array_steal_index (thread_pool_scheduler->workers,
+                                                thread_pool_scheduler->workers->len - 1);
+  g_rw_lock_writer_unlock (&thread_pool_scheduler->workers_lock);
+
+  dex_thread_pool_worker_park (thread_pool_worker);
+
+  g_rw_lock_writer_lock (&thread_pool_scheduler->workers_lock);
+  g_ptr_array_add (thread_pool_scheduler->parked, thread_pool_worker);
+  g_rw_lock_writer_unlock (&thread_pool_scheduler->workers_lock);
+
+  return TRUE;
+}
+
+/* Exits the thread of parked workers which have not been needed again
+ * for retire_timeout and which nothing is bound to anymore.
+ */
+static void
+dex_thread_pool_scheduler_retire (DexThreadPoolScheduler *thread_pool_scheduler,
+                                  gint64                  now)
+{
+  g_assert (DEX_IS_THREAD_POOL_SCHEDULER (thread_pool_scheduler));
+
+  for (guint i = thread_pool_scheduler->parked->len; i > 0; i--)
+    {
+      DexThreadPoolWorker *thread_pool_worker = g_ptr_array_index (thread_pool_scheduler->parked, i - 1);
+
+      if (now - dex_thread_pool_worker_get_parked_at (thread_pool_worker) < thread_pool_scheduler->retire_timeout ||
+          !dex_thread_pool_worker_is_quiescent (thread_pool_worker))
+        continue;
+
+      g_rw_lock_writer_lock (&thread_pool_scheduler->workers_lock);
+      g_ptr_array_steal_index (thread_pool_scheduler->parked, i - 1);
+      g_rw_lock_writer_unlock (&thread_pool_scheduler->workers_lock);
+
+      /* Joins the thread of the worker once it has stopped */
+      dex_unref (thread_pool_worker);
+    }
+}
+
+/* Must be called with the monitor's mutex held */
+static void
+dex_thread_pool_monitor_tick (DexThreadPoolMonitor *monitor)
+{
+  DexThreadPoolScheduler *thread_pool_scheduler = monitor->thread_pool_scheduler;
+  gint64 now;
+
+  g_assert (thread_pool_scheduler != NULL);
+
+  now = g_get_monotonic_time ();
+
+  /* Items may also be stuck in the queue of a worker which is blocked,
+   * waiting for a peer to steal them.
+   */
+  if (!dex_work_queue_is_empty (thread_pool_scheduler->global_work_queue) ||
+      dex_thread_pool_worker_set_has_pending (thread_pool_scheduler->set))
+    {
+      monitor->idle_since = 0;
+
+      if (monitor->backlog_since == 0)
+        monitor->backlog_since = now;
+      else if (now - monitor->backlog_since >= thread_pool_scheduler->grow_threshold &&
+               dex_thread_pool_scheduler_grow (thread_pool_scheduler))
+        monitor->backlog_since = now;
+    }
+  else
+    {
+      monitor->backlog_since = 0;
+
+      if (monitor->idle_since == 0)
+        monitor->idle_since = now;
+      else if (now - monitor->idle_since >= thread_pool_scheduler->idle_timeout &&
+               dex_thread_pool_scheduler_shrink (thread_pool_scheduler))
+        monitor->idle_since = now;
+    }
+
+  if (thread_pool_scheduler->parked->len > 0)
+    dex_thread_pool_scheduler_retire (thread_pool_scheduler, now);
+}
+
+static gint64
+dex_thread_pool_getenv_msec (const char *name,
+                             guint       default_value)
+{
+  const char *str = g_getenv (name);
+  guint64 value;
+
+  if (str == NULL ||
+      !g_ascii_string_to_unsigned (str, 10, 0, G_MAXUINT, &value, NULL))
+    value = default_value;
+
+  return value * G_TIME_SPAN_MILLISECOND;
+}
+
+static void
+dex_thread_pool_monitor_finalize (gpointer data)
+{
+  DexThreadPoolMonitor *monitor = data;
+
+  g_assert (monitor->thread_pool_scheduler == NULL);
+
+  g_mutex_clear (&monitor->mutex);
+  g_cond_clear (&monitor->cond);
+}
+
+static void
+dex_thread_pool_monitor_unref (gpointer data)
+{
+  g_atomic_rc_box_release_full (data, dex_thread_pool_monitor_finalize);
+}
+
+static gpointer
+dex_thread_pool_monitor_thread_func (gpointer data)
+{
+  DexThreadPoolMonitor *monitor = data;
+
+  g_mutex_lock (&monitor->mutex);
+
+  /* Runs until the thread pool clears the back-pointer and signals us */
+  while (monitor->thread_pool_scheduler != NULL)
+    {
+      gint64 deadline = g_get_monotonic_time () + (MONITOR_INTERVAL_MSEC * G_TIME_SPAN_MILLISECOND);
+
+      if (!g_cond_wait_until (&monitor->cond, &monitor->mutex, deadline) &&
+          monitor->thread_pool_scheduler != NULL)
+        dex_thread_pool_monitor_tick (monitor);
+    }
+
+  g_mutex_unlock (&monitor->mutex);
+
+  dex_thread_pool_monitor_unref (monitor);
+
+  return NULL;
 }
 
 static void
@@ -157,12 +420,28 @@ dex_thread_pool_scheduler_finalize (DexObject *object)
       return;
     }
 
+  /* Stop the monitor before we tear down the workers. Clearing the
+   * back-pointer while holding the lock ensures that a concurrent
+   * tick has completed, and joining ensures there won't be another.
+   */
+  if (thread_pool_scheduler->monitor != NULL)
+    {
+      g_mutex_lock (&thread_pool_scheduler->monitor->mutex);
+      thread_pool_scheduler->monitor->thread_pool_scheduler = NULL;
+      g_cond_signal (&thread_pool_scheduler->monitor->cond);
+      g_mutex_unlock (&thread_pool_scheduler->monitor->mutex);
+
+      g_thread_join (g_steal_pointer (&thread_pool_scheduler->monitor_thread));
+      g_clear_pointer (&thread_pool_scheduler->monitor, dex_thread_pool_monitor_unref);
+    }
+
   dex_clear (&thread_pool_scheduler->global_work_queue);
 
   g_clear_pointer (&thread_pool_scheduler->set, dex_thread_pool_worker_set_unref);
 
-  for (guint i = 0; i < thread_pool_scheduler->n_workers; i++)
-    dex_clear (&thread_pool_scheduler->workers[i]);
+  g_clear_pointer (&thread_pool_scheduler->workers, g_ptr_array_unref);
+  g_clear_pointer (&thread_pool_scheduler->parked, g_ptr_array_unref);
+  g_rw_lock_clear (&thread_pool_scheduler->workers_lock);
 
   DEX_OBJECT_CLASS (dex_thread_pool_scheduler_parent_class)->finalize (object);
 }
@@ -177,6 +456,7 @@ dex_thread_pool_scheduler_class_init (DexThreadPoolSchedulerClass *thread_pool_s
 
   scheduler_class->get_main_context = dex_thread_pool_scheduler_get_main_context;
   scheduler_class->get_aio_context = dex_thread_pool_scheduler_get_aio_context;
+  scheduler_class->get_timer_queue = dex_thread_pool_scheduler_get_timer_queue;
   scheduler_class->push = dex_thread_pool_scheduler_push;
   scheduler_class->spawn = dex_thread_pool_scheduler_spawn;
   scheduler_class->spawn_coroutine = dex_thread_pool_scheduler_spawn_coroutine;
@@ -187,6 +467,9 @@ dex_thread_pool_scheduler_init (DexThreadPoolScheduler *thread_pool_scheduler)
 {
   thread_pool_scheduler->global_work_queue = dex_work_queue_new ();
   thread_pool_scheduler->set = dex_thread_pool_worker_set_new ();
+  thread_pool_scheduler->workers = g_ptr_array_new_with_free_func (dex_unref);
+  thread_pool_scheduler->parked = g_ptr_array_new_with_free_func (dex_unref);
+  g_rw_lock_init (&thread_pool_scheduler->workers_lock);
 }
 
 /**
@@ -194,37 +477,83 @@ dex_thread_pool_scheduler_init (DexThreadPoolScheduler *thread_pool_scheduler)
  *
  * Creates a new [class@Dex.Scheduler] that executes work items on a thread pool.
  *
+ * The number of workers is determined from the number of processors
+ * available to the process.
+ *
  * Returns: (transfer full): a [class@Dex.ThreadPoolScheduler]
  */
 DexScheduler *
 dex_thread_pool_scheduler_new (void)
+{
+  return dex_thread_pool_scheduler_new_full (0, 0);
+}
+
+/**
+ * dex_thread_pool_scheduler_new_full:
+ * @min_workers: the number of workers to start with, or 0 for a default
+ *   based on the number of processors
+ * @max_workers: the maximum number of workers, or 0 to use @min_workers
+ *
+ * Creates a new [class@Dex.Scheduler] that executes work items on a thread
+ * pool of at least @min_workers threads.
+ *
+ * If @max_workers is larger than @min_workers, additional workers will be
+ * started when work items remain queued for a period of time. Those workers
+ * stop taking new work again after the pool has been idle for a period of
+ * time, but continue to run fibers which have already been assigned to
+ * them. Their threads exit once nothing is bound to them anymore.
+ *
+ * The periods of time may be tuned from the environment, in milliseconds:
+ *
+ *  - `DEX_THREAD_POOL_GROW_THRESHOLD` is how long work items must have been
+ *    queued before another worker is started (default 100)
+ *  - `DEX_THREAD_POOL_IDLE_TIMEOUT` is how long the pool must have been
+ *    idle before a worker stops taking new work (default 10000)
+ *  - `DEX_THREAD_POOL_RETIRE_TIMEOUT` is how long a worker must not have
+ *    taken new work before its thread may exit (default 60000)
+ *
+ * Returns: (transfer full): a [class@Dex.ThreadPoolScheduler]
+ *
+ * Since: 1.2
+ */
+DexScheduler *
+dex_thread_pool_scheduler_new_full (guint min_workers,
+                                    guint max_workers)
 {
   DexThreadPoolScheduler *thread_pool_scheduler;
-  guint n_procs;
-  guint n_workers;
 
   thread_pool_scheduler = (DexThreadPoolScheduler *)dex_object_create_instance (DEX_TYPE_THREAD_POOL_SCHEDULER);
 
-  /* TODO: let this be dynamic and tunable, as well as thread pinning */
-
-  n_procs = MIN (MAX_WORKERS, g_get_num_processors ());
-
-  /* Couple things here, which we should take a look at in the future to
-   * see how we can tune them correctly, but:
-   *
-   * Remove one as the main thread has an AIO context too and we don't want
-   * to create contention there. Also, io_uring may limit us in the number
-   * of io_uring we can create.
-   *
-   * g_get_num_processors() includes hyperthreads, so take the result and
-   * cut it in half. It would be nicer to actually verify this on the system
-   * for cases where we don't have that.
-   *
-   * Additionally, bail if the worker fails to be created.
-   */
-  n_workers = MAX (1, (n_procs/2));
+  /* TODO: thread pinning */
+
+  if (min_workers == 0)
+    {
+      /* Couple things here, which we should take a look at in the future to
+       * see how we can tune them correctly, but:
+       *
+       * g_get_num_processors() includes hyperthreads, so take the result and
+       * cut it in half. It would be nicer to actually verify this on the system
+       * for cases where we don't have that.
+       *
+       * Additionally, io_uring may limit us in the number of io_uring we can
+       * create, so we bail if the worker fails to be created.
+       */
+      min_workers = MAX (1, g_get_num_processors () / 2);
+    }
+
+  if (max_workers != 0 && max_workers < min_workers)
+    min_workers = max_workers;
+
+  thread_pool_scheduler->min_workers = min_workers;
+  thread_pool_scheduler->max_workers = MAX (min_workers, max_workers);
+  thread_pool_scheduler->grow_threshold = dex_thread_pool_getenv_msec ("DEX_THREAD_POOL_GROW_THRESHOLD",
+                                                                       DEFAULT_GROW_THRESHOLD_MSEC);
+  thread_pool_scheduler->idle_timeout = dex_thread_pool_getenv_msec ("DEX_THREAD_POOL_IDLE_TIMEOUT",
+                                                                     DEFAULT_IDLE_TIMEOUT_MSEC);
+  thread_pool_scheduler->retire_timeout = dex_thread_pool_getenv_msec ("DEX_THREAD_POOL_RETIRE_TIMEOUT",
+                                                                       DEFAULT_RETIRE_TIMEOUT_MSEC);
 
-  for (guint i = 0; i < n_workers; i++)
+  for (guint i = 0; i < min_workers; i++)
     {
       DexThreadPoolWorker *thread_pool_worker;
 
@@ -235,16 +564,90 @@ dex_thread_pool_scheduler_new (void)
       if (thread_pool_worker == NULL)
         break;
 
-      thread_pool_scheduler->workers[thread_pool_scheduler->n_workers++] = thread_pool_worker;
+      g_ptr_array_add (thread_pool_scheduler->workers, thread_pool_worker);
     }
 
-  g_assert (thread_pool_scheduler->n_workers > 0);
+  g_assert (thread_pool_scheduler->workers->len > 0);
+
+  /* Don't try to go past whatever limit we hit */
+  if (thread_pool_scheduler->workers->len < min_workers)
+    thread_pool_scheduler->min_workers =
+      thread_pool_scheduler->max_workers =
+        thread_pool_scheduler->workers->len;
+
+  /* If we may grow, monitor the work queues from a thread of our own
+   * as the workers may all be blocked when we need to grow the most.
+   */
+  if (thread_pool_scheduler->max_workers > thread_pool_scheduler->min_workers)
+    {
+      thread_pool_scheduler->monitor = g_atomic_rc_box_new0 (DexThreadPoolMonitor);
+      thread_pool_scheduler->monitor->thread_pool_scheduler = thread_pool_scheduler;
+      g_mutex_init (&thread_pool_scheduler->monitor->mutex);
+      g_cond_init (&thread_pool_scheduler->monitor->cond);
+
+      thread_pool_scheduler->monitor_thread =
+        g_thread_new ("dex-thread-pool-monitor",
+                      dex_thread_pool_monitor_thread_func,
+                      g_atomic_rc_box_acquire (thread_pool_scheduler->monitor));
+    }
 
   atomic_thread_fence (memory_order_seq_cst);
 
   return DEX_SCHEDULER (thread_pool_scheduler);
 }
 
+/**
+ * dex_thread_pool_scheduler_get_n_workers:
+ * @thread_pool_scheduler: a [class@Dex.ThreadPoolScheduler]
+ *
+ * Gets the number of workers which are currently accepting new work.
+ *
+ * Returns: the number of active workers
+ *
+ * Since: 1.2
+ */
+guint
+dex_thread_pool_scheduler_get_n_workers (DexThreadPoolScheduler *thread_pool_scheduler)
+{
+  guint n_workers;
+
+  g_return_val_if_fail (DEX_IS_THREAD_POOL_SCHEDULER (thread_pool_scheduler), 0);
+
+  g_rw_lock_reader_lock (&thread_pool_scheduler->workers_lock);
+  n_workers = thread_pool_scheduler->workers->len;
+  g_rw_lock_reader_unlock (&thread_pool_scheduler->workers_lock);
+
+  return n_workers;
+}
+
+/* Returns how many workers no longer take new work but have not been
+ * retired yet.
+ */
+guint
+dex_thread_pool_scheduler_get_n_parked (DexThreadPoolScheduler *thread_pool_scheduler)
+{
+  guint n_parked;
+
+  g_return_val_if_fail (DEX_IS_THREAD_POOL_SCHEDULER (thread_pool_scheduler), 0);
+
+  g_rw_lock_reader_lock (&thread_pool_scheduler->workers_lock);
+  n_parked = thread_pool_scheduler->parked->len;
+  g_rw_lock_reader_unlock (&thread_pool_scheduler->workers_lock);
+
+  return n_parked;
+}
+
+/* Returns how many workers are asleep waiting for a peer to wake them
+ * up to steal work.
+ */
+guint
+dex_thread_pool_scheduler_get_n_idle (DexThreadPoolScheduler *thread_pool_scheduler)
+{
+  g_return_val_if_fail (DEX_IS_THREAD_POOL_SCHEDULER (thread_pool_scheduler), 0);
+
+  return dex_thread_pool_worker_set_get_n_idle (thread_pool_scheduler->set);
+}
+
 /**
  * dex_thread_pool_scheduler_get_default:
  *
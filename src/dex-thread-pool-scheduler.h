@@ -32,11 +32,16 @@ G_BEGIN_DECLS
 typedef struct _DexThreadPoolScheduler DexThreadPoolScheduler;
 
 DEX_AVAILABLE_IN_ALL
-GType         dex_thread_pool_scheduler_get_type    (void);
+GType         dex_thread_pool_scheduler_get_type      (void);
 DEX_AVAILABLE_IN_ALL
-DexScheduler *dex_thread_pool_scheduler_new         (void);
+DexScheduler *dex_thread_pool_scheduler_new           (void);
+DEX_AVAILABLE_IN_1_2
+DexScheduler *dex_thread_pool_scheduler_new_full      (guint                   min_workers,
+                                                       guint                   max_workers);
 DEX_AVAILABLE_IN_ALL
-DexScheduler *dex_thread_pool_scheduler_get_default (void);
+DexScheduler *dex_thread_pool_scheduler_get_default   (void);
+DEX_AVAILABLE_IN_1_2
+guint         dex_thread_pool_scheduler_get_n_workers (DexThreadPoolScheduler *thread_pool_scheduler);
 
 G_DEFINE_AUTOPTR_CLEANUP_FUNC (DexThreadPoolScheduler, dex_unref)
 
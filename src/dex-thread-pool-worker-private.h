@@ -34,12 +34,18 @@ G_BEGIN_DECLS
 typedef struct _DexThreadPoolWorker    DexThreadPoolWorker;
 typedef struct _DexThreadPoolWorkerSet DexThreadPoolWorkerSet;
 
-GType                   dex_thread_pool_worker_get_type  (void);
-DexThreadPoolWorker    *dex_thread_pool_worker_new       (DexWorkQueue           *work_queue,
-                                                          DexThreadPoolWorkerSet *set,
-                                                          gboolean                force_create);
-DexThreadPoolWorkerSet *dex_thread_pool_worker_set_new   (void);
-DexThreadPoolWorkerSet *dex_thread_pool_worker_set_ref   (DexThreadPoolWorkerSet *set);
-void                    dex_thread_pool_worker_set_unref (DexThreadPoolWorkerSet *set);
+GType                   dex_thread_pool_worker_get_type        (void);
+DexThreadPoolWorker    *dex_thread_pool_worker_new             (DexWorkQueue           *work_queue,
+                                                                DexThreadPoolWorkerSet *set,
+                                                                gboolean                force_create);
+void                    dex_thread_pool_worker_park            (DexThreadPoolWorker    *thread_pool_worker);
+void                    dex_thread_pool_worker_unpark          (DexThreadPoolWorker    *thread_pool_worker);
+gint64                  dex_thread_pool_worker_get_parked_at   (DexThreadPoolWorker    *thread_pool_worker);
+gboolean                dex_thread_pool_worker_is_quiescent    (DexThreadPoolWorker    *thread_pool_worker);
+DexThreadPoolWorkerSet *dex_thread_pool_worker_set_new         (void);
+DexThreadPoolWorkerSet *dex_thread_pool_worker_set_ref         (DexThreadPoolWorkerSet *set);
+void                    dex_thread_pool_worker_set_unref       (DexThreadPoolWorkerSet *set);
+gboolean                dex_thread_pool_worker_set_has_pending (DexThreadPoolWorkerSet *set);
+guint                   dex_thread_pool_worker_set_get_n_idle  (DexThreadPoolWorkerSet *set);
 
 G_END_DECLS
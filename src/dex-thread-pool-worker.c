@@ -41,11 +41,21 @@ typedef enum _DexThreadPoolWorkerStatus
   DEX_THREAD_POOL_WORKER_FINISHED,
 } DexThreadPoolWorkerStatus;
 
+/* What other workers in the set may see of a worker. This outlives the
+ * worker itself as a snapshot of the set may still reference it.
+ */
+typedef struct _DexThreadPoolWorkerPeer
+{
+  DexWorkStealingQueue *work_stealing_queue;
+  GMainContext         *main_context;
+  _Atomic(gboolean)     idle;
+} DexThreadPoolWorkerPeer;
+
 struct _DexThreadPoolWorker
 {
   DexScheduler               parent_instance;
 
-  GList                      set_link;
+  DexThreadPoolWorkerPeer   *peer;
   DexThreadPoolWorkerSet    *set;
 
   GThread                   *thread;
@@ -53,17 +63,24 @@ struct _DexThreadPoolWorker
   GMainLoop                 *main_loop;
   DexAioContext             *aio_context;
   DexWorkQueue              *global_work_queue;
+  DexFuture                 *global_work_queue_loop;
   DexWorkStealingQueue      *work_stealing_queue;
+  GSource                   *inbox_source;
   GSource                   *set_source;
   GSource                   *local_source;
   GSource                   *fiber_scheduler;
   GSource                   *coroutine_scheduler;
+  DexTimerQueue             *timer_queue;
 
   GMutex                     setup_mutex;
   GCond                      setup_cond;
 
+  /* Only used by the thread which parks and unparks us */
+  gint64                     parked_at;
+
   DexThreadPoolWorkerStatus  status : 2;
   guint                      force_create : 1;
+  guint                      parked : 1;
 };
 
 typedef struct _DexThreadPoolWorkerClass
@@ -82,13 +99,228 @@ static void     dex_thread_pool_worker_set_remove        (DexThreadPoolWorkerSet
                                                           DexThreadPoolWorker    *thread_pool_worker);
 static GSource *dex_thread_pool_worker_set_create_source (DexThreadPoolWorkerSet *set,
                                                           DexThreadPoolWorker    *thread_pool_worker);
+static void     dex_thread_pool_worker_set_wake_one      (DexThreadPoolWorkerSet *set,
+                                                          DexThreadPoolWorker    *thread_pool_worker);
+static void     dex_thread_pool_worker_peer_unref        (DexThreadPoolWorkerPeer *peer);
+
+/*
+ * The inbox is used for work items pushed to a worker from any thread other
+ * than the worker itself (generally related to completing futures). It is a
+ * multi-producer/single-consumer queue based on the design by Dmitry Vyukov
+ * so that producers never block each other.
+ *
+ * Work items are passed by value, so every push allocates a node to link
+ * the item into the queue and the worker frees it once the item is popped.
+ * Pooling those nodes would need another lock-free structure to hand them
+ * back to producers, which the allocator's per-thread caches already cover.
+ *
+ * Producers only wake up the worker when the inbox transitions from having
+ * been drained to having items again. The worker drains the inbox in batches
+ * from a single GSource which lives as long as the worker.
+ */
+
+#define INBOX_BATCH_SIZE 64
+
+/* The most items reserved from the global work queue at once. Items are
+ * only reserved in bulk when no other worker is waiting for them.
+ */
+#define GLOBAL_WORK_BATCH_SIZE 16
+
+/* The initial capacity of a worker's own queue. It grows as needed and
+ * shrinks back once drained, so this only needs to fit the common case.
+ */
+#define WORK_STEALING_QUEUE_CAPACITY 32
+
+/* After running out of work, a worker keeps looking for work to steal
+ * with an exponentially growing poll timeout. Once that passes
+ * STEAL_BACKOFF_MAX_MSEC it sleeps without a timeout. Either way it is
+ * marked idle while it waits so that a peer which has more work than it
+ * can handle wakes it up early.
+ */
+#define STEAL_BACKOFF_MAX_MSEC 64
+
+typedef struct _DexThreadPoolWorkerInboxItem
+{
+  struct _DexThreadPoolWorkerInboxItem * _Atomic next;
+  DexWorkItem                                    work_item;
+} DexThreadPoolWorkerInboxItem;
+
+typedef struct _DexThreadPoolWorkerInbox
+{
+  GSource                                 parent_source;
+  DexThreadPoolWorkerInboxItem * _Atomic  head;
+  DexThreadPoolWorkerInboxItem           *tail;
+  DexThreadPoolWorkerInboxItem            stub;
+  _Atomic(gboolean)                       pending;
+} DexThreadPoolWorkerInbox;
+
+static void
+dex_thread_pool_worker_inbox_link (DexThreadPoolWorkerInbox     *inbox,
+                                   DexThreadPoolWorkerInboxItem *item)
+{
+  DexThreadPoolWorkerInboxItem *prev;
+
+  atomic_store_explicit (&item->next, NULL, memory_order_relaxed);
+  prev = atomic_exchange_explicit (&inbox->head, item, memory_order_acq_rel);
+  atomic_store_explicit (&prev->next, item, memory_order_release);
+}
+
+static void
+dex_thread_pool_worker_inbox_push (DexThreadPoolWorkerInbox *inbox,
+                                   GMainContext             *main_context,
+                                   DexWorkItem               work_item)
+{
+  DexThreadPoolWorkerInboxItem *item;
+
+  item = g_new (DexThreadPoolWorkerInboxItem, 1);
+  item->work_item = work_item;
+
+  dex_thread_pool_worker_inbox_link (inbox, item);
+
+  /* Only the first producer after the worker drained the inbox needs
+   * to wake up the worker's main context.
+   */
+  if (!atomic_exchange_explicit (&inbox->pending, TRUE, memory_order_acq_rel))
+    g_main_context_wakeup (main_context);
+}
+
+/* Must only be called from the thread owning the inbox. Returns %NULL when
+ * the inbox is empty or a producer has not yet finished linking an item, in
+ * which case that producer will mark the inbox as pending once it has.
+ */
+static DexThreadPoolWorkerInboxItem *
+dex_thread_pool_worker_inbox_pop (DexThreadPoolWorkerInbox *inbox)
+{
+  DexThreadPoolWorkerInboxItem *tail = inbox->tail;
+  DexThreadPoolWorkerInboxItem *next = atomic_load_explicit (&tail->next, memory_order_acquire);
+
+  if (tail == &inbox->stub)
+    {
+      if (next == NULL)
+        return NULL;
+
+      inbox->tail = tail = next;
+      next = atomic_load_explicit (&tail->next, memory_order_acquire);
+    }
+
+  if (next != NULL)
+    {
+      inbox->tail = next;
+      return tail;
+    }
+
+  if (tail != atomic_load_explicit (&inbox->head, memory_order_acquire))
+    return NULL;
+
+  /* @tail is the last item, put the stub back behind it so that
+   * we can detach @tail from the inbox.
+   */
+  dex_thread_pool_worker_inbox_link (inbox, &inbox->stub);
+
+  if ((next = atomic_load_explicit (&tail->next, memory_order_acquire)))
+    {
+      inbox->tail = next;
+      return tail;
+    }
+
+  return NULL;
+}
 
 static gboolean
-dex_thread_pool_worker_work_item_cb (gpointer user_data)
+dex_thread_pool_worker_inbox_prepare (GSource *source,
+                                      int     *timeout)
 {
-  DexWorkItem *work_item = user_data;
-  dex_work_item_invoke (work_item);
-  return G_SOURCE_REMOVE;
+  DexThreadPoolWorkerInbox *inbox = (DexThreadPoolWorkerInbox *)source;
+
+  *timeout = -1;
+
+  return atomic_load_explicit (&inbox->pending, memory_order_acquire);
+}
+
+static gboolean
+dex_thread_pool_worker_inbox_check (GSource *source)
+{
+  DexThreadPoolWorkerInbox *inbox = (DexThreadPoolWorkerInbox *)source;
+
+  return atomic_load_explicit (&inbox->pending, memory_order_acquire);
+}
+
+static gboolean
+dex_thread_pool_worker_inbox_dispatch (GSource     *source,
+                                       GSourceFunc  callback,
+                                       gpointer     callback_data)
+{
+  DexThreadPoolWorkerInbox *inbox = (DexThreadPoolWorkerInbox *)source;
+  DexThreadPoolWorkerInboxItem *item;
+  guint n_items = 0;
+
+  /* Clear pending before draining so that any producer linking an item
+   * after this point will wake us up again.
+   */
+  atomic_exchange_explicit (&inbox->pending, FALSE, memory_order_acq_rel);
+
+  while ((item = dex_thread_pool_worker_inbox_pop (inbox)))
+    {
+      DexWorkItem work_item = item->work_item;
+
+      g_free (item);
+      dex_work_item_invoke (&work_item);
+
+      /* Give other sources a chance to run, we'll come right back */
+      if (++n_items == INBOX_BATCH_SIZE)
+        {
+          atomic_store_explicit (&inbox->pending, TRUE, memory_order_release);
+          break;
+        }
+    }
+
+  return G_SOURCE_CONTINUE;
+}
+
+static void
+dex_thread_pool_worker_inbox_finalize (GSource *source)
+{
+  DexThreadPoolWorkerInbox *inbox = (DexThreadPoolWorkerInbox *)source;
+  DexThreadPoolWorkerInboxItem *item;
+
+  /* Other threads must hold a reference to the worker to push, so the
+   * worker thread drains everything they pushed before it exits. Only
+   * items the worker pushed to itself after destroying the inbox (such
+   * as from timers being cancelled) can be left. They are dropped here
+   * without being run, as there is no thread left to run them on.
+   */
+  while ((item = dex_thread_pool_worker_inbox_pop (inbox)))
+    g_free (item);
+}
+
+static GSourceFuncs dex_thread_pool_worker_inbox_funcs = {
+  .prepare = dex_thread_pool_worker_inbox_prepare,
+  .check = dex_thread_pool_worker_inbox_check,
+  .dispatch = dex_thread_pool_worker_inbox_dispatch,
+  .finalize = dex_thread_pool_worker_inbox_finalize,
+};
+
+static GSource *
+dex_thread_pool_worker_inbox_new (void)
+{
+  DexThreadPoolWorkerInbox *inbox;
+
+  inbox = (DexThreadPoolWorkerInbox *)
+    g_source_new (&dex_thread_pool_worker_inbox_funcs, sizeof *inbox);
+  _g_source_set_static_name ((GSource *)inbox, "[dex-thread-pool-worker-inbox]");
+
+  atomic_init (&inbox->stub.next, NULL);
+  atomic_init (&inbox->head, &inbox->stub);
+  atomic_init (&inbox->pending, FALSE);
+  inbox->tail = &inbox->stub;
+
+  /* Pushing a work item directly onto a worker is generally going to be
+   * related to completing work items. Treat those as extremely high
+   * priority as they will delay further processing of futures.
+   */
+  g_source_set_priority ((GSource *)inbox, G_MININT);
+
+  return (GSource *)inbox;
 }
 
 static void
@@ -101,34 +333,160 @@ dex_thread_pool_worker_push (DexScheduler *scheduler,
 
   if G_LIKELY (g_thread_self () == thread_pool_worker->thread &&
                thread_pool_worker->status == DEX_THREAD_POOL_WORKER_RUNNING)
-    dex_work_stealing_queue_push (thread_pool_worker->work_stealing_queue, work_item);
+    {
+      dex_work_stealing_queue_push (thread_pool_worker->work_stealing_queue, work_item);
+
+      /* Even a single item may sit behind whatever we are running now,
+       * which could block for a long time, so let a sleeping peer steal
+       * it. This is cheap when no peer is asleep.
+       */
+      dex_thread_pool_worker_set_wake_one (thread_pool_worker->set, thread_pool_worker);
+    }
   else
+    dex_thread_pool_worker_inbox_push ((DexThreadPoolWorkerInbox *)thread_pool_worker->inbox_source,
+                                       thread_pool_worker->main_context,
+                                       work_item);
+}
+
+static gboolean
+dex_thread_pool_worker_clear_global_work_cb (gpointer data)
+{
+  DexThreadPoolWorker *thread_pool_worker = data;
+
+  g_assert (DEX_IS_THREAD_POOL_WORKER (thread_pool_worker));
+  g_assert (thread_pool_worker->thread == g_thread_self ());
+
+  /* We may have been unparked in the mean time */
+  if (thread_pool_worker->global_work_queue_loop != NULL &&
+      !dex_future_is_pending (thread_pool_worker->global_work_queue_loop))
+    dex_clear (&thread_pool_worker->global_work_queue_loop);
+
+  return G_SOURCE_REMOVE;
+}
+
+static DexFuture *
+dex_thread_pool_worker_global_work_cb (DexFuture *completed,
+                                       gpointer   user_data)
+{
+  DexThreadPoolWorker *thread_pool_worker = user_data;
+  DexWorkQueue *work_queue;
+  const GValue *value;
+  GSource *idle_source;
+  guint n_items;
+
+  g_assert (DEX_IS_THREAD_POOL_WORKER (thread_pool_worker));
+
+  work_queue = thread_pool_worker->global_work_queue;
+
+  /* We may pop as many items as were reserved for us, but only that one
+   * batch. The next reservation goes through the loop again, so nested
+   * dispatch is bounded by DEX_DISPATCH_RECURSE_MAX before it is deferred
+   * to the main loop where the inbox, stolen work, timers and fibers get
+   * to run and park_cb can park us. A reservation that completes right
+   * away still costs no waiter, so a busy queue stays cheap.
+   */
+  value = dex_future_get_value (completed, NULL);
+  n_items = value != NULL ? g_value_get_uint (value) : 0;
+
+  while (n_items > 0)
     {
-      GSource *source;
-
-      /* Pushing a work item directly onto a worker is generally going
-       * to be related to completing work items. Treat those as extremely
-       * high priority as they will delay further processing of futures.
-       *
-       * This is currently a workaround to improve the situation with
-       * issue #17 when we're on fallback configurations. If we want
-       * to improve that situation further, we can reduce some overhead
-       * here by creating a dedicated GSource like DexMainScheduler does
-       * for work items instead of a 1:1 GSource creation.
-       *
-       * But this at least improves the situation immediately that is
-       * causing potential lock-ups.
+      DexWorkItem work_item;
+
+      /* We were parked while waiting for work. Hand the reservations
+       * back so that the items are picked up by another worker rather
+       * than us.
        */
+      if G_UNLIKELY (thread_pool_worker->parked)
+        {
+          dex_work_queue_release (work_queue, n_items);
+          goto parked;
+        }
 
-      source = g_idle_source_new ();
-      g_source_set_priority (source, G_MININT);
-      g_source_set_callback (source,
-                             dex_thread_pool_worker_work_item_cb,
-                             g_memdup2 (&work_item, sizeof work_item),
-                             g_free);
-      g_source_attach (source, thread_pool_worker->main_context);
-      g_source_unref (source);
+      if (!dex_work_queue_try_pop (work_queue, &work_item))
+        break;
+
+      n_items--;
+
+      dex_work_item_invoke (&work_item);
     }
+
+  if G_UNLIKELY (thread_pool_worker->parked)
+    goto parked;
+
+  return dex_work_queue_wait_many (work_queue, GLOBAL_WORK_BATCH_SIZE);
+
+parked:
+  /* The loop holds a reference to us through its block, so drop it once
+   * it has completed or we could never be retired. This must not go
+   * through our work stealing queue as a peer could run it.
+   */
+  idle_source = g_idle_source_new ();
+  _g_source_set_static_name (idle_source, "[dex-thread-pool-worker-parked]");
+  g_source_set_callback (idle_source,
+                         dex_thread_pool_worker_clear_global_work_cb,
+                         thread_pool_worker, NULL);
+  g_source_attach (idle_source, thread_pool_worker->main_context);
+  g_source_unref (idle_source);
+
+  return NULL;
+}
+
+static void
+dex_thread_pool_worker_start_global_work (DexThreadPoolWorker *thread_pool_worker)
+{
+  DexFuture *future;
+
+  g_assert (DEX_IS_THREAD_POOL_WORKER (thread_pool_worker));
+  g_assert (thread_pool_worker->thread == g_thread_self ());
+
+  /* The previous loop must have completed by noticing we were parked */
+  if (thread_pool_worker->global_work_queue_loop != NULL &&
+      dex_future_is_pending (thread_pool_worker->global_work_queue_loop))
+    return;
+
+  dex_clear (&thread_pool_worker->global_work_queue_loop);
+
+  /* Async process global work-queue items until we're told to shutdown or park */
+  future = dex_work_queue_wait_many (thread_pool_worker->global_work_queue,
+                                     GLOBAL_WORK_BATCH_SIZE);
+  future = dex_future_finally_loop (future,
+                                    dex_thread_pool_worker_global_work_cb,
+                                    thread_pool_worker, NULL);
+  thread_pool_worker->global_work_queue_loop = future;
+}
+
+static void
+dex_thread_pool_worker_park_cb (gpointer data)
+{
+  DexThreadPoolWorker *thread_pool_worker = data;
+
+  g_assert (DEX_IS_THREAD_POOL_WORKER (thread_pool_worker));
+  g_assert (thread_pool_worker->thread == g_thread_self ());
+
+  /* The global work-queue loop will stop the next time it wakes up.
+   * Withdraw our waiter so that wakes it up right away rather than it
+   * taking items which are meant for the active workers.
+   */
+  thread_pool_worker->parked = TRUE;
+  dex_work_queue_withdraw (thread_pool_worker->global_work_queue,
+                           DEX_SCHEDULER (thread_pool_worker));
+}
+
+static void
+dex_thread_pool_worker_unpark_cb (gpointer data)
+{
+  DexThreadPoolWorker *thread_pool_worker = data;
+
+  g_assert (DEX_IS_THREAD_POOL_WORKER (thread_pool_worker));
+  g_assert (thread_pool_worker->thread == g_thread_self ());
+
+  if (!thread_pool_worker->parked ||
+      thread_pool_worker->status != DEX_THREAD_POOL_WORKER_RUNNING)
+    return;
+
+  thread_pool_worker->parked = FALSE;
+
+  dex_thread_pool_worker_start_global_work (thread_pool_worker);
 }
 
 static gboolean
@@ -182,21 +540,22 @@ dex_thread_pool_worker_finalize (DexObject *object)
 #endif
 
   /* These are all destroyed during thread shutdown */
+  g_clear_pointer (&thread_pool_worker->inbox_source, g_source_unref);
   g_clear_pointer (&thread_pool_worker->set_source, g_source_unref);
   g_clear_pointer (&thread_pool_worker->local_source, g_source_unref);
   g_clear_pointer (&thread_pool_worker->fiber_scheduler, g_source_unref);
   g_clear_pointer (&thread_pool_worker->coroutine_scheduler, g_source_unref);
+  g_clear_pointer (&thread_pool_worker->timer_queue, dex_timer_queue_unref);
 
   g_clear_pointer (&thread_pool_worker->thread, g_thread_unref);
   g_clear_pointer (&thread_pool_worker->main_context, g_main_context_unref);
   g_clear_pointer (&thread_pool_worker->main_loop, g_main_loop_unref);
   g_clear_pointer (&thread_pool_worker->work_stealing_queue, dex_work_stealing_queue_unref);
+  g_clear_pointer (&thread_pool_worker->peer, dex_thread_pool_worker_peer_unref);
+  g_clear_pointer (&thread_pool_worker->set, dex_thread_pool_worker_set_unref);
 
   dex_clear (&thread_pool_worker->global_work_queue);
 
-  g_assert (thread_pool_worker->set_link.prev == NULL);
-  g_assert (thread_pool_worker->set_link.next == NULL);
-
   g_mutex_clear (&thread_pool_worker->setup_mutex);
   g_cond_clear (&thread_pool_worker->setup_cond);
 
@@ -223,6 +582,16 @@ dex_thread_pool_worker_get_aio_context (DexScheduler *scheduler)
   return thread_pool_worker->aio_context;
 }
 
+static DexTimerQueue *
+dex_thread_pool_worker_get_timer_queue (DexScheduler *scheduler)
+{
+  DexThreadPoolWorker *thread_pool_worker = DEX_THREAD_POOL_WORKER (scheduler);
+
+  g_assert (DEX_IS_THREAD_POOL_WORKER (thread_pool_worker));
+
+  return thread_pool_worker->timer_queue;
+}
+
 static void
 dex_thread_pool_worker_spawn (DexScheduler *scheduler,
                               DexFiber     *fiber)
@@ -259,17 +628,32 @@ dex_thread_pool_worker_class_init (DexThreadPoolWorkerClass *thread_pool_worker_
   scheduler_class->spawn = dex_thread_pool_worker_spawn;
   scheduler_class->spawn_coroutine = dex_thread_pool_worker_spawn_coroutine;
   scheduler_class->get_aio_context = dex_thread_pool_worker_get_aio_context;
+  scheduler_class->get_timer_queue = dex_thread_pool_worker_get_timer_queue;
 }
 
 static void
 dex_thread_pool_worker_init (DexThreadPoolWorker *thread_pool_worker)
 {
-  thread_pool_worker->set_link.data = thread_pool_worker;
-
   g_mutex_init (&thread_pool_worker->setup_mutex);
   g_cond_init (&thread_pool_worker->setup_cond);
 }
 
+/* Installed as the poll function of the worker's GMainContext so that the
+ * aio backend may wait for completions along with everything else.
+ */
+static int
+dex_thread_pool_worker_poll (GPollFD *fds,
+                             guint    n_fds,
+                             int      timeout)
+{
+  DexAioContext *aio_context = dex_thread_storage_get ()->aio_context;
+
+  if G_UNLIKELY (aio_context == NULL)
+    return g_poll (fds, n_fds, timeout);
+
+  return dex_aio_backend_poll (aio_context->aio_backend, aio_context, fds, n_fds, timeout);
+}
+
 static gpointer
 dex_thread_pool_worker_thread_func (gpointer data)
 {
@@ -277,7 +661,6 @@ dex_thread_pool_worker_thread_func (gpointer data)
   DexThreadStorage *storage = dex_thread_storage_get ();
   DexAioBackend *aio_backend;
   DexAioContext *aio_context;
-  DexFuture *global_work_queue_loop;
   GSource *source;
 
   g_mutex_lock (&thread_pool_worker->setup_mutex);
@@ -320,6 +703,10 @@ dex_thread_pool_worker_thread_func (gpointer data)
   g_source_attach (source, thread_pool_worker->main_context);
   thread_pool_worker->local_source = g_steal_pointer (&source);
 
+  /* Attach the inbox which other threads push work items into */
+  g_source_attach (thread_pool_worker->inbox_source,
+                   thread_pool_worker->main_context);
+
   /* Create a source to steal work items from other thread pool threads.
    * This is slightly higher priority than the global queue because we
    * want to steal items from the peers before the global queue.
@@ -339,18 +726,29 @@ dex_thread_pool_worker_thread_func (gpointer data)
   g_source_attach (source, thread_pool_worker->main_context);
   thread_pool_worker->coroutine_scheduler = g_steal_pointer (&source);
 
+  /* Setup the timer queue shared by all timeouts on this worker */
+  thread_pool_worker->timer_queue = dex_timer_queue_new ();
+  g_source_attach ((GSource *)thread_pool_worker->timer_queue,
+                   thread_pool_worker->main_context);
+
   storage->scheduler = DEX_SCHEDULER (thread_pool_worker);
   storage->worker = thread_pool_worker;
   storage->aio_context = thread_pool_worker->aio_context;
 
+  /* Reap completions directly while waiting rather than waking up
+   * for the eventfd and reading it before dispatching.
+   */
+  g_main_context_set_poll_func (thread_pool_worker->main_context,
+                                dex_thread_pool_worker_poll);
+
   g_main_context_push_thread_default (thread_pool_worker->main_context);
   thread_pool_worker->status = DEX_THREAD_POOL_WORKER_RUNNING;
 
   /* Add to set so others may steal work items from us */
   dex_thread_pool_worker_set_add (thread_pool_worker->set, thread_pool_worker);
 
-  /* Async processing global work-queue items until we're told to shutdown */
-  global_work_queue_loop = dex_work_queue_run (thread_pool_worker->global_work_queue);
+  /* Start processing global work-queue items */
+  dex_thread_pool_worker_start_global_work (thread_pool_worker);
 
   /* Notify the caller that we are all setup */
   g_cond_signal (&thread_pool_worker->setup_cond);
@@ -360,7 +758,7 @@ dex_thread_pool_worker_thread_func (gpointer data)
   g_main_loop_run (thread_pool_worker->main_loop);
 
   /* Discard our work queue loop */
-  dex_clear (&global_work_queue_loop);
+  dex_clear (&thread_pool_worker->global_work_queue_loop);
 
   /* Flush out any pending operations */
   while (g_main_context_pending (thread_pool_worker->main_context))
@@ -370,10 +768,12 @@ dex_thread_pool_worker_thread_func (gpointer data)
   dex_thread_pool_worker_set_remove (thread_pool_worker->set, thread_pool_worker);
 
   /* Ensure our sources will not continue on */
+  g_source_destroy (thread_pool_worker->inbox_source);
   g_source_destroy (thread_pool_worker->set_source);
   g_source_destroy (thread_pool_worker->local_source);
   g_source_destroy (thread_pool_worker->fiber_scheduler);
   g_source_destroy (thread_pool_worker->coroutine_scheduler);
+  dex_timer_queue_destroy (thread_pool_worker->timer_queue);
 
   thread_pool_worker->status = DEX_THREAD_POOL_WORKER_FINISHED;
   g_main_context_pop_thread_default (thread_pool_worker->main_context);
@@ -385,28 +785,90 @@ dex_thread_pool_worker_thread_func (gpointer data)
   return NULL;
 }
 
-static gboolean
-dex_thread_pool_worker_maybe_steal (DexThreadPoolWorker *thread_pool_worker,
-                                    DexThreadPoolWorker *neighbor)
+static DexThreadPoolWorkerPeer *
+dex_thread_pool_worker_peer_new (DexThreadPoolWorker *thread_pool_worker)
 {
-  DexWorkItem work_item;
+  DexThreadPoolWorkerPeer *peer;
 
-  g_assert (DEX_IS_THREAD_POOL_WORKER (thread_pool_worker));
-  g_assert (DEX_IS_THREAD_POOL_WORKER (neighbor));
+  peer = g_atomic_rc_box_new0 (DexThreadPoolWorkerPeer);
+  peer->work_stealing_queue = dex_work_stealing_queue_ref (thread_pool_worker->work_stealing_queue);
+  peer->main_context = g_main_context_ref (thread_pool_worker->main_context);
+  atomic_init (&peer->idle, FALSE);
 
-  if (dex_work_stealing_queue_steal (neighbor->work_stealing_queue, &work_item))
-    {
-      dex_work_item_invoke (&work_item);
-      return TRUE;
-    }
+  return peer;
+}
 
-  return FALSE;
+static DexThreadPoolWorkerPeer *
+dex_thread_pool_worker_peer_ref (DexThreadPoolWorkerPeer *peer)
+{
+  return g_atomic_rc_box_acquire (peer);
+}
+
+static void
+dex_thread_pool_worker_peer_finalize (gpointer data)
+{
+  DexThreadPoolWorkerPeer *peer = data;
+
+  g_clear_pointer (&peer->work_stealing_queue, dex_work_stealing_queue_unref);
+  g_clear_pointer (&peer->main_context, g_main_context_unref);
+}
+
+static void
+dex_thread_pool_worker_peer_unref (DexThreadPoolWorkerPeer *peer)
+{
+  g_atomic_rc_box_release_full (peer, dex_thread_pool_worker_peer_finalize);
+}
+
+/* An immutable copy of the peers in a set. Stealing and waking only ever
+ * look at the current snapshot, which is replaced whenever a worker is
+ * added or removed, so neither has to take a lock.
+ */
+typedef struct _DexThreadPoolWorkerSnapshot
+{
+  guint                    n_peers;
+  DexThreadPoolWorkerPeer *peers[];
+} DexThreadPoolWorkerSnapshot;
+
+static DexThreadPoolWorkerSnapshot *
+dex_thread_pool_worker_snapshot_new (GPtrArray *peers)
+{
+  DexThreadPoolWorkerSnapshot *snapshot;
+
+  snapshot = g_malloc (sizeof *snapshot + (peers->len * sizeof (DexThreadPoolWorkerPeer *)));
+  snapshot->n_peers = peers->len;
+
+  for (guint i = 0; i < peers->len; i++)
+    snapshot->peers[i] = dex_thread_pool_worker_peer_ref (g_ptr_array_index (peers, i));
+
+  return snapshot;
+}
+
+static void
+dex_thread_pool_worker_snapshot_free (DexThreadPoolWorkerSnapshot *snapshot)
+{
+  for (guint i = 0; i < snapshot->n_peers; i++)
+    dex_thread_pool_worker_peer_unref (snapshot->peers[i]);
+
+  g_free (snapshot);
 }
 
 typedef struct _DexThreadPoolWorkerSet
 {
-  GQueue  queue;
-  GRWLock rwlock;
+  _Atomic(DexThreadPoolWorkerSnapshot *) snapshot;
+  _Atomic(guint)                         n_idle;
+
+  /* Threads looking at the current snapshot announce themselves here
+   * first, see dex_thread_pool_worker_set_collect().
+   */
+  _Atomic(guint)                         n_readers;
+
+  /* Only used when adding or removing workers. Replaced snapshots may
+   * still be in use by a reader so they are kept in @garbage until none
+   * can be.
+   */
+  GMutex                                 mutex;
+  GPtrArray                             *peers;
+  GPtrArray                             *garbage;
 } DexThreadPoolWorkerSet;
 
 DexThreadPoolWorkerSet *
@@ -415,23 +877,112 @@ dex_thread_pool_worker_set_new (void)
   DexThreadPoolWorkerSet *set;
 
   set = g_atomic_rc_box_new0 (DexThreadPoolWorkerSet);
-  g_rw_lock_init (&set->rwlock);
+  g_mutex_init (&set->mutex);
+  set->peers = g_ptr_array_new_with_free_func ((GDestroyNotify)dex_thread_pool_worker_peer_unref);
+  set->garbage = g_ptr_array_new_with_free_func ((GDestroyNotify)dex_thread_pool_worker_snapshot_free);
+  atomic_init (&set->snapshot, dex_thread_pool_worker_snapshot_new (set->peers));
+  atomic_init (&set->n_idle, 0);
+  atomic_init (&set->n_readers, 0);
 
   return set;
 }
 
+static inline DexThreadPoolWorkerSnapshot *
+dex_thread_pool_worker_set_enter (DexThreadPoolWorkerSet *set)
+{
+  /* Pairs with the fence in dex_thread_pool_worker_set_collect_locked() */
+  atomic_fetch_add_explicit (&set->n_readers, 1, memory_order_seq_cst);
+
+  return atomic_load_explicit (&set->snapshot, memory_order_seq_cst);
+}
+
+static inline void
+dex_thread_pool_worker_set_leave (DexThreadPoolWorkerSet *set)
+{
+  atomic_fetch_sub_explicit (&set->n_readers, 1, memory_order_release);
+}
+
+/* Frees replaced snapshots once no reader may still be looking at them.
+ *
+ * Readers announce themselves in n_readers before loading the snapshot.
+ * If there are none after the replacement was published, any reader that
+ * comes later is guaranteed to see the new snapshot. Otherwise they are
+ * kept until the next time this is called.
+ *
+ * Must be called with the set's mutex held.
+ */
+static void
+dex_thread_pool_worker_set_collect_locked (DexThreadPoolWorkerSet *set)
+{
+  if (set->garbage->len == 0)
+    return;
+
+  atomic_thread_fence (memory_order_seq_cst);
+
+  if (atomic_load_explicit (&set->n_readers, memory_order_acquire) == 0)
+    g_ptr_array_set_size (set->garbage, 0);
+}
+
+/* Called by workers on their way to sleep, which is when they are sure
+ * not to be reading a snapshot themselves.
+ */
+static void
+dex_thread_pool_worker_set_collect (DexThreadPoolWorkerSet *set)
+{
+  if (g_mutex_trylock (&set->mutex))
+    {
+      dex_thread_pool_worker_set_collect_locked (set);
+      g_mutex_unlock (&set->mutex);
+    }
+}
+
+/* Must be called with the set's mutex held */
+static void
+dex_thread_pool_worker_set_publish (DexThreadPoolWorkerSet *set)
+{
+  DexThreadPoolWorkerSnapshot *snapshot;
+
+  snapshot = dex_thread_pool_worker_snapshot_new (set->peers);
+  snapshot = atomic_exchange_explicit (&set->snapshot, snapshot, memory_order_seq_cst);
+  g_ptr_array_add (set->garbage, snapshot);
+
+  dex_thread_pool_worker_set_collect_locked (set);
+}
+
+static inline void
+dex_thread_pool_worker_set_mark_idle (DexThreadPoolWorkerSet  *set,
+                                      DexThreadPoolWorkerPeer *peer)
+{
+  if (!atomic_exchange_explicit (&peer->idle, TRUE, memory_order_acq_rel))
+    atomic_fetch_add_explicit (&set->n_idle, 1, memory_order_seq_cst);
+}
+
+/* Returns %TRUE if @peer was idle and it was us that changed that */
+static inline gboolean
+dex_thread_pool_worker_set_clear_idle (DexThreadPoolWorkerSet  *set,
+                                       DexThreadPoolWorkerPeer *peer)
+{
+  if (atomic_load_explicit (&peer->idle, memory_order_relaxed) &&
+      atomic_exchange_explicit (&peer->idle, FALSE, memory_order_acq_rel))
+    {
+      atomic_fetch_sub_explicit (&set->n_idle, 1, memory_order_relaxed);
+      return TRUE;
+    }
+
+  return FALSE;
+}
+
 static void
 dex_thread_pool_worker_set_add (DexThreadPoolWorkerSet *set,
                                 DexThreadPoolWorker    *thread_pool_worker)
 {
   g_return_if_fail (set != NULL);
   g_return_if_fail (DEX_IS_THREAD_POOL_WORKER (thread_pool_worker));
-  g_return_if_fail (thread_pool_worker->set_link.prev == NULL);
-  g_return_if_fail (thread_pool_worker->set_link.next == NULL);
 
-  g_rw_lock_writer_lock (&set->rwlock);
-  g_queue_push_tail_link (&set->queue, &thread_pool_worker->set_link);
-  g_rw_lock_writer_unlock (&set->rwlock);
+  g_mutex_lock (&set->mutex);
+  g_ptr_array_add (set->peers, dex_thread_pool_worker_peer_ref (thread_pool_worker->peer));
+  dex_thread_pool_worker_set_publish (set);
+  g_mutex_unlock (&set->mutex);
 }
 
 static void
@@ -441,9 +992,12 @@ dex_thread_pool_worker_set_remove (DexThreadPoolWorkerSet *set,
   g_return_if_fail (set != NULL);
   g_return_if_fail (DEX_IS_THREAD_POOL_WORKER (thread_pool_worker));
 
-  g_rw_lock_writer_lock (&set->rwlock);
-  g_queue_unlink (&set->queue, &thread_pool_worker->set_link);
-  g_rw_lock_writer_unlock (&set->rwlock);
+  g_mutex_lock (&set->mutex);
+  if (g_ptr_array_remove (set->peers, thread_pool_worker->peer))
+    dex_thread_pool_worker_set_publish (set);
+  g_mutex_unlock (&set->mutex);
+
+  dex_thread_pool_worker_set_clear_idle (set, thread_pool_worker->peer);
 }
 
 DexThreadPoolWorkerSet *
@@ -458,10 +1012,10 @@ dex_thread_pool_worker_set_finalize (gpointer data)
 {
   DexThreadPoolWorkerSet *set = data;
 
-  while (set->queue.length > 0)
-    dex_thread_pool_worker_set_remove (set, g_queue_peek_head (&set->queue));
-
-  g_rw_lock_clear (&set->rwlock);
+  dex_thread_pool_worker_snapshot_free (atomic_load (&set->snapshot));
+  g_clear_pointer (&set->garbage, g_ptr_array_unref);
+  g_clear_pointer (&set->peers, g_ptr_array_unref);
+  g_mutex_clear (&set->mutex);
 }
 
 void
@@ -470,26 +1024,102 @@ dex_thread_pool_worker_set_unref (DexThreadPoolWorkerSet *set)
   g_atomic_rc_box_release_full (set, dex_thread_pool_worker_set_finalize);
 }
 
-static inline void
-dex_thread_pool_worker_set_foreach (DexThreadPoolWorkerSet *set,
-                                    DexThreadPoolWorker    *head)
+/* Returns %TRUE if a peer of @thread_pool_worker has work items which
+ * could be stolen.
+ */
+static gboolean
+dex_thread_pool_worker_set_has_work (DexThreadPoolWorkerSet *set,
+                                     DexThreadPoolWorker    *thread_pool_worker)
 {
-  g_rw_lock_reader_lock (&set->rwlock);
+  DexThreadPoolWorkerSnapshot *snapshot;
+  gboolean ret = FALSE;
+
+  snapshot = dex_thread_pool_worker_set_enter (set);
 
-  for (const GList *iter = head->set_link.next; iter; iter = iter->next)
+  for (guint i = 0; i < snapshot->n_peers; i++)
     {
-      if (dex_thread_pool_worker_maybe_steal (head, iter->data))
-        goto unlock;
+      DexThreadPoolWorkerPeer *peer = snapshot->peers[i];
+
+      if (peer != thread_pool_worker->peer &&
+          !dex_work_stealing_queue_empty (peer->work_stealing_queue))
+        {
+          ret = TRUE;
+          break;
+        }
     }
 
-  for (const GList *iter = set->queue.head; iter->data != head; iter = iter->next)
+  dex_thread_pool_worker_set_leave (set);
+
+  return ret;
+}
+
+/* Returns %TRUE if any worker in @set has items waiting in its own
+ * queue, such as when it is blocked and nobody has stolen them yet.
+ */
+gboolean
+dex_thread_pool_worker_set_has_pending (DexThreadPoolWorkerSet *set)
+{
+  DexThreadPoolWorkerSnapshot *snapshot;
+  gboolean ret = FALSE;
+
+  g_return_val_if_fail (set != NULL, FALSE);
+
+  snapshot = dex_thread_pool_worker_set_enter (set);
+
+  for (guint i = 0; i < snapshot->n_peers; i++)
     {
-      if (dex_thread_pool_worker_maybe_steal (head, iter->data))
-        goto unlock;
+      if (!dex_work_stealing_queue_empty (snapshot->peers[i]->work_stealing_queue))
+        {
+          ret = TRUE;
+          break;
+        }
     }
 
-unlock:
-  g_rw_lock_reader_unlock (&set->rwlock);
+  dex_thread_pool_worker_set_leave (set);
+
+  return ret;
+}
+
+/* Returns the number of workers in @set which are asleep until a peer
+ * wakes them up to steal.
+ */
+guint
+dex_thread_pool_worker_set_get_n_idle (DexThreadPoolWorkerSet *set)
+{
+  g_return_val_if_fail (set != NULL, 0);
+
+  return atomic_load_explicit (&set->n_idle, memory_order_relaxed);
+}
+
+static void
+dex_thread_pool_worker_set_wake_one (DexThreadPoolWorkerSet *set,
+                                     DexThreadPoolWorker    *thread_pool_worker)
+{
+  DexThreadPoolWorkerSnapshot *snapshot;
+
+  /* Pairs with the fence in dex_thread_pool_worker_set_source_prepare()
+   * so that either we see the peer is idle or it sees our work items.
+   */
+  atomic_thread_fence (memory_order_seq_cst);
+
+  if G_LIKELY (atomic_load_explicit (&set->n_idle, memory_order_relaxed) == 0)
+    return;
+
+  snapshot = dex_thread_pool_worker_set_enter (set);
+
+  for (guint i = 0; i < snapshot->n_peers; i++)
+    {
+      DexThreadPoolWorkerPeer *peer = snapshot->peers[i];
+
+      if (peer != thread_pool_worker->peer &&
+          dex_thread_pool_worker_set_clear_idle (set, peer))
+        {
+          g_main_context_wakeup (peer->main_context);
+          break;
+        }
+    }
+
+  dex_thread_pool_worker_set_leave (set);
 }
 
 typedef struct _DexThreadPoolWorkerSetSource
@@ -497,13 +1127,150 @@ typedef struct _DexThreadPoolWorkerSetSource
   GSource                 parent_source;
   DexThreadPoolWorkerSet *set;
   DexThreadPoolWorker    *thread_pool_worker;
+  guint32                 rand_state;
+  int                     backoff_msec;
 } DexThreadPoolWorkerSetSource;
 
+static inline guint32
+dex_thread_pool_worker_set_source_rand (DexThreadPoolWorkerSetSource *real_source)
+{
+  guint32 x = real_source->rand_state;
+
+  /* xorshift32, only used to spread thieves over their victims */
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+
+  return real_source->rand_state = x;
+}
+
+static inline void
+dex_thread_pool_worker_set_source_backoff (DexThreadPoolWorkerSetSource *real_source)
+{
+  if (real_source->backoff_msec <= STEAL_BACKOFF_MAX_MSEC)
+    real_source->backoff_msec = MAX (1, real_source->backoff_msec * 2);
+}
+
+static gboolean
+dex_thread_pool_worker_set_source_steal (DexThreadPoolWorkerSetSource *real_source)
+{
+  DexThreadPoolWorker *thread_pool_worker = real_source->thread_pool_worker;
+  DexThreadPoolWorkerSnapshot *snapshot;
+  DexWorkItem work_item;
+  gboolean stolen = FALSE;
+  guint offset;
+
+  snapshot = dex_thread_pool_worker_set_enter (real_source->set);
+
+  /* Start with a random peer so that idle workers spread out rather
+   * than all going after the same victim.
+   */
+  if (snapshot->n_peers > 0)
+    offset = dex_thread_pool_worker_set_source_rand (real_source) % snapshot->n_peers;
+  else
+    offset = 0;
+
+  for (guint i = 0; i < snapshot->n_peers; i++)
+    {
+      DexThreadPoolWorkerPeer *peer = snapshot->peers[(offset + i) % snapshot->n_peers];
+
+      if (peer == thread_pool_worker->peer)
+        continue;
+
+      if (dex_work_stealing_queue_steal_half (peer->work_stealing_queue,
+                                              thread_pool_worker->work_stealing_queue,
+                                              &work_item))
+        {
+          stolen = TRUE;
+          break;
+        }
+    }
+
+  dex_thread_pool_worker_set_leave (real_source->set);
+
+  /* Run it once we no longer hold on to the snapshot */
+  if (stolen)
+    dex_work_item_invoke (&work_item);
+
+  return stolen;
+}
+
+static gboolean
+dex_thread_pool_worker_set_source_prepare (GSource *source,
+                                           int     *timeout)
+{
+  DexThreadPoolWorkerSetSource *real_source = (DexThreadPoolWorkerSetSource *)source;
+  DexThreadPoolWorker *thread_pool_worker = real_source->thread_pool_worker;
+  DexThreadPoolWorkerSet *set = real_source->set;
+
+  *timeout = -1;
+
+  /* Parked workers only process what is pushed to them directly, and
+   * there is no reason to look at peers while we have work of our own.
+   */
+  if (thread_pool_worker->parked ||
+      !dex_work_stealing_queue_empty (thread_pool_worker->work_stealing_queue))
+    return FALSE;
+
+  if (real_source->backoff_msec == 0)
+    {
+      if (dex_thread_pool_worker_set_has_work (set, thread_pool_worker))
+        return TRUE;
+
+      *timeout = 0;
+      return FALSE;
+    }
+
+  /* Wait until the backoff passes, or without a timeout once it has grown
+   * past STEAL_BACKOFF_MAX_MSEC. Either way we announce that we are idle
+   * and then look once more so that a peer pushing work concurrently
+   * either sees that and wakes us up or we see its work items here.
+   */
+  dex_thread_pool_worker_set_mark_idle (set, thread_pool_worker->peer);
+  atomic_thread_fence (memory_order_seq_cst);
+
+  if (real_source->backoff_msec <= STEAL_BACKOFF_MAX_MSEC)
+    {
+      if (dex_thread_pool_worker_set_has_work (set, thread_pool_worker))
+        {
+          dex_thread_pool_worker_set_clear_idle (set, thread_pool_worker->peer);
+          return TRUE;
+        }
+
+      *timeout = real_source->backoff_msec;
+      return FALSE;
+    }
+
+  if (dex_thread_pool_worker_set_has_work (set, thread_pool_worker))
+    {
+      dex_thread_pool_worker_set_clear_idle (set, thread_pool_worker->peer);
+      return TRUE;
+    }
+
+  dex_thread_pool_worker_set_collect (set);
+
+  return FALSE;
+}
+
 static gboolean
 dex_thread_pool_worker_set_source_check (GSource *source)
 {
-  /* We always check the peers for work */
-  return TRUE;
+  DexThreadPoolWorkerSetSource *real_source = (DexThreadPoolWorkerSetSource *)source;
+  DexThreadPoolWorker *thread_pool_worker = real_source->thread_pool_worker;
+
+  /* Whatever woke us up, we are no longer asleep */
+  dex_thread_pool_worker_set_clear_idle (real_source->set, thread_pool_worker->peer);
+
+  if (thread_pool_worker->parked ||
+      !dex_work_stealing_queue_empty (thread_pool_worker->work_stealing_queue))
+    return FALSE;
+
+  if (dex_thread_pool_worker_set_has_work (real_source->set, thread_pool_worker))
+    return TRUE;
+
+  dex_thread_pool_worker_set_source_backoff (real_source);
+
+  return FALSE;
 }
 
 static gboolean
@@ -512,11 +1279,20 @@ dex_thread_pool_worker_set_source_dispatch (GSource     *source,
                                             gpointer     callback_data)
 {
   DexThreadPoolWorkerSetSource *real_source = (DexThreadPoolWorkerSetSource *)source;
-  dex_thread_pool_worker_set_foreach (real_source->set, real_source->thread_pool_worker);
+
+  if (real_source->thread_pool_worker->parked)
+    return G_SOURCE_CONTINUE;
+
+  if (dex_thread_pool_worker_set_source_steal (real_source))
+    real_source->backoff_msec = 0;
+  else
+    dex_thread_pool_worker_set_source_backoff (real_source);
+
   return G_SOURCE_CONTINUE;
 }
 
 static GSourceFuncs dex_thread_pool_worker_set_source_funcs = {
+  .prepare = dex_thread_pool_worker_set_source_prepare,
   .check = dex_thread_pool_worker_set_source_check,
   .dispatch = dex_thread_pool_worker_set_source_dispatch,
 };
@@ -535,6 +1311,7 @@ dex_thread_pool_worker_set_create_source (DexThreadPoolWorkerSet *set,
   _g_source_set_static_name ((GSource *)source, "[dex-thread-pool-worker-set]");
   source->set = set;
   source->thread_pool_worker = thread_pool_worker;
+  source->rand_state = g_random_int () | 1;
 
   return (GSource *)source;
 }
@@ -554,8 +1331,10 @@ dex_thread_pool_worker_new (DexWorkQueue           *work_queue,
   thread_pool_worker->main_context = g_main_context_new ();
   thread_pool_worker->main_loop = g_main_loop_new (thread_pool_worker->main_context, FALSE);
   thread_pool_worker->global_work_queue = dex_ref (work_queue);
-  thread_pool_worker->work_stealing_queue = dex_work_stealing_queue_new (255);
-  thread_pool_worker->set = set;
+  thread_pool_worker->work_stealing_queue = dex_work_stealing_queue_new (WORK_STEALING_QUEUE_CAPACITY);
+  thread_pool_worker->peer = dex_thread_pool_worker_peer_new (thread_pool_worker);
+  thread_pool_worker->inbox_source = dex_thread_pool_worker_inbox_new ();
+  thread_pool_worker->set = dex_thread_pool_worker_set_ref (set);
   thread_pool_worker->force_create = !!force_create;
 
   /* Now spawn our thread to process events via GSource */
@@ -572,3 +1351,71 @@ dex_thread_pool_worker_new (DexWorkQueue           *work_queue,
 
   return thread_pool_worker;
 }
+
+/* Parked workers stop taking work items from the global work queue and
+ * stop stealing from their peers. They continue to process fibers,
+ * coroutines, and work items pushed directly to them so that anything
+ * already bound to the worker may complete.
+ */
+void
+dex_thread_pool_worker_park (DexThreadPoolWorker *thread_pool_worker)
+{
+  g_return_if_fail (DEX_IS_THREAD_POOL_WORKER (thread_pool_worker));
+
+  thread_pool_worker->parked_at = g_get_monotonic_time ();
+
+  dex_scheduler_push (DEX_SCHEDULER (thread_pool_worker),
+                      dex_thread_pool_worker_park_cb,
+                      thread_pool_worker);
+}
+
+void
+dex_thread_pool_worker_unpark (DexThreadPoolWorker *thread_pool_worker)
+{
+  g_return_if_fail (DEX_IS_THREAD_POOL_WORKER (thread_pool_worker));
+
+  dex_scheduler_push (DEX_SCHEDULER (thread_pool_worker),
+                      dex_thread_pool_worker_unpark_cb,
+                      thread_pool_worker);
+}
+
+/* Returns the monotonic time at which @thread_pool_worker was last
+ * parked. Must be called from the thread which parked it.
+ */
+gint64
+dex_thread_pool_worker_get_parked_at (DexThreadPoolWorker *thread_pool_worker)
+{
+  g_return_val_if_fail (DEX_IS_THREAD_POOL_WORKER (thread_pool_worker), 0);
+
+  return thread_pool_worker->parked_at;
+}
+
+/* Checks if nothing is bound to a parked worker anymore so that the
+ * caller may drop the last reference to it, exiting its thread.
+ *
+ * Blocks and anything else dispatching to the worker hold a reference
+ * to it, so only the caller may be holding one. Fibers and coroutines
+ * never migrate, and timers, queued work items and pending items in
+ * the inbox would all be lost. Must be called from the thread which
+ * parked @thread_pool_worker and owns the only reference.
+ *
+ * AIO which was started from a work item and is only awaited from
+ * another thread is not tracked and would be cancelled.
+ */
+gboolean
+dex_thread_pool_worker_is_quiescent (DexThreadPoolWorker *thread_pool_worker)
+{
+  DexThreadPoolWorkerInbox *inbox;
+
+  g_return_val_if_fail (DEX_IS_THREAD_POOL_WORKER (thread_pool_worker), FALSE);
+
+  inbox = (DexThreadPoolWorkerInbox *)thread_pool_worker->inbox_source;
+
+  return atomic_load (&DEX_OBJECT (thread_pool_worker)->ref_count) == 1 &&
+         atomic_load_explicit (&inbox->head, memory_order_acquire) == &inbox->stub &&
+         !atomic_load_explicit (&inbox->pending, memory_order_acquire) &&
+         dex_work_stealing_queue_empty (thread_pool_worker->work_stealing_queue) &&
+         dex_timer_queue_get_size (thread_pool_worker->timer_queue) == 0 &&
+         dex_fiber_scheduler_is_empty ((DexFiberScheduler *)thread_pool_worker->fiber_scheduler) &&
+         dex_coroutine_scheduler_is_empty ((DexCoroutineScheduler *)thread_pool_worker->coroutine_scheduler);
+}
@@ -23,12 +23,12 @@
 
 #include <gio/gio.h>
 
-#include "dex-compat-private.h"
 #include "dex-error.h"
 #include "dex-future-private.h"
-#include "dex-scheduler.h"
+#include "dex-scheduler-private.h"
 #include "dex-timeout.h"
 #include "dex-timeout-private.h"
+#include "dex-timer-queue-private.h"
 
 /**
  * DexTimeout:
@@ -39,9 +39,13 @@
 
 typedef struct _DexTimeout
 {
-  DexFuture parent_instance;
-  GSource *source;
-  DexFuture *future;
+  DexFuture      parent_instance;
+  DexTimerQueue *timer_queue;
+  DexFuture     *future;
+  gint64         deadline;
+  gint64         slack;
+  DexTimerNode   node;
+  guint          disarmed : 1;
 } DexTimeout;
 
 typedef struct _DexTimeoutClass
@@ -51,24 +55,89 @@ typedef struct _DexTimeoutClass
 
 DEX_DEFINE_FINAL_TYPE (DexTimeout, dex_timeout, DEX_TYPE_FUTURE)
 
+static void dex_timeout_expired (DexTimerNode *node,
+                                 gboolean      expired);
+
+/* Rounds the deadline up to a multiple of the slack so that timeouts
+ * in the same window share a deadline and therefore a single wakeup.
+ * Must be called with the timeout lock held.
+ */
+static inline gint64
+dex_timeout_get_effective_deadline (DexTimeout *timeout)
+{
+  gint64 deadline = timeout->deadline;
+  gint64 slack = timeout->slack;
+
+  if (slack <= 0 || deadline <= 0 || deadline > G_MAXINT64 - slack)
+    return deadline;
+
+  return ((deadline + slack - 1) / slack) * slack;
+}
+
+/* Timeouts are not armed until something is chained to them so that
+ * they end up on the scheduler of whoever is awaiting them and those
+ * which are discarded first never touch a main context.
+ */
 static void
-dex_timeout_clear_source (DexTimeout *timeout)
+dex_timeout_arm (DexTimeout *timeout)
 {
-  GSource *source = NULL;
+  DexScheduler *scheduler;
 
   g_assert (DEX_IS_TIMEOUT (timeout));
 
   dex_object_lock (timeout);
-  source = g_steal_pointer (&timeout->source);
-  dex_object_unlock (timeout);
 
-  if (source != NULL)
+  if (timeout->timer_queue != NULL ||
+      timeout->disarmed ||
+      DEX_FUTURE (timeout)->status != DEX_FUTURE_STATUS_PENDING)
     {
-      if (!g_source_is_destroyed (source))
-        g_source_destroy (source);
-
-      g_source_unref (source);
+      dex_object_unlock (timeout);
+      return;
     }
+
+  if (!(scheduler = dex_scheduler_get_thread_default ()))
+    scheduler = dex_scheduler_get_default ();
+
+  /* Every timeout on the scheduler shares a single GSource so the cost
+   * of an iteration of the main context does not grow with the number
+   * of timeouts pending.
+   */
+  timeout->timer_queue = dex_timer_queue_ref (dex_scheduler_get_timer_queue (scheduler));
+
+  /* Reference is owned by the queue until expired or removed */
+  dex_ref (timeout);
+  if (!dex_timer_queue_add (timeout->timer_queue,
+                            &timeout->node,
+                            dex_timeout_get_effective_deadline (timeout)))
+    dex_unref (timeout);
+
+  dex_object_unlock (timeout);
+}
+
+/* The timer queue holds a reference to @timeout while it is queued which
+ * is released here if we removed it before it expired.
+ */
+static void
+dex_timeout_disarm (DexTimeout *timeout)
+{
+  gboolean removed = FALSE;
+
+  g_assert (DEX_IS_TIMEOUT (timeout));
+
+  dex_object_lock (timeout);
+  timeout->disarmed = TRUE;
+  if (timeout->timer_queue != NULL)
+    removed = dex_timer_queue_remove (timeout->timer_queue, &timeout->node);
+  dex_object_unlock (timeout);
+
+  if (removed)
+    dex_unref (timeout);
+}
+
+static void
+dex_timeout_chained (DexFuture *future)
+{
+  dex_timeout_arm (DEX_TIMEOUT (future));
 }
 
 static void
@@ -76,7 +145,7 @@ dex_timeout_discard (DexFuture *future)
 {
   DexTimeout *timeout = DEX_TIMEOUT (future);
 
-  dex_timeout_clear_source (timeout);
+  dex_timeout_disarm (timeout);
 
   if (timeout->future != NULL)
     dex_future_discard (timeout->future, future);
@@ -93,7 +162,7 @@ dex_timeout_propagate (DexFuture *future,
 
   if (completed == timeout->future)
     {
-      dex_timeout_clear_source (timeout);
+      dex_timeout_disarm (timeout);
       dex_future_complete_from (future, completed);
       return TRUE;
     }
@@ -106,19 +175,10 @@ dex_timeout_finalize (DexObject *object)
 {
   DexTimeout *timeout = DEX_TIMEOUT (object);
 
-  if (timeout->source != NULL)
-    {
-      if (!g_source_is_destroyed (timeout->source))
-        {
-          g_critical ("%s destroyed while timer was active. "
-                      "This is likely a bug as no future is holding a reference to %p",
-                      DEX_OBJECT_TYPE_NAME (object), object);
-          g_source_destroy (timeout->source);
-        }
-
-      g_clear_pointer (&timeout->source, g_source_unref);
-    }
+  /* The timer queue holds a reference while queued */
+  g_assert (timeout->node.index == DEX_TIMER_NODE_UNQUEUED);
 
+  g_clear_pointer (&timeout->timer_queue, dex_timer_queue_unref);
   dex_clear (&timeout->future);
 
   DEX_OBJECT_CLASS (dex_timeout_parent_class)->finalize (object);
@@ -134,6 +194,7 @@ dex_timeout_class_init (DexTimeoutClass *timeout_class)
 
   future_class->propagate = dex_timeout_propagate;
   future_class->discard = dex_timeout_discard;
+  future_class->chained = dex_timeout_chained;
 }
 
 static void
@@ -142,21 +203,14 @@ dex_timeout_init (DexTimeout *timeout)
 }
 
 static void
-clear_weak_ref (gpointer data)
-{
-  dex_weak_ref_clear (data);
-  g_free (data);
-}
-
-static gboolean
-dex_timeout_source_func (gpointer data)
+dex_timeout_expired (DexTimerNode *node,
+                     gboolean      expired)
 {
-  DexWeakRef *wr = data;
-  DexTimeout *timeout = dex_weak_ref_get (wr);
+  DexTimeout *timeout = (DexTimeout *)(gpointer)((guint8 *)node - G_STRUCT_OFFSET (DexTimeout, node));
 
-  g_assert (!timeout || DEX_IS_TIMEOUT (timeout));
+  g_assert (DEX_IS_TIMEOUT (timeout));
 
-  if (timeout != NULL)
+  if (expired)
     {
       dex_future_complete (DEX_FUTURE (timeout),
                            NULL,
@@ -166,15 +220,10 @@ dex_timeout_source_func (gpointer data)
 
       if (timeout->future != NULL)
         dex_future_discard (timeout->future, DEX_FUTURE (timeout));
-
-      dex_object_lock (timeout);
-      g_clear_pointer (&timeout->source, g_source_unref);
-      dex_object_unlock (timeout);
-
-      dex_unref (timeout);
     }
 
-  return G_SOURCE_REMOVE;
+  /* Release the reference held by the timer queue */
+  dex_unref (timeout);
 }
 
 /**
@@ -183,49 +232,20 @@ dex_timeout_source_func (gpointer data)
  *
  * Creates a new timeout that will reject at a deadline.
  *
+ * The timer is not started until something awaits the timeout, such as
+ * `dex_await()` or [ctor@Dex.Future.first]. It then runs on the
+ * scheduler of the thread which first awaited it.
+ *
  * Returns: (transfer full):
  */
 DexFuture *
 dex_timeout_new_deadline (gint64 deadline)
 {
-  static const char *name;
-  DexScheduler *scheduler;
   DexTimeout *timeout;
-  DexWeakRef *wr;
-
-  if G_UNLIKELY (name == NULL)
-    name = g_intern_static_string ("[dex-timeout]");
 
   timeout = (DexTimeout *)dex_object_create_instance (DEX_TYPE_TIMEOUT);
-
-  wr = g_new0 (DexWeakRef, 1);
-  dex_weak_ref_init (wr, timeout);
-
-  timeout->source = g_timeout_source_new (0);
-  g_source_set_ready_time (timeout->source, deadline);
-  _g_source_set_static_name (timeout->source, name);
-  g_source_set_priority (timeout->source, G_PRIORITY_DEFAULT);
-  g_source_set_callback (timeout->source,
-                         dex_timeout_source_func,
-                         wr, clear_weak_ref);
-
-  if (!(scheduler = dex_scheduler_get_thread_default ()))
-    scheduler = dex_scheduler_get_default ();
-
-  /* TODO: Delay attaching until timeout is awaited.
-   *
-   * Currently, this attaches the GSource when the timeout is created. This
-   * can be the wrong thing to do when you are creating a bunch of futures and
-   * then want them to run on a specific scheduler.
-   *
-   * In that case, you probably want to delay arming the timeout until something
-   * on the thread has "awaited" it.
-   *
-   * Currently we don't have explicit awaiting though, so this will need to be
-   * implemented first before we can do the above work.
-   */
-
-  g_source_attach (timeout->source, dex_scheduler_get_main_context (scheduler));
+  timeout->deadline = deadline;
+  dex_timer_node_init (&timeout->node, dex_timeout_expired);
 
   return DEX_FUTURE (timeout);
 }
@@ -336,7 +356,68 @@ dex_timeout_postpone_until (DexTimeout *timeout,
   g_return_if_fail (DEX_IS_TIMEOUT (timeout));
 
   dex_object_lock (timeout);
-  if (timeout->source != NULL)
-    g_source_set_ready_time (timeout->source, deadline);
+  timeout->deadline = deadline;
+  if (timeout->timer_queue != NULL)
+    dex_timer_queue_reschedule (timeout->timer_queue,
+                                &timeout->node,
+                                dex_timeout_get_effective_deadline (timeout));
+  dex_object_unlock (timeout);
+}
+
+/**
+ * dex_timeout_set_slack:
+ * @timeout: a [class@Dex.Timeout]
+ * @slack: the slack in microseconds, or 0 for none
+ *
+ * Allows @timeout to complete up to @slack microseconds after its
+ * deadline.
+ *
+ * The deadline is rounded up to a multiple of @slack in the monotonic
+ * clock. Timeouts on the same scheduler which fall within the same
+ * window therefore complete together with a single wakeup, much like
+ * [func@GLib.timeout_add_seconds] does for seconds.
+ *
+ * This is useful for timeouts such as watchdogs which do not need to
+ * be precise and may be numerous.
+ *
+ * Since: 1.2
+ */
+void
+dex_timeout_set_slack (DexTimeout *timeout,
+                       gint64      slack)
+{
+  g_return_if_fail (DEX_IS_TIMEOUT (timeout));
+  g_return_if_fail (slack >= 0);
+
+  dex_object_lock (timeout);
+  timeout->slack = slack;
+  if (timeout->timer_queue != NULL)
+    dex_timer_queue_reschedule (timeout->timer_queue,
+                                &timeout->node,
+                                dex_timeout_get_effective_deadline (timeout));
   dex_object_unlock (timeout);
 }
+
+/**
+ * dex_timeout_get_slack:
+ * @timeout: a [class@Dex.Timeout]
+ *
+ * Gets the slack set with [method@Dex.Timeout.set_slack].
+ *
+ * Returns: the slack in microseconds
+ *
+ * Since: 1.2
+ */
+gint64
+dex_timeout_get_slack (DexTimeout *timeout)
+{
+  gint64 slack;
+
+  g_return_val_if_fail (DEX_IS_TIMEOUT (timeout), 0);
+
+  dex_object_lock (timeout);
+  slack = timeout->slack;
+  dex_object_unlock (timeout);
+
+  return slack;
+}
@@ -48,6 +48,11 @@ DexFuture *dex_timeout_new_usec       (gint64      usec);
 DEX_AVAILABLE_IN_ALL
 void       dex_timeout_postpone_until (DexTimeout *timeout,
                                        gint64      deadline);
+DEX_AVAILABLE_IN_1_2
+void       dex_timeout_set_slack      (DexTimeout *timeout,
+                                       gint64      slack);
+DEX_AVAILABLE_IN_1_2
+gint64     dex_timeout_get_slack      (DexTimeout *timeout);
 
 G_DEFINE_AUTOPTR_CLEANUP_FUNC (DexTimeout, dex_unref)
 
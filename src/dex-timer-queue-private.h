@@ -0,0 +1,73 @@
+/*
+ * dex-timer-queue-private.h
+ *
+ * Copyright 2026 Christian Hergert
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of the
+ * License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#pragma once
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+#define DEX_TIMER_NODE_UNQUEUED G_MAXUINT
+
+typedef struct _DexTimerNode  DexTimerNode;
+typedef struct _DexTimerQueue DexTimerQueue;
+
+/* Called from the thread iterating the queue's GMainContext after the
+ * node has been removed from the queue. @expired is %FALSE if the queue
+ * was destroyed instead and the node will never fire.
+ */
+typedef void (*DexTimerFunc) (DexTimerNode *node,
+                              gboolean      expired);
+
+/* Embedded within the structure that owns the timer. All fields but
+ * @func are protected by the lock of the queue the node is added to.
+ */
+struct _DexTimerNode
+{
+  gint64       deadline;
+  guint        index;
+  DexTimerFunc func;
+};
+
+DexTimerQueue *dex_timer_queue_new        (void);
+DexTimerQueue *dex_timer_queue_ref        (DexTimerQueue *timer_queue);
+void           dex_timer_queue_unref      (DexTimerQueue *timer_queue);
+void           dex_timer_queue_destroy    (DexTimerQueue *timer_queue);
+gboolean       dex_timer_queue_add        (DexTimerQueue *timer_queue,
+                                           DexTimerNode  *node,
+                                           gint64         deadline);
+gboolean       dex_timer_queue_remove     (DexTimerQueue *timer_queue,
+                                           DexTimerNode  *node);
+gboolean       dex_timer_queue_reschedule (DexTimerQueue *timer_queue,
+                                           DexTimerNode  *node,
+                                           gint64         deadline);
+guint          dex_timer_queue_get_size   (DexTimerQueue *timer_queue);
+
+static inline void
+dex_timer_node_init (DexTimerNode *node,
+                     DexTimerFunc  func)
+{
+  node->deadline = 0;
+  node->index = DEX_TIMER_NODE_UNQUEUED;
+  node->func = func;
+}
+
+G_END_DECLS
@@ -0,0 +1,415 @@
+/*
+ * dex-timer-queue.c
+ *
+ * Copyright 2026 Christian Hergert
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of the
+ * License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#include "config.h"
+
+#include "dex-compat-private.h"
+#include "dex-timer-queue-private.h"
+
+/* A DexTimerQueue is a single GSource per scheduler which holds every
+ * pending timer in a binary min-heap ordered by deadline. The ready time
+ * of the source tracks the root of the heap so the GMainContext only ever
+ * sees one timer no matter how many are pending.
+ *
+ * Adding, removing and rescheduling a timer is O(log n) and never touches
+ * the GMainContext unless the earliest deadline changes. Everything that
+ * has expired is removed in batches and dispatched together.
+ *
+ * Timers may be added, removed and rescheduled from any thread.
+ */
+
+/* Number of expired nodes to take per acquisition of the lock */
+#define EXPIRE_BATCH_SIZE 64
+
+struct _DexTimerQueue
+{
+  GSource        source;
+  GMutex         mutex;
+  DexTimerNode **heap;
+  guint          len;
+  guint          allocated;
+  gint64         ready_time;
+  guint          destroyed : 1;
+};
+
+static inline gboolean
+dex_timer_queue_less (DexTimerQueue *timer_queue,
+                      guint          a,
+                      guint          b)
+{
+  return timer_queue->heap[a]->deadline < timer_queue->heap[b]->deadline;
+}
+
+static inline void
+dex_timer_queue_set (DexTimerQueue *timer_queue,
+                     guint          index,
+                     DexTimerNode  *node)
+{
+  timer_queue->heap[index] = node;
+  node->index = index;
+}
+
+static void
+dex_timer_queue_sift_up (DexTimerQueue *timer_queue,
+                         guint          index)
+{
+  DexTimerNode *node = timer_queue->heap[index];
+
+  while (index > 0)
+    {
+      guint parent = (index - 1) / 2;
+
+      if (timer_queue->heap[parent]->deadline <= node->deadline)
+        break;
+
+      dex_timer_queue_set (timer_queue, index, timer_queue->heap[parent]);
+      index = parent;
+    }
+
+  dex_timer_queue_set (timer_queue, index, node);
+}
+
+static void
+dex_timer_queue_sift_down (DexTimerQueue *timer_queue,
+                           guint          index)
+{
+  DexTimerNode *node = timer_queue->heap[index];
+
+  for (;;)
+    {
+      guint child = (index * 2) + 1;
+
+      if (child >= timer_queue->len)
+        break;
+
+      if (child + 1 < timer_queue->len &&
+          dex_timer_queue_less (timer_queue, child + 1, child))
+        child++;
+
+      if (node->deadline <= timer_queue->heap[child]->deadline)
+        break;
+
+      dex_timer_queue_set (timer_queue, index, timer_queue->heap[child]);
+      index = child;
+    }
+
+  dex_timer_queue_set (timer_queue, index, node);
+}
+
+/* Moves @node into position after its deadline changed */
+static void
+dex_timer_queue_sift (DexTimerQueue *timer_queue,
+                      guint          index)
+{
+  if (index > 0 &&
+      timer_queue->heap[index]->deadline < timer_queue->heap[(index - 1) / 2]->deadline)
+    dex_timer_queue_sift_up (timer_queue, index);
+  else
+    dex_timer_queue_sift_down (timer_queue, index);
+}
+
+static void
+dex_timer_queue_take (DexTimerQueue *timer_queue,
+                      DexTimerNode  *node)
+{
+  guint index = node->index;
+  DexTimerNode *last;
+
+  g_assert (index < timer_queue->len);
+  g_assert (timer_queue->heap[index] == node);
+
+  node->index = DEX_TIMER_NODE_UNQUEUED;
+
+  last = timer_queue->heap[--timer_queue->len];
+  timer_queue->heap[timer_queue->len] = NULL;
+
+  if (last != node)
+    {
+      dex_timer_queue_set (timer_queue, index, last);
+      dex_timer_queue_sift (timer_queue, index);
+    }
+}
+
+/* Must be called with the lock held so that the ready time cannot be
+ * set out of order with changes to the heap.
+ */
+static void
+dex_timer_queue_update_ready_time (DexTimerQueue *timer_queue)
+{
+  gint64 ready_time = timer_queue->len > 0 ? timer_queue->heap[0]->deadline : -1;
+
+  if (ready_time != timer_queue->ready_time && !timer_queue->destroyed)
+    {
+      timer_queue->ready_time = ready_time;
+      g_source_set_ready_time ((GSource *)timer_queue, ready_time);
+    }
+}
+
+static gboolean
+dex_timer_queue_dispatch (GSource     *source,
+                          GSourceFunc  callback,
+                          gpointer     user_data)
+{
+  DexTimerQueue *timer_queue = (DexTimerQueue *)source;
+  DexTimerNode *expired[EXPIRE_BATCH_SIZE];
+  gint64 now = g_source_get_time (source);
+  guint n_expired;
+
+  do
+    {
+      n_expired = 0;
+
+      g_mutex_lock (&timer_queue->mutex);
+      while (n_expired < G_N_ELEMENTS (expired) &&
+             timer_queue->len > 0 &&
+             timer_queue->heap[0]->deadline <= now)
+        {
+          DexTimerNode *node = timer_queue->heap[0];
+
+          dex_timer_queue_take (timer_queue, node);
+          expired[n_expired++] = node;
+        }
+      dex_timer_queue_update_ready_time (timer_queue);
+      g_mutex_unlock (&timer_queue->mutex);
+
+      /* Nodes are no longer queued, so the owner will not try to remove
+       * them out from under us and the callback inherits the reference
+       * the owner holds while queued.
+       */
+      for (guint i = 0; i < n_expired; i++)
+        expired[i]->func (expired[i], TRUE);
+    }
+  while (n_expired == G_N_ELEMENTS (expired));
+
+  return G_SOURCE_CONTINUE;
+}
+
+static void
+dex_timer_queue_finalize (GSource *source)
+{
+  DexTimerQueue *timer_queue = (DexTimerQueue *)source;
+
+  g_assert (timer_queue->len == 0);
+
+  g_clear_pointer (&timer_queue->heap, g_free);
+  g_mutex_clear (&timer_queue->mutex);
+}
+
+static GSourceFuncs dex_timer_queue_source_funcs = {
+  .dispatch = dex_timer_queue_dispatch,
+  .finalize = dex_timer_queue_finalize,
+};
+
+DexTimerQueue *
+dex_timer_queue_new (void)
+{
+  static const char *name;
+  DexTimerQueue *timer_queue;
+
+  if G_UNLIKELY (name == NULL)
+    name = g_intern_static_string ("[dex-timer-queue]");
+
+  timer_queue = (DexTimerQueue *)g_source_new (&dex_timer_queue_source_funcs,
+                                               sizeof *timer_queue);
+  g_mutex_init (&timer_queue->mutex);
+  timer_queue->ready_time = -1;
+
+  _g_source_set_static_name ((GSource *)timer_queue, name);
+  g_source_set_priority ((GSource *)timer_queue, G_PRIORITY_DEFAULT);
+
+  return timer_queue;
+}
+
+DexTimerQueue *
+dex_timer_queue_ref (DexTimerQueue *timer_queue)
+{
+  return (DexTimerQueue *)g_source_ref ((GSource *)timer_queue);
+}
+
+void
+dex_timer_queue_unref (DexTimerQueue *timer_queue)
+{
+  g_source_unref ((GSource *)timer_queue);
+}
+
+/**
+ * dex_timer_queue_add:
+ * @timer_queue: a #DexTimerQueue
+ * @node: a #DexTimerNode that is not queued
+ * @deadline: the deadline in the monotonic clock
+ *
+ * Queues @node so that its callback is run once @deadline has passed.
+ *
+ * The owner of @node must keep it alive until either the callback has
+ * run or dex_timer_queue_remove() returns %TRUE.
+ *
+ * Returns: %TRUE if @node was queued; otherwise %FALSE if @timer_queue
+ *   has been destroyed and @node will never expire.
+ */
+gboolean
+dex_timer_queue_add (DexTimerQueue *timer_queue,
+                     DexTimerNode  *node,
+                     gint64         deadline)
+{
+  g_assert (timer_queue != NULL);
+  g_assert (node != NULL);
+  g_assert (node->func != NULL);
+  g_assert (node->index == DEX_TIMER_NODE_UNQUEUED);
+
+  g_mutex_lock (&timer_queue->mutex);
+
+  if G_UNLIKELY (timer_queue->destroyed)
+    {
+      g_mutex_unlock (&timer_queue->mutex);
+      return FALSE;
+    }
+
+  if G_UNLIKELY (timer_queue->len == timer_queue->allocated)
+    {
+      timer_queue->allocated = MAX (16, timer_queue->allocated * 2);
+      timer_queue->heap = g_renew (DexTimerNode *, timer_queue->heap, timer_queue->allocated);
+    }
+
+  node->deadline = deadline;
+  dex_timer_queue_set (timer_queue, timer_queue->len++, node);
+  dex_timer_queue_sift_up (timer_queue, node->index);
+  dex_timer_queue_update_ready_time (timer_queue);
+
+  g_mutex_unlock (&timer_queue->mutex);
+
+  return TRUE;
+}
+
+/**
+ * dex_timer_queue_destroy:
+ * @timer_queue: a #DexTimerQueue
+ *
+ * Destroys the source and releases every node still queued by calling
+ * its callback with expired set to %FALSE. Nothing may be queued after
+ * this has been called.
+ *
+ * This must be called before the scheduler owning @timer_queue goes
+ * away as queued nodes are generally holding a reference to an object
+ * which in turn is holding a reference to @timer_queue.
+ */
+void
+dex_timer_queue_destroy (DexTimerQueue *timer_queue)
+{
+  DexTimerNode **heap;
+  guint len;
+
+  g_assert (timer_queue != NULL);
+
+  g_source_destroy ((GSource *)timer_queue);
+
+  g_mutex_lock (&timer_queue->mutex);
+  timer_queue->destroyed = TRUE;
+  heap = g_steal_pointer (&timer_queue->heap);
+  len = timer_queue->len;
+  timer_queue->len = 0;
+  timer_queue->allocated = 0;
+  for (guint i = 0; i < len; i++)
+    heap[i]->index = DEX_TIMER_NODE_UNQUEUED;
+  g_mutex_unlock (&timer_queue->mutex);
+
+  for (guint i = 0; i < len; i++)
+    heap[i]->func (heap[i], FALSE);
+
+  g_free (heap);
+}
+
+/**
+ * dex_timer_queue_remove:
+ * @timer_queue: a #DexTimerQueue
+ * @node: a #DexTimerNode
+ *
+ * Removes @node from @timer_queue if it has not yet expired.
+ *
+ * Returns: %TRUE if @node was removed and its callback will not be run,
+ *   otherwise %FALSE as the callback already ran or is about to.
+ */
+gboolean
+dex_timer_queue_remove (DexTimerQueue *timer_queue,
+                        DexTimerNode  *node)
+{
+  gboolean ret = FALSE;
+
+  g_assert (timer_queue != NULL);
+  g_assert (node != NULL);
+
+  g_mutex_lock (&timer_queue->mutex);
+  if (node->index != DEX_TIMER_NODE_UNQUEUED)
+    {
+      dex_timer_queue_take (timer_queue, node);
+      dex_timer_queue_update_ready_time (timer_queue);
+      ret = TRUE;
+    }
+  g_mutex_unlock (&timer_queue->mutex);
+
+  return ret;
+}
+
+/**
+ * dex_timer_queue_reschedule:
+ * @timer_queue: a #DexTimerQueue
+ * @node: a #DexTimerNode
+ * @deadline: the new deadline in the monotonic clock
+ *
+ * Moves @node to @deadline in place if it has not yet expired.
+ *
+ * Returns: %TRUE if @node was rescheduled; otherwise %FALSE
+ */
+gboolean
+dex_timer_queue_reschedule (DexTimerQueue *timer_queue,
+                            DexTimerNode  *node,
+                            gint64         deadline)
+{
+  gboolean ret = FALSE;
+
+  g_assert (timer_queue != NULL);
+  g_assert (node != NULL);
+
+  g_mutex_lock (&timer_queue->mutex);
+  if (node->index != DEX_TIMER_NODE_UNQUEUED)
+    {
+      node->deadline = deadline;
+      dex_timer_queue_sift (timer_queue, node->index);
+      dex_timer_queue_update_ready_time (timer_queue);
+      ret = TRUE;
+    }
+  g_mutex_unlock (&timer_queue->mutex);
+
+  return ret;
+}
+
+guint
+dex_timer_queue_get_size (DexTimerQueue *timer_queue)
+{
+  guint ret;
+
+  g_assert (timer_queue != NULL);
+
+  g_mutex_lock (&timer_queue->mutex);
+  ret = timer_queue->len;
+  g_mutex_unlock (&timer_queue->mutex);
+
+  return ret;
+}
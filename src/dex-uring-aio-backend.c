@@ -21,6 +21,8 @@
 #include "config.h"
 
 #include <errno.h>
+#include <stdatomic.h>
+#include <string.h>
 #include <sys/eventfd.h>
 #include <sys/utsname.h>
 #include <stdio.h>
@@ -33,7 +35,42 @@
 #include "dex-uring-future-private.h"
 #include "dex-uring-version.h"
 
-#define DEFAULT_URING_SIZE 32
+#define DEFAULT_SQ_SIZE     256
+#define DEFAULT_SQPOLL_IDLE 1000
+
+/* Completions for polls armed by dex_uring_aio_backend_poll() have the low
+ * bit set in their user_data, which is never set for a DexUringFuture.
+ * The generation changes every time the polls are armed again so that
+ * completions of removed polls are ignored.
+ */
+#define POLL_TAG                  1
+#define POLL_USER_DATA(gen, idx)  ((((guint64)(gen)) << 32) | (((guint64)(idx)) << 1) | POLL_TAG)
+#define POLL_INDEX(data)          ((guint)(((data) >> 1) & G_MAXINT32))
+
+typedef enum _DexUringFlags
+{
+  DEX_URING_FLAGS_COOP_TASKRUN  = 1 << 0,
+  DEX_URING_FLAGS_SINGLE_ISSUER = 1 << 1,
+  DEX_URING_FLAGS_DEFER_TASKRUN = 1 << 2,
+  DEX_URING_FLAGS_SQPOLL        = 1 << 3,
+} DexUringFlags;
+
+typedef struct _DexUringConfig
+{
+  guint sq_size;
+  guint cq_size;
+  guint sqpoll_idle;
+  guint flags;
+} DexUringConfig;
+
+static const GDebugKey uring_flag_keys[] = {
+  { "coop-taskrun", DEX_URING_FLAGS_COOP_TASKRUN },
+  { "single-issuer", DEX_URING_FLAGS_SINGLE_ISSUER },
+  { "defer-taskrun", DEX_URING_FLAGS_DEFER_TASKRUN },
+  { "sqpoll", DEX_URING_FLAGS_SQPOLL },
+};
+
+static DexUringConfig uring_config;
 
 struct _DexUringAioBackend
 {
@@ -48,17 +85,34 @@ struct _DexUringAioBackendClass
 
 typedef struct _DexUringAioContext
 {
-  DexAioContext    parent;
-  struct io_uring  ring;
-  int              eventfd;
-  gpointer         eventfdtag;
-  GMutex           mutex;
-  GQueue           queued;
-  guint            ring_initialized : 1;
+  DexAioContext             parent;
+  struct io_uring           ring;
+  int                       eventfd;
+  gpointer                  eventfdtag;
+  DexUringFuture * _Atomic  overflow;
+  GQueue                    pending;
+  DexUringRegistry          registry;
+  GArray                   *polls;
+  guint32                   poll_generation;
+  guint                     ring_initialized : 1;
+  guint                     defer_taskrun : 1;
 } DexUringAioContext;
 
+/* A poll armed by dex_uring_aio_backend_poll() for the GPollFD at the
+ * same index. @user_data is cleared once its completion has been seen.
+ */
+typedef struct _DexUringPoll
+{
+  int     fd;
+  gushort events;
+  guint64 user_data;
+} DexUringPoll;
+
 DEX_DEFINE_FINAL_TYPE (DexUringAioBackend, dex_uring_aio_backend, DEX_TYPE_AIO_BACKEND)
 
+static DexFuture *dex_uring_aio_context_queue (DexUringAioContext *aio_context,
+                                               DexUringFuture     *future);
+
 G_GNUC_UNUSED static gboolean
 dex_uring_check_kernel_version (int major,
                                 int minor)
@@ -92,6 +146,195 @@ dex_uring_check_kernel_version (int major,
          (kernel_major == major && kernel_minor >= minor);
 }
 
+static guint
+dex_uring_getenv_uint (const char *name,
+                       guint       default_value)
+{
+  const char *str = g_getenv (name);
+  guint64 value;
+
+  if (str == NULL ||
+      !g_ascii_string_to_unsigned (str, 10, 0, G_MAXUINT, &value, NULL))
+    return default_value;
+
+  return value;
+}
+
+/* The process-wide ring configuration may be tuned from the environment.
+ * Every aio context (one per scheduler thread) is created with it.
+ *
+ *   DEX_URING_SQ_SIZE      submission queue entries
+ *   DEX_URING_CQ_SIZE      completion queue entries, at least the SQ size
+ *   DEX_URING_SQPOLL_IDLE  milliseconds before an idle SQPOLL thread sleeps
+ *   DEX_URING_FLAGS        "coop-taskrun", "single-issuer", "defer-taskrun"
+ *                          and/or "sqpoll", replacing the defaults
+ *
+ * Flags the running kernel does not support are dropped.
+ */
+static const DexUringConfig *
+dex_uring_get_config (void)
+{
+  static gsize initialized;
+
+  if (g_once_init_enter (&initialized))
+    {
+      const char *flags = g_getenv ("DEX_URING_FLAGS");
+
+      uring_config.sq_size = dex_uring_getenv_uint ("DEX_URING_SQ_SIZE", DEFAULT_SQ_SIZE);
+      uring_config.cq_size = dex_uring_getenv_uint ("DEX_URING_CQ_SIZE", 0);
+      uring_config.sqpoll_idle = dex_uring_getenv_uint ("DEX_URING_SQPOLL_IDLE", DEFAULT_SQPOLL_IDLE);
+
+      if (flags != NULL)
+        uring_config.flags = g_parse_debug_string (flags,
+                                                   uring_flag_keys,
+                                                   G_N_ELEMENTS (uring_flag_keys));
+      else
+        uring_config.flags = DEX_URING_FLAGS_COOP_TASKRUN | DEX_URING_FLAGS_SINGLE_ISSUER;
+
+      if (uring_config.sq_size == 0)
+        uring_config.sq_size = DEFAULT_SQ_SIZE;
+
+      g_once_init_leave (&initialized, TRUE);
+    }
+
+  return &uring_config;
+}
+
+static guint
+dex_uring_config_get_setup_flags (const DexUringConfig *config)
+{
+  guint setup_flags = 0;
+
+  if (config->flags & DEX_URING_FLAGS_SQPOLL)
+    setup_flags |= IORING_SETUP_SQPOLL;
+
+  if (config->cq_size > config->sq_size)
+    setup_flags |= IORING_SETUP_CQSIZE;
+
+#if DEX_URING_CHECK_VERSION(2, 3)
+  /* Deferred task running requires a single issuer and cannot be used
+   * with SQPOLL since completions are only posted when we enter the ring.
+   */
+  if ((config->flags & DEX_URING_FLAGS_DEFER_TASKRUN) &&
+      !(config->flags & DEX_URING_FLAGS_SQPOLL) &&
+      dex_uring_check_kernel_version (6, 1))
+    return setup_flags | IORING_SETUP_DEFER_TASKRUN | IORING_SETUP_SINGLE_ISSUER;
+
+  if ((config->flags & DEX_URING_FLAGS_SINGLE_ISSUER) &&
+      dex_uring_check_kernel_version (6, 0))
+    setup_flags |= IORING_SETUP_SINGLE_ISSUER;
+#endif
+
+#if DEX_URING_CHECK_VERSION(2, 2)
+  if ((config->flags & DEX_URING_FLAGS_COOP_TASKRUN) &&
+      dex_uring_check_kernel_version (5, 19))
+    setup_flags |= IORING_SETUP_COOP_TASKRUN;
+#endif
+
+  return setup_flags;
+}
+
+static struct io_uring_sqe *
+dex_uring_aio_context_get_sqe (DexUringAioContext *aio_context)
+{
+  struct io_uring_sqe *sqe;
+
+  /* Submit what we have so far to make room if the SQ is full. If we
+   * still fail to get an sqe, we'll wait for completions to advance.
+   */
+  if G_UNLIKELY (!(sqe = io_uring_get_sqe (&aio_context->ring)))
+    {
+      io_uring_submit (&aio_context->ring);
+      sqe = io_uring_get_sqe (&aio_context->ring);
+    }
+
+  return sqe;
+}
+
+static void
+dex_uring_aio_context_cancel (DexUringAioContext *aio_context,
+                              DexUringFuture     *future)
+{
+#if DEX_URING_CHECK_VERSION(2, 3)
+  struct io_uring_sqe *sqe;
+
+  /* Submitted from prepare() along with anything else pending */
+  if G_LIKELY ((sqe = dex_uring_aio_context_get_sqe (aio_context)))
+    {
+      io_uring_prep_cancel (sqe, future, 0);
+      io_uring_sqe_set_data (sqe, NULL);
+    }
+#endif
+}
+
+/* A multishot request waiting for its channel to have room again */
+typedef struct _DexUringResume
+{
+  DexUringAioContext *aio_context;
+  DexUringFuture     *future;
+} DexUringResume;
+
+static DexUringResume *
+dex_uring_resume_new (DexUringAioContext *aio_context,
+                      DexUringFuture     *future)
+{
+  DexUringResume *resume;
+
+  resume = g_new0 (DexUringResume, 1);
+  resume->aio_context = (DexUringAioContext *)g_source_ref ((GSource *)aio_context);
+  resume->future = dex_ref (future);
+
+  return resume;
+}
+
+static void
+dex_uring_resume_free (DexUringResume *resume)
+{
+  g_clear_pointer ((GSource **)&resume->aio_context, g_source_unref);
+  dex_clear (&resume->future);
+  g_free (resume);
+}
+
+static DexFuture *
+dex_uring_aio_context_resume_cb (DexFuture *completed,
+                                 gpointer   user_data)
+{
+  DexUringResume *resume = user_data;
+
+  if (dex_uring_future_resume (resume->future))
+    dex_uring_aio_context_queue (resume->aio_context, resume->future);
+
+  return NULL;
+}
+
+/* Marks the poll @user_data was armed for as completed. Returns %FALSE
+ * if it was removed or its completion was already seen.
+ */
+static gboolean
+dex_uring_aio_context_take_poll (DexUringAioContext *aio_context,
+                                 guint64             user_data,
+                                 guint              *idx)
+{
+  DexUringPoll *entry;
+  guint i = POLL_INDEX (user_data);
+
+  if (aio_context->polls == NULL ||
+      i >= aio_context->polls->len)
+    return FALSE;
+
+  entry = &g_array_index (aio_context->polls, DexUringPoll, i);
+
+  if (entry->user_data != user_data)
+    return FALSE;
+
+  entry->user_data = 0;
+
+  if (idx != NULL)
+    *idx = i;
+
+  return TRUE;
+}
+
 static gboolean
 dex_uring_aio_context_dispatch (GSource     *source,
                                 GSourceFunc  callback,
@@ -109,6 +352,12 @@ dex_uring_aio_context_dispatch (GSource     *source,
         {
           /* Do mothing */
         }
+
+#if DEX_URING_CHECK_VERSION(2, 3)
+      /* Completions are not posted until we ask for them */
+      if (aio_context->defer_taskrun)
+        io_uring_get_events (&aio_context->ring);
+#endif
     }
 
 again:
@@ -116,7 +365,26 @@ again:
   while (io_uring_peek_cqe (&aio_context->ring, &cqe) == 0)
     {
       DexUringFuture *future = io_uring_cqe_get_data (cqe);
-      dex_uring_future_cqe (future, cqe);
+
+      /* Cancellation requests have no future attached. A poll armed
+       * while waiting may complete after the poll function looked, so
+       * make sure it is armed again.
+       */
+      if G_UNLIKELY (future == NULL || (cqe->user_data & POLL_TAG))
+        {
+          if (cqe->user_data & POLL_TAG)
+            dex_uring_aio_context_take_poll (aio_context, cqe->user_data, NULL);
+
+          io_uring_cqe_seen (&aio_context->ring, cqe);
+          continue;
+        }
+
+      /* Multishot requests keep the submission reference until their
+       * final completion, so take another for the handled stack.
+       */
+      if (!dex_uring_future_cqe (future, cqe))
+        dex_ref (future);
+
       io_uring_cqe_seen (&aio_context->ring, cqe);
       handledstack[n_handled++] = future;
 
@@ -127,7 +395,20 @@ again:
   for (guint i = 0; i < n_handled; i++)
     {
       DexUringFuture *future = handledstack[i];
+      DexFuture *resume;
+
       dex_uring_future_complete (future);
+
+      if G_UNLIKELY (dex_uring_future_take_cancel (future))
+        dex_uring_aio_context_cancel (aio_context, future);
+      else if G_UNLIKELY (dex_uring_future_take_resubmit (future))
+        dex_uring_aio_context_queue (aio_context, future);
+      else if G_UNLIKELY ((resume = dex_uring_future_take_resume (future)))
+        dex_future_disown (dex_future_finally (resume,
+                                               dex_uring_aio_context_resume_cb,
+                                               dex_uring_resume_new (aio_context, future),
+                                               (GDestroyNotify)dex_uring_resume_free));
+
       dex_unref (future);
     }
 
@@ -137,49 +418,71 @@ again:
   return G_SOURCE_CONTINUE;
 }
 
-static gboolean
-dex_uring_aio_context_prepare (GSource *source,
-                               int     *timeout)
+/* Moves futures queued from other threads into @pending, which is only
+ * touched by the thread owning @aio_context, and then fills the SQ from
+ * @pending for as long as there is room.
+ */
+static void
+dex_uring_aio_context_flush (DexUringAioContext *aio_context)
 {
-  DexUringAioContext *aio_context = (DexUringAioContext *)source;
-  gboolean do_submit;
+  DexUringFuture *stack;
 
-  g_assert (aio_context != NULL);
-  g_assert (DEX_IS_URING_AIO_BACKEND (aio_context->parent.aio_backend));
+  if ((stack = atomic_exchange_explicit (&aio_context->overflow, NULL, memory_order_acquire)))
+    {
+      GList *link = NULL;
 
-  *timeout = -1;
+      /* The stack is newest-first, so prepend to restore submission order */
+      while (stack != NULL)
+        {
+          DexUringFuture *next = dex_uring_future_get_next (stack);
 
-  g_mutex_lock (&aio_context->mutex);
+          dex_uring_future_set_next (stack, NULL);
+          link = g_list_prepend (link, stack);
+          stack = next;
+        }
 
-  do_submit = aio_context->queued.length > 0;
+      for (; link != NULL; link = g_list_delete_link (link, link))
+        g_queue_push_tail (&aio_context->pending, link->data);
+    }
 
-  while (aio_context->queued.length)
+  while (aio_context->pending.length > 0)
     {
       struct io_uring_sqe *sqe;
-      DexUringFuture *future;
+      DexUringFuture *future = g_queue_peek_head (&aio_context->pending);
 
-      /* Try to get the next sqe, and submit if we can't get
-       * one right away. If we still fail to get an sqe, then
-       * we'll wait for completions to come in to advance this.
-       */
-      if G_UNLIKELY (!(sqe = io_uring_get_sqe (&aio_context->ring)))
+      /* Completed without being submitted */
+      if (!dex_uring_future_prepare (future, &aio_context->ring, &aio_context->registry))
         {
-          io_uring_submit (&aio_context->ring);
-
-          if (!(sqe = io_uring_get_sqe (&aio_context->ring)))
-            break;
+          dex_unref (g_queue_pop_head (&aio_context->pending));
+          continue;
         }
 
-      future = g_queue_pop_head (&aio_context->queued);
-      dex_uring_future_sqe (future, sqe);
-      io_uring_sqe_set_data (sqe, dex_ref (future));
-      dex_unref (future);
+      if G_UNLIKELY (!(sqe = dex_uring_aio_context_get_sqe (aio_context)))
+        break;
+
+      /* Reference is transferred from @pending to the sqe */
+      future = g_queue_pop_head (&aio_context->pending);
+      dex_uring_future_sqe (future, &aio_context->ring, &aio_context->registry, sqe);
+      io_uring_sqe_set_data (sqe, future);
     }
+}
 
-  if (do_submit || io_uring_sq_ready (&aio_context->ring) > 0)
-    io_uring_submit (&aio_context->ring);
+static gboolean
+dex_uring_aio_context_prepare (GSource *source,
+                               int     *timeout)
+{
+  DexUringAioContext *aio_context = (DexUringAioContext *)source;
 
-  g_mutex_unlock (&aio_context->mutex);
+  g_assert (aio_context != NULL);
+  g_assert (DEX_IS_URING_AIO_BACKEND (aio_context->parent.aio_backend));
+
+  *timeout = -1;
+
+  dex_uring_aio_context_flush (aio_context);
+
+  /* Everything prepared since the last iteration goes in one submission */
+  if (io_uring_sq_ready (&aio_context->ring) > 0)
+    io_uring_submit (&aio_context->ring);
 
   return io_uring_cq_ready (&aio_context->ring) > 0;
 }
@@ -203,14 +506,17 @@ dex_uring_aio_context_finalize (GSource *source)
   g_assert (aio_context != NULL);
   g_assert (DEX_IS_URING_AIO_BACKEND (aio_context->parent.aio_backend));
 
-  if (aio_context->queued.length > 0)
+  if (aio_context->pending.length > 0 ||
+      atomic_load_explicit (&aio_context->overflow, memory_order_relaxed) != NULL)
     g_critical ("Destroying DexAioContext with queued items!");
 
   if (aio_context->ring_initialized)
     io_uring_queue_exit (&aio_context->ring);
 
+  dex_uring_registry_clear (&aio_context->registry);
+  g_clear_pointer (&aio_context->polls, g_array_unref);
+
   dex_clear (&aio_context->parent.aio_backend);
-  g_mutex_clear (&aio_context->mutex);
 
   if (aio_context->eventfd != -1)
     {
@@ -230,30 +536,53 @@ static DexFuture *
 dex_uring_aio_context_queue (DexUringAioContext *aio_context,
                              DexUringFuture     *future)
 {
-  gboolean is_same_thread;
   struct io_uring_sqe *sqe;
+  DexUringFuture *head;
 
   g_assert (aio_context != NULL);
   g_assert (DEX_IS_URING_AIO_BACKEND (aio_context->parent.aio_backend));
   g_assert (DEX_IS_URING_FUTURE (future));
 
-  is_same_thread = dex_thread_storage_get ()->aio_context == (DexAioContext *)aio_context;
-
-  g_mutex_lock (&aio_context->mutex);
-  if G_LIKELY (is_same_thread &&
-               aio_context->queued.length == 0 &&
-               (sqe = io_uring_get_sqe (&aio_context->ring)))
-    {
-      dex_uring_future_sqe (future, sqe);
-      io_uring_sqe_set_data (sqe, dex_ref (future));
-    }
-  else
+  if (dex_thread_storage_get ()->aio_context == (DexAioContext *)aio_context)
     {
-      g_queue_push_tail (&aio_context->queued, dex_ref (future));
+      /* Only this thread touches the ring, so no locking is necessary.
+       * The sqe is submitted along with others from prepare().
+       */
+      if G_LIKELY (aio_context->pending.length == 0)
+        {
+          if (!dex_uring_future_prepare (future, &aio_context->ring, &aio_context->registry))
+            return DEX_FUTURE (future);
+
+          if G_LIKELY ((sqe = io_uring_get_sqe (&aio_context->ring)))
+            {
+              dex_uring_future_sqe (future, &aio_context->ring, &aio_context->registry, sqe);
+              io_uring_sqe_set_data (sqe, dex_ref (future));
+              return DEX_FUTURE (future);
+            }
+        }
+
+      g_queue_push_tail (&aio_context->pending, dex_ref (future));
+
+      return DEX_FUTURE (future);
     }
-  g_mutex_unlock (&aio_context->mutex);
 
-  if (!is_same_thread)
+  /* Other threads push onto a lock-free stack which the owning thread
+   * takes all at once, so there is no ABA hazard.
+   */
+  dex_ref (future);
+  head = atomic_load_explicit (&aio_context->overflow, memory_order_relaxed);
+  do
+    dex_uring_future_set_next (future, head);
+  while (!atomic_compare_exchange_weak_explicit (&aio_context->overflow,
+                                                 &head,
+                                                 future,
+                                                 memory_order_release,
+                                                 memory_order_relaxed));
+
+  /* Only the push onto an empty stack needs to wake the owning thread,
+   * otherwise a wakeup is already pending which will take this too.
+   */
+  if (head == NULL)
     g_main_context_wakeup (g_source_get_context ((GSource *)aio_context));
 
   return DEX_FUTURE (future);
@@ -262,8 +591,9 @@ dex_uring_aio_context_queue (DexUringAioContext *aio_context,
 static DexAioContext *
 dex_uring_aio_backend_create_context (DexAioBackend *aio_backend)
 {
+  const DexUringConfig *config = dex_uring_get_config ();
   DexUringAioContext *aio_context;
-  guint uring_flags = 0;
+  struct io_uring_params params;
 
   g_assert (DEX_IS_URING_AIO_BACKEND (aio_backend));
 
@@ -275,23 +605,28 @@ dex_uring_aio_backend_create_context (DexAioBackend *aio_backend)
                   sizeof *aio_context);
   g_source_set_can_recurse ((GSource *)aio_context, TRUE);
   aio_context->parent.aio_backend = dex_ref (aio_backend);
-  g_mutex_init (&aio_context->mutex);
 
-#if DEX_URING_CHECK_VERSION(2, 2)
-  if (dex_uring_check_kernel_version (5, 19))
-    uring_flags |= IORING_SETUP_COOP_TASKRUN;
-#endif
+  aio_context->eventfd = -1;
 
-#if DEX_URING_CHECK_VERSION(2, 3)
-  if (dex_uring_check_kernel_version (6, 0))
-    uring_flags |= IORING_SETUP_SINGLE_ISSUER;
-#endif
+  memset (&params, 0, sizeof params);
+  params.flags = dex_uring_config_get_setup_flags (config);
+  params.sq_thread_idle = config->sqpoll_idle;
+  params.cq_entries = config->cq_size;
 
-  aio_context->eventfd = -1;
+  /* Setup uring submission/completion queue. If the configured setup is
+   * refused (such as SQPOLL without privileges) fall back to the defaults.
+   */
+  if (io_uring_queue_init_params (config->sq_size, &aio_context->ring, &params) != 0)
+    {
+      memset (&params, 0, sizeof params);
 
-  /* Setup uring submission/completion queue */
-  if (io_uring_queue_init (DEFAULT_URING_SIZE, &aio_context->ring, uring_flags) != 0)
-    goto failure;
+      if (io_uring_queue_init_params (DEFAULT_SQ_SIZE, &aio_context->ring, &params) != 0)
+        goto failure;
+    }
+
+#if DEX_URING_CHECK_VERSION(2, 3)
+  aio_context->defer_taskrun = !!(params.flags & IORING_SETUP_DEFER_TASKRUN);
+#endif
 
   aio_context->ring_initialized = TRUE;
 
@@ -367,6 +702,458 @@ dex_uring_aio_backend_write (DexAioBackend *aio_backend,
                                       dex_uring_future_new_write (fd, buffer, count, offset));
 }
 
+static DexFuture *
+dex_uring_aio_backend_fsync (DexAioBackend *aio_backend,
+                             DexAioContext *aio_context,
+                             int            fd,
+                             gboolean       datasync)
+{
+  return dex_uring_aio_context_queue ((DexUringAioContext *)aio_context,
+                                      dex_uring_future_new_fsync (fd, datasync));
+}
+
+static DexFuture *
+dex_uring_aio_backend_statx (DexAioBackend *aio_backend,
+                             DexAioContext *aio_context,
+                             int            dirfd,
+                             const char    *path,
+                             int            flags,
+                             guint          mask,
+                             struct statx  *statxbuf)
+{
+  return dex_uring_aio_context_queue ((DexUringAioContext *)aio_context,
+                                      dex_uring_future_new_statx (dirfd, path, flags, mask, statxbuf));
+}
+
+static DexFuture *
+dex_uring_aio_backend_fallocate (DexAioBackend *aio_backend,
+                                 DexAioContext *aio_context,
+                                 int            fd,
+                                 int            mode,
+                                 goffset        offset,
+                                 goffset        length)
+{
+  return dex_uring_aio_context_queue ((DexUringAioContext *)aio_context,
+                                      dex_uring_future_new_fallocate (fd, mode, offset, length));
+}
+
+static DexFuture *
+dex_uring_aio_backend_readv (DexAioBackend *aio_backend,
+                             DexAioContext *aio_context,
+                             int            fd,
+                             GInputVector  *vectors,
+                             guint          n_vectors,
+                             goffset        offset)
+{
+  return dex_uring_aio_context_queue ((DexUringAioContext *)aio_context,
+                                      dex_uring_future_new_readv (fd, vectors, n_vectors, offset));
+}
+
+static DexFuture *
+dex_uring_aio_backend_writev (DexAioBackend       *aio_backend,
+                              DexAioContext       *aio_context,
+                              int                  fd,
+                              const GOutputVector *vectors,
+                              guint                n_vectors,
+                              goffset              offset)
+{
+  return dex_uring_aio_context_queue ((DexUringAioContext *)aio_context,
+                                      dex_uring_future_new_writev (fd, vectors, n_vectors, offset));
+}
+
+static DexFuture *
+dex_uring_aio_backend_splice (DexAioBackend *aio_backend,
+                              DexAioContext *aio_context,
+                              int            fd_in,
+                              goffset        offset_in,
+                              int            fd_out,
+                              goffset        offset_out,
+                              gsize          length,
+                              guint          flags)
+{
+  return dex_uring_aio_context_queue ((DexUringAioContext *)aio_context,
+                                      dex_uring_future_new_splice (fd_in, offset_in,
+                                                                   fd_out, offset_out,
+                                                                   length, flags));
+}
+
+static DexFuture *
+dex_uring_aio_backend_renameat (DexAioBackend *aio_backend,
+                                DexAioContext *aio_context,
+                                int            old_dirfd,
+                                const char    *old_path,
+                                int            new_dirfd,
+                                const char    *new_path,
+                                guint          flags)
+{
+#if DEX_URING_CHECK_VERSION(2, 0)
+  return dex_uring_aio_context_queue ((DexUringAioContext *)aio_context,
+                                      dex_uring_future_new_renameat (old_dirfd, old_path,
+                                                                     new_dirfd, new_path,
+                                                                     flags));
+#else
+  return dex_future_new_reject (G_IO_ERROR,
+                                G_IO_ERROR_NOT_SUPPORTED,
+                                "renameat requires liburing 2.0");
+#endif
+}
+
+static DexFuture *
+dex_uring_aio_backend_unlinkat (DexAioBackend *aio_backend,
+                                DexAioContext *aio_context,
+                                int            dirfd,
+                                const char    *path,
+                                int            flags)
+{
+#if DEX_URING_CHECK_VERSION(2, 0)
+  return dex_uring_aio_context_queue ((DexUringAioContext *)aio_context,
+                                      dex_uring_future_new_unlinkat (dirfd, path, flags));
+#else
+  return dex_future_new_reject (G_IO_ERROR,
+                                G_IO_ERROR_NOT_SUPPORTED,
+                                "unlinkat requires liburing 2.0");
+#endif
+}
+
+static DexFuture *
+dex_uring_aio_backend_mkdirat (DexAioBackend *aio_backend,
+                               DexAioContext *aio_context,
+                               int            dirfd,
+                               const char    *path,
+                               int            mode)
+{
+#if DEX_URING_CHECK_VERSION(2, 1)
+  return dex_uring_aio_context_queue ((DexUringAioContext *)aio_context,
+                                      dex_uring_future_new_mkdirat (dirfd, path, mode));
+#else
+  return dex_future_new_reject (G_IO_ERROR,
+                                G_IO_ERROR_NOT_SUPPORTED,
+                                "mkdirat requires liburing 2.1");
+#endif
+}
+
+static DexFuture *
+dex_uring_aio_backend_accept (DexAioBackend   *aio_backend,
+                              DexAioContext   *aio_context,
+                              int              fd,
+                              struct sockaddr *addr,
+                              socklen_t       *addrlen,
+                              int              flags)
+{
+  return dex_uring_aio_context_queue ((DexUringAioContext *)aio_context,
+                                      dex_uring_future_new_accept (fd, addr, addrlen, flags));
+}
+
+static DexFuture *
+dex_uring_aio_backend_connect (DexAioBackend         *aio_backend,
+                               DexAioContext         *aio_context,
+                               int                    fd,
+                               const struct sockaddr *addr,
+                               socklen_t              addrlen)
+{
+  return dex_uring_aio_context_queue ((DexUringAioContext *)aio_context,
+                                      dex_uring_future_new_connect (fd, addr, addrlen));
+}
+
+static DexFuture *
+dex_uring_aio_backend_recv (DexAioBackend *aio_backend,
+                            DexAioContext *aio_context,
+                            int            fd,
+                            gpointer       buffer,
+                            gsize          count,
+                            int            flags)
+{
+  return dex_uring_aio_context_queue ((DexUringAioContext *)aio_context,
+                                      dex_uring_future_new_recv (fd, buffer, count, flags));
+}
+
+static DexFuture *
+dex_uring_aio_backend_send (DexAioBackend *aio_backend,
+                            DexAioContext *aio_context,
+                            int            fd,
+                            gconstpointer  buffer,
+                            gsize          count,
+                            int            flags)
+{
+  return dex_uring_aio_context_queue ((DexUringAioContext *)aio_context,
+                                      dex_uring_future_new_send (fd, buffer, count, flags));
+}
+
+static DexFuture *
+dex_uring_aio_backend_recvmsg (DexAioBackend *aio_backend,
+                               DexAioContext *aio_context,
+                               int            fd,
+                               struct msghdr *msg,
+                               int            flags)
+{
+  return dex_uring_aio_context_queue ((DexUringAioContext *)aio_context,
+                                      dex_uring_future_new_recvmsg (fd, msg, flags));
+}
+
+static DexFuture *
+dex_uring_aio_backend_sendmsg (DexAioBackend       *aio_backend,
+                               DexAioContext       *aio_context,
+                               int                  fd,
+                               const struct msghdr *msg,
+                               int                  flags)
+{
+  return dex_uring_aio_context_queue ((DexUringAioContext *)aio_context,
+                                      dex_uring_future_new_sendmsg (fd, msg, flags));
+}
+
+static gboolean
+dex_uring_aio_backend_register_files (DexAioBackend  *aio_backend,
+                                      DexAioContext  *aio_context,
+                                      const int      *fds,
+                                      guint           n_fds,
+                                      int            *fixed_fds,
+                                      GError        **error)
+{
+  DexUringAioContext *uring_context = (DexUringAioContext *)aio_context;
+  int ret;
+
+  if (uring_context->registry.n_files > 0)
+    {
+      io_uring_unregister_files (&uring_context->ring);
+      dex_uring_registry_set_files (&uring_context->registry, NULL, 0, NULL);
+    }
+
+  if (n_fds == 0)
+    return TRUE;
+
+  if ((ret = io_uring_register_files (&uring_context->ring, fds, n_fds)) < 0)
+    {
+      g_set_error_literal (error,
+                           G_IO_ERROR,
+                           g_io_error_from_errno (-ret),
+                           g_strerror (-ret));
+      return FALSE;
+    }
+
+  dex_uring_registry_set_files (&uring_context->registry, fds, n_fds, fixed_fds);
+
+  return TRUE;
+}
+
+static gboolean
+dex_uring_aio_backend_register_buffers (DexAioBackend       *aio_backend,
+                                        DexAioContext       *aio_context,
+                                        const GInputVector  *buffers,
+                                        guint                n_buffers,
+                                        GError             **error)
+{
+  DexUringAioContext *uring_context = (DexUringAioContext *)aio_context;
+  int ret;
+
+  if (uring_context->registry.n_buffers > 0)
+    {
+      io_uring_unregister_buffers (&uring_context->ring);
+      dex_uring_registry_set_buffers (&uring_context->registry, NULL, 0);
+    }
+
+  if (n_buffers == 0)
+    return TRUE;
+
+  /* GInputVector matches struct iovec, see dex-uring-future.c */
+  if ((ret = io_uring_register_buffers (&uring_context->ring,
+                                        (const struct iovec *)buffers,
+                                        n_buffers)) < 0)
+    {
+      g_set_error_literal (error,
+                           G_IO_ERROR,
+                           g_io_error_from_errno (-ret),
+                           g_strerror (-ret));
+      return FALSE;
+    }
+
+  dex_uring_registry_set_buffers (&uring_context->registry,
+                                  (const struct iovec *)buffers,
+                                  n_buffers);
+
+  return TRUE;
+}
+
+#if DEX_URING_CHECK_VERSION(2, 3)
+static inline gboolean
+dex_uring_aio_context_wants_poll (DexUringAioContext *aio_context,
+                                  const GPollFD      *fd)
+{
+  /* Our own completions are seen directly in the CQ */
+  return fd->fd >= 0 && fd->fd != aio_context->eventfd;
+}
+
+/* Replaces g_poll() on thread pool workers so that completions, wakeups
+ * from other threads, and timeouts are all waited on from a single
+ * io_uring_enter(). Completions for futures are left in the CQ where the
+ * aio GSource will notice them from check() without having to read() the
+ * eventfd.
+ *
+ * Every file descriptor GMainContext wants to poll gets a one-shot poll
+ * request which stays armed across iterations for as long as GMainContext
+ * keeps asking for the same descriptors and events, so an iteration woken
+ * up by a completion or a timeout submits nothing for them. Once any of
+ * them completed, all of them are armed again:
+ *
+ *  - GMainContext expects level-triggered results, which only a new
+ *    request provides for a descriptor that was not drained
+ *  - a descriptor may have been closed and its number reused. A request
+ *    keeps polling the file it was armed for, but GMainContext signals its
+ *    wakeup descriptor, which is one of @fds, whenever its polls change
+ *
+ * Multishot polls are not used as they would need to be removed to get
+ * level-triggered results all the same, and their completions could not
+ * be told apart once seen by both us and the aio GSource.
+ */
+static int
+dex_uring_aio_backend_poll (DexAioBackend *aio_backend,
+                            DexAioContext *context,
+                            GPollFD       *fds,
+                            guint          n_fds,
+                            int            timeout)
+{
+  DexUringAioContext *aio_context = (DexUringAioContext *)context;
+  struct io_uring *ring = &aio_context->ring;
+  struct io_uring_cqe *cqe;
+  DexUringPoll *polls;
+  gboolean rearm;
+  unsigned head;
+  int n_ready = 0;
+  int ret;
+
+  g_assert (DEX_IS_URING_AIO_BACKEND (aio_backend));
+  g_assert (aio_context != NULL);
+
+  if (aio_context->polls == NULL)
+    aio_context->polls = g_array_new (FALSE, TRUE, sizeof (DexUringPoll));
+
+  polls = (DexUringPoll *)(gpointer)aio_context->polls->data;
+
+  rearm = aio_context->polls->len != n_fds;
+  for (guint i = 0; !rearm && i < n_fds; i++)
+    rearm = polls[i].fd != fds[i].fd ||
+            polls[i].events != fds[i].events ||
+            (polls[i].user_data == 0 && dex_uring_aio_context_wants_poll (aio_context, &fds[i]));
+
+  if (rearm)
+    {
+      for (guint i = 0; i < aio_context->polls->len; i++)
+        {
+          struct io_uring_sqe *sqe;
+
+          if (polls[i].user_data == 0)
+            continue;
+
+          /* Its completion no longer matches and will be ignored */
+          if G_LIKELY ((sqe = dex_uring_aio_context_get_sqe (aio_context)))
+            {
+              io_uring_prep_poll_remove (sqe, polls[i].user_data);
+              io_uring_sqe_set_data (sqe, NULL);
+            }
+        }
+
+      g_array_set_size (aio_context->polls, n_fds);
+      polls = (DexUringPoll *)(gpointer)aio_context->polls->data;
+
+      aio_context->poll_generation++;
+
+      for (guint i = 0; i < n_fds; i++)
+        {
+          struct io_uring_sqe *sqe;
+
+          polls[i].fd = fds[i].fd;
+          polls[i].events = fds[i].events;
+          polls[i].user_data = 0;
+
+          if (!dex_uring_aio_context_wants_poll (aio_context, &fds[i]))
+            continue;
+
+          /* Try again from the next iteration rather than blocking */
+          if G_UNLIKELY (!(sqe = dex_uring_aio_context_get_sqe (aio_context)))
+            {
+              timeout = 0;
+              continue;
+            }
+
+          polls[i].user_data = POLL_USER_DATA (aio_context->poll_generation, i);
+          io_uring_prep_poll_add (sqe, fds[i].fd, fds[i].events);
+          io_uring_sqe_set_data64 (sqe, polls[i].user_data);
+        }
+    }
+
+  for (guint i = 0; i < n_fds; i++)
+    fds[i].revents = 0;
+
+  if (timeout == 0)
+    {
+      ret = io_uring_submit_and_get_events (ring);
+    }
+  else if (timeout < 0)
+    {
+      ret = io_uring_submit_and_wait (ring, 1);
+    }
+  else
+    {
+      struct __kernel_timespec ts;
+
+      ts.tv_sec = timeout / 1000;
+      ts.tv_nsec = (timeout % 1000) * 1000000L;
+
+      ret = io_uring_submit_and_wait_timeout (ring, &cqe, 1, &ts, NULL);
+    }
+
+  if G_UNLIKELY (ret < 0 && ret != -ETIME && ret != -EINTR && ret != -EBUSY)
+    {
+      g_critical ("Failed to wait on io_uring: %s", g_strerror (-ret));
+      return g_poll (fds, n_fds, timeout);
+    }
+
+  /* The CQEs are left for the aio GSource, which skips polls */
+  io_uring_for_each_cqe (ring, head, cqe)
+    {
+      guint idx;
+
+      if (!(cqe->user_data & POLL_TAG) ||
+          !dex_uring_aio_context_take_poll (aio_context, cqe->user_data, &idx))
+        continue;
+
+      if (cqe->res > 0)
+        fds[idx].revents = cqe->res & (fds[idx].events | G_IO_ERR | G_IO_HUP | G_IO_NVAL);
+      else if (cqe->res < 0)
+        fds[idx].revents = G_IO_ERR;
+
+      if (fds[idx].revents != 0)
+        n_ready++;
+    }
+
+  return n_ready;
+}
+
+static DexFuture *
+dex_uring_aio_backend_accept_stream (DexAioBackend *aio_backend,
+                                     DexAioContext *aio_context,
+                                     int            fd,
+                                     int            flags,
+                                     DexChannel    *channel)
+{
+  return dex_uring_aio_context_queue ((DexUringAioContext *)aio_context,
+                                      dex_uring_future_new_accept_stream (fd, flags, channel));
+}
+
+static DexFuture *
+dex_uring_aio_backend_recv_stream (DexAioBackend *aio_backend,
+                                   DexAioContext *aio_context,
+                                   int            fd,
+                                   gsize          buffer_size,
+                                   guint          n_buffers,
+                                   int            flags,
+                                   DexChannel    *channel)
+{
+  return dex_uring_aio_context_queue ((DexUringAioContext *)aio_context,
+                                      dex_uring_future_new_recv_stream (fd, buffer_size, n_buffers,
+                                                                        flags, channel));
+}
+#endif
+
 static void
 dex_uring_aio_backend_class_init (DexUringAioBackendClass *uring_aio_backend_class)
 {
@@ -377,6 +1164,33 @@ dex_uring_aio_backend_class_init (DexUringAioBackendClass *uring_aio_backend_cla
   aio_backend_class->open = dex_uring_aio_backend_open;
   aio_backend_class->read = dex_uring_aio_backend_read;
   aio_backend_class->write = dex_uring_aio_backend_write;
+  aio_backend_class->fsync = dex_uring_aio_backend_fsync;
+  aio_backend_class->statx = dex_uring_aio_backend_statx;
+  aio_backend_class->fallocate = dex_uring_aio_backend_fallocate;
+  aio_backend_class->readv = dex_uring_aio_backend_readv;
+  aio_backend_class->writev = dex_uring_aio_backend_writev;
+  aio_backend_class->splice = dex_uring_aio_backend_splice;
+  aio_backend_class->renameat = dex_uring_aio_backend_renameat;
+  aio_backend_class->unlinkat = dex_uring_aio_backend_unlinkat;
+  aio_backend_class->mkdirat = dex_uring_aio_backend_mkdirat;
+  aio_backend_class->accept = dex_uring_aio_backend_accept;
+  aio_backend_class->connect = dex_uring_aio_backend_connect;
+  aio_backend_class->recv = dex_uring_aio_backend_recv;
+  aio_backend_class->send = dex_uring_aio_backend_send;
+  aio_backend_class->recvmsg = dex_uring_aio_backend_recvmsg;
+  aio_backend_class->sendmsg = dex_uring_aio_backend_sendmsg;
+  aio_backend_class->register_files = dex_uring_aio_backend_register_files;
+  aio_backend_class->register_buffers = dex_uring_aio_backend_register_buffers;
+
+#if DEX_URING_CHECK_VERSION(2, 3)
+  aio_backend_class->poll = dex_uring_aio_backend_poll;
+#endif
+
+  /* Otherwise the fiber based fallback from DexAioBackend is used */
+#if DEX_URING_CHECK_VERSION(2, 3)
+  aio_backend_class->accept_stream = dex_uring_aio_backend_accept_stream;
+  aio_backend_class->recv_stream = dex_uring_aio_backend_recv_stream;
+#endif
 }
 
 static void
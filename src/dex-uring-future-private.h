@@ -20,8 +20,13 @@
 
 #pragma once
 
+#include <sys/socket.h>
+
 #include <liburing.h>
 
+#include <gio/gio.h>
+
+#include "dex-channel.h"
 #include "dex-future.h"
 
 G_BEGIN_DECLS
@@ -32,23 +37,148 @@ G_BEGIN_DECLS
 
 typedef struct _DexUringFuture DexUringFuture;
 
-GType           dex_uring_future_get_type  (void);
-DexUringFuture *dex_uring_future_new_close (int                  fd);
-DexUringFuture *dex_uring_future_new_open  (const char          *path,
-                                            int                  flags,
-                                            int                  mode);
-DexUringFuture *dex_uring_future_new_read  (int                  fd,
-                                            gpointer             buffer,
-                                            gsize                count,
-                                            goffset              offset);
-DexUringFuture *dex_uring_future_new_write (int                  fd,
-                                            gconstpointer        buffer,
-                                            gsize                count,
-                                            goffset              offset);
-void            dex_uring_future_sqe       (DexUringFuture      *uring_future,
-                                            struct io_uring_sqe *sqe);
-void            dex_uring_future_cqe       (DexUringFuture      *uring_future,
-                                            struct io_uring_cqe *cqe);
-void            dex_uring_future_complete  (DexUringFuture      *uring_future);
+typedef struct _DexUringFixedBuffer
+{
+  const guint8 *base;
+  gsize         length;
+  guint         index;
+} DexUringFixedBuffer;
+
+/* Registered files are addressed by handles which can never be a valid
+ * file descriptor, -1 or AT_FDCWD, so a request only uses the registered
+ * file when it was explicitly given its handle.
+ *
+ * A handle holds the slot along with the generation of the registration
+ * it was given out by. Requests are only resolved to a slot once they are
+ * submitted, so a request made before the files were registered again
+ * fails with EBADF rather than reaching whatever file took the slot.
+ * IORING_MAX_FIXED_FILES fits within DEX_URING_FIXED_FILE_SLOT_BITS.
+ */
+#define DEX_URING_FIXED_FILE_BASE        G_MININT
+#define DEX_URING_FIXED_FILE_SLOT_BITS   20
+#define DEX_URING_FIXED_FILE_GENERATIONS (1 << 10)
+#define DEX_URING_IS_FIXED_FILE(fd) \
+  ((fd) < 0 && \
+   (guint)((fd) - DEX_URING_FIXED_FILE_BASE) < (DEX_URING_FIXED_FILE_GENERATIONS << DEX_URING_FIXED_FILE_SLOT_BITS))
+
+/* Files and buffers registered with a ring. Reads and writes into a
+ * registered buffer use the registered form instead. Only accessed from
+ * the thread submitting to the ring.
+ *
+ * @files holds the file descriptor of each registered slot, or -1 once
+ * it has been closed. @file_generation changes with every registration.
+ */
+typedef struct _DexUringRegistry
+{
+  int                 *files;
+  guint                n_files;
+  guint                file_generation;
+  DexUringFixedBuffer *buffers;
+  guint                n_buffers;
+} DexUringRegistry;
+
+GType           dex_uring_future_get_type          (void);
+DexUringFuture *dex_uring_future_new_close         (int                    fd);
+DexUringFuture *dex_uring_future_new_open          (const char            *path,
+                                                    int                    flags,
+                                                    int                    mode);
+DexUringFuture *dex_uring_future_new_read          (int                    fd,
+                                                    gpointer               buffer,
+                                                    gsize                  count,
+                                                    goffset                offset);
+DexUringFuture *dex_uring_future_new_write         (int                    fd,
+                                                    gconstpointer          buffer,
+                                                    gsize                  count,
+                                                    goffset                offset);
+DexUringFuture *dex_uring_future_new_fsync         (int                    fd,
+                                                    gboolean               datasync);
+DexUringFuture *dex_uring_future_new_statx         (int                    dirfd,
+                                                    const char            *path,
+                                                    int                    flags,
+                                                    guint                  mask,
+                                                    struct statx          *statxbuf);
+DexUringFuture *dex_uring_future_new_fallocate     (int                    fd,
+                                                    int                    mode,
+                                                    goffset                offset,
+                                                    goffset                length);
+DexUringFuture *dex_uring_future_new_readv         (int                    fd,
+                                                    GInputVector          *vectors,
+                                                    guint                  n_vectors,
+                                                    goffset                offset);
+DexUringFuture *dex_uring_future_new_writev        (int                    fd,
+                                                    const GOutputVector   *vectors,
+                                                    guint                  n_vectors,
+                                                    goffset                offset);
+DexUringFuture *dex_uring_future_new_splice        (int                    fd_in,
+                                                    goffset                offset_in,
+                                                    int                    fd_out,
+                                                    goffset                offset_out,
+                                                    gsize                  length,
+                                                    guint                  flags);
+DexUringFuture *dex_uring_future_new_renameat      (int                    old_dirfd,
+                                                    const char            *old_path,
+                                                    int                    new_dirfd,
+                                                    const char            *new_path,
+                                                    guint                  flags);
+DexUringFuture *dex_uring_future_new_unlinkat      (int                    dirfd,
+                                                    const char            *path,
+                                                    int                    flags);
+DexUringFuture *dex_uring_future_new_mkdirat       (int                    dirfd,
+                                                    const char            *path,
+                                                    int                    mode);
+DexUringFuture *dex_uring_future_new_accept        (int                    fd,
+                                                    struct sockaddr       *addr,
+                                                    socklen_t             *addrlen,
+                                                    int                    flags);
+DexUringFuture *dex_uring_future_new_connect       (int                    fd,
+                                                    const struct sockaddr *addr,
+                                                    socklen_t              addrlen);
+DexUringFuture *dex_uring_future_new_recv          (int                    fd,
+                                                    gpointer               buffer,
+                                                    gsize                  count,
+                                                    int                    flags);
+DexUringFuture *dex_uring_future_new_send          (int                    fd,
+                                                    gconstpointer          buffer,
+                                                    gsize                  count,
+                                                    int                    flags);
+DexUringFuture *dex_uring_future_new_recvmsg       (int                    fd,
+                                                    struct msghdr         *msg,
+                                                    int                    flags);
+DexUringFuture *dex_uring_future_new_sendmsg       (int                    fd,
+                                                    const struct msghdr   *msg,
+                                                    int                    flags);
+DexUringFuture *dex_uring_future_new_accept_stream (int                    fd,
+                                                    int                    flags,
+                                                    DexChannel            *channel);
+DexUringFuture *dex_uring_future_new_recv_stream   (int                    fd,
+                                                    gsize                  buffer_size,
+                                                    guint                  n_buffers,
+                                                    int                    flags,
+                                                    DexChannel            *channel);
+gboolean        dex_uring_future_prepare           (DexUringFuture        *uring_future,
+                                                    struct io_uring       *ring,
+                                                    DexUringRegistry      *registry);
+void            dex_uring_future_sqe               (DexUringFuture        *uring_future,
+                                                    struct io_uring       *ring,
+                                                    DexUringRegistry      *registry,
+                                                    struct io_uring_sqe   *sqe);
+gboolean        dex_uring_future_cqe               (DexUringFuture        *uring_future,
+                                                    struct io_uring_cqe   *cqe);
+void            dex_uring_future_complete          (DexUringFuture        *uring_future);
+gboolean        dex_uring_future_take_cancel       (DexUringFuture        *uring_future);
+gboolean        dex_uring_future_take_resubmit     (DexUringFuture        *uring_future);
+DexFuture      *dex_uring_future_take_resume       (DexUringFuture        *uring_future);
+gboolean        dex_uring_future_resume            (DexUringFuture        *uring_future);
+DexUringFuture *dex_uring_future_get_next          (DexUringFuture        *uring_future);
+void            dex_uring_future_set_next          (DexUringFuture        *uring_future,
+                                                    DexUringFuture        *next);
+void            dex_uring_registry_set_files       (DexUringRegistry      *registry,
+                                                    const int             *fds,
+                                                    guint                  n_fds,
+                                                    int                   *fixed_fds);
+void            dex_uring_registry_set_buffers     (DexUringRegistry      *registry,
+                                                    const struct iovec    *iov,
+                                                    guint                  n_iov);
+void            dex_uring_registry_clear           (DexUringRegistry      *registry);
 
 G_END_DECLS
@@ -18,17 +18,29 @@
  * SPDX-License-Identifier: LGPL-2.1-or-later
  */
 
+#ifndef _GNU_SOURCE
+# define _GNU_SOURCE
+#endif
+
 #include "config.h"
 
+#include <errno.h>
 #include <fcntl.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
 
 #include <liburing.h>
 
 #include <gio/gio.h>
 
+#include "dex-channel.h"
 #include "dex-fd-private.h"
 #include "dex-future-private.h"
 #include "dex-uring-future-private.h"
+#include "dex-uring-version.h"
 
 typedef enum _DexUringType
 {
@@ -36,12 +48,36 @@ typedef enum _DexUringType
   DEX_URING_TYPE_OPEN,
   DEX_URING_TYPE_READ,
   DEX_URING_TYPE_WRITE,
+  DEX_URING_TYPE_FSYNC,
+  DEX_URING_TYPE_STATX,
+  DEX_URING_TYPE_FALLOCATE,
+  DEX_URING_TYPE_READV,
+  DEX_URING_TYPE_WRITEV,
+  DEX_URING_TYPE_SPLICE,
+  DEX_URING_TYPE_RENAMEAT,
+  DEX_URING_TYPE_UNLINKAT,
+  DEX_URING_TYPE_MKDIRAT,
+  DEX_URING_TYPE_ACCEPT,
+  DEX_URING_TYPE_CONNECT,
+  DEX_URING_TYPE_RECV,
+  DEX_URING_TYPE_SEND,
+  DEX_URING_TYPE_RECVMSG,
+  DEX_URING_TYPE_SENDMSG,
+  DEX_URING_TYPE_ACCEPT_STREAM,
+  DEX_URING_TYPE_RECV_STREAM,
 } DexUringType;
 
+/* Buffer group IDs are allocated process-wide, so on the off chance that
+ * we wrap around onto one still registered with a ring, try a few more.
+ */
+#define MAX_BUF_GROUP_ATTEMPTS 8
+
 struct _DexUringFuture
 {
   DexFuture parent_instance;
   DexUringType type;
+  /* Link for the overflow stack of DexUringAioContext */
+  DexUringFuture *next;
   union {
     struct {
       DexFD *fd;
@@ -67,9 +103,145 @@ struct _DexUringFuture
       goffset offset;
       gssize result;
     } write;
+    struct {
+      int fd;
+      guint flags;
+      int result;
+    } fsync;
+    struct {
+      int dirfd;
+      char *path;
+      int flags;
+      guint mask;
+      struct statx *statxbuf;
+      int result;
+    } statx;
+    struct {
+      int fd;
+      int mode;
+      goffset offset;
+      goffset length;
+      int result;
+    } fallocate;
+    struct {
+      int fd;
+      struct iovec *iov;
+      guint n_iov;
+      goffset offset;
+      gssize result;
+    } readv;
+    struct {
+      int fd;
+      struct iovec *iov;
+      guint n_iov;
+      goffset offset;
+      gssize result;
+    } writev;
+    struct {
+      int fd_in;
+      goffset offset_in;
+      int fd_out;
+      goffset offset_out;
+      gsize length;
+      guint flags;
+      gssize result;
+    } splice;
+    struct {
+      int old_dirfd;
+      char *old_path;
+      int new_dirfd;
+      char *new_path;
+      guint flags;
+      int result;
+    } renameat;
+    struct {
+      int dirfd;
+      char *path;
+      int flags;
+      int result;
+    } unlinkat;
+    struct {
+      int dirfd;
+      char *path;
+      int mode;
+      int result;
+    } mkdirat;
+    struct {
+      int fd;
+      struct sockaddr *addr;
+      socklen_t *addrlen;
+      int flags;
+      int result;
+    } accept;
+    struct {
+      int fd;
+      struct sockaddr *addr;
+      socklen_t addrlen;
+      int result;
+    } connect;
+    struct {
+      int fd;
+      gpointer buffer;
+      gsize count;
+      int flags;
+      gssize result;
+    } recv;
+    struct {
+      int fd;
+      gconstpointer buffer;
+      gsize count;
+      int flags;
+      gssize result;
+    } send;
+    struct {
+      int fd;
+      struct msghdr *msg;
+      int flags;
+      gssize result;
+    } recvmsg;
+    struct {
+      int fd;
+      const struct msghdr *msg;
+      int flags;
+      gssize result;
+    } sendmsg;
+    /* Shared by ACCEPT_STREAM and RECV_STREAM which are multishot
+     * requests that produce many completions for a single submission.
+     * The buffer ring is only used by RECV_STREAM. @send is the future
+     * for the last item sent to @channel, which stays pending while the
+     * channel is at capacity.
+     */
+    struct {
+      int fd;
+      int flags;
+      DexChannel *channel;
+      DexFuture *send;
+      GQueue items;
+      struct io_uring *ring;
+      struct io_uring_buf_ring *buf_ring;
+      gsize buf_ring_size;
+      guint8 *buffers;
+      gsize buffer_size;
+      guint n_buffers;
+      int buf_group;
+      int setup_error;
+      int result;
+      guint final : 1;
+      guint cancelled : 1;
+      guint paused : 1;
+      guint needs_cancel : 1;
+      guint needs_resubmit : 1;
+      guint needs_resume : 1;
+    } stream;
   };
 };
 
+/* GInputVector and GOutputVector are documented to match struct iovec */
+G_STATIC_ASSERT (sizeof (GInputVector) == sizeof (struct iovec));
+G_STATIC_ASSERT (sizeof (GOutputVector) == sizeof (struct iovec));
+G_STATIC_ASSERT (G_STRUCT_OFFSET (GInputVector, buffer) == G_STRUCT_OFFSET (struct iovec, iov_base));
+G_STATIC_ASSERT (G_STRUCT_OFFSET (GInputVector, size) == G_STRUCT_OFFSET (struct iovec, iov_len));
+
 typedef struct _DexUringFutureClass
 {
   DexFutureClass parent_class;
@@ -85,10 +257,71 @@ dex_uring_future_finalize (DexObject *object)
 {
   DexUringFuture *uring_future = DEX_URING_FUTURE (object);
 
-  if (uring_future->type == DEX_URING_TYPE_CLOSE)
-    g_clear_pointer (&uring_future->close.fd, dex_fd_free);
-  else if (uring_future->type == DEX_URING_TYPE_OPEN)
-    g_clear_pointer (&uring_future->open.path, g_free);
+  switch (uring_future->type)
+    {
+    case DEX_URING_TYPE_CLOSE:
+      g_clear_pointer (&uring_future->close.fd, dex_fd_free);
+      break;
+
+    case DEX_URING_TYPE_OPEN:
+      g_clear_pointer (&uring_future->open.path, g_free);
+      break;
+
+    case DEX_URING_TYPE_STATX:
+      g_clear_pointer (&uring_future->statx.path, g_free);
+      break;
+
+    case DEX_URING_TYPE_READV:
+      g_clear_pointer (&uring_future->readv.iov, g_free);
+      break;
+
+    case DEX_URING_TYPE_WRITEV:
+      g_clear_pointer (&uring_future->writev.iov, g_free);
+      break;
+
+    case DEX_URING_TYPE_RENAMEAT:
+      g_clear_pointer (&uring_future->renameat.old_path, g_free);
+      g_clear_pointer (&uring_future->renameat.new_path, g_free);
+      break;
+
+    case DEX_URING_TYPE_UNLINKAT:
+      g_clear_pointer (&uring_future->unlinkat.path, g_free);
+      break;
+
+    case DEX_URING_TYPE_MKDIRAT:
+      g_clear_pointer (&uring_future->mkdirat.path, g_free);
+      break;
+
+    case DEX_URING_TYPE_CONNECT:
+      g_clear_pointer (&uring_future->connect.addr, g_free);
+      break;
+
+    case DEX_URING_TYPE_ACCEPT_STREAM:
+    case DEX_URING_TYPE_RECV_STREAM:
+      /* Only reached with a registered buffer ring if the ring itself
+       * went away first, so there is nothing left to unregister from.
+       */
+      if (uring_future->stream.buf_ring != NULL)
+        munmap (uring_future->stream.buf_ring, uring_future->stream.buf_ring_size);
+      g_clear_pointer (&uring_future->stream.buffers, g_free);
+      g_queue_clear_full (&uring_future->stream.items, dex_unref);
+      dex_clear (&uring_future->stream.send);
+      dex_clear (&uring_future->stream.channel);
+      break;
+
+    case DEX_URING_TYPE_READ:
+    case DEX_URING_TYPE_WRITE:
+    case DEX_URING_TYPE_FSYNC:
+    case DEX_URING_TYPE_FALLOCATE:
+    case DEX_URING_TYPE_SPLICE:
+    case DEX_URING_TYPE_ACCEPT:
+    case DEX_URING_TYPE_RECV:
+    case DEX_URING_TYPE_SEND:
+    case DEX_URING_TYPE_RECVMSG:
+    case DEX_URING_TYPE_SENDMSG:
+    default:
+      break;
+    }
 
   DEX_OBJECT_CLASS (dex_uring_future_parent_class)->finalize (object);
 }
@@ -99,6 +332,7 @@ dex_uring_future_class_init (DexUringFutureClass *uring_future_class)
   DexObjectClass *object_class = DEX_OBJECT_CLASS (uring_future_class);
 
   object_class->finalize = dex_uring_future_finalize;
+  dex_object_class_enable_slab (object_class);
 }
 
 static void
@@ -153,13 +387,317 @@ complete_ssize (DexUringFuture *uring_future,
   if (value < 0)
     dex_future_complete (DEX_FUTURE (uring_future),
                          NULL,
-                         create_error (-value));
+                         create_error (value));
   else
     dex_future_complete (DEX_FUTURE (uring_future),
                          &(GValue) { G_TYPE_INT64, {{.v_int64 = value}}},
                          NULL);
 }
 
+#if DEX_URING_CHECK_VERSION(2, 3)
+static int
+dex_uring_future_register_buf_ring (DexUringFuture  *uring_future,
+                                    struct io_uring *ring)
+{
+  static guint last_buf_group;
+  struct io_uring_buf_reg reg = {0};
+  struct io_uring_buf_ring *buf_ring;
+  gsize buf_ring_size;
+  guint n_buffers;
+  gsize buffer_size;
+  guint8 *buffers;
+  int ret = -EEXIST;
+  int mask;
+
+  g_assert (uring_future->type == DEX_URING_TYPE_RECV_STREAM);
+  g_assert (uring_future->stream.buf_ring == NULL);
+
+  n_buffers = uring_future->stream.n_buffers;
+  buffer_size = uring_future->stream.buffer_size;
+  buf_ring_size = sizeof (struct io_uring_buf) * n_buffers;
+
+  /* The kernel requires the ring to be page aligned */
+  buf_ring = mmap (NULL, buf_ring_size,
+                   PROT_READ | PROT_WRITE,
+                   MAP_ANONYMOUS | MAP_PRIVATE,
+                   -1, 0);
+  if (buf_ring == MAP_FAILED)
+    return -errno;
+
+  reg.ring_addr = (guint64)(guintptr)buf_ring;
+  reg.ring_entries = n_buffers;
+
+  for (guint i = 0; ret == -EEXIST && i < MAX_BUF_GROUP_ATTEMPTS; i++)
+    {
+      reg.bgid = (guint16)g_atomic_int_add (&last_buf_group, 1);
+      ret = io_uring_register_buf_ring (ring, &reg, 0);
+    }
+
+  if (ret < 0)
+    {
+      munmap (buf_ring, buf_ring_size);
+      return ret;
+    }
+
+  buffers = g_malloc (n_buffers * buffer_size);
+  mask = io_uring_buf_ring_mask (n_buffers);
+
+  io_uring_buf_ring_init (buf_ring);
+  for (guint i = 0; i < n_buffers; i++)
+    io_uring_buf_ring_add (buf_ring, buffers + (i * buffer_size), buffer_size, i, mask, i);
+  io_uring_buf_ring_advance (buf_ring, n_buffers);
+
+  uring_future->stream.ring = ring;
+  uring_future->stream.buf_ring = buf_ring;
+  uring_future->stream.buf_ring_size = buf_ring_size;
+  uring_future->stream.buffers = buffers;
+  uring_future->stream.buf_group = reg.bgid;
+
+  return 0;
+}
+
+static void
+dex_uring_future_unregister_buf_ring (DexUringFuture *uring_future)
+{
+  if (uring_future->stream.buf_ring == NULL)
+    return;
+
+  io_uring_unregister_buf_ring (uring_future->stream.ring,
+                                uring_future->stream.buf_group);
+  munmap (uring_future->stream.buf_ring, uring_future->stream.buf_ring_size);
+  g_clear_pointer (&uring_future->stream.buffers, g_free);
+
+  uring_future->stream.buf_ring = NULL;
+  uring_future->stream.ring = NULL;
+}
+
+static gboolean
+dex_uring_future_stream_cqe (DexUringFuture      *uring_future,
+                             struct io_uring_cqe *cqe)
+{
+  DexFuture *item = NULL;
+
+  if G_UNLIKELY (uring_future->stream.setup_error != 0)
+    {
+      uring_future->stream.result = uring_future->stream.setup_error;
+      uring_future->stream.setup_error = 0;
+      uring_future->stream.final = TRUE;
+      return TRUE;
+    }
+
+  if (uring_future->type == DEX_URING_TYPE_ACCEPT_STREAM)
+    {
+      if (cqe->res >= 0)
+        item = dex_future_new_for_fd (cqe->res);
+    }
+  else if (cqe->flags & IORING_CQE_F_BUFFER)
+    {
+      guint bid = cqe->flags >> IORING_CQE_BUFFER_SHIFT;
+      guint8 *buffer = uring_future->stream.buffers + (bid * uring_future->stream.buffer_size);
+
+      /* Copy out so the buffer can go straight back to the kernel */
+      if (cqe->res > 0)
+        item = dex_future_new_take_boxed (G_TYPE_BYTES, g_bytes_new (buffer, cqe->res));
+
+      io_uring_buf_ring_add (uring_future->stream.buf_ring,
+                             buffer,
+                             uring_future->stream.buffer_size,
+                             bid,
+                             io_uring_buf_ring_mask (uring_future->stream.n_buffers),
+                             0);
+      io_uring_buf_ring_advance (uring_future->stream.buf_ring, 1);
+    }
+
+  if (item != NULL)
+    g_queue_push_tail (&uring_future->stream.items, item);
+
+  if (cqe->flags & IORING_CQE_F_MORE)
+    return FALSE;
+
+  uring_future->stream.result = cqe->res;
+  uring_future->stream.final = TRUE;
+
+  return TRUE;
+}
+
+static gboolean
+dex_uring_future_stream_is_full (DexUringFuture *uring_future)
+{
+  return uring_future->stream.send != NULL &&
+         dex_future_is_pending (uring_future->stream.send);
+}
+
+static void
+dex_uring_future_stream_finish (DexUringFuture *uring_future,
+                                int             result)
+{
+  dex_uring_future_unregister_buf_ring (uring_future);
+  dex_channel_close_send (uring_future->stream.channel);
+  dex_clear (&uring_future->stream.send);
+
+  if (result == -ECANCELED || result == -ENOBUFS)
+    result = 0;
+
+  complete_boolean (uring_future, result);
+}
+
+static void
+dex_uring_future_stream_complete (DexUringFuture *uring_future)
+{
+  gboolean is_open;
+  DexFuture *item;
+  int result;
+
+  is_open = dex_channel_can_send (uring_future->stream.channel) &&
+            dex_channel_can_receive (uring_future->stream.channel);
+
+  /* The channel holds on to the send future, we only need to ensure
+   * that items are delivered in order.
+   */
+  while ((item = g_queue_pop_head (&uring_future->stream.items)))
+    {
+      if (is_open)
+        {
+          dex_clear (&uring_future->stream.send);
+          uring_future->stream.send = dex_channel_send (uring_future->stream.channel, item);
+        }
+      else
+        {
+          dex_unref (item);
+        }
+    }
+
+  if (!uring_future->stream.final)
+    {
+      /* Stop the kernel from producing more while the channel is at
+       * capacity. Whatever completes before the cancellation lands is
+       * still delivered, which is bounded by the buffer ring.
+       */
+      if (!uring_future->stream.cancelled &&
+          (!is_open || dex_uring_future_stream_is_full (uring_future)))
+        {
+          uring_future->stream.cancelled = TRUE;
+          uring_future->stream.paused = is_open;
+          uring_future->stream.needs_cancel = TRUE;
+        }
+
+      return;
+    }
+
+  uring_future->stream.final = FALSE;
+  result = uring_future->stream.result;
+
+  /* The kernel may end a multishot request on its own, such as when it
+   * ran out of provided buffers, or we may have paused it. Keep going if
+   * nobody asked us to stop, but only once the channel has room again.
+   */
+  if (is_open &&
+      (!uring_future->stream.cancelled || uring_future->stream.paused) &&
+      ((result == -ECANCELED && uring_future->stream.paused) ||
+       result == -ENOBUFS ||
+       (result > 0) ||
+       (result == 0 && uring_future->type == DEX_URING_TYPE_ACCEPT_STREAM)))
+    {
+      uring_future->stream.cancelled = FALSE;
+      uring_future->stream.paused = FALSE;
+
+      if (dex_uring_future_stream_is_full (uring_future))
+        uring_future->stream.needs_resume = TRUE;
+      else
+        uring_future->stream.needs_resubmit = TRUE;
+
+      return;
+    }
+
+  dex_uring_future_stream_finish (uring_future, result);
+}
+#endif
+
+DexUringFuture *
+dex_uring_future_get_next (DexUringFuture *uring_future)
+{
+  return uring_future->next;
+}
+
+void
+dex_uring_future_set_next (DexUringFuture *uring_future,
+                           DexUringFuture *next)
+{
+  uring_future->next = next;
+}
+
+/* Returns %TRUE, at most once, when a multishot request should be
+ * cancelled because its channel was closed.
+ */
+gboolean
+dex_uring_future_take_cancel (DexUringFuture *uring_future)
+{
+  gboolean ret = FALSE;
+
+  if (uring_future->type == DEX_URING_TYPE_ACCEPT_STREAM ||
+      uring_future->type == DEX_URING_TYPE_RECV_STREAM)
+    {
+      ret = uring_future->stream.needs_cancel;
+      uring_future->stream.needs_cancel = FALSE;
+    }
+
+  return ret;
+}
+
+/* Returns the future to wait for before a multishot request that was
+ * stopped because its channel was at capacity may be queued again with
+ * dex_uring_future_resume(), or %NULL.
+ */
+DexFuture *
+dex_uring_future_take_resume (DexUringFuture *uring_future)
+{
+  if ((uring_future->type == DEX_URING_TYPE_ACCEPT_STREAM ||
+       uring_future->type == DEX_URING_TYPE_RECV_STREAM) &&
+      uring_future->stream.needs_resume)
+    {
+      uring_future->stream.needs_resume = FALSE;
+      return dex_ref (uring_future->stream.send);
+    }
+
+  return NULL;
+}
+
+/* Called once the future from dex_uring_future_take_resume() completed.
+ * Returns %TRUE if the request should be queued again, otherwise the
+ * channel was closed in the meantime and the stream is completed.
+ */
+gboolean
+dex_uring_future_resume (DexUringFuture *uring_future)
+{
+#if DEX_URING_CHECK_VERSION(2, 3)
+  if (dex_channel_can_send (uring_future->stream.channel) &&
+      dex_channel_can_receive (uring_future->stream.channel))
+    return TRUE;
+
+  dex_uring_future_stream_finish (uring_future, 0);
+#endif
+
+  return FALSE;
+}
+
+/* Returns %TRUE when the kernel ended a multishot request that still
+ * has a receiver interested in it, and it should be queued again.
+ */
+gboolean
+dex_uring_future_take_resubmit (DexUringFuture *uring_future)
+{
+  gboolean ret = FALSE;
+
+  if (uring_future->type == DEX_URING_TYPE_ACCEPT_STREAM ||
+      uring_future->type == DEX_URING_TYPE_RECV_STREAM)
+    {
+      ret = uring_future->stream.needs_resubmit;
+      uring_future->stream.needs_resubmit = FALSE;
+    }
+
+  return ret;
+}
+
 void
 dex_uring_future_complete (DexUringFuture *uring_future)
 {
@@ -181,12 +719,80 @@ dex_uring_future_complete (DexUringFuture *uring_future)
       complete_ssize (uring_future, uring_future->write.result);
       break;
 
+    case DEX_URING_TYPE_FSYNC:
+      complete_boolean (uring_future, uring_future->fsync.result);
+      break;
+
+    case DEX_URING_TYPE_STATX:
+      complete_boolean (uring_future, uring_future->statx.result);
+      break;
+
+    case DEX_URING_TYPE_FALLOCATE:
+      complete_boolean (uring_future, uring_future->fallocate.result);
+      break;
+
+    case DEX_URING_TYPE_READV:
+      complete_ssize (uring_future, uring_future->readv.result);
+      break;
+
+    case DEX_URING_TYPE_WRITEV:
+      complete_ssize (uring_future, uring_future->writev.result);
+      break;
+
+    case DEX_URING_TYPE_SPLICE:
+      complete_ssize (uring_future, uring_future->splice.result);
+      break;
+
+    case DEX_URING_TYPE_RENAMEAT:
+      complete_boolean (uring_future, uring_future->renameat.result);
+      break;
+
+    case DEX_URING_TYPE_UNLINKAT:
+      complete_boolean (uring_future, uring_future->unlinkat.result);
+      break;
+
+    case DEX_URING_TYPE_MKDIRAT:
+      complete_boolean (uring_future, uring_future->mkdirat.result);
+      break;
+
+    case DEX_URING_TYPE_ACCEPT:
+      complete_fd (uring_future, uring_future->accept.result);
+      break;
+
+    case DEX_URING_TYPE_CONNECT:
+      complete_boolean (uring_future, uring_future->connect.result);
+      break;
+
+    case DEX_URING_TYPE_RECV:
+      complete_ssize (uring_future, uring_future->recv.result);
+      break;
+
+    case DEX_URING_TYPE_SEND:
+      complete_ssize (uring_future, uring_future->send.result);
+      break;
+
+    case DEX_URING_TYPE_RECVMSG:
+      complete_ssize (uring_future, uring_future->recvmsg.result);
+      break;
+
+    case DEX_URING_TYPE_SENDMSG:
+      complete_ssize (uring_future, uring_future->sendmsg.result);
+      break;
+
+#if DEX_URING_CHECK_VERSION(2, 3)
+    case DEX_URING_TYPE_ACCEPT_STREAM:
+    case DEX_URING_TYPE_RECV_STREAM:
+      dex_uring_future_stream_complete (uring_future);
+      break;
+#endif
+
     default:
       g_assert_not_reached ();
     }
 }
 
-void
+/* Returns %FALSE if more completions will follow for a multishot request */
+gboolean
 dex_uring_future_cqe (DexUringFuture      *uring_future,
                       struct io_uring_cqe *cqe)
 {
@@ -208,45 +814,521 @@ dex_uring_future_cqe (DexUringFuture      *uring_future,
       uring_future->write.result = cqe->res;
       break;
 
-    default:
-      g_assert_not_reached ();
-    }
-}
+    case DEX_URING_TYPE_FSYNC:
+      uring_future->fsync.result = cqe->res;
+      break;
 
-void
-dex_uring_future_sqe (DexUringFuture      *uring_future,
-                      struct io_uring_sqe *sqe)
-{
-  switch (uring_future->type)
-    {
-    case DEX_URING_TYPE_CLOSE:
-      io_uring_prep_close (sqe, dex_fd_steal (uring_future->close.fd));
+    case DEX_URING_TYPE_STATX:
+      uring_future->statx.result = cqe->res;
       break;
 
-    case DEX_URING_TYPE_OPEN:
-      io_uring_prep_openat (sqe,
-                            AT_FDCWD,
-                            uring_future->open.path,
-                            uring_future->open.flags,
-                            uring_future->open.mode);
+    case DEX_URING_TYPE_FALLOCATE:
+      uring_future->fallocate.result = cqe->res;
       break;
 
-    case DEX_URING_TYPE_READ:
-      io_uring_prep_read (sqe,
-                          uring_future->read.fd,
-                          uring_future->read.buffer,
-                          uring_future->read.count,
-                          uring_future->read.offset);
+    case DEX_URING_TYPE_READV:
+      uring_future->readv.result = cqe->res;
       break;
 
-    case DEX_URING_TYPE_WRITE:
-      io_uring_prep_write (sqe,
-                           uring_future->write.fd,
-                           uring_future->write.buffer,
-                           uring_future->write.count,
-                           uring_future->write.offset);
+    case DEX_URING_TYPE_WRITEV:
+      uring_future->writev.result = cqe->res;
       break;
 
+    case DEX_URING_TYPE_SPLICE:
+      uring_future->splice.result = cqe->res;
+      break;
+
+    case DEX_URING_TYPE_RENAMEAT:
+      uring_future->renameat.result = cqe->res;
+      break;
+
+    case DEX_URING_TYPE_UNLINKAT:
+      uring_future->unlinkat.result = cqe->res;
+      break;
+
+    case DEX_URING_TYPE_MKDIRAT:
+      uring_future->mkdirat.result = cqe->res;
+      break;
+
+    case DEX_URING_TYPE_ACCEPT:
+      uring_future->accept.result = cqe->res;
+      break;
+
+    case DEX_URING_TYPE_CONNECT:
+      uring_future->connect.result = cqe->res;
+      break;
+
+    case DEX_URING_TYPE_RECV:
+      uring_future->recv.result = cqe->res;
+      break;
+
+    case DEX_URING_TYPE_SEND:
+      uring_future->send.result = cqe->res;
+      break;
+
+    case DEX_URING_TYPE_RECVMSG:
+      uring_future->recvmsg.result = cqe->res;
+      break;
+
+    case DEX_URING_TYPE_SENDMSG:
+      uring_future->sendmsg.result = cqe->res;
+      break;
+
+#if DEX_URING_CHECK_VERSION(2, 3)
+    case DEX_URING_TYPE_ACCEPT_STREAM:
+    case DEX_URING_TYPE_RECV_STREAM:
+      return dex_uring_future_stream_cqe (uring_future, cqe);
+#endif
+
+    default:
+      g_assert_not_reached ();
+    }
+
+  return TRUE;
+}
+
+static int
+compare_fixed_buffer (gconstpointer a,
+                      gconstpointer b)
+{
+  const DexUringFixedBuffer *fixed_a = a;
+  const DexUringFixedBuffer *fixed_b = b;
+
+  if (fixed_a->base < fixed_b->base)
+    return -1;
+  else if (fixed_a->base > fixed_b->base)
+    return 1;
+  else
+    return 0;
+}
+
+void
+dex_uring_registry_set_files (DexUringRegistry *registry,
+                              const int        *fds,
+                              guint             n_fds,
+                              int              *fixed_fds)
+{
+  g_clear_pointer (&registry->files, g_free);
+  registry->n_files = 0;
+
+  /* Handles from the previous registration must no longer resolve */
+  registry->file_generation = (registry->file_generation + 1) % DEX_URING_FIXED_FILE_GENERATIONS;
+
+  if (n_fds == 0)
+    return;
+
+  g_assert (n_fds <= (1u << DEX_URING_FIXED_FILE_SLOT_BITS));
+
+  registry->files = g_memdup2 (fds, sizeof (int) * n_fds);
+  registry->n_files = n_fds;
+
+  if (fixed_fds != NULL)
+    {
+      for (guint i = 0; i < n_fds; i++)
+        fixed_fds[i] = DEX_URING_FIXED_FILE_BASE +
+                       (int)((registry->file_generation << DEX_URING_FIXED_FILE_SLOT_BITS) | i);
+    }
+}
+
+void
+dex_uring_registry_set_buffers (DexUringRegistry   *registry,
+                                const struct iovec *iov,
+                                guint               n_iov)
+{
+  g_clear_pointer (&registry->buffers, g_free);
+  registry->n_buffers = 0;
+
+  if (n_iov == 0)
+    return;
+
+  registry->buffers = g_new (DexUringFixedBuffer, n_iov);
+  registry->n_buffers = n_iov;
+
+  for (guint i = 0; i < n_iov; i++)
+    {
+      registry->buffers[i].base = iov[i].iov_base;
+      registry->buffers[i].length = iov[i].iov_len;
+      registry->buffers[i].index = i;
+    }
+
+  /* Sorted by address so lookups can bisect */
+  qsort (registry->buffers, n_iov, sizeof (DexUringFixedBuffer), compare_fixed_buffer);
+}
+
+void
+dex_uring_registry_clear (DexUringRegistry *registry)
+{
+  dex_uring_registry_set_files (registry, NULL, 0, NULL);
+  dex_uring_registry_set_buffers (registry, NULL, 0);
+}
+
+/* Returns the slot for a handle given out by the current registration or
+ * -1 if it is stale or its file was closed. Plain file descriptors are
+ * never looked up.
+ */
+static inline int
+dex_uring_registry_lookup_file (DexUringRegistry *registry,
+                                int               fixed_fd)
+{
+  guint handle;
+  guint file_index;
+
+  if (registry == NULL || !DEX_URING_IS_FIXED_FILE (fixed_fd))
+    return -1;
+
+  handle = (guint)(fixed_fd - DEX_URING_FIXED_FILE_BASE);
+  file_index = handle & ((1u << DEX_URING_FIXED_FILE_SLOT_BITS) - 1);
+
+  if ((handle >> DEX_URING_FIXED_FILE_SLOT_BITS) != registry->file_generation ||
+      file_index >= registry->n_files ||
+      registry->files[file_index] == -1)
+    return -1;
+
+  return file_index;
+}
+
+static inline int
+dex_uring_registry_lookup_buffer (DexUringRegistry *registry,
+                                  gconstpointer     buffer,
+                                  gsize             count)
+{
+  const guint8 *begin = buffer;
+  guint lo;
+  guint hi;
+
+  if (registry == NULL || registry->n_buffers == 0)
+    return -1;
+
+  /* Find the last registered buffer starting at or before @buffer */
+  lo = 0;
+  hi = registry->n_buffers;
+  while (lo < hi)
+    {
+      guint mid = lo + (hi - lo) / 2;
+
+      if (registry->buffers[mid].base <= begin)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+
+  if (lo == 0)
+    return -1;
+
+  /* The whole transfer must fall within the registered region */
+  if (begin + count > registry->buffers[lo - 1].base + registry->buffers[lo - 1].length)
+    return -1;
+
+  return registry->buffers[lo - 1].index;
+}
+
+static inline void
+dex_uring_registry_apply_file (DexUringRegistry    *registry,
+                               struct io_uring_sqe *sqe)
+{
+  int file_index;
+
+  if (!DEX_URING_IS_FIXED_FILE (sqe->fd))
+    return;
+
+  /* Stale handles fail with EBADF */
+  if ((file_index = dex_uring_registry_lookup_file (registry, sqe->fd)) >= 0)
+    {
+      sqe->fd = file_index;
+      sqe->flags |= IOSQE_FIXED_FILE;
+    }
+  else
+    {
+      sqe->fd = -1;
+    }
+}
+
+/* Must be called on the thread submitting to @ring before the sqe for
+ * @uring_future is prepared, which may happen more than once if there
+ * was no room in the SQ.
+ *
+ * A registered file about to be closed, given either by handle or by file
+ * descriptor, is unregistered here so the ring does not keep it open and
+ * the close then uses the file descriptor. Returns %FALSE if that failed,
+ * in which case @uring_future has been rejected and must not be submitted.
+ */
+gboolean
+dex_uring_future_prepare (DexUringFuture   *uring_future,
+                          struct io_uring  *ring,
+                          DexUringRegistry *registry)
+{
+  int file_index;
+  int unused = -1;
+  int fd;
+  int ret;
+
+  if (uring_future->type != DEX_URING_TYPE_CLOSE || registry->n_files == 0)
+    return TRUE;
+
+  fd = dex_fd_peek (uring_future->close.fd);
+
+  if ((file_index = dex_uring_registry_lookup_file (registry, fd)) < 0 && fd >= 0)
+    {
+      for (guint i = 0; i < registry->n_files; i++)
+        {
+          if (registry->files[i] == fd)
+            {
+              file_index = i;
+              break;
+            }
+        }
+    }
+
+  if (file_index < 0)
+    return TRUE;
+
+  /* Requests already prepared may still use the slot, so they must be
+   * submitted before it is cleared.
+   */
+  if (io_uring_sq_ready (ring) > 0)
+    io_uring_submit (ring);
+
+  if ((ret = io_uring_register_files_update (ring, file_index, &unused, 1)) < 0)
+    {
+      uring_future->close.result = ret;
+      dex_uring_future_complete (uring_future);
+      return FALSE;
+    }
+
+  /* A handle is not a file descriptor, so there is nothing to close */
+  if (fd != registry->files[file_index])
+    {
+      g_free (uring_future->close.fd);
+      uring_future->close.fd = g_memdup2 (&registry->files[file_index], sizeof (int));
+    }
+
+  registry->files[file_index] = -1;
+
+  return TRUE;
+}
+
+void
+dex_uring_future_sqe (DexUringFuture      *uring_future,
+                      struct io_uring     *ring,
+                      DexUringRegistry    *registry,
+                      struct io_uring_sqe *sqe)
+{
+  int buf_index;
+
+  switch (uring_future->type)
+    {
+    case DEX_URING_TYPE_CLOSE:
+      io_uring_prep_close (sqe, dex_fd_steal (uring_future->close.fd));
+      break;
+
+    case DEX_URING_TYPE_OPEN:
+      io_uring_prep_openat (sqe,
+                            AT_FDCWD,
+                            uring_future->open.path,
+                            uring_future->open.flags,
+                            uring_future->open.mode);
+      break;
+
+    case DEX_URING_TYPE_READ:
+      buf_index = dex_uring_registry_lookup_buffer (registry,
+                                                    uring_future->read.buffer,
+                                                    uring_future->read.count);
+      if (buf_index >= 0)
+        io_uring_prep_read_fixed (sqe,
+                                  uring_future->read.fd,
+                                  uring_future->read.buffer,
+                                  uring_future->read.count,
+                                  uring_future->read.offset,
+                                  buf_index);
+      else
+        io_uring_prep_read (sqe,
+                            uring_future->read.fd,
+                            uring_future->read.buffer,
+                            uring_future->read.count,
+                            uring_future->read.offset);
+      dex_uring_registry_apply_file (registry, sqe);
+      break;
+
+    case DEX_URING_TYPE_WRITE:
+      buf_index = dex_uring_registry_lookup_buffer (registry,
+                                                    uring_future->write.buffer,
+                                                    uring_future->write.count);
+      if (buf_index >= 0)
+        io_uring_prep_write_fixed (sqe,
+                                   uring_future->write.fd,
+                                   uring_future->write.buffer,
+                                   uring_future->write.count,
+                                   uring_future->write.offset,
+                                   buf_index);
+      else
+        io_uring_prep_write (sqe,
+                             uring_future->write.fd,
+                             uring_future->write.buffer,
+                             uring_future->write.count,
+                             uring_future->write.offset);
+      dex_uring_registry_apply_file (registry, sqe);
+      break;
+
+    case DEX_URING_TYPE_FSYNC:
+      io_uring_prep_fsync (sqe,
+                           uring_future->fsync.fd,
+                           uring_future->fsync.flags);
+      dex_uring_registry_apply_file (registry, sqe);
+      break;
+
+    case DEX_URING_TYPE_STATX:
+      io_uring_prep_statx (sqe,
+                           uring_future->statx.dirfd,
+                           uring_future->statx.path,
+                           uring_future->statx.flags,
+                           uring_future->statx.mask,
+                           uring_future->statx.statxbuf);
+      break;
+
+    case DEX_URING_TYPE_FALLOCATE:
+      io_uring_prep_fallocate (sqe,
+                               uring_future->fallocate.fd,
+                               uring_future->fallocate.mode,
+                               uring_future->fallocate.offset,
+                               uring_future->fallocate.length);
+      dex_uring_registry_apply_file (registry, sqe);
+      break;
+
+    case DEX_URING_TYPE_READV:
+      io_uring_prep_readv (sqe,
+                           uring_future->readv.fd,
+                           uring_future->readv.iov,
+                           uring_future->readv.n_iov,
+                           uring_future->readv.offset);
+      dex_uring_registry_apply_file (registry, sqe);
+      break;
+
+    case DEX_URING_TYPE_WRITEV:
+      io_uring_prep_writev (sqe,
+                            uring_future->writev.fd,
+                            uring_future->writev.iov,
+                            uring_future->writev.n_iov,
+                            uring_future->writev.offset);
+      dex_uring_registry_apply_file (registry, sqe);
+      break;
+
+    case DEX_URING_TYPE_SPLICE:
+      io_uring_prep_splice (sqe,
+                            uring_future->splice.fd_in,
+                            uring_future->splice.offset_in,
+                            uring_future->splice.fd_out,
+                            uring_future->splice.offset_out,
+                            uring_future->splice.length,
+                            uring_future->splice.flags);
+      break;
+
+#if DEX_URING_CHECK_VERSION(2, 0)
+    case DEX_URING_TYPE_RENAMEAT:
+      io_uring_prep_renameat (sqe,
+                              uring_future->renameat.old_dirfd,
+                              uring_future->renameat.old_path,
+                              uring_future->renameat.new_dirfd,
+                              uring_future->renameat.new_path,
+                              uring_future->renameat.flags);
+      break;
+
+    case DEX_URING_TYPE_UNLINKAT:
+      io_uring_prep_unlinkat (sqe,
+                              uring_future->unlinkat.dirfd,
+                              uring_future->unlinkat.path,
+                              uring_future->unlinkat.flags);
+      break;
+#endif
+
+#if DEX_URING_CHECK_VERSION(2, 1)
+    case DEX_URING_TYPE_MKDIRAT:
+      io_uring_prep_mkdirat (sqe,
+                             uring_future->mkdirat.dirfd,
+                             uring_future->mkdirat.path,
+                             uring_future->mkdirat.mode);
+      break;
+#endif
+
+    case DEX_URING_TYPE_ACCEPT:
+      io_uring_prep_accept (sqe,
+                            uring_future->accept.fd,
+                            uring_future->accept.addr,
+                            uring_future->accept.addrlen,
+                            uring_future->accept.flags);
+      break;
+
+    case DEX_URING_TYPE_CONNECT:
+      io_uring_prep_connect (sqe,
+                             uring_future->connect.fd,
+                             uring_future->connect.addr,
+                             uring_future->connect.addrlen);
+      break;
+
+    case DEX_URING_TYPE_RECV:
+      io_uring_prep_recv (sqe,
+                          uring_future->recv.fd,
+                          uring_future->recv.buffer,
+                          uring_future->recv.count,
+                          uring_future->recv.flags);
+      break;
+
+    case DEX_URING_TYPE_SEND:
+      io_uring_prep_send (sqe,
+                          uring_future->send.fd,
+                          uring_future->send.buffer,
+                          uring_future->send.count,
+                          uring_future->send.flags);
+      break;
+
+    case DEX_URING_TYPE_RECVMSG:
+      io_uring_prep_recvmsg (sqe,
+                             uring_future->recvmsg.fd,
+                             uring_future->recvmsg.msg,
+                             uring_future->recvmsg.flags);
+      break;
+
+    case DEX_URING_TYPE_SENDMSG:
+      io_uring_prep_sendmsg (sqe,
+                             uring_future->sendmsg.fd,
+                             uring_future->sendmsg.msg,
+                             uring_future->sendmsg.flags);
+      break;
+
+#if DEX_URING_CHECK_VERSION(2, 3)
+    case DEX_URING_TYPE_ACCEPT_STREAM:
+      io_uring_prep_multishot_accept (sqe,
+                                      uring_future->stream.fd,
+                                      NULL,
+                                      NULL,
+                                      uring_future->stream.flags);
+      break;
+
+    case DEX_URING_TYPE_RECV_STREAM:
+      /* Registration has to happen on the thread submitting to @ring
+       * as it may have been created with IORING_SETUP_SINGLE_ISSUER.
+       */
+      if (uring_future->stream.buf_ring == NULL)
+        {
+          int ret = dex_uring_future_register_buf_ring (uring_future, ring);
+
+          if (ret < 0)
+            {
+              uring_future->stream.setup_error = ret;
+              io_uring_prep_nop (sqe);
+              break;
+            }
+        }
+
+      io_uring_prep_recv_multishot (sqe,
+                                    uring_future->stream.fd,
+                                    NULL,
+                                    0,
+                                    uring_future->stream.flags);
+      sqe->flags |= IOSQE_BUFFER_SELECT;
+      sqe->buf_group = uring_future->stream.buf_group;
+      break;
+#endif
+
     default:
       g_assert_not_reached ();
     }
@@ -317,3 +1399,325 @@ dex_uring_future_new_write (int           fd,
 
   return future;
 }
+
+DexUringFuture *
+dex_uring_future_new_fsync (int      fd,
+                            gboolean datasync)
+{
+  DexUringFuture *future;
+
+  future = (DexUringFuture *)dex_object_create_instance (DEX_TYPE_URING_FUTURE);
+  future->type = DEX_URING_TYPE_FSYNC;
+  future->fsync.fd = fd;
+  future->fsync.flags = datasync ? IORING_FSYNC_DATASYNC : 0;
+  future->fsync.result = -1;
+
+  return future;
+}
+
+DexUringFuture *
+dex_uring_future_new_statx (int           dirfd,
+                            const char   *path,
+                            int           flags,
+                            guint         mask,
+                            struct statx *statxbuf)
+{
+  DexUringFuture *future;
+
+  future = (DexUringFuture *)dex_object_create_instance (DEX_TYPE_URING_FUTURE);
+  future->type = DEX_URING_TYPE_STATX;
+  future->statx.dirfd = dirfd;
+  future->statx.path = g_strdup (path);
+  future->statx.flags = flags;
+  future->statx.mask = mask;
+  future->statx.statxbuf = statxbuf;
+  future->statx.result = -1;
+
+  return future;
+}
+
+DexUringFuture *
+dex_uring_future_new_fallocate (int     fd,
+                                int     mode,
+                                goffset offset,
+                                goffset length)
+{
+  DexUringFuture *future;
+
+  future = (DexUringFuture *)dex_object_create_instance (DEX_TYPE_URING_FUTURE);
+  future->type = DEX_URING_TYPE_FALLOCATE;
+  future->fallocate.fd = fd;
+  future->fallocate.mode = mode;
+  future->fallocate.offset = offset;
+  future->fallocate.length = length;
+  future->fallocate.result = -1;
+
+  return future;
+}
+
+DexUringFuture *
+dex_uring_future_new_readv (int           fd,
+                            GInputVector *vectors,
+                            guint         n_vectors,
+                            goffset       offset)
+{
+  DexUringFuture *future;
+
+  future = (DexUringFuture *)dex_object_create_instance (DEX_TYPE_URING_FUTURE);
+  future->type = DEX_URING_TYPE_READV;
+  future->readv.fd = fd;
+  future->readv.iov = g_memdup2 (vectors, sizeof (struct iovec) * n_vectors);
+  future->readv.n_iov = n_vectors;
+  future->readv.offset = offset;
+  future->readv.result = -1;
+
+  return future;
+}
+
+DexUringFuture *
+dex_uring_future_new_writev (int                  fd,
+                             const GOutputVector *vectors,
+                             guint                n_vectors,
+                             goffset              offset)
+{
+  DexUringFuture *future;
+
+  future = (DexUringFuture *)dex_object_create_instance (DEX_TYPE_URING_FUTURE);
+  future->type = DEX_URING_TYPE_WRITEV;
+  future->writev.fd = fd;
+  future->writev.iov = g_memdup2 (vectors, sizeof (struct iovec) * n_vectors);
+  future->writev.n_iov = n_vectors;
+  future->writev.offset = offset;
+  future->writev.result = -1;
+
+  return future;
+}
+
+DexUringFuture *
+dex_uring_future_new_splice (int     fd_in,
+                             goffset offset_in,
+                             int     fd_out,
+                             goffset offset_out,
+                             gsize   length,
+                             guint   flags)
+{
+  DexUringFuture *future;
+
+  future = (DexUringFuture *)dex_object_create_instance (DEX_TYPE_URING_FUTURE);
+  future->type = DEX_URING_TYPE_SPLICE;
+  future->splice.fd_in = fd_in;
+  future->splice.offset_in = offset_in;
+  future->splice.fd_out = fd_out;
+  future->splice.offset_out = offset_out;
+  future->splice.length = length;
+  future->splice.flags = flags;
+  future->splice.result = -1;
+
+  return future;
+}
+
+DexUringFuture *
+dex_uring_future_new_renameat (int         old_dirfd,
+                               const char *old_path,
+                               int         new_dirfd,
+                               const char *new_path,
+                               guint       flags)
+{
+  DexUringFuture *future;
+
+  future = (DexUringFuture *)dex_object_create_instance (DEX_TYPE_URING_FUTURE);
+  future->type = DEX_URING_TYPE_RENAMEAT;
+  future->renameat.old_dirfd = old_dirfd;
+  future->renameat.old_path = g_strdup (old_path);
+  future->renameat.new_dirfd = new_dirfd;
+  future->renameat.new_path = g_strdup (new_path);
+  future->renameat.flags = flags;
+  future->renameat.result = -1;
+
+  return future;
+}
+
+DexUringFuture *
+dex_uring_future_new_unlinkat (int         dirfd,
+                               const char *path,
+                               int         flags)
+{
+  DexUringFuture *future;
+
+  future = (DexUringFuture *)dex_object_create_instance (DEX_TYPE_URING_FUTURE);
+  future->type = DEX_URING_TYPE_UNLINKAT;
+  future->unlinkat.dirfd = dirfd;
+  future->unlinkat.path = g_strdup (path);
+  future->unlinkat.flags = flags;
+  future->unlinkat.result = -1;
+
+  return future;
+}
+
+DexUringFuture *
+dex_uring_future_new_mkdirat (int         dirfd,
+                              const char *path,
+                              int         mode)
+{
+  DexUringFuture *future;
+
+  future = (DexUringFuture *)dex_object_create_instance (DEX_TYPE_URING_FUTURE);
+  future->type = DEX_URING_TYPE_MKDIRAT;
+  future->mkdirat.dirfd = dirfd;
+  future->mkdirat.path = g_strdup (path);
+  future->mkdirat.mode = mode;
+  future->mkdirat.result = -1;
+
+  return future;
+}
+
+DexUringFuture *
+dex_uring_future_new_accept (int              fd,
+                             struct sockaddr *addr,
+                             socklen_t       *addrlen,
+                             int              flags)
+{
+  DexUringFuture *future;
+
+  future = (DexUringFuture *)dex_object_create_instance (DEX_TYPE_URING_FUTURE);
+  future->type = DEX_URING_TYPE_ACCEPT;
+  future->accept.fd = fd;
+  future->accept.addr = addr;
+  future->accept.addrlen = addrlen;
+  future->accept.flags = flags;
+  future->accept.result = -1;
+
+  return future;
+}
+
+DexUringFuture *
+dex_uring_future_new_connect (int                    fd,
+                              const struct sockaddr *addr,
+                              socklen_t              addrlen)
+{
+  DexUringFuture *future;
+
+  future = (DexUringFuture *)dex_object_create_instance (DEX_TYPE_URING_FUTURE);
+  future->type = DEX_URING_TYPE_CONNECT;
+  future->connect.fd = fd;
+  future->connect.addr = g_memdup2 (addr, addrlen);
+  future->connect.addrlen = addrlen;
+  future->connect.result = -1;
+
+  return future;
+}
+
+DexUringFuture *
+dex_uring_future_new_recv (int      fd,
+                           gpointer buffer,
+                           gsize    count,
+                           int      flags)
+{
+  DexUringFuture *future;
+
+  future = (DexUringFuture *)dex_object_create_instance (DEX_TYPE_URING_FUTURE);
+  future->type = DEX_URING_TYPE_RECV;
+  future->recv.fd = fd;
+  future->recv.buffer = buffer;
+  future->recv.count = count;
+  future->recv.flags = flags;
+  future->recv.result = -1;
+
+  return future;
+}
+
+DexUringFuture *
+dex_uring_future_new_send (int           fd,
+                           gconstpointer buffer,
+                           gsize         count,
+                           int           flags)
+{
+  DexUringFuture *future;
+
+  future = (DexUringFuture *)dex_object_create_instance (DEX_TYPE_URING_FUTURE);
+  future->type = DEX_URING_TYPE_SEND;
+  future->send.fd = fd;
+  future->send.buffer = buffer;
+  future->send.count = count;
+  future->send.flags = flags;
+  future->send.result = -1;
+
+  return future;
+}
+
+DexUringFuture *
+dex_uring_future_new_recvmsg (int            fd,
+                              struct msghdr *msg,
+                              int            flags)
+{
+  DexUringFuture *future;
+
+  future = (DexUringFuture *)dex_object_create_instance (DEX_TYPE_URING_FUTURE);
+  future->type = DEX_URING_TYPE_RECVMSG;
+  future->recvmsg.fd = fd;
+  future->recvmsg.msg = msg;
+  future->recvmsg.flags = flags;
+  future->recvmsg.result = -1;
+
+  return future;
+}
+
+DexUringFuture *
+dex_uring_future_new_sendmsg (int                  fd,
+                              const struct msghdr *msg,
+                              int                  flags)
+{
+  DexUringFuture *future;
+
+  future = (DexUringFuture *)dex_object_create_instance (DEX_TYPE_URING_FUTURE);
+  future->type = DEX_URING_TYPE_SENDMSG;
+  future->sendmsg.fd = fd;
+  future->sendmsg.msg = msg;
+  future->sendmsg.flags = flags;
+  future->sendmsg.result = -1;
+
+  return future;
+}
+
+DexUringFuture *
+dex_uring_future_new_accept_stream (int         fd,
+                                    int         flags,
+                                    DexChannel *channel)
+{
+  DexUringFuture *future;
+
+  future = (DexUringFuture *)dex_object_create_instance (DEX_TYPE_URING_FUTURE);
+  future->type = DEX_URING_TYPE_ACCEPT_STREAM;
+  future->stream.fd = fd;
+  future->stream.flags = flags;
+  future->stream.channel = dex_ref (channel);
+  future->stream.result = -1;
+
+  return future;
+}
+
+DexUringFuture *
+dex_uring_future_new_recv_stream (int         fd,
+                                  gsize       buffer_size,
+                                  guint       n_buffers,
+                                  int         flags,
+                                  DexChannel *channel)
+{
+  DexUringFuture *future;
+
+  future = (DexUringFuture *)dex_object_create_instance (DEX_TYPE_URING_FUTURE);
+  future->type = DEX_URING_TYPE_RECV_STREAM;
+  future->stream.fd = fd;
+  future->stream.flags = flags;
+  future->stream.channel = dex_ref (channel);
+  future->stream.buffer_size = buffer_size;
+  future->stream.n_buffers = 1;
+  future->stream.buf_group = -1;
+  future->stream.result = -1;
+
+  /* Buffer rings must be a power of two in length */
+  while (future->stream.n_buffers < MIN (n_buffers, 32768))
+    future->stream.n_buffers <<= 1;
+
+  return future;
+}
@@ -31,12 +31,19 @@ G_BEGIN_DECLS
 
 typedef struct _DexWorkQueue DexWorkQueue;
 
-GType         dex_work_queue_get_type (void);
-DexWorkQueue *dex_work_queue_new      (void);
-void          dex_work_queue_push     (DexWorkQueue *work_queue,
-                                       DexWorkItem   work_item);
-gboolean      dex_work_queue_try_pop  (DexWorkQueue *work_queue,
-                                       DexWorkItem  *out_work_item);
-DexFuture    *dex_work_queue_run      (DexWorkQueue *work_queue);
+GType         dex_work_queue_get_type  (void);
+DexWorkQueue *dex_work_queue_new       (void);
+void          dex_work_queue_push      (DexWorkQueue *work_queue,
+                                        DexWorkItem   work_item);
+gboolean      dex_work_queue_try_pop   (DexWorkQueue *work_queue,
+                                        DexWorkItem  *out_work_item);
+gboolean      dex_work_queue_is_empty  (DexWorkQueue *work_queue);
+DexFuture    *dex_work_queue_wait      (DexWorkQueue *work_queue);
+DexFuture    *dex_work_queue_wait_many (DexWorkQueue *work_queue,
+                                        guint         max_items);
+void          dex_work_queue_release   (DexWorkQueue *work_queue,
+                                        guint         n_items);
+void          dex_work_queue_withdraw  (DexWorkQueue *work_queue,
+                                        DexScheduler *scheduler);
 
 G_END_DECLS
@@ -21,16 +21,85 @@
 
 #include "config.h"
 
+#include <stdatomic.h>
+
 #include "dex-object-private.h"
 #include "dex-semaphore-private.h"
 #include "dex-work-queue-private.h"
 
+/*
+ * NOTES:
+ *
+ * The global work queue is fed by any thread which is not a thread pool
+ * worker (and therefore has no work-stealing queue of its own) and drained
+ * by every worker of the pool. That makes it a multi-producer/multi-consumer
+ * queue and, under load, a serious point of contention if it is protected
+ * by a single mutex.
+ *
+ * This is an unbounded, lock-free MPMC queue built from a linked list of
+ * fixed-size blocks. It is based upon the design of SegQueue from the
+ * crossbeam project (MIT/Apache-2.0).
+ *
+ * Both the head and tail are an index plus a pointer to the block the index
+ * is currently within. The low bit of the index is used by the head to note
+ * that there is a block following the current one so that consumers may
+ * avoid reading the tail in the common case.
+ *
+ * Producers claim a slot by advancing the tail index with a CAS and then
+ * publish the work item by setting WRITE on the slot. Consumers claim a slot
+ * by advancing the head index and wait for WRITE to be set (which is only
+ * ever a short window). The producer which claims the last slot in a block
+ * installs the next block.
+ *
+ * A block may be released once every slot has been read. Consumers which
+ * are still reading from a block are tracked with the READ and DESTROY bits
+ * so that whichever thread finishes last releases the block.
+ *
+ * Work items are stored inline within the block so the only allocations
+ * happen when crossing into a new block. Released blocks are kept in a
+ * single spare slot so that a queue oscillating around a small number of
+ * items does not allocate at all.
+ */
+
+#ifndef DEX_CACHELINE_SIZE
+# define DEX_CACHELINE_SIZE 64
+#endif
+
+#define LAP       32
+#define BLOCK_CAP (LAP - 1)
+#define SHIFT     1
+#define HAS_NEXT  1
+
+#define SLOT_WRITE   (1 << 0)
+#define SLOT_READ    (1 << 1)
+#define SLOT_DESTROY (1 << 2)
+
+typedef struct _DexWorkQueueSlot
+{
+  DexWorkItem    work_item;
+  _Atomic(guint) state;
+} DexWorkQueueSlot;
+
+typedef struct _DexWorkQueueBlock
+{
+  struct _DexWorkQueueBlock * _Atomic next;
+  DexWorkQueueSlot                    slots[BLOCK_CAP];
+} DexWorkQueueBlock;
+
+typedef struct _DexWorkQueuePosition
+{
+  _Atomic(gsize)                index;
+  DexWorkQueueBlock * _Atomic   block;
+  char                          padding[DEX_CACHELINE_SIZE - sizeof (gsize) - sizeof (gpointer)];
+} DexWorkQueuePosition;
+
 struct _DexWorkQueue
 {
-  DexObject parent_instance;
-  DexSemaphore *semaphore;
-  GMutex mutex;
-  GQueue queue;
+  DexObject                    parent_instance;
+  DexSemaphore                *semaphore;
+  DexWorkQueueBlock * _Atomic  spare;
+  DexWorkQueuePosition         head;
+  DexWorkQueuePosition         tail;
 };
 
 typedef struct _DexWorkQueueClass
@@ -40,22 +109,114 @@ typedef struct _DexWorkQueueClass
 
 DEX_DEFINE_FINAL_TYPE (DexWorkQueue, dex_work_queue, DEX_TYPE_OBJECT)
 
-typedef struct _DexWorkQueueItem
+static inline void
+dex_work_queue_snooze (void)
+{
+  g_thread_yield ();
+}
+
+static DexWorkQueueBlock *
+dex_work_queue_block_new (DexWorkQueue *work_queue)
+{
+  DexWorkQueueBlock *block;
+
+  if ((block = atomic_exchange_explicit (&work_queue->spare, NULL, memory_order_acquire)))
+    {
+      atomic_store_explicit (&block->next, NULL, memory_order_relaxed);
+      for (guint i = 0; i < BLOCK_CAP; i++)
+        atomic_store_explicit (&block->slots[i].state, 0, memory_order_relaxed);
+      return block;
+    }
+
+  return g_new0 (DexWorkQueueBlock, 1);
+}
+
+static void
+dex_work_queue_block_release (DexWorkQueue      *work_queue,
+                              DexWorkQueueBlock *block)
+{
+  DexWorkQueueBlock *expected = NULL;
+
+  if (!atomic_compare_exchange_strong_explicit (&work_queue->spare,
+                                                &expected,
+                                                block,
+                                                memory_order_release,
+                                                memory_order_relaxed))
+    g_free (block);
+}
+
+static DexWorkQueueBlock *
+dex_work_queue_block_wait_next (DexWorkQueueBlock *block)
+{
+  DexWorkQueueBlock *next;
+
+  while (!(next = atomic_load_explicit (&block->next, memory_order_acquire)))
+    dex_work_queue_snooze ();
+
+  return next;
+}
+
+/* Release @block unless a consumer is still reading one of the slots
+ * starting at @start. In that case, the consumer will notice DESTROY
+ * once it has finished and continue releasing the block.
+ */
+static void
+dex_work_queue_block_destroy (DexWorkQueue      *work_queue,
+                              DexWorkQueueBlock *block,
+                              guint              start)
 {
-  GList link;
-  DexWorkItem work_item;
-} DexWorkQueueItem;
+  /* The last slot need not be marked as that is the slot which
+   * started destruction of the block.
+   */
+  for (guint i = start; i < BLOCK_CAP - 1; i++)
+    {
+      DexWorkQueueSlot *slot = &block->slots[i];
+
+      if ((atomic_load_explicit (&slot->state, memory_order_acquire) & SLOT_READ) == 0 &&
+          (atomic_fetch_or_explicit (&slot->state, SLOT_DESTROY, memory_order_acq_rel) & SLOT_READ) == 0)
+        return;
+    }
+
+  dex_work_queue_block_release (work_queue, block);
+}
 
 static void
 dex_work_queue_finalize (DexObject *object)
 {
   DexWorkQueue *work_queue = DEX_WORK_QUEUE (object);
+  DexWorkQueueBlock *block;
+  gsize head;
+  gsize tail;
+  guint n_items = 0;
+
+  head = atomic_load (&work_queue->head.index) & ~HAS_NEXT;
+  tail = atomic_load (&work_queue->tail.index) & ~HAS_NEXT;
+  block = atomic_load (&work_queue->head.block);
 
-  if (work_queue->queue.length > 0)
+  /* Release every block still reachable from the head */
+  while (head != tail)
+    {
+      if (((head >> SHIFT) % LAP) < BLOCK_CAP)
+        {
+          n_items++;
+        }
+      else
+        {
+          DexWorkQueueBlock *next = atomic_load (&block->next);
+          g_free (block);
+          block = next;
+        }
+
+      head += (1 << SHIFT);
+    }
+
+  g_free (block);
+  g_free (atomic_exchange (&work_queue->spare, NULL));
+
+  if (n_items > 0)
     g_critical ("Work queue %p freed with %u items still in it!",
-                work_queue, work_queue->queue.length);
+                work_queue, n_items);
 
-  g_mutex_clear (&work_queue->mutex);
   dex_clear (&work_queue->semaphore);
 
   DEX_OBJECT_CLASS (dex_work_queue_parent_class)->finalize (object);
@@ -72,8 +233,15 @@ dex_work_queue_class_init (DexWorkQueueClass *work_queue_class)
 static void
 dex_work_queue_init (DexWorkQueue *work_queue)
 {
+  DexWorkQueueBlock *block = g_new0 (DexWorkQueueBlock, 1);
+
   work_queue->semaphore = dex_semaphore_new ();
-  g_mutex_init (&work_queue->mutex);
+
+  atomic_init (&work_queue->spare, NULL);
+  atomic_init (&work_queue->head.index, 0);
+  atomic_init (&work_queue->head.block, block);
+  atomic_init (&work_queue->tail.index, 0);
+  atomic_init (&work_queue->tail.block, block);
 }
 
 DexWorkQueue *
@@ -86,18 +254,71 @@ void
 dex_work_queue_push (DexWorkQueue *work_queue,
                      DexWorkItem   work_item)
 {
-  DexWorkQueueItem *work_queue_item;
+  DexWorkQueueBlock *next_block = NULL;
+  DexWorkQueueBlock *block;
+  gsize tail;
 
   g_return_if_fail (DEX_IS_WORK_QUEUE (work_queue));
   g_return_if_fail (work_item.func != NULL);
 
-  work_queue_item = g_new0 (DexWorkQueueItem, 1);
-  work_queue_item->link.data = work_queue_item;
-  work_queue_item->work_item = work_item;
+  tail = atomic_load_explicit (&work_queue->tail.index, memory_order_acquire);
+  block = atomic_load_explicit (&work_queue->tail.block, memory_order_acquire);
 
-  g_mutex_lock (&work_queue->mutex);
-  g_queue_push_tail_link (&work_queue->queue, &work_queue_item->link);
-  g_mutex_unlock (&work_queue->mutex);
+  for (;;)
+    {
+      gsize offset = (tail >> SHIFT) % LAP;
+      gsize new_tail;
+
+      /* Another producer is installing the next block, wait for it */
+      if G_UNLIKELY (offset == BLOCK_CAP)
+        {
+          dex_work_queue_snooze ();
+          tail = atomic_load_explicit (&work_queue->tail.index, memory_order_acquire);
+          block = atomic_load_explicit (&work_queue->tail.block, memory_order_acquire);
+          continue;
+        }
+
+      /* If we are about to fill the block, get the next block ready now so
+       * that the window where other producers must wait is as small as
+       * possible.
+       */
+      if G_UNLIKELY (offset + 1 == BLOCK_CAP && next_block == NULL)
+        next_block = dex_work_queue_block_new (work_queue);
+
+      new_tail = tail + (1 << SHIFT);
+
+      if (atomic_compare_exchange_weak_explicit (&work_queue->tail.index,
+                                                 &tail,
+                                                 new_tail,
+                                                 memory_order_seq_cst,
+                                                 memory_order_acquire))
+        {
+          DexWorkQueueSlot *slot = &block->slots[offset];
+
+          if G_UNLIKELY (offset + 1 == BLOCK_CAP)
+            {
+              gsize next_index = new_tail + (1 << SHIFT);
+
+              atomic_store_explicit (&work_queue->tail.block, next_block, memory_order_release);
+              atomic_store_explicit (&work_queue->tail.index, next_index, memory_order_release);
+              atomic_store_explicit (&block->next, next_block, memory_order_release);
+
+              next_block = NULL;
+            }
+
+          slot->work_item = work_item;
+          atomic_fetch_or_explicit (&slot->state, SLOT_WRITE, memory_order_release);
+
+          break;
+        }
+
+      /* @tail was updated by the failed compare-exchange */
+      block = atomic_load_explicit (&work_queue->tail.block, memory_order_acquire);
+    }
+
+  /* We may have raced for the last slot and lost */
+  if G_UNLIKELY (next_block != NULL)
+    dex_work_queue_block_release (work_queue, next_block);
 
   dex_semaphore_post (work_queue->semaphore);
 }
@@ -106,52 +327,148 @@ gboolean
 dex_work_queue_try_pop (DexWorkQueue *work_queue,
                         DexWorkItem  *out_work_item)
 {
-  GList *link;
+  DexWorkQueueBlock *block;
+  gsize head;
 
   g_return_val_if_fail (DEX_IS_WORK_QUEUE (work_queue), FALSE);
   g_return_val_if_fail (out_work_item != NULL, FALSE);
 
-  g_mutex_lock (&work_queue->mutex);
-  link = g_queue_pop_head_link (&work_queue->queue);
-  g_mutex_unlock (&work_queue->mutex);
+  head = atomic_load_explicit (&work_queue->head.index, memory_order_acquire);
+  block = atomic_load_explicit (&work_queue->head.block, memory_order_acquire);
 
-  if (link != NULL)
+  for (;;)
     {
-      DexWorkQueueItem *item = link->data;
-      *out_work_item = item->work_item;
-      g_free (item);
+      gsize offset = (head >> SHIFT) % LAP;
+      gsize new_head;
+
+      /* Another consumer is moving the head to the next block */
+      if G_UNLIKELY (offset == BLOCK_CAP)
+        {
+          dex_work_queue_snooze ();
+          head = atomic_load_explicit (&work_queue->head.index, memory_order_acquire);
+          block = atomic_load_explicit (&work_queue->head.block, memory_order_acquire);
+          continue;
+        }
+
+      new_head = head + (1 << SHIFT);
+
+      /* Only look at the tail if we don't already know there is
+       * another block following this one.
+       */
+      if ((new_head & HAS_NEXT) == 0)
+        {
+          gsize tail;
+
+          atomic_thread_fence (memory_order_seq_cst);
+          tail = atomic_load_explicit (&work_queue->tail.index, memory_order_relaxed);
+
+          /* Queue is empty */
+          if ((head >> SHIFT) == (tail >> SHIFT))
+            return FALSE;
+
+          if ((head >> SHIFT) / LAP != (tail >> SHIFT) / LAP)
+            new_head |= HAS_NEXT;
+        }
+
+      if (atomic_compare_exchange_weak_explicit (&work_queue->head.index,
+                                                 &head,
+                                                 new_head,
+                                                 memory_order_seq_cst,
+                                                 memory_order_acquire))
+        {
+          DexWorkQueueSlot *slot = &block->slots[offset];
+
+          if G_UNLIKELY (offset + 1 == BLOCK_CAP)
+            {
+              DexWorkQueueBlock *next = dex_work_queue_block_wait_next (block);
+              gsize next_index = (new_head & ~HAS_NEXT) + (1 << SHIFT);
+
+              if (atomic_load_explicit (&next->next, memory_order_relaxed) != NULL)
+                next_index |= HAS_NEXT;
+
+              atomic_store_explicit (&work_queue->head.block, next, memory_order_release);
+              atomic_store_explicit (&work_queue->head.index, next_index, memory_order_release);
+            }
+
+          /* The producer has claimed the slot but may not have stored
+           * the work item quite yet.
+           */
+          while ((atomic_load_explicit (&slot->state, memory_order_acquire) & SLOT_WRITE) == 0)
+            dex_work_queue_snooze ();
+
+          *out_work_item = slot->work_item;
+
+          if G_UNLIKELY (offset + 1 == BLOCK_CAP)
+            dex_work_queue_block_destroy (work_queue, block, 0);
+          else if (atomic_fetch_or_explicit (&slot->state, SLOT_READ, memory_order_acq_rel) & SLOT_DESTROY)
+            dex_work_queue_block_destroy (work_queue, block, offset + 1);
+
+          return TRUE;
+        }
+
+      /* @head was updated by the failed compare-exchange */
+      block = atomic_load_explicit (&work_queue->head.block, memory_order_acquire);
     }
-
-  return link != NULL;
 }
 
-static DexFuture *
-dex_work_queue_run_cb (DexFuture *future,
-                       gpointer   user_data)
+gboolean
+dex_work_queue_is_empty (DexWorkQueue *work_queue)
 {
-  DexWorkQueue *work_queue = user_data;
-  DexWorkItem work_item;
+  gsize head;
+  gsize tail;
 
-  g_assert (DEX_IS_WORK_QUEUE (work_queue));
+  g_return_val_if_fail (DEX_IS_WORK_QUEUE (work_queue), TRUE);
 
-  if (dex_work_queue_try_pop (work_queue, &work_item))
-    dex_work_item_invoke (&work_item);
+  head = atomic_load_explicit (&work_queue->head.index, memory_order_acquire);
+  tail = atomic_load_explicit (&work_queue->tail.index, memory_order_acquire);
+
+  return (head >> SHIFT) == (tail >> SHIFT);
+}
+
+/* Each push completes a single waiter so that we only wake up one
+ * consumer per work item.
+ */
+DexFuture *
+dex_work_queue_wait (DexWorkQueue *work_queue)
+{
+  g_return_val_if_fail (DEX_IS_WORK_QUEUE (work_queue), NULL);
 
   return dex_semaphore_wait (work_queue->semaphore);
 }
 
+/* Reserves up to @max_items items for the caller to pop, waiting until
+ * there is at least one. The future resolves to the number reserved as
+ * a guint.
+ */
 DexFuture *
-dex_work_queue_run (DexWorkQueue *work_queue)
+dex_work_queue_wait_many (DexWorkQueue *work_queue,
+                          guint         max_items)
 {
-  DexFuture *future;
+  g_return_val_if_fail (DEX_IS_WORK_QUEUE (work_queue), NULL);
 
-  g_return_val_if_fail (work_queue != NULL, NULL);
+  return dex_semaphore_wait_many (work_queue->semaphore, max_items);
+}
 
-  future = dex_semaphore_wait (work_queue->semaphore);
-  future = dex_future_finally_loop (future,
-                                    dex_work_queue_run_cb,
-                                    dex_ref (work_queue),
-                                    dex_unref);
+/* Gives back reservations for items the caller will not pop so that
+ * another consumer is woken up for them.
+ */
+void
+dex_work_queue_release (DexWorkQueue *work_queue,
+                        guint         n_items)
+{
+  g_return_if_fail (DEX_IS_WORK_QUEUE (work_queue));
+
+  dex_semaphore_post_many (work_queue->semaphore, n_items);
+}
+
+/* Withdraws any consumer waiting on @scheduler so that it no longer
+ * reserves items, such as when a worker is parked.
+ */
+void
+dex_work_queue_withdraw (DexWorkQueue *work_queue,
+                         DexScheduler *scheduler)
+{
+  g_return_if_fail (DEX_IS_WORK_QUEUE (work_queue));
 
-  return future;
+  dex_semaphore_withdraw (work_queue->semaphore, scheduler);
 }
@@ -89,13 +89,17 @@ typedef struct _DexWorkStealingQueue
   _Alignas(DEX_CACHELINE_SIZE) _Atomic(gint64)                bottom;
   _Alignas(DEX_CACHELINE_SIZE) _Atomic(DexWorkStealingArray*) array;
                                        GPtrArray             *garbage;
+                                       gint64                 min_capacity;
                                        gatomicrefcount        ref_count;
+  _Alignas(DEX_CACHELINE_SIZE) _Atomic(guint)                 n_stealers;
 } DexWorkStealingQueue;
 
 DexWorkStealingQueue *dex_work_stealing_queue_new           (gint64                capacity);
 DexWorkStealingQueue *dex_work_stealing_queue_ref           (DexWorkStealingQueue *work_stealing_queue);
 void                  dex_work_stealing_queue_unref         (DexWorkStealingQueue *work_stealing_queue);
 GSource              *dex_work_stealing_queue_create_source (DexWorkStealingQueue *work_stealing_queue);
+void                  dex_work_stealing_queue_collect       (DexWorkStealingQueue *work_stealing_queue);
+void                  dex_work_stealing_queue_trim          (DexWorkStealingQueue *work_stealing_queue);
 
 static inline DexWorkStealingArray *
 dex_work_stealing_array_new (gint64 c)
@@ -197,6 +201,7 @@ dex_work_stealing_queue_push (DexWorkStealingQueue *work_stealing_queue,
       g_ptr_array_add (work_stealing_queue->garbage, a);
       a = tmp;
       atomic_store_explicit (&work_stealing_queue->array, a, memory_order_relaxed);
+      dex_work_stealing_queue_collect (work_stealing_queue);
     }
 
   dex_work_stealing_array_push (a, b, work_item);
@@ -225,7 +230,16 @@ dex_work_stealing_queue_pop (DexWorkStealingQueue *work_stealing_queue,
   gint64 b;
   gint64 t;
 
-  b = atomic_load_explicit (&work_stealing_queue->bottom, memory_order_relaxed) - 1;
+  b = atomic_load_explicit (&work_stealing_queue->bottom, memory_order_relaxed);
+  t = atomic_load_explicit (&work_stealing_queue->top, memory_order_relaxed);
+
+  /* Top only ever moves forward, so if the queue looks empty here it is.
+   * That saves the store and fence below when polling an empty queue.
+   */
+  if (b <= t)
+    return FALSE;
+
+  b--;
   a = atomic_load_explicit (&work_stealing_queue->array, memory_order_relaxed);
   atomic_store_explicit (&work_stealing_queue->bottom, b, memory_order_relaxed);
   atomic_thread_fence (memory_order_seq_cst);
@@ -275,9 +289,15 @@ static inline gboolean
 dex_work_stealing_queue_steal (DexWorkStealingQueue *work_stealing_queue,
                                DexWorkItem          *out_work_item)
 {
+  gboolean ret = FALSE;
   gint64 t;
   gint64 b;
 
+  /* Announce ourselves before loading the array so that it is not freed
+   * out from under us. See dex_work_stealing_queue_collect().
+   */
+  atomic_fetch_add_explicit (&work_stealing_queue->n_stealers, 1, memory_order_seq_cst);
+
   t = atomic_load_explicit (&work_stealing_queue->top, memory_order_acquire);
   atomic_thread_fence (memory_order_seq_cst);
   b = atomic_load_explicit (&work_stealing_queue->bottom, memory_order_acquire);
@@ -293,10 +313,58 @@ dex_work_stealing_queue_steal (DexWorkStealingQueue *work_stealing_queue,
                                                    t + 1,
                                                    memory_order_seq_cst,
                                                    memory_order_relaxed))
-        return TRUE;
+        ret = TRUE;
+    }
+
+  atomic_fetch_sub_explicit (&work_stealing_queue->n_stealers, 1, memory_order_release);
+
+  return ret;
+}
+
+/**
+ * dex_work_stealing_queue_steal_half:
+ * @work_stealing_queue: a #DexWorkStealingQueue
+ * @local: the #DexWorkStealingQueue owned by the calling thread
+ * @out_work_item: (out): a location to store the first work item
+ *
+ * Attempts to steal half of the work items in @work_stealing_queue. The
+ * first is stored in @out_work_item and the rest are pushed onto @local
+ * so the thief need not come back to the victim for each of them and
+ * other idle workers may in turn steal from the thief.
+ *
+ * Items are claimed one at a time. Advancing top past more than one item
+ * with a single compare-and-swap would race with the owner taking the
+ * last item without one.
+ *
+ * This function must _ONLY_ be called by the thread owning @local.
+ *
+ * Returns: the number of work items stolen
+ */
+static inline guint
+dex_work_stealing_queue_steal_half (DexWorkStealingQueue *work_stealing_queue,
+                                    DexWorkStealingQueue *local,
+                                    DexWorkItem          *out_work_item)
+{
+  gsize n_items;
+  guint n_stolen;
+
+  if (!dex_work_stealing_queue_steal (work_stealing_queue, out_work_item))
+    return 0;
+
+  /* Half of what was there before we took the first item, rounded up */
+  n_items = (dex_work_stealing_queue_size (work_stealing_queue) + 2) / 2;
+
+  for (n_stolen = 1; n_stolen < n_items; n_stolen++)
+    {
+      DexWorkItem work_item;
+
+      if (!dex_work_stealing_queue_steal (work_stealing_queue, &work_item))
+        break;
+
+      dex_work_stealing_queue_push (local, work_item);
     }
 
-  return FALSE;
+  return n_stolen;
 }
 
 static inline gint64
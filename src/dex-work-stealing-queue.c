@@ -26,10 +26,20 @@
 
 #define DEFAULT_BATCH_SIZE 32
 
+/* Go back to the initial capacity once drained if the array has grown
+ * to at least this many times that.
+ */
+#define TRIM_FACTOR 4
+
 DexWorkStealingQueue *
 dex_work_stealing_queue_new (gint64 capacity)
 {
   DexWorkStealingQueue *work_stealing_queue;
+  gint64 min_capacity = 2;
+
+  /* Items are indexed with a mask so this must be a power of two */
+  while (min_capacity < capacity)
+    min_capacity <<= 1;
 
   work_stealing_queue = g_aligned_alloc0 (1,
                                           sizeof (DexWorkStealingQueue),
@@ -37,9 +47,11 @@ dex_work_stealing_queue_new (gint64 capacity)
   atomic_store_explicit (&work_stealing_queue->top, 0, memory_order_relaxed);
   atomic_store_explicit (&work_stealing_queue->bottom, 0, memory_order_relaxed);
   atomic_store_explicit (&work_stealing_queue->array,
-                         dex_work_stealing_array_new (capacity),
+                         dex_work_stealing_array_new (min_capacity),
                          memory_order_relaxed);
-  work_stealing_queue->garbage = g_ptr_array_new_full (32, (GDestroyNotify)dex_work_stealing_array_free);
+  atomic_store_explicit (&work_stealing_queue->n_stealers, 0, memory_order_relaxed);
+  work_stealing_queue->garbage = g_ptr_array_new_full (4, (GDestroyNotify)dex_work_stealing_array_free);
+  work_stealing_queue->min_capacity = min_capacity;
   g_atomic_ref_count_init (&work_stealing_queue->ref_count);
 
   return work_stealing_queue;
@@ -72,6 +84,64 @@ dex_work_stealing_queue_unref (DexWorkStealingQueue *work_stealing_queue)
     }
 }
 
+/**
+ * dex_work_stealing_queue_collect:
+ * @work_stealing_queue: a #DexWorkStealingQueue
+ *
+ * Frees arrays which have been replaced when growing or trimming the
+ * queue once no thief may still be reading from them.
+ *
+ * Thieves announce themselves in n_stealers before loading the array.
+ * If there are none after the replacement was published, any thief
+ * that comes later is guaranteed to see the new array. Otherwise the
+ * arrays are kept until the next time this is called.
+ *
+ * This may _ONLY_ be called by the thread that owns @work_stealing_queue.
+ */
+void
+dex_work_stealing_queue_collect (DexWorkStealingQueue *work_stealing_queue)
+{
+  if (work_stealing_queue->garbage->len == 0)
+    return;
+
+  /* Pairs with the increment in dex_work_stealing_queue_steal() */
+  atomic_thread_fence (memory_order_seq_cst);
+
+  if (atomic_load_explicit (&work_stealing_queue->n_stealers, memory_order_acquire) == 0)
+    g_ptr_array_set_size (work_stealing_queue->garbage, 0);
+}
+
+/**
+ * dex_work_stealing_queue_trim:
+ * @work_stealing_queue: a #DexWorkStealingQueue
+ *
+ * Releases memory held on to after a burst of work items. If the queue
+ * is empty and has grown well past its initial capacity, it goes back
+ * to the initial capacity.
+ *
+ * This may _ONLY_ be called by the thread that owns @work_stealing_queue.
+ */
+void
+dex_work_stealing_queue_trim (DexWorkStealingQueue *work_stealing_queue)
+{
+  DexWorkStealingArray *a = atomic_load_explicit (&work_stealing_queue->array, memory_order_relaxed);
+
+  /* Nothing needs to be copied while empty. A thief which saw an item
+   * before it was taken will fail to advance top regardless of which
+   * array it loaded.
+   */
+  if (dex_work_stealing_array_capacity (a) >= work_stealing_queue->min_capacity * TRIM_FACTOR &&
+      dex_work_stealing_queue_empty (work_stealing_queue))
+    {
+      g_ptr_array_add (work_stealing_queue->garbage, a);
+      atomic_store_explicit (&work_stealing_queue->array,
+                             dex_work_stealing_array_new (work_stealing_queue->min_capacity),
+                             memory_order_release);
+    }
+
+  dex_work_stealing_queue_collect (work_stealing_queue);
+}
+
 typedef struct _DexWorkStealingQueueSource
 {
   GSource               parent_instance;
@@ -111,7 +181,10 @@ dex_work_stealing_queue_source_dispatch (GSource     *source,
       DexWorkItem work_item;
 
       if (!dex_work_stealing_queue_pop (work_stealing_queue, &work_item))
-        break;
+        {
+          dex_work_stealing_queue_trim (work_stealing_queue);
+          break;
+        }
 
       dex_work_item_invoke (&work_item);
     }
@@ -18,10 +18,21 @@
  * SPDX-License-Identifier: LGPL-2.1-or-later
  */
 
+#ifndef _GNU_SOURCE
+# define _GNU_SOURCE
+#endif
+
 #include <config.h>
 
 #include <errno.h>
 #include <fcntl.h>
+#include <sys/stat.h>
+
+#ifdef G_OS_UNIX
+# include <glib-unix.h>
+# include <netinet/in.h>
+# include <sys/socket.h>
+#endif
 
 #ifdef HAVE_UNISTD_H
 # include <unistd.h>
@@ -157,6 +168,491 @@ run_aio_open_missing (DexAioContext *aio_context)
   g_clear_pointer (&path, g_free);
 }
 
+static void
+run_aio_vectored (DexAioContext *aio_context)
+{
+  static const char first[] = "libdex ";
+  static const char second[] = "aio vectored";
+  char *path = NULL;
+  GError * error = NULL;
+  DexFuture *future;
+  char buffer1[sizeof first - 1] = {0};
+  char buffer2[sizeof second - 1] = {0};
+  GOutputVector out_vectors[2] = {
+    { first, strlen (first) },
+    { second, strlen (second) },
+  };
+  GInputVector in_vectors[2] = {
+    { buffer1, sizeof buffer1 },
+    { buffer2, sizeof buffer2 },
+  };
+  gint64 len;
+  gboolean ret;
+  int fd;
+
+  fd = g_file_open_tmp ("libdex-aio-vectored-XXXXXX", &path, &error);
+  g_assert_no_error (error);
+  g_assert_cmpint (fd, >=, 0);
+
+  future = await_future (dex_aio_writev (aio_context, fd, out_vectors, G_N_ELEMENTS (out_vectors), 0));
+  len = dex_await_int64 (future, &error);
+  g_assert_no_error (error);
+  g_assert_cmpint (len, ==, strlen (first) + strlen (second));
+
+  future = await_future (dex_aio_fdatasync (aio_context, fd));
+  ret = dex_await_boolean (future, &error);
+  g_assert_no_error (error);
+  g_assert_true (ret);
+
+  future = await_future (dex_aio_fsync (aio_context, fd));
+  ret = dex_await_boolean (future, &error);
+  g_assert_no_error (error);
+  g_assert_true (ret);
+
+  future = await_future (dex_aio_readv (aio_context, fd, in_vectors, G_N_ELEMENTS (in_vectors), 0));
+  len = dex_await_int64 (future, &error);
+  g_assert_no_error (error);
+  g_assert_cmpint (len, ==, strlen (first) + strlen (second));
+  g_assert_cmpmem (buffer1, sizeof buffer1, first, strlen (first));
+  g_assert_cmpmem (buffer2, sizeof buffer2, second, strlen (second));
+
+  g_assert_cmpint (close (fd), ==, 0);
+  g_assert_cmpint (g_unlink (path), ==, 0);
+  g_clear_pointer (&path, g_free);
+}
+
+static void
+run_aio_registered (DexAioContext *aio_context)
+{
+  static const char contents[] = "registered files and buffers";
+  char *path = NULL;
+  GError * error = NULL;
+  DexFuture *future;
+  char *pool = g_malloc0 (128);
+  GInputVector buffers[2] = {
+    { pool, 64 },
+    { pool + 64, 64 },
+  };
+  gboolean ret;
+  gint64 len;
+  int fixed;
+  int fd;
+
+  fd = g_file_open_tmp ("libdex-aio-registered-XXXXXX", &path, &error);
+  g_assert_no_error (error);
+  g_assert_cmpint (fd, >=, 0);
+
+  g_assert_true (dex_aio_register_files (aio_context, &fd, 1, &fixed, &error));
+  g_assert_no_error (error);
+  g_assert_true (dex_aio_register_buffers (aio_context, buffers, G_N_ELEMENTS (buffers), &error));
+  g_assert_no_error (error);
+
+  /* Written from the start of the second registered buffer */
+  memcpy (pool + 64, contents, strlen (contents));
+  future = await_future (dex_aio_write (aio_context, fixed, pool + 64, strlen (contents), 0));
+  len = dex_await_int64 (future, &error);
+  g_assert_no_error (error);
+  g_assert_cmpint (len, ==, strlen (contents));
+
+  /* Read into the middle of the first registered buffer */
+  future = await_future (dex_aio_read (aio_context, fixed, pool + 8, strlen (contents), 0));
+  len = dex_await_int64 (future, &error);
+  g_assert_no_error (error);
+  g_assert_cmpmem (pool + 8, len, contents, strlen (contents));
+
+  /* Straddling both registered buffers uses a regular read, and the plain
+   * file descriptor keeps working alongside the handle.
+   */
+  memset (pool, 0, 128);
+  future = await_future (dex_aio_read (aio_context, fd, pool + 48, strlen (contents), 0));
+  len = dex_await_int64 (future, &error);
+  g_assert_no_error (error);
+  g_assert_cmpmem (pool + 48, len, contents, strlen (contents));
+
+  /* Registering again makes earlier handles stale so they can not reach
+   * whatever file now occupies their slot. Backends without registration
+   * hand out the file descriptors themselves.
+   */
+  if (fixed != fd)
+    {
+      int stale = fixed;
+
+      g_assert_true (dex_aio_register_files (aio_context, &fd, 1, &fixed, &error));
+      g_assert_no_error (error);
+      g_assert_cmpint (fixed, !=, stale);
+
+      future = await_future (dex_aio_read (aio_context, stale, pool, strlen (contents), 0));
+      len = dex_await_int64 (future, &error);
+      g_assert_error (error, G_IO_ERROR, g_io_error_from_errno (EBADF));
+      g_clear_error (&error);
+    }
+
+  g_assert_true (dex_aio_register_buffers (aio_context, NULL, 0, &error));
+  g_assert_no_error (error);
+
+  /* Closing by handle closes the file and unregisters it */
+  future = await_future (dex_aio_close (aio_context, fixed));
+  ret = dex_await_boolean (future, &error);
+  g_assert_no_error (error);
+  g_assert_true (ret);
+
+  errno = 0;
+  g_assert_cmpint (fcntl (fd, F_GETFD), ==, -1);
+  g_assert_cmpint (errno, ==, EBADF);
+
+  future = await_future (dex_aio_read (aio_context, fixed, pool, strlen (contents), 0));
+  len = dex_await_int64 (future, &error);
+  g_assert_nonnull (error);
+  g_clear_error (&error);
+
+  g_assert_true (dex_aio_register_files (aio_context, NULL, 0, NULL, &error));
+  g_assert_no_error (error);
+
+  g_assert_cmpint (g_unlink (path), ==, 0);
+  g_clear_pointer (&path, g_free);
+  g_free (pool);
+}
+
+static void
+run_aio_directory (DexAioContext *aio_context)
+{
+  char *tmpdir = NULL;
+  GError * error = NULL;
+  DexFuture *future;
+  gboolean ret;
+  int dirfd;
+
+  tmpdir = g_dir_make_tmp ("libdex-aio-dir-XXXXXX", &error);
+  g_assert_no_error (error);
+
+  dirfd = open (tmpdir, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  g_assert_cmpint (dirfd, >=, 0);
+
+  future = await_future (dex_aio_mkdirat (aio_context, dirfd, "a", 0750));
+  ret = dex_await_boolean (future, &error);
+  g_assert_no_error (error);
+  g_assert_true (ret);
+
+  future = await_future (dex_aio_mkdirat (aio_context, dirfd, "a", 0750));
+  ret = dex_await_boolean (future, &error);
+  g_assert_error (error, G_IO_ERROR, G_IO_ERROR_EXISTS);
+  g_assert_false (ret);
+  g_clear_error (&error);
+
+#ifdef STATX_TYPE
+  {
+    struct statx stx = {0};
+
+    future = await_future (dex_aio_statx (aio_context, dirfd, "a", 0, STATX_TYPE | STATX_MODE, &stx));
+    ret = dex_await_boolean (future, &error);
+
+    if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED))
+      g_clear_error (&error);
+    else
+      {
+        g_assert_no_error (error);
+        g_assert_true (ret);
+        g_assert_true (S_ISDIR (stx.stx_mode));
+        g_assert_cmpint (stx.stx_mode & 0777, ==, 0750 & ~umask (umask (0)));
+      }
+  }
+#endif
+
+  future = await_future (dex_aio_renameat (aio_context, dirfd, "a", dirfd, "b", 0));
+  ret = dex_await_boolean (future, &error);
+  g_assert_no_error (error);
+  g_assert_true (ret);
+
+  future = await_future (dex_aio_unlinkat (aio_context, dirfd, "a", AT_REMOVEDIR));
+  ret = dex_await_boolean (future, &error);
+  g_assert_error (error, G_IO_ERROR, G_IO_ERROR_NOT_FOUND);
+  g_assert_false (ret);
+  g_clear_error (&error);
+
+  future = await_future (dex_aio_unlinkat (aio_context, dirfd, "b", AT_REMOVEDIR));
+  ret = dex_await_boolean (future, &error);
+  g_assert_no_error (error);
+  g_assert_true (ret);
+
+  g_assert_cmpint (close (dirfd), ==, 0);
+  g_assert_cmpint (g_rmdir (tmpdir), ==, 0);
+  g_clear_pointer (&tmpdir, g_free);
+}
+
+#ifdef G_OS_UNIX
+static void
+run_aio_socket (DexAioContext *aio_context)
+{
+  static const char request[] = "ping";
+  static const char reply[] = "pong";
+  struct sockaddr_in addr = {0};
+  socklen_t addrlen = sizeof addr;
+  GError * error = NULL;
+  DexFuture *accept_future;
+  DexFuture *future;
+  char buffer[16] = {0};
+  struct iovec iov = { buffer, sizeof buffer };
+  struct iovec out_iov = { (gpointer)reply, strlen (reply) };
+  struct msghdr msg = { .msg_iov = &iov, .msg_iovlen = 1 };
+  struct msghdr out_msg = { .msg_iov = &out_iov, .msg_iovlen = 1 };
+  gint64 len;
+  int listen_fd;
+  int client_fd;
+  int server_fd;
+
+  listen_fd = socket (AF_INET, SOCK_STREAM, 0);
+  g_assert_cmpint (listen_fd, >=, 0);
+  g_assert_cmpint (fcntl (listen_fd, F_SETFL, O_NONBLOCK), ==, 0);
+
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl (INADDR_LOOPBACK);
+  g_assert_cmpint (bind (listen_fd, (struct sockaddr *)&addr, sizeof addr), ==, 0);
+  g_assert_cmpint (getsockname (listen_fd, (struct sockaddr *)&addr, &addrlen), ==, 0);
+  g_assert_cmpint (listen (listen_fd, 1), ==, 0);
+
+  client_fd = socket (AF_INET, SOCK_STREAM, 0);
+  g_assert_cmpint (client_fd, >=, 0);
+  g_assert_cmpint (fcntl (client_fd, F_SETFL, O_NONBLOCK), ==, 0);
+
+  /* Accept is pending before the peer connects */
+  accept_future = dex_aio_accept (aio_context, listen_fd, NULL, NULL, 0);
+  future = await_future (dex_future_all (dex_ref (accept_future),
+                                         dex_aio_connect (aio_context, client_fd, (struct sockaddr *)&addr, addrlen),
+                                         NULL));
+  g_assert_true (dex_await (future, &error));
+  g_assert_no_error (error);
+  server_fd = dex_await_fd (accept_future, &error);
+  g_assert_no_error (error);
+  g_assert_cmpint (server_fd, >=, 0);
+
+  future = await_future (dex_aio_send (aio_context, client_fd, request, strlen (request), 0));
+  len = dex_await_int64 (future, &error);
+  g_assert_no_error (error);
+  g_assert_cmpint (len, ==, strlen (request));
+
+  future = await_future (dex_aio_recv (aio_context, server_fd, buffer, sizeof buffer, 0));
+  len = dex_await_int64 (future, &error);
+  g_assert_no_error (error);
+  g_assert_cmpmem (buffer, len, request, strlen (request));
+
+  future = await_future (dex_aio_sendmsg (aio_context, server_fd, &out_msg, 0));
+  len = dex_await_int64 (future, &error);
+  g_assert_no_error (error);
+  g_assert_cmpint (len, ==, strlen (reply));
+
+  memset (buffer, 0, sizeof buffer);
+  future = await_future (dex_aio_recvmsg (aio_context, client_fd, &msg, 0));
+  len = dex_await_int64 (future, &error);
+  g_assert_no_error (error);
+  g_assert_cmpmem (buffer, len, reply, strlen (reply));
+
+  /* Orderly shutdown is reported as zero bytes */
+  g_assert_cmpint (close (server_fd), ==, 0);
+  future = await_future (dex_aio_recv (aio_context, client_fd, buffer, sizeof buffer, 0));
+  len = dex_await_int64 (future, &error);
+  g_assert_no_error (error);
+  g_assert_cmpint (len, ==, 0);
+
+  g_assert_cmpint (close (client_fd), ==, 0);
+  g_assert_cmpint (close (listen_fd), ==, 0);
+}
+
+static int
+connect_loopback (const struct sockaddr_in *addr)
+{
+  int fd;
+
+  fd = socket (AF_INET, SOCK_STREAM, 0);
+  g_assert_cmpint (fd, >=, 0);
+  g_assert_cmpint (connect (fd, (const struct sockaddr *)addr, sizeof *addr), ==, 0);
+
+  return fd;
+}
+
+static void
+run_aio_stream (DexAioContext *aio_context)
+{
+  static const char request[] = "hello, world";
+  struct sockaddr_in addr = {0};
+  socklen_t addrlen = sizeof addr;
+  GString *received = g_string_new (NULL);
+  DexChannel *connections;
+  DexChannel *chunks;
+  DexFuture *accept_stream;
+  DexFuture *recv_stream;
+  DexFuture *future;
+  GError *error = NULL;
+  int listen_fd;
+  int client_fd;
+  int server_fd;
+
+  listen_fd = socket (AF_INET, SOCK_STREAM, 0);
+  g_assert_cmpint (listen_fd, >=, 0);
+  g_assert_cmpint (fcntl (listen_fd, F_SETFL, O_NONBLOCK), ==, 0);
+
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl (INADDR_LOOPBACK);
+  g_assert_cmpint (bind (listen_fd, (struct sockaddr *)&addr, sizeof addr), ==, 0);
+  g_assert_cmpint (getsockname (listen_fd, (struct sockaddr *)&addr, &addrlen), ==, 0);
+  g_assert_cmpint (listen (listen_fd, 4), ==, 0);
+
+  connections = dex_channel_new (0);
+  accept_stream = dex_aio_accept_stream (aio_context, listen_fd, 0, connections);
+
+  client_fd = connect_loopback (&addr);
+  future = await_future (dex_channel_receive (connections));
+  server_fd = dex_await_fd (future, &error);
+  g_assert_no_error (error);
+  g_assert_cmpint (server_fd, >=, 0);
+
+  /* Tiny buffers so the data spans many completions and buffers must be
+   * recycled (or the request re-armed) along the way. The channel only
+   * holds a single chunk so the stream has to stop and resume as we
+   * drain it.
+   */
+  chunks = dex_channel_new (1);
+  recv_stream = dex_aio_recv_stream (aio_context, server_fd, 4, 2, 0, chunks);
+
+  g_assert_cmpint (write (client_fd, request, strlen (request)), ==, strlen (request));
+  g_assert_cmpint (shutdown (client_fd, SHUT_WR), ==, 0);
+
+  for (;;)
+    {
+      GBytes *bytes;
+
+      future = await_future (dex_channel_receive (chunks));
+      if (!(bytes = dex_await_boxed (future, &error)))
+        break;
+
+      g_assert_cmpint (g_bytes_get_size (bytes), >, 0);
+      g_assert_cmpint (g_bytes_get_size (bytes), <=, 4);
+      g_string_append_len (received,
+                           g_bytes_get_data (bytes, NULL),
+                           g_bytes_get_size (bytes));
+      g_bytes_unref (bytes);
+    }
+
+  /* End-of-file closes the send side of the channel */
+  g_assert_error (error, DEX_ERROR, DEX_ERROR_CHANNEL_CLOSED);
+  g_clear_error (&error);
+  g_assert_cmpstr (received->str, ==, request);
+
+  recv_stream = await_future (recv_stream);
+  g_assert_true (dex_await (recv_stream, &error));
+  g_assert_no_error (error);
+
+  /* Closing the channel only stops the accept stream once the next
+   * connection comes in, which is then dropped.
+   */
+  dex_channel_close_receive (connections);
+  g_assert_cmpint (close (client_fd), ==, 0);
+  client_fd = connect_loopback (&addr);
+
+  accept_stream = await_future (accept_stream);
+  g_assert_true (dex_await (accept_stream, &error));
+  g_assert_no_error (error);
+
+  g_assert_cmpint (close (client_fd), ==, 0);
+  g_assert_cmpint (close (server_fd), ==, 0);
+  g_assert_cmpint (close (listen_fd), ==, 0);
+
+  dex_unref (connections);
+  dex_unref (chunks);
+  g_string_free (received, TRUE);
+}
+
+static void
+test_aio_socket (void)
+{
+  run_aio_socket (NULL);
+}
+
+typedef struct
+{
+  GMutex   mutex;
+  GCond    cond;
+  int      fd;
+  guint    n_calls;
+  gboolean done;
+} PollLevel;
+
+static gboolean
+poll_level_cb (int          fd,
+               GIOCondition condition,
+               gpointer     user_data)
+{
+  PollLevel *state = user_data;
+
+  g_assert_cmpint (fd, ==, state->fd);
+  g_assert_true (condition & G_IO_IN);
+
+  /* Never drain the pipe, we must be called again regardless */
+  if (++state->n_calls < 3)
+    return G_SOURCE_CONTINUE;
+
+  g_mutex_lock (&state->mutex);
+  state->done = TRUE;
+  g_cond_signal (&state->cond);
+  g_mutex_unlock (&state->mutex);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+poll_level_watch (gpointer user_data)
+{
+  PollLevel *state = user_data;
+  GSource *source;
+
+  /* Runs on the worker, whose poll function may be backed by io_uring */
+  source = g_unix_fd_source_new (state->fd, G_IO_IN);
+  g_source_set_callback (source, G_SOURCE_FUNC (poll_level_cb), state, NULL);
+  g_source_attach (source, g_main_context_get_thread_default ());
+  g_source_unref (source);
+}
+
+static void
+test_aio_poll_level (void)
+{
+  DexScheduler *pool = dex_thread_pool_scheduler_new_full (1, 1);
+  PollLevel state = {0};
+  gint64 deadline;
+  int fds[2];
+
+  g_assert_no_errno (pipe (fds));
+  g_assert_cmpint (write (fds[1], "x", 1), ==, 1);
+
+  g_mutex_init (&state.mutex);
+  g_cond_init (&state.cond);
+  state.fd = fds[0];
+
+  g_mutex_lock (&state.mutex);
+  dex_scheduler_push (pool, poll_level_watch, &state);
+  deadline = g_get_monotonic_time () + (G_USEC_PER_SEC * 30);
+  while (!state.done)
+    {
+      if (!g_cond_wait_until (&state.cond, &state.mutex, deadline))
+        break;
+    }
+  g_assert_true (state.done);
+  g_mutex_unlock (&state.mutex);
+
+  dex_unref (pool);
+
+  close (fds[0]);
+  close (fds[1]);
+
+  g_mutex_clear (&state.mutex);
+  g_cond_clear (&state.cond);
+}
+
+static void
+test_aio_stream (void)
+{
+  run_aio_stream (NULL);
+}
+#endif
+
 static void
 test_aio_close_success (void)
 {
@@ -181,6 +677,24 @@ test_aio_open_missing (void)
   run_aio_open_missing (NULL);
 }
 
+static void
+test_aio_vectored (void)
+{
+  run_aio_vectored (NULL);
+}
+
+static void
+test_aio_directory (void)
+{
+  run_aio_directory (NULL);
+}
+
+static void
+test_aio_registered (void)
+{
+  run_aio_registered (NULL);
+}
+
 static void
 test_aio_open_posix (void)
 {
@@ -195,6 +709,13 @@ test_aio_open_posix (void)
   run_aio_close_bad_fd (aio_context);
   run_aio_open_success (aio_context);
   run_aio_open_missing (aio_context);
+  run_aio_vectored (aio_context);
+  run_aio_directory (aio_context);
+  run_aio_registered (aio_context);
+#ifdef G_OS_UNIX
+  run_aio_socket (aio_context);
+  run_aio_stream (aio_context);
+#endif
 
   g_source_destroy ((GSource *)aio_context);
   g_source_unref ((GSource *)aio_context);
@@ -221,6 +742,13 @@ test_aio_open_uring (void)
   run_aio_close_bad_fd (aio_context);
   run_aio_open_success (aio_context);
   run_aio_open_missing (aio_context);
+  run_aio_vectored (aio_context);
+  run_aio_directory (aio_context);
+  run_aio_registered (aio_context);
+#ifdef G_OS_UNIX
+  run_aio_socket (aio_context);
+  run_aio_stream (aio_context);
+#endif
 
   g_source_destroy ((GSource *)aio_context);
   g_source_unref ((GSource *)aio_context);
@@ -238,6 +766,14 @@ main (int   argc,
   g_test_add_func ("/Dex/TestSuite/Aio/close-bad-fd", test_aio_close_bad_fd);
   g_test_add_func ("/Dex/TestSuite/Aio/open-success", test_aio_open_success);
   g_test_add_func ("/Dex/TestSuite/Aio/open-missing", test_aio_open_missing);
+  g_test_add_func ("/Dex/TestSuite/Aio/vectored", test_aio_vectored);
+  g_test_add_func ("/Dex/TestSuite/Aio/directory", test_aio_directory);
+  g_test_add_func ("/Dex/TestSuite/Aio/registered", test_aio_registered);
+#ifdef G_OS_UNIX
+  g_test_add_func ("/Dex/TestSuite/Aio/socket", test_aio_socket);
+  g_test_add_func ("/Dex/TestSuite/Aio/stream", test_aio_stream);
+  g_test_add_func ("/Dex/TestSuite/Aio/poll-level", test_aio_poll_level);
+#endif
   g_test_add_func ("/Dex/TestSuite/Aio/open-posix", test_aio_open_posix);
 #ifdef HAVE_LIBURING
   g_test_add_func ("/Dex/TestSuite/Aio/open-uring", test_aio_open_uring);
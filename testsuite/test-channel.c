@@ -23,6 +23,8 @@
 
 #include <libdex.h>
 
+#include "dex-object-private.h"
+
 #define ASSERT_STATUS(f,status) g_assert_cmpint(status, ==, dex_future_get_status(DEX_FUTURE(f)))
 
 #define ASSERT_CMP(future, kind, get, op, v) \
@@ -35,6 +37,13 @@
   } G_STMT_END
 #define ASSERT_CMPINT(future, op, value) ASSERT_CMP(future, int, int, op, value)
 #define ASSERT_CMPUINT(future, op, value) ASSERT_CMP(future, int, uint, op, value)
+#define ASSERT_ERROR(future, domain, code) \
+  G_STMT_START { \
+    GError *error = NULL; \
+    g_assert_null (dex_future_get_value (DEX_FUTURE (future), &error)); \
+    g_assert_error (error, domain, code); \
+    g_clear_error (&error); \
+  } G_STMT_END
 
 static void
 test_channel_basic (void)
@@ -193,6 +202,531 @@ test_channel_receive_all_with_blocked_sender (void)
   dex_clear (&recv);
 }
 
+static void
+test_channel_select_receive (void)
+{
+  DexChannel *channels[3] = { dex_channel_new (0), dex_channel_new (0), dex_channel_new (0) };
+  DexChannel *values = dex_channel_new_for_values (sizeof (guint), 4, DEX_CHANNEL_FLAGS_NONE);
+  GError *error = NULL;
+  DexFuture *select;
+  DexFuture *send;
+  DexFuture *recv;
+
+  /* Nothing is ready, so the select waits on every channel */
+  select = dex_channel_select_receive (channels, G_N_ELEMENTS (channels));
+  ASSERT_STATUS (select, DEX_FUTURE_STATUS_PENDING);
+
+  send = dex_channel_send (channels[1], dex_future_new_for_int (1));
+  ASSERT_STATUS (select, DEX_FUTURE_STATUS_RESOLVED);
+  ASSERT_CMPINT (select, ==, 1);
+  dex_clear (&select);
+  dex_clear (&send);
+
+  /* The other channels no longer have a receiver waiting */
+  send = dex_channel_send (channels[0], dex_future_new_for_int (2));
+  recv = dex_channel_receive (channels[0]);
+  ASSERT_CMPINT (recv, ==, 2);
+  dex_clear (&send);
+  dex_clear (&recv);
+
+  /* Only one item is taken when more than one channel is ready */
+  send = dex_channel_send (channels[2], dex_future_new_for_int (3));
+  dex_clear (&send);
+  send = dex_channel_send (channels[1], dex_future_new_for_int (4));
+  dex_clear (&send);
+  select = dex_channel_select_receive (channels, G_N_ELEMENTS (channels));
+  ASSERT_CMPINT (select, ==, 4);
+  recv = dex_channel_receive (channels[2]);
+  ASSERT_CMPINT (recv, ==, 3);
+  dex_clear (&select);
+  dex_clear (&recv);
+
+  /* Closing one of the channels completes a waiting select */
+  select = dex_channel_select_receive (channels, 2);
+  ASSERT_STATUS (select, DEX_FUTURE_STATUS_PENDING);
+  dex_channel_close_send (channels[0]);
+  ASSERT_STATUS (select, DEX_FUTURE_STATUS_REJECTED);
+  dex_clear (&select);
+
+  send = dex_channel_send (channels[1], dex_future_new_for_int (5));
+  recv = dex_channel_receive (channels[1]);
+  ASSERT_CMPINT (recv, ==, 5);
+  dex_clear (&send);
+  dex_clear (&recv);
+
+  /* As does a channel that is already closed */
+  select = dex_channel_select_receive (channels, G_N_ELEMENTS (channels));
+  ASSERT_STATUS (select, DEX_FUTURE_STATUS_REJECTED);
+  dex_clear (&select);
+
+  select = dex_channel_select_receive (&values, 1);
+  g_assert_null (dex_future_get_value (select, &error));
+  g_assert_error (error, DEX_ERROR, DEX_ERROR_TYPE_NOT_SUPPORTED);
+  g_clear_error (&error);
+  dex_clear (&select);
+
+  for (guint i = 0; i < G_N_ELEMENTS (channels); i++)
+    dex_clear (&channels[i]);
+  dex_clear (&values);
+}
+
+static gpointer
+test_channel_select_race_thread (gpointer data)
+{
+  DexChannel **channels = data;
+
+  /* Make both of the channels the select is waiting on ready while
+   * it may still be queueing itself into the last one.
+   */
+  dex_unref (dex_channel_send (channels[0], dex_future_new_for_int (1)));
+  dex_unref (dex_channel_send (channels[1], dex_future_new_for_int (2)));
+
+  return NULL;
+}
+
+static void
+test_channel_select_race (void)
+{
+  for (guint i = 0; i < 1000; i++)
+    {
+      DexChannel *channels[3] = { dex_channel_new (0), dex_channel_new (0), dex_channel_new (0) };
+      DexWeakRef wr;
+      DexFuture *select;
+      GThread *thread;
+      gpointer alive;
+
+      thread = g_thread_new ("test-channel-select-race",
+                             test_channel_select_race_thread,
+                             channels);
+      select = dex_channel_select_receive (channels, G_N_ELEMENTS (channels));
+      g_thread_join (thread);
+
+      ASSERT_STATUS (select, DEX_FUTURE_STATUS_RESOLVED);
+
+      /* An arm left behind in the idle channel would keep the select,
+       * and therefore its result, alive.
+       */
+      dex_weak_ref_init (&wr, select);
+      dex_clear (&select);
+      alive = dex_weak_ref_get (&wr);
+      g_assert_null (alive);
+      dex_weak_ref_clear (&wr);
+
+      for (guint j = 0; j < G_N_ELEMENTS (channels); j++)
+        dex_clear (&channels[j]);
+    }
+}
+
+static void
+test_channel_select_send (void)
+{
+  DexChannel *channels[2] = { dex_channel_new (1), dex_channel_new (1) };
+  DexChannel *reversed[2] = { channels[1], channels[0] };
+  DexFuture *select1;
+  DexFuture *select2;
+  DexFuture *select3;
+  DexFuture *recv;
+
+  select1 = dex_channel_select_send (channels, G_N_ELEMENTS (channels), dex_future_new_for_int (1));
+  ASSERT_STATUS (select1, DEX_FUTURE_STATUS_RESOLVED);
+  ASSERT_CMPUINT (select1, ==, 1);
+
+  /* The first channel is full so the next one is used */
+  select2 = dex_channel_select_send (channels, G_N_ELEMENTS (channels), dex_future_new_for_int (2));
+  ASSERT_STATUS (select2, DEX_FUTURE_STATUS_RESOLVED);
+  ASSERT_CMPUINT (select2, ==, 1);
+
+  /* Both are full, so wait for whichever drains first */
+  select3 = dex_channel_select_send (channels, G_N_ELEMENTS (channels), dex_future_new_for_int (3));
+  ASSERT_STATUS (select3, DEX_FUTURE_STATUS_PENDING);
+
+  recv = dex_channel_receive (channels[1]);
+  ASSERT_CMPINT (recv, ==, 2);
+  ASSERT_STATUS (select3, DEX_FUTURE_STATUS_RESOLVED);
+  ASSERT_CMPUINT (select3, ==, 1);
+  dex_clear (&recv);
+
+  recv = dex_channel_receive (channels[1]);
+  ASSERT_CMPINT (recv, ==, 3);
+  dex_clear (&recv);
+
+  /* Nothing but the first item was queued to the first channel */
+  recv = dex_channel_receive (channels[0]);
+  ASSERT_CMPINT (recv, ==, 1);
+  dex_clear (&recv);
+
+  recv = dex_channel_receive (channels[0]);
+  ASSERT_STATUS (recv, DEX_FUTURE_STATUS_PENDING);
+  dex_channel_close_send (channels[0]);
+  ASSERT_STATUS (recv, DEX_FUTURE_STATUS_REJECTED);
+  dex_clear (&recv);
+
+  dex_clear (&select1);
+  dex_clear (&select2);
+  dex_clear (&select3);
+
+  /* A closed channel completes the select before later ones are tried */
+  dex_channel_close_receive (channels[1]);
+  select1 = dex_channel_select_send (reversed, G_N_ELEMENTS (reversed), dex_future_new_for_int (4));
+  ASSERT_STATUS (select1, DEX_FUTURE_STATUS_REJECTED);
+  dex_clear (&select1);
+
+  for (guint i = 0; i < G_N_ELEMENTS (channels); i++)
+    dex_clear (&channels[i]);
+}
+
+static void
+test_channel_values (void)
+{
+  DexChannel *channel = dex_channel_new_for_values (sizeof (guint), 4, DEX_CHANNEL_FLAGS_NONE);
+  guint in[6] = { 1, 2, 3, 4, 5, 6 };
+  guint out[6] = {0};
+  DexFuture *sendable;
+  DexFuture *receivable;
+  DexFuture *recv;
+
+  g_assert_true (G_TYPE_IS_FLAGS (DEX_TYPE_CHANNEL_FLAGS));
+
+  /* Futures can not be used with value channels */
+  recv = dex_channel_send (channel, dex_future_new_for_int (1));
+  ASSERT_ERROR (recv, DEX_ERROR, DEX_ERROR_TYPE_NOT_SUPPORTED);
+  dex_clear (&recv);
+  recv = dex_channel_receive (channel);
+  ASSERT_ERROR (recv, DEX_ERROR, DEX_ERROR_TYPE_NOT_SUPPORTED);
+  dex_clear (&recv);
+  recv = dex_channel_receive_all (channel);
+  ASSERT_ERROR (recv, DEX_ERROR, DEX_ERROR_TYPE_NOT_SUPPORTED);
+  dex_clear (&recv);
+
+  receivable = dex_channel_wait_receivable (channel);
+  ASSERT_STATUS (receivable, DEX_FUTURE_STATUS_PENDING);
+
+  g_assert_cmpuint (dex_channel_try_send_values (channel, in, 3), ==, 3);
+  ASSERT_STATUS (receivable, DEX_FUTURE_STATUS_RESOLVED);
+  dex_clear (&receivable);
+
+  /* Only one slot left */
+  g_assert_cmpuint (dex_channel_try_send_values (channel, &in[3], 3), ==, 1);
+  g_assert_cmpuint (dex_channel_try_send_values (channel, &in[4], 2), ==, 0);
+
+  sendable = dex_channel_wait_sendable (channel);
+  ASSERT_STATUS (sendable, DEX_FUTURE_STATUS_PENDING);
+
+  g_assert_cmpuint (dex_channel_try_receive_values (channel, out, 2), ==, 2);
+  g_assert_cmpuint (out[0], ==, 1);
+  g_assert_cmpuint (out[1], ==, 2);
+  ASSERT_STATUS (sendable, DEX_FUTURE_STATUS_RESOLVED);
+  dex_clear (&sendable);
+
+  /* These wrap around the end of the ring */
+  g_assert_cmpuint (dex_channel_try_send_values (channel, &in[4], 2), ==, 2);
+
+  dex_channel_close_send (channel);
+  g_assert_cmpuint (dex_channel_try_send_values (channel, in, 1), ==, 0);
+
+  /* Remaining values may still be drained after closing the send side */
+  receivable = dex_channel_wait_receivable (channel);
+  ASSERT_STATUS (receivable, DEX_FUTURE_STATUS_RESOLVED);
+  dex_clear (&receivable);
+
+  g_assert_cmpuint (dex_channel_try_receive_values (channel, out, G_N_ELEMENTS (out)), ==, 4);
+  g_assert_cmpuint (out[0], ==, 3);
+  g_assert_cmpuint (out[1], ==, 4);
+  g_assert_cmpuint (out[2], ==, 5);
+  g_assert_cmpuint (out[3], ==, 6);
+
+  receivable = dex_channel_wait_receivable (channel);
+  ASSERT_STATUS (receivable, DEX_FUTURE_STATUS_REJECTED);
+  dex_clear (&receivable);
+
+  dex_clear (&channel);
+}
+
+static DexFuture *
+quit_cb (DexFuture *completed,
+         gpointer   user_data)
+{
+  g_main_loop_quit (user_data);
+  return NULL;
+}
+
+static void
+run_values_discard (DexChannelFlags flags)
+{
+  GMainLoop *main_loop = g_main_loop_new (NULL, FALSE);
+  DexChannel *channel = dex_channel_new_for_values (sizeof (guint), 4, flags);
+  DexFuture *receivable;
+  DexFuture *first;
+  guint value = 1;
+
+  /* Let a timeout win against the waiter so that it is discarded */
+  receivable = dex_channel_wait_receivable (channel);
+  first = dex_future_first (dex_ref (receivable), dex_timeout_new_msec (1), NULL);
+  first = dex_future_finally (first, quit_cb, main_loop, NULL);
+  g_main_loop_run (main_loop);
+  ASSERT_STATUS (first, DEX_FUTURE_STATUS_REJECTED);
+  ASSERT_STATUS (receivable, DEX_FUTURE_STATUS_PENDING);
+  dex_clear (&first);
+  dex_clear (&receivable);
+
+  /* The discarded waiter must not consume the wakeup for this one */
+  receivable = dex_channel_wait_receivable (channel);
+  g_assert_cmpuint (dex_channel_try_send_values (channel, &value, 1), ==, 1);
+  ASSERT_STATUS (receivable, DEX_FUTURE_STATUS_RESOLVED);
+  dex_clear (&receivable);
+
+  dex_clear (&channel);
+  g_main_loop_unref (main_loop);
+}
+
+static void
+test_channel_values_discard (void)
+{
+  run_values_discard (DEX_CHANNEL_FLAGS_NONE);
+  run_values_discard (DEX_CHANNEL_FLAGS_SINGLE_CONSUMER);
+  run_values_discard (DEX_CHANNEL_FLAGS_SINGLE_PRODUCER|DEX_CHANNEL_FLAGS_SINGLE_CONSUMER);
+}
+
+#define N_VALUES 10000
+#define MAX_PRODUCERS 4
+
+typedef struct _Pipeline
+{
+  DexChannel *channel;
+  guint       n_values;
+  guint       n_producers;
+  int         n_running;
+} Pipeline;
+
+typedef struct _Producer
+{
+  Pipeline *pipeline;
+  guint     id;
+} Producer;
+
+static DexFuture *
+values_producer (gpointer user_data)
+{
+  Producer *producer = user_data;
+  Pipeline *pipeline = producer->pipeline;
+  GError *error = NULL;
+  guint batch[10];
+
+  for (guint i = 0; i < pipeline->n_values; i += G_N_ELEMENTS (batch))
+    {
+      guint n = MIN (G_N_ELEMENTS (batch), pipeline->n_values - i);
+
+      /* Encode the producer so ordering can be checked per producer */
+      for (guint j = 0; j < n; j++)
+        batch[j] = (producer->id * pipeline->n_values) + i + j;
+
+      if (!dex_channel_send_values (pipeline->channel, batch, n, &error))
+        return dex_future_new_for_error (error);
+    }
+
+  if (g_atomic_int_dec_and_test (&pipeline->n_running))
+    dex_channel_close_send (pipeline->channel);
+
+  return dex_future_new_true ();
+}
+
+static DexFuture *
+values_consumer (gpointer user_data)
+{
+  Pipeline *pipeline = user_data;
+  guint next[MAX_PRODUCERS] = {0};
+  GError *error = NULL;
+  guint n_received = 0;
+  guint batch[7];
+  guint n;
+
+  while ((n = dex_channel_receive_values (pipeline->channel, batch, G_N_ELEMENTS (batch), &error)))
+    {
+      for (guint i = 0; i < n; i++)
+        {
+          guint id = batch[i] / pipeline->n_values;
+
+          g_assert_cmpuint (id, <, pipeline->n_producers);
+          g_assert_cmpuint (batch[i] % pipeline->n_values, ==, next[id]++);
+        }
+
+      n_received += n;
+    }
+
+  g_assert_error (error, DEX_ERROR, DEX_ERROR_CHANNEL_CLOSED);
+  g_clear_error (&error);
+
+  return dex_future_new_for_uint (n_received);
+}
+
+static guint
+run_values_pipeline (DexScheduler    *scheduler,
+                     DexChannelFlags  flags,
+                     guint            n_producers,
+                     guint            n_values)
+{
+  GMainLoop *main_loop = g_main_loop_new (NULL, FALSE);
+  Producer producers[MAX_PRODUCERS];
+  DexFuture *futures[MAX_PRODUCERS + 1];
+  DexFuture *all;
+  Pipeline pipeline;
+  guint n_received;
+
+  g_assert_cmpuint (n_producers, <=, MAX_PRODUCERS);
+
+  pipeline.channel = dex_channel_new_for_values (sizeof (guint), 16, flags);
+  pipeline.n_values = n_values;
+  pipeline.n_producers = n_producers;
+  pipeline.n_running = n_producers;
+
+  futures[0] = dex_scheduler_spawn (scheduler, 0, values_consumer, &pipeline, NULL);
+
+  for (guint i = 0; i < n_producers; i++)
+    {
+      producers[i].pipeline = &pipeline;
+      producers[i].id = i;
+      futures[i + 1] = dex_scheduler_spawn (scheduler, 0, values_producer, &producers[i], NULL);
+    }
+
+  all = dex_future_allv (futures, n_producers + 1);
+  all = dex_future_finally (all, quit_cb, main_loop, NULL);
+
+  g_main_loop_run (main_loop);
+
+  ASSERT_STATUS (all, DEX_FUTURE_STATUS_RESOLVED);
+  n_received = g_value_get_uint (dex_future_get_value (futures[0], NULL));
+
+  for (guint i = 0; i < n_producers + 1; i++)
+    dex_clear (&futures[i]);
+  dex_clear (&all);
+  dex_clear (&pipeline.channel);
+  g_main_loop_unref (main_loop);
+
+  return n_received;
+}
+
+static void
+test_channel_values_fiber (void)
+{
+  DexScheduler *main_scheduler = dex_scheduler_get_default ();
+  DexScheduler *thread_pool = dex_thread_pool_scheduler_get_default ();
+  const DexChannelFlags spsc = DEX_CHANNEL_FLAGS_SINGLE_PRODUCER|DEX_CHANNEL_FLAGS_SINGLE_CONSUMER;
+
+  g_assert_cmpuint (run_values_pipeline (main_scheduler, DEX_CHANNEL_FLAGS_NONE, 1, N_VALUES), ==, N_VALUES);
+  g_assert_cmpuint (run_values_pipeline (main_scheduler, spsc, 1, N_VALUES), ==, N_VALUES);
+
+  g_assert_cmpuint (run_values_pipeline (thread_pool, DEX_CHANNEL_FLAGS_NONE, MAX_PRODUCERS, N_VALUES), ==, MAX_PRODUCERS * N_VALUES);
+  g_assert_cmpuint (run_values_pipeline (thread_pool, DEX_CHANNEL_FLAGS_SINGLE_CONSUMER, MAX_PRODUCERS, N_VALUES), ==, MAX_PRODUCERS * N_VALUES);
+  g_assert_cmpuint (run_values_pipeline (thread_pool, spsc, 1, N_VALUES), ==, N_VALUES);
+}
+
+static DexFuture *
+futures_producer (gpointer user_data)
+{
+  Pipeline *pipeline = user_data;
+  GError *error = NULL;
+
+  for (guint i = 0; i < pipeline->n_values; i++)
+    {
+      if (!dex_await (dex_channel_send (pipeline->channel, dex_future_new_for_uint (i)), &error))
+        return dex_future_new_for_error (error);
+    }
+
+  dex_channel_close_send (pipeline->channel);
+
+  return dex_future_new_true ();
+}
+
+static DexFuture *
+futures_consumer (gpointer user_data)
+{
+  Pipeline *pipeline = user_data;
+  GError *error = NULL;
+  guint n_received = 0;
+
+  for (;;)
+    {
+      guint value = dex_await_uint (dex_channel_receive (pipeline->channel), &error);
+
+      if (error != NULL)
+        break;
+
+      g_assert_cmpuint (value, ==, n_received++);
+    }
+
+  g_clear_error (&error);
+
+  return dex_future_new_for_uint (n_received);
+}
+
+static guint
+run_futures_pipeline (DexScheduler *scheduler,
+                      guint         n_values)
+{
+  GMainLoop *main_loop = g_main_loop_new (NULL, FALSE);
+  Pipeline pipeline = {0};
+  DexFuture *consumer;
+  DexFuture *producer;
+  DexFuture *all;
+  guint n_received;
+
+  pipeline.channel = dex_channel_new (16);
+  pipeline.n_values = n_values;
+
+  consumer = dex_scheduler_spawn (scheduler, 0, futures_consumer, &pipeline, NULL);
+  producer = dex_scheduler_spawn (scheduler, 0, futures_producer, &pipeline, NULL);
+
+  all = dex_future_all (dex_ref (consumer), dex_ref (producer), NULL);
+  all = dex_future_finally (all, quit_cb, main_loop, NULL);
+
+  g_main_loop_run (main_loop);
+
+  n_received = g_value_get_uint (dex_future_get_value (consumer, NULL));
+
+  dex_clear (&consumer);
+  dex_clear (&producer);
+  dex_clear (&all);
+  dex_clear (&pipeline.channel);
+  g_main_loop_unref (main_loop);
+
+  return n_received;
+}
+
+static void
+test_channel_bench (void)
+{
+  DexScheduler *thread_pool = dex_thread_pool_scheduler_get_default ();
+  const guint n_values = 1000000;
+  static const struct {
+    const char      *name;
+    DexChannelFlags  flags;
+    guint            n_producers;
+  } variants[] = {
+    { "values", DEX_CHANNEL_FLAGS_NONE, 1 },
+    { "values-spsc", DEX_CHANNEL_FLAGS_SINGLE_PRODUCER|DEX_CHANNEL_FLAGS_SINGLE_CONSUMER, 1 },
+    { "values-mpsc", DEX_CHANNEL_FLAGS_SINGLE_CONSUMER, 1 },
+    { "values", DEX_CHANNEL_FLAGS_NONE, MAX_PRODUCERS },
+    { "values-mpsc", DEX_CHANNEL_FLAGS_SINGLE_CONSUMER, MAX_PRODUCERS },
+  };
+  gint64 begin;
+  double elapsed;
+
+  begin = g_get_monotonic_time ();
+  g_assert_cmpuint (run_futures_pipeline (thread_pool, n_values), ==, n_values);
+  elapsed = (g_get_monotonic_time () - begin) / (double)G_USEC_PER_SEC;
+  g_test_message ("%-12s x%u: %.0lf values/sec", "futures", 1, n_values / elapsed);
+
+  for (guint i = 0; i < G_N_ELEMENTS (variants); i++)
+    {
+      guint total = n_values * variants[i].n_producers;
+
+      begin = g_get_monotonic_time ();
+      g_assert_cmpuint (run_values_pipeline (thread_pool, variants[i].flags, variants[i].n_producers, n_values), ==, total);
+      elapsed = (g_get_monotonic_time () - begin) / (double)G_USEC_PER_SEC;
+      g_test_message ("%-12s x%u: %.0lf values/sec", variants[i].name, variants[i].n_producers, total / elapsed);
+    }
+}
+
 int
 main (int argc,
       char *argv[])
@@ -203,5 +737,13 @@ main (int argc,
   g_test_add_func ("/Dex/TestSuite/Channel/recv_first", test_channel_recv_first);
   g_test_add_func ("/Dex/TestSuite/Channel/receive_all_with_blocked_sender",
                    test_channel_receive_all_with_blocked_sender);
+  g_test_add_func ("/Dex/TestSuite/Channel/select_receive", test_channel_select_receive);
+  g_test_add_func ("/Dex/TestSuite/Channel/select_race", test_channel_select_race);
+  g_test_add_func ("/Dex/TestSuite/Channel/select_send", test_channel_select_send);
+  g_test_add_func ("/Dex/TestSuite/Channel/values", test_channel_values);
+  g_test_add_func ("/Dex/TestSuite/Channel/values_discard", test_channel_values_discard);
+  g_test_add_func ("/Dex/TestSuite/Channel/values_fiber", test_channel_values_fiber);
+  if (g_test_perf ())
+    g_test_add_func ("/Dex/TestSuite/Channel/bench", test_channel_bench);
   return g_test_run ();
 }
@@ -23,6 +23,7 @@
 #include <libdex.h>
 
 #include "dex-fiber-private.h"
+#include "dex-stack-private.h"
 
 #define ASSERT_STATUS(f,status) g_assert_cmpint(status, ==, dex_future_get_status(DEX_FUTURE(f)))
 #define ASSERT_ERROR(f,d,c) \
@@ -364,6 +365,48 @@ test_fiber_cancel_propagate (void)
   g_source_unref ((GSource *)fiber_scheduler);
 }
 
+static void
+test_stack_pool (void)
+{
+  DexStackPool *stack_pool = dex_stack_pool_new (0, 0, 4);
+  DexStack *stacks[8];
+
+  g_assert_nonnull (stack_pool);
+  g_assert_cmpint (stack_pool->stacks.length, ==, 0);
+  g_assert_cmpint (stack_pool->watermark, <=, 4);
+
+  for (guint i = 0; i < G_N_ELEMENTS (stacks); i++)
+    stacks[i] = dex_stack_pool_acquire (stack_pool);
+
+  /* Anything beyond the pool size overflows to the shared pool, coldest
+   * stacks first, and only @watermark of the cached stacks stay resident.
+   */
+  for (guint i = 0; i < G_N_ELEMENTS (stacks); i++)
+    dex_stack_pool_release (stack_pool, stacks[i]);
+  g_assert_cmpint (stack_pool->stacks.length, ==, 4);
+  g_assert_cmpint (stack_pool->n_resident, ==, stack_pool->watermark);
+  for (guint i = 0; i < 4; i++)
+    g_assert_true (g_queue_peek_nth (&stack_pool->stacks, i) == stacks[7 - i]);
+
+  /* The most recently released stack is reused first */
+  for (guint i = 0; i < 4; i++)
+    stacks[i] = dex_stack_pool_acquire (stack_pool);
+  g_assert_true (stacks[0] == stacks[7]);
+  g_assert_cmpint (stack_pool->n_resident, ==, 0);
+
+  /* Releasing past the watermark gives up the oldest resident stack
+   * rather than the one that was just used.
+   */
+  stack_pool->watermark = 2;
+  for (guint i = 0; i < 4; i++)
+    dex_stack_pool_release (stack_pool, stacks[i]);
+  g_assert_cmpint (stack_pool->n_resident, ==, 2);
+  g_assert_true (g_queue_peek_nth (&stack_pool->stacks, 0) == stacks[3]);
+  g_assert_true (g_queue_peek_nth (&stack_pool->stacks, 1) == stacks[2]);
+
+  dex_stack_pool_free (stack_pool);
+}
+
 int
 main (int argc,
       char *argv[])
@@ -376,5 +419,6 @@ main (int argc,
   g_test_add_func ("/Dex/TestSuite/FiberScheduler/basic", test_fiber_scheduler_basic);
   g_test_add_func ("/Dex/TestSuite/FiberScheduler/await", test_fiber_scheduler_await);
   g_test_add_func ("/Dex/TestSuite/FiberScheduler/cancel_propagate", test_fiber_cancel_propagate);
+  g_test_add_func ("/Dex/TestSuite/StackPool/overflow", test_stack_pool);
   return g_test_run ();
 }
@@ -25,7 +25,9 @@
 #include <gio/gio.h>
 
 #include "dex-future-private.h"
+#include "dex-promise-private.h"
 #include "dex-async-pair-private.h"
+#include "dex-scheduler-private.h"
 
 #define ASSERT_STATUS(f,status) g_assert_cmpint(status, ==, dex_future_get_status(DEX_FUTURE(f)))
 #define ASSERT_INSTANCE_TYPE(obj,type) \
@@ -177,6 +179,200 @@ test_timeout (void)
   g_main_loop_unref (main_loop);
 }
 
+static guint
+get_timer_queue_size (void)
+{
+  return dex_timer_queue_get_size (dex_scheduler_get_timer_queue (dex_scheduler_get_default ()));
+}
+
+static void
+test_timeout_many (void)
+{
+  GMainLoop *main_loop = g_main_loop_new (NULL, FALSE);
+  DexFuture *timeouts[100];
+  DexFuture *future;
+  gint64 now = g_get_monotonic_time ();
+  guint size = get_timer_queue_size ();
+
+  /* Create them in reverse so each one becomes the earliest deadline */
+  for (guint i = 0; i < G_N_ELEMENTS (timeouts); i++)
+    timeouts[i] = dex_timeout_new_deadline (now + (G_N_ELEMENTS (timeouts) - i) * 100);
+
+  /* Nothing is armed until awaited */
+  g_assert_cmpint (get_timer_queue_size (), ==, size);
+
+  future = dex_future_allv (timeouts, G_N_ELEMENTS (timeouts));
+  future = dex_future_finally (future, on_timed_out, main_loop, NULL);
+
+  g_assert_cmpint (get_timer_queue_size (), ==, size + G_N_ELEMENTS (timeouts));
+
+  g_main_loop_run (main_loop);
+
+  for (guint i = 0; i < G_N_ELEMENTS (timeouts); i++)
+    {
+      ASSERT_STATUS (timeouts[i], DEX_FUTURE_STATUS_REJECTED);
+      dex_clear (&timeouts[i]);
+    }
+
+  g_assert_cmpint (get_timer_queue_size (), ==, size);
+
+  dex_clear (&future);
+  g_main_loop_unref (main_loop);
+}
+
+static void
+test_timeout_postpone (void)
+{
+  GMainLoop *main_loop = g_main_loop_new (NULL, FALSE);
+  DexFuture *postponed = dex_timeout_new_msec (1);
+  DexFuture *first = dex_timeout_new_msec (10);
+  DexFuture *future;
+
+  dex_timeout_postpone_until (DEX_TIMEOUT (postponed),
+                              g_get_monotonic_time () + (G_USEC_PER_SEC / 10));
+
+  future = dex_future_catch (dex_ref (first), on_timed_out, main_loop, NULL);
+  g_main_loop_run (main_loop);
+  dex_clear (&future);
+
+  ASSERT_STATUS (first, DEX_FUTURE_STATUS_REJECTED);
+  ASSERT_STATUS (postponed, DEX_FUTURE_STATUS_PENDING);
+
+  /* Bringing the deadline in should work as well */
+  dex_timeout_postpone_until (DEX_TIMEOUT (postponed), g_get_monotonic_time ());
+
+  future = dex_future_catch (dex_ref (postponed), on_timed_out, main_loop, NULL);
+  g_main_loop_run (main_loop);
+  dex_clear (&future);
+
+  ASSERT_STATUS (postponed, DEX_FUTURE_STATUS_REJECTED);
+
+  dex_clear (&first);
+  dex_clear (&postponed);
+  g_main_loop_unref (main_loop);
+}
+
+static void
+test_timeout_discard (void)
+{
+  guint size = get_timer_queue_size ();
+  DexFuture *future;
+
+  future = dex_future_first (dex_timeout_new_seconds (60),
+                             dex_future_new_for_int (123),
+                             NULL);
+
+  ASSERT_STATUS (future, DEX_FUTURE_STATUS_RESOLVED);
+
+  /* The timeout is removed from the queue once nothing awaits it */
+  g_assert_cmpint (get_timer_queue_size (), ==, size);
+
+  dex_clear (&future);
+}
+
+static void
+test_timeout_unawaited (void)
+{
+  guint size = get_timer_queue_size ();
+  DexFuture *timeout;
+
+  timeout = dex_timeout_new_msec (1);
+  dex_timeout_postpone_until (DEX_TIMEOUT (timeout), g_get_monotonic_time ());
+  dex_clear (&timeout);
+
+  g_assert_cmpint (get_timer_queue_size (), ==, size);
+}
+
+typedef struct
+{
+  DexFuture *timeout;
+  guint      size;
+} ArmOnWorker;
+
+static DexFuture *
+catch_timed_out (DexFuture *future,
+                 gpointer   user_data)
+{
+  return dex_future_new_true ();
+}
+
+static DexFuture *
+arm_on_worker_fiber (gpointer user_data)
+{
+  ArmOnWorker *state = user_data;
+  DexFuture *future;
+  GError *error = NULL;
+
+  future = dex_future_catch (dex_ref (state->timeout), catch_timed_out, NULL, NULL);
+
+  /* Armed on this worker rather than where the timeout was created */
+  g_assert_cmpint (get_timer_queue_size (), ==, state->size);
+
+  if (!dex_await (future, &error))
+    return dex_future_new_for_error (error);
+
+  return dex_future_new_true ();
+}
+
+static void
+test_timeout_arm_on_awaiting_scheduler (void)
+{
+  GMainLoop *main_loop = g_main_loop_new (NULL, FALSE);
+  ArmOnWorker state;
+  DexFuture *future;
+
+  state.timeout = dex_timeout_new_msec (1);
+  state.size = get_timer_queue_size ();
+
+  future = dex_scheduler_spawn (dex_thread_pool_scheduler_get_default (), 0,
+                                arm_on_worker_fiber, &state, NULL);
+  future = dex_future_finally (future, on_timed_out, main_loop, NULL);
+
+  g_main_loop_run (main_loop);
+
+  ASSERT_STATUS (future, DEX_FUTURE_STATUS_RESOLVED);
+  ASSERT_STATUS (state.timeout, DEX_FUTURE_STATUS_REJECTED);
+
+  dex_clear (&state.timeout);
+  dex_clear (&future);
+  g_main_loop_unref (main_loop);
+}
+
+static void
+test_timeout_slack (void)
+{
+  GMainLoop *main_loop = g_main_loop_new (NULL, FALSE);
+  gint64 slack = G_USEC_PER_SEC / 100;
+  gint64 window;
+  DexFuture *early;
+  DexFuture *late;
+  DexFuture *future;
+
+  /* Both deadlines fall within the same window of slack */
+  window = ((g_get_monotonic_time () / slack) + 1) * slack;
+  early = dex_timeout_new_deadline (window + 1000);
+  late = dex_timeout_new_deadline (window + slack - 1000);
+
+  dex_timeout_set_slack (DEX_TIMEOUT (early), slack);
+  dex_timeout_set_slack (DEX_TIMEOUT (late), slack);
+  g_assert_cmpint (dex_timeout_get_slack (DEX_TIMEOUT (early)), ==, slack);
+
+  future = dex_future_catch (dex_ref (early), on_timed_out, main_loop, NULL);
+  dex_future_disown (dex_ref (late));
+
+  g_main_loop_run (main_loop);
+
+  /* Neither fired before the end of the window and both in one wakeup */
+  g_assert_cmpint (g_get_monotonic_time (), >=, window + slack);
+  ASSERT_STATUS (early, DEX_FUTURE_STATUS_REJECTED);
+  ASSERT_STATUS (late, DEX_FUTURE_STATUS_REJECTED);
+
+  dex_clear (&future);
+  dex_clear (&early);
+  dex_clear (&late);
+  g_main_loop_unref (main_loop);
+}
+
 static void
 test_future_with_timeout_resolves (void)
 {
@@ -269,6 +465,53 @@ test_promise_new (void)
   dex_clear (&promise);
 }
 
+static void
+test_promise_cancellable_reuse (void)
+{
+  DexPromise *promise;
+  GCancellable *cancellable;
+  GCancellable *held;
+
+  if (g_getenv ("DEX_CANCELLABLE_POOL_SIZE") != NULL)
+    {
+      g_test_skip ("Cancellable pool size overridden");
+      return;
+    }
+
+  /* An untouched cancellable is recycled by the next promise */
+  promise = dex_promise_new_cancellable ();
+  cancellable = dex_promise_peek_cancellable (promise);
+  g_assert_true (G_IS_CANCELLABLE (cancellable));
+  dex_clear (&promise);
+
+  promise = dex_promise_new_cancellable ();
+  g_assert_true (dex_promise_peek_cancellable (promise) == cancellable);
+
+  /* A cancelled one is not */
+  g_cancellable_cancel (cancellable);
+  dex_clear (&promise);
+
+  promise = dex_promise_new_cancellable ();
+  g_assert_false (g_cancellable_is_cancelled (dex_promise_peek_cancellable (promise)));
+
+  /* Nor one that somebody else still holds */
+  held = g_object_ref (dex_promise_peek_cancellable (promise));
+  dex_clear (&promise);
+
+  promise = dex_promise_new_cancellable ();
+  g_assert_true (dex_promise_peek_cancellable (promise) != held);
+  g_object_unref (held);
+
+  /* Nor one that was handed out, as it may carry data we can't see */
+  held = dex_promise_get_cancellable (promise);
+  g_object_set_data (G_OBJECT (held), "test-data", GINT_TO_POINTER (1));
+  dex_clear (&promise);
+
+  promise = dex_promise_new_cancellable ();
+  g_assert_null (g_object_get_data (G_OBJECT (dex_promise_peek_cancellable (promise)), "test-data"));
+  dex_clear (&promise);
+}
+
 static void
 test_static_future_new (void)
 {
@@ -295,6 +538,55 @@ test_static_future_new (void)
   dex_clear (&future);
 }
 
+static void
+test_static_future_scalars (void)
+{
+  static int pointer_target;
+  DexPromise *promise;
+  DexFuture *future;
+  GError *error = NULL;
+  char *string;
+
+  g_assert_cmpint (dex_await_int (dex_future_new_for_int (-123), &error), ==, -123);
+  g_assert_no_error (error);
+
+  g_assert_cmpuint (dex_await_uint (dex_future_new_for_uint (123), &error), ==, 123);
+  g_assert_no_error (error);
+
+  g_assert_cmpint (dex_await_int64 (dex_future_new_for_int64 (G_MININT64), &error), ==, G_MININT64);
+  g_assert_no_error (error);
+
+  g_assert_cmpuint (dex_await_uint64 (dex_future_new_for_uint64 (G_MAXUINT64), &error), ==, G_MAXUINT64);
+  g_assert_no_error (error);
+
+  g_assert_cmpfloat (dex_await_float (dex_future_new_for_float (1.5f), &error), ==, 1.5f);
+  g_assert_no_error (error);
+
+  g_assert_cmpfloat (dex_await_double (dex_future_new_for_double (-2.5), &error), ==, -2.5);
+  g_assert_no_error (error);
+
+  g_assert_true (dex_await_pointer (dex_future_new_for_pointer (&pointer_target), &error) == &pointer_target);
+  g_assert_no_error (error);
+
+  /* Scalars are copied without the value table when completing */
+  promise = dex_promise_new ();
+  future = dex_future_new_for_int64 (G_MAXINT64);
+  dex_future_complete_from (DEX_FUTURE (promise), future);
+  dex_clear (&future);
+  g_assert_cmpint (dex_await_int64 (DEX_FUTURE (promise), &error), ==, G_MAXINT64);
+  g_assert_no_error (error);
+
+  /* Non-scalars must still be deep copied */
+  promise = dex_promise_new ();
+  future = dex_future_new_for_string ("123");
+  dex_future_complete_from (DEX_FUTURE (promise), future);
+  dex_clear (&future);
+  string = dex_await_string (DEX_FUTURE (promise), &error);
+  g_assert_no_error (error);
+  g_assert_cmpstr (string, ==, "123");
+  g_free (string);
+}
+
 static void
 test_promise_resolve (void)
 {
@@ -941,6 +1233,86 @@ test_future_discard (void)
   dex_clear (&any);
 }
 
+static DexFuture *
+chain_forward_cb (DexFuture *completed,
+                  gpointer   user_data)
+{
+  return dex_ref (completed);
+}
+
+static void
+test_future_chain_fan_out (void)
+{
+  DexPromise *promise = dex_promise_new ();
+  DexFuture *future = DEX_FUTURE (promise);
+  guint64 n_allocated = dex_future_get_n_chained_allocated ();
+  DexFuture *first;
+  DexFuture *second;
+
+  /* The first chained future uses the inline slot */
+  first = dex_future_then (dex_ref (promise), chain_forward_cb, NULL, NULL);
+  g_assert_cmpuint (future->chained.length, ==, 1);
+  g_assert_true (future->chained.head->data == &future->first_chained);
+  g_assert_cmpuint (dex_future_get_n_chained_allocated (), ==, n_allocated);
+
+  /* A second one has to fall back to the heap */
+  second = dex_future_then (dex_ref (promise), chain_forward_cb, NULL, NULL);
+  g_assert_cmpuint (future->chained.length, ==, 2);
+  g_assert_true (future->chained.tail->data != &future->first_chained);
+  g_assert_cmpuint (dex_future_get_n_chained_allocated (), ==, n_allocated + 1);
+
+  dex_promise_resolve_int (promise, 42);
+
+  while (dex_future_is_pending (first) || dex_future_is_pending (second))
+    g_main_context_iteration (NULL, TRUE);
+
+  ASSERT_STATUS (first, DEX_FUTURE_STATUS_RESOLVED);
+  ASSERT_STATUS (second, DEX_FUTURE_STATUS_RESOLVED);
+  g_assert_cmpint (g_value_get_int (dex_future_get_value (first, NULL)), ==, 42);
+  g_assert_cmpint (g_value_get_int (dex_future_get_value (second, NULL)), ==, 42);
+  g_assert_cmpuint (future->chained.length, ==, 0);
+
+  dex_unref (first);
+  dex_unref (second);
+  dex_unref (promise);
+}
+
+static void
+test_future_chain_discard_rechain (void)
+{
+  DexPromise *promise = dex_promise_new ();
+  DexFuture *future = DEX_FUTURE (promise);
+  guint64 n_allocated = dex_future_get_n_chained_allocated ();
+  DexFuture *first;
+  DexFuture *second;
+
+  first = dex_future_then (dex_ref (promise), chain_forward_cb, NULL, NULL);
+  g_assert_true (future->first_chained_in_use);
+  g_assert_true (future->chained.head->data == &future->first_chained);
+
+  /* Releasing the block discards it, which must free the inline slot */
+  dex_unref (first);
+  g_assert_false (future->first_chained_in_use);
+  g_assert_cmpuint (future->chained.length, ==, 0);
+
+  /* So the next chained future reuses it rather than allocating */
+  second = dex_future_then (dex_ref (promise), chain_forward_cb, NULL, NULL);
+  g_assert_true (future->first_chained_in_use);
+  g_assert_true (future->chained.head->data == &future->first_chained);
+  g_assert_cmpuint (dex_future_get_n_chained_allocated (), ==, n_allocated);
+
+  dex_promise_resolve_int (promise, 42);
+
+  while (dex_future_is_pending (second))
+    g_main_context_iteration (NULL, TRUE);
+
+  ASSERT_STATUS (second, DEX_FUTURE_STATUS_RESOLVED);
+  g_assert_cmpint (g_value_get_int (dex_future_get_value (second, NULL)), ==, 42);
+
+  dex_unref (second);
+  dex_unref (promise);
+}
+
 static void
 test_future_with_timeout_disowned (void)
 {
@@ -1141,13 +1513,22 @@ main (int   argc,
   g_test_add_func ("/Dex/TestSuite/Block/then", test_future_then);
   g_test_add_func ("/Dex/TestSuite/Cancellable/cancel", test_cancellable_cancel);
   g_test_add_func ("/Dex/TestSuite/StaticFuture/new", test_static_future_new);
+  g_test_add_func ("/Dex/TestSuite/StaticFuture/scalars", test_static_future_scalars);
   g_test_add_func ("/Dex/TestSuite/Promise/type", test_promise_type);
 #if !defined (_MSC_VER) && !defined (__clang__)
   g_test_add_func ("/Dex/TestSuite/Promise/autoptr", test_promise_autoptr);
 #endif
   g_test_add_func ("/Dex/TestSuite/Promise/new", test_promise_new);
+  g_test_add_func ("/Dex/TestSuite/Promise/cancellable_reuse", test_promise_cancellable_reuse);
   g_test_add_func ("/Dex/TestSuite/Promise/resolve", test_promise_resolve);
   g_test_add_func ("/Dex/TestSuite/Timeout/timed-out", test_timeout);
+  g_test_add_func ("/Dex/TestSuite/Timeout/many", test_timeout_many);
+  g_test_add_func ("/Dex/TestSuite/Timeout/postpone", test_timeout_postpone);
+  g_test_add_func ("/Dex/TestSuite/Timeout/discard", test_timeout_discard);
+  g_test_add_func ("/Dex/TestSuite/Timeout/unawaited", test_timeout_unawaited);
+  g_test_add_func ("/Dex/TestSuite/Timeout/slack", test_timeout_slack);
+  g_test_add_func ("/Dex/TestSuite/Timeout/arm-on-awaiting-scheduler",
+                   test_timeout_arm_on_awaiting_scheduler);
   g_test_add_func ("/Dex/TestSuite/Future/with-timeout/resolves",
                    test_future_with_timeout_resolves);
   g_test_add_func ("/Dex/TestSuite/Future/with-timeout/rejects", test_future_with_timeout_rejects);
@@ -1179,6 +1560,8 @@ main (int   argc,
   g_test_add_func ("/Dex/TestSuite/Future/any", test_future_any);
   g_test_add_func ("/Dex/TestSuite/Future/first", test_future_first);
   g_test_add_func ("/Dex/TestSuite/Future/discard", test_future_discard);
+  g_test_add_func ("/Dex/TestSuite/Future/chain_fan_out", test_future_chain_fan_out);
+  g_test_add_func ("/Dex/TestSuite/Future/chain_discard_rechain", test_future_chain_discard_rechain);
   g_test_add_func ("/Dex/TestSuite/Delayed/simple", test_delayed_simple);
   g_test_add_func ("/Dex/TestSuite/Delayed/release_before_completion",
                    test_delayed_release_before_completion);
@@ -76,6 +76,45 @@ test_object_new (void)
   return (TestObject *)g_type_create_instance (TEST_TYPE_OBJECT);
 }
 
+#define TEST_TYPE_SLAB_OBJECT (test_slab_object_get_type())
+
+GType test_slab_object_get_type (void);
+
+typedef struct _TestSlabObject
+{
+  DexObject parent_instance;
+  int initialized;
+  int dirty;
+} TestSlabObject;
+
+typedef struct _TestSlabObjectClass
+{
+  DexObjectClass parent_class;
+} TestSlabObjectClass;
+
+DEX_DEFINE_FINAL_TYPE (TestSlabObject, test_slab_object, DEX_TYPE_OBJECT)
+
+static void
+test_slab_object_class_init (TestSlabObjectClass *test_slab_object_class)
+{
+  DexObjectClass *object_class = DEX_OBJECT_CLASS (test_slab_object_class);
+
+  object_class->finalize = test_object_finalize;
+  dex_object_class_enable_slab (object_class);
+}
+
+static void
+test_slab_object_init (TestSlabObject *test_slab_object)
+{
+  test_slab_object->initialized = TRUE;
+}
+
+static TestSlabObject *
+test_slab_object_new (void)
+{
+  return (TestSlabObject *)dex_object_create_instance (TEST_TYPE_SLAB_OBJECT);
+}
+
 #define TEST_TYPE_PROPERTY_OBJECT (test_property_object_get_type())
 #define TEST_PROPERTY_OBJECT(obj) \
   (G_TYPE_CHECK_INSTANCE_CAST(obj, TEST_TYPE_PROPERTY_OBJECT, TestPropertyObject))
@@ -759,6 +798,56 @@ test_object_property (void)
   g_clear_object (&object);
 }
 
+static gpointer
+test_slab_remote_free_thread (gpointer data)
+{
+  dex_unref (data);
+  return NULL;
+}
+
+static void
+test_object_slab (void)
+{
+  TestSlabObject *obj;
+  guint64 n_allocated;
+  guint64 n_reused;
+  guint64 n_reused_before;
+  guint count;
+
+  obj = test_slab_object_new ();
+
+  if (DEX_OBJECT_GET_CLASS (obj)->slab_type == NULL)
+    {
+      dex_unref (obj);
+      g_test_skip ("Object slab is disabled");
+      return;
+    }
+
+  g_assert_true (obj->initialized);
+  obj->dirty = TRUE;
+
+  count = g_atomic_int_get (&finalize_count);
+  dex_object_get_slab_stats (NULL, &n_reused_before);
+  dex_unref (obj);
+  g_assert_cmpint (count + 1, ==, g_atomic_int_get (&finalize_count));
+
+  /* Recycled instances must look freshly initialized */
+  obj = test_slab_object_new ();
+  g_assert_true (obj->initialized);
+  g_assert_false (obj->dirty);
+  dex_object_get_slab_stats (&n_allocated, &n_reused);
+  g_assert_cmpuint (n_reused, ==, n_reused_before + 1);
+  g_assert_cmpuint (n_allocated, >, 0);
+
+  /* Freed on another thread, comes back through the remote list */
+  g_thread_join (g_thread_new ("remote-free", test_slab_remote_free_thread, obj));
+  obj = test_slab_object_new ();
+  g_assert_true (obj->initialized);
+  dex_object_get_slab_stats (NULL, &n_reused);
+  g_assert_cmpuint (n_reused, ==, n_reused_before + 2);
+  dex_unref (obj);
+}
+
 int
 main (int   argc,
       char *argv[])
@@ -768,6 +857,7 @@ main (int   argc,
   g_test_add_func ("/Dex/TestSuite/Object/basic", test_object_basic);
   g_test_add_func ("/Dex/TestSuite/Object/set-object", test_object_set_object);
   g_test_add_func ("/Dex/TestSuite/Object/property", test_object_property);
+  g_test_add_func ("/Dex/TestSuite/Object/slab", test_object_slab);
   g_test_add_func ("/Dex/TestSuite/WeakRef/single-threaded", test_weak_ref_st);
   g_test_add_func ("/Dex/TestSuite/WeakRef/retarget", test_weak_ref_retarget);
   g_test_add_func ("/Dex/TestSuite/WeakRef/multi-threaded", test_weak_ref_mt);
@@ -20,6 +20,8 @@
 
 #include <libdex.h>
 
+#include "dex-thread-pool-scheduler-private.h"
+
 static DexScheduler *thread_pool;
 static GMainLoop *main_loop;
 
@@ -181,6 +183,257 @@ test_thread_pool_scheduler_push (void)
   g_cond_clear (&syncobj.cond);
 }
 
+static void
+test_thread_pool_scheduler_new_full (void)
+{
+  DexScheduler *pool;
+  DexFuture *future;
+  guint count = 0;
+
+  pool = dex_thread_pool_scheduler_new_full (3, 0);
+  g_assert_cmpuint (dex_thread_pool_scheduler_get_n_workers (DEX_THREAD_POOL_SCHEDULER (pool)), >=, 1);
+  g_assert_cmpuint (dex_thread_pool_scheduler_get_n_workers (DEX_THREAD_POOL_SCHEDULER (pool)), <=, 3);
+
+  thread_pool = pool;
+  main_loop = g_main_loop_new (NULL, FALSE);
+
+  future = dex_scheduler_spawn (NULL, 0, spawner, &count, NULL);
+  future = dex_future_finally (future, quit_cb, NULL, NULL);
+  g_main_loop_run (main_loop);
+
+  g_assert_cmpint (count, ==, 10*1000);
+
+  dex_unref (future);
+  dex_unref (pool);
+  g_clear_pointer (&main_loop, g_main_loop_unref);
+}
+
+typedef struct
+{
+  GMutex mutex;
+  GCond cond;
+  guint remaining;
+} Backlog;
+
+typedef struct
+{
+  GMutex mutex;
+  GCond cond;
+  gboolean blocked;
+  gboolean released;
+  gboolean ran;
+} Gate;
+
+static void
+test_thread_pool_scheduler_grow_block_cb (gpointer data)
+{
+  Gate *gate = data;
+
+  /* Hold on to the only worker until the test lets us go */
+  g_mutex_lock (&gate->mutex);
+  gate->blocked = TRUE;
+  g_cond_broadcast (&gate->cond);
+  while (!gate->released)
+    g_cond_wait (&gate->cond, &gate->mutex);
+  g_mutex_unlock (&gate->mutex);
+}
+
+static void
+test_thread_pool_scheduler_grow_cb (gpointer data)
+{
+  Gate *gate = data;
+
+  g_mutex_lock (&gate->mutex);
+  gate->ran = TRUE;
+  g_cond_broadcast (&gate->cond);
+  g_mutex_unlock (&gate->mutex);
+}
+
+static void
+test_thread_pool_scheduler_grow (void)
+{
+  DexScheduler *pool;
+  gint64 deadline;
+  Gate gate = {0};
+
+  pool = dex_thread_pool_scheduler_new_full (1, 4);
+  g_assert_cmpuint (dex_thread_pool_scheduler_get_n_workers (DEX_THREAD_POOL_SCHEDULER (pool)), ==, 1);
+
+  g_mutex_init (&gate.mutex);
+  g_cond_init (&gate.cond);
+
+  g_mutex_lock (&gate.mutex);
+
+  dex_scheduler_push (pool, test_thread_pool_scheduler_grow_block_cb, &gate);
+  while (!gate.blocked)
+    g_cond_wait (&gate.cond, &gate.mutex);
+
+  /* The only worker is blocked, so this can only run once the pool has
+   * grown. The deadline only exists so that a regression fails rather
+   * than hangs.
+   */
+  dex_scheduler_push (pool, test_thread_pool_scheduler_grow_cb, &gate);
+  deadline = g_get_monotonic_time () + (G_USEC_PER_SEC * 30);
+  while (!gate.ran)
+    {
+      if (!g_cond_wait_until (&gate.cond, &gate.mutex, deadline))
+        break;
+    }
+  g_assert_true (gate.ran);
+
+  g_assert_cmpuint (dex_thread_pool_scheduler_get_n_workers (DEX_THREAD_POOL_SCHEDULER (pool)), >, 1);
+  g_assert_cmpuint (dex_thread_pool_scheduler_get_n_workers (DEX_THREAD_POOL_SCHEDULER (pool)), <=, 4);
+
+  gate.released = TRUE;
+  g_cond_broadcast (&gate.cond);
+  g_mutex_unlock (&gate.mutex);
+
+  dex_unref (pool);
+
+  g_mutex_clear (&gate.mutex);
+  g_cond_clear (&gate.cond);
+}
+
+static void
+test_thread_pool_scheduler_shrink (void)
+{
+  DexThreadPoolScheduler *pool;
+  gint64 deadline;
+  Gate gate = {0};
+
+  /* Read when the pool is created, so they only apply to this one */
+  g_setenv ("DEX_THREAD_POOL_GROW_THRESHOLD", "0", TRUE);
+  g_setenv ("DEX_THREAD_POOL_IDLE_TIMEOUT", "100", TRUE);
+  g_setenv ("DEX_THREAD_POOL_RETIRE_TIMEOUT", "100", TRUE);
+  pool = DEX_THREAD_POOL_SCHEDULER (dex_thread_pool_scheduler_new_full (1, 2));
+  g_unsetenv ("DEX_THREAD_POOL_GROW_THRESHOLD");
+  g_unsetenv ("DEX_THREAD_POOL_IDLE_TIMEOUT");
+  g_unsetenv ("DEX_THREAD_POOL_RETIRE_TIMEOUT");
+
+  g_mutex_init (&gate.mutex);
+  g_cond_init (&gate.cond);
+
+  g_mutex_lock (&gate.mutex);
+
+  dex_scheduler_push (DEX_SCHEDULER (pool), test_thread_pool_scheduler_grow_block_cb, &gate);
+  while (!gate.blocked)
+    g_cond_wait (&gate.cond, &gate.mutex);
+
+  /* Only a second worker can run this while the first is blocked */
+  dex_scheduler_push (DEX_SCHEDULER (pool), test_thread_pool_scheduler_grow_cb, &gate);
+  deadline = g_get_monotonic_time () + (G_USEC_PER_SEC * 30);
+  while (!gate.ran)
+    {
+      if (!g_cond_wait_until (&gate.cond, &gate.mutex, deadline))
+        break;
+    }
+  g_assert_true (gate.ran);
+  g_assert_cmpuint (dex_thread_pool_scheduler_get_n_workers (pool), ==, 2);
+
+  gate.released = TRUE;
+  g_cond_broadcast (&gate.cond);
+  g_mutex_unlock (&gate.mutex);
+
+  /* Once idle, the second worker is parked and then its thread exits.
+   * The deadline only exists so that a regression fails rather than
+   * hangs.
+   */
+  deadline = g_get_monotonic_time () + (G_USEC_PER_SEC * 30);
+  while ((dex_thread_pool_scheduler_get_n_workers (pool) > 1 ||
+          dex_thread_pool_scheduler_get_n_parked (pool) > 0) &&
+         g_get_monotonic_time () < deadline)
+    g_usleep (G_USEC_PER_SEC / 100);
+
+  g_assert_cmpuint (dex_thread_pool_scheduler_get_n_workers (pool), ==, 1);
+  g_assert_cmpuint (dex_thread_pool_scheduler_get_n_parked (pool), ==, 0);
+
+  /* The pool still works with the worker it has left */
+  g_mutex_lock (&gate.mutex);
+  gate.ran = FALSE;
+  dex_scheduler_push (DEX_SCHEDULER (pool), test_thread_pool_scheduler_grow_cb, &gate);
+  deadline = g_get_monotonic_time () + (G_USEC_PER_SEC * 30);
+  while (!gate.ran)
+    {
+      if (!g_cond_wait_until (&gate.cond, &gate.mutex, deadline))
+        break;
+    }
+  g_assert_true (gate.ran);
+  g_mutex_unlock (&gate.mutex);
+
+  dex_unref (pool);
+
+  g_mutex_clear (&gate.mutex);
+  g_cond_clear (&gate.cond);
+}
+
+static void
+test_thread_pool_scheduler_steal_item_cb (gpointer data)
+{
+  Backlog *backlog = data;
+
+  g_mutex_lock (&backlog->mutex);
+  if (--backlog->remaining == 0)
+    g_cond_signal (&backlog->cond);
+  g_mutex_unlock (&backlog->mutex);
+}
+
+static void
+test_thread_pool_scheduler_steal_cb (gpointer data)
+{
+  Backlog *backlog = data;
+  DexScheduler *worker = dex_scheduler_get_thread_default ();
+  gint64 deadline = g_get_monotonic_time () + (G_USEC_PER_SEC * 30);
+
+  /* This goes to our own queue, but we block until it is done so it
+   * can only be run if our sleeping peer is woken up to steal. A single
+   * item is enough to need that. The deadline only exists so that a
+   * regression fails rather than hangs.
+   */
+  g_mutex_lock (&backlog->mutex);
+  dex_scheduler_push (worker, test_thread_pool_scheduler_steal_item_cb, backlog);
+  while (backlog->remaining > 1)
+    {
+      if (!g_cond_wait_until (&backlog->cond, &backlog->mutex, deadline))
+        break;
+    }
+  g_assert_cmpuint (backlog->remaining, ==, 1);
+  if (--backlog->remaining == 0)
+    g_cond_signal (&backlog->cond);
+  g_mutex_unlock (&backlog->mutex);
+}
+
+static void
+test_thread_pool_scheduler_steal (void)
+{
+  DexScheduler *pool;
+  Backlog backlog;
+  gint64 deadline;
+
+  pool = dex_thread_pool_scheduler_new_full (2, 2);
+
+  g_mutex_init (&backlog.mutex);
+  g_cond_init (&backlog.cond);
+  backlog.remaining = 2;
+
+  /* Let both workers run out of things to do and go to sleep */
+  deadline = g_get_monotonic_time () + (G_USEC_PER_SEC * 30);
+  while (dex_thread_pool_scheduler_get_n_idle (DEX_THREAD_POOL_SCHEDULER (pool)) < 2 &&
+         g_get_monotonic_time () < deadline)
+    g_usleep (G_USEC_PER_SEC / 1000);
+  g_assert_cmpuint (dex_thread_pool_scheduler_get_n_idle (DEX_THREAD_POOL_SCHEDULER (pool)), ==, 2);
+
+  g_mutex_lock (&backlog.mutex);
+  dex_scheduler_push (pool, test_thread_pool_scheduler_steal_cb, &backlog);
+  while (backlog.remaining > 0)
+    g_cond_wait (&backlog.cond, &backlog.mutex);
+  g_mutex_unlock (&backlog.mutex);
+
+  g_mutex_clear (&backlog.mutex);
+  g_cond_clear (&backlog.cond);
+
+  dex_unref (pool);
+}
+
 int
 main (int   argc,
       char *argv[])
@@ -191,5 +444,9 @@ main (int   argc,
   g_test_add_func ("/Dex/TestSuite/Scheduler/spawn_static_name", test_scheduler_spawn_static_name);
   g_test_add_func ("/Dex/TestSuite/ThreadPoolScheduler/10_000_fibers", test_thread_pool_scheduler_spawn);
   g_test_add_func ("/Dex/TestSuite/ThreadPoolScheduler/push", test_thread_pool_scheduler_push);
+  g_test_add_func ("/Dex/TestSuite/ThreadPoolScheduler/new_full", test_thread_pool_scheduler_new_full);
+  g_test_add_func ("/Dex/TestSuite/ThreadPoolScheduler/grow", test_thread_pool_scheduler_grow);
+  g_test_add_func ("/Dex/TestSuite/ThreadPoolScheduler/shrink", test_thread_pool_scheduler_shrink);
+  g_test_add_func ("/Dex/TestSuite/ThreadPoolScheduler/steal", test_thread_pool_scheduler_steal);
   return g_test_run ();
 }
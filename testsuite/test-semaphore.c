@@ -128,12 +128,60 @@ test_semaphore_threaded (void)
   dex_unref (semaphore);
 }
 
+static void
+test_semaphore_many (void)
+{
+  DexSemaphore *semaphore = dex_semaphore_new ();
+  GError *error = NULL;
+  DexFuture *wait1;
+  DexFuture *wait2;
+  DexFuture *wait3;
+
+  dex_semaphore_post_many (semaphore, 5);
+  g_assert_cmpuint (dex_semaphore_try_wait_many (semaphore, 3), ==, 3);
+  g_assert_cmpuint (dex_semaphore_try_wait_many (semaphore, 3), ==, 2);
+  g_assert_cmpuint (dex_semaphore_try_wait_many (semaphore, 3), ==, 0);
+
+  /* Tokens available up front complete the wait immediately */
+  dex_semaphore_post_many (semaphore, 2);
+  wait1 = dex_semaphore_wait_many (semaphore, 8);
+  g_assert_cmpuint (dex_await_uint (wait1, &error), ==, 2);
+  g_assert_no_error (error);
+
+  /* Posted tokens are spread across the waiters */
+  wait1 = dex_semaphore_wait_many (semaphore, 8);
+  wait2 = dex_semaphore_wait_many (semaphore, 8);
+  wait3 = dex_semaphore_wait (semaphore);
+  g_assert_true (dex_future_is_pending (wait1));
+  g_assert_true (dex_future_is_pending (wait2));
+  g_assert_true (dex_future_is_pending (wait3));
+
+  dex_semaphore_post_many (semaphore, 7);
+
+  while (dex_future_is_pending (wait1) ||
+         dex_future_is_pending (wait2) ||
+         dex_future_is_pending (wait3))
+    g_main_context_iteration (NULL, TRUE);
+
+  g_assert_cmpuint (dex_await_uint (wait1, &error), ==, 2);
+  g_assert_no_error (error);
+  g_assert_cmpuint (dex_await_uint (wait2, &error), ==, 2);
+  g_assert_no_error (error);
+  g_assert_true (dex_await_boolean (wait3, &error));
+  g_assert_no_error (error);
+  g_assert_cmpuint (dex_semaphore_try_wait_many (semaphore, 8), ==, 2);
+
+  dex_semaphore_close (semaphore);
+  dex_unref (semaphore);
+}
+
 int
 main (int argc,
       char *argv[])
 {
   dex_init ();
   g_test_init (&argc, &argv, NULL);
+  g_test_add_func ("/Dex/TestSuite/Semaphore/many", test_semaphore_many);
   g_test_add_func ("/Dex/TestSuite/Semaphore/threaded", test_semaphore_threaded);
   return g_test_run ();
 }
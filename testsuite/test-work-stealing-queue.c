@@ -0,0 +1,200 @@
+/* test-work-stealing-queue.c
+ *
+ * Copyright 2026 Christian Hergert
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2.1 of the
+ * License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ */
+
+#include <libdex.h>
+
+#include "dex-work-stealing-queue-private.h"
+
+#define N_THIEVES 4
+#define N_BURSTS  50
+#define BURST     5000
+
+static DexWorkStealingQueue *victim;
+static guint *counts;
+static guint n_run;
+static guint done;
+
+static void
+count_cb (gpointer data)
+{
+  g_atomic_int_inc (&counts[GPOINTER_TO_UINT (data)]);
+  g_atomic_int_inc (&n_run);
+}
+
+static gpointer
+thief_thread (gpointer data)
+{
+  DexWorkStealingQueue *local = dex_work_stealing_queue_new (2);
+
+  while (!g_atomic_int_get (&done))
+    {
+      DexWorkItem work_item;
+
+      if (dex_work_stealing_queue_steal_half (victim, local, &work_item))
+        dex_work_item_invoke (&work_item);
+
+      while (dex_work_stealing_queue_pop (local, &work_item))
+        dex_work_item_invoke (&work_item);
+
+      dex_work_stealing_queue_trim (local);
+    }
+
+  g_assert_true (dex_work_stealing_queue_empty (local));
+
+  dex_work_stealing_queue_trim (local);
+  g_assert_cmpint (dex_work_stealing_queue_capacity (local), ==, 2);
+  g_assert_cmpuint (local->garbage->len, ==, 0);
+
+  dex_work_stealing_queue_unref (local);
+
+  return NULL;
+}
+
+static void
+test_work_stealing_queue_stress (void)
+{
+  GThread *thieves[N_THIEVES];
+  guint index = 0;
+
+  victim = dex_work_stealing_queue_new (4);
+  counts = g_new0 (guint, N_BURSTS * BURST);
+  n_run = 0;
+  done = FALSE;
+
+  for (guint i = 0; i < N_THIEVES; i++)
+    thieves[i] = g_thread_new ("thief", thief_thread, NULL);
+
+  /* Bursts grow the array well past its initial capacity while thieves
+   * are loading it, then the owner drains what is left and trims.
+   */
+  for (guint i = 0; i < N_BURSTS; i++)
+    {
+      DexWorkItem work_item;
+
+      for (guint j = 0; j < BURST; j++)
+        {
+          work_item.func = count_cb;
+          work_item.func_data = GUINT_TO_POINTER (index++);
+          dex_work_stealing_queue_push (victim, work_item);
+        }
+
+      while (dex_work_stealing_queue_pop (victim, &work_item))
+        dex_work_item_invoke (&work_item);
+
+      dex_work_stealing_queue_trim (victim);
+    }
+
+  while ((guint)g_atomic_int_get (&n_run) < N_BURSTS * BURST)
+    g_thread_yield ();
+
+  g_atomic_int_set (&done, TRUE);
+
+  for (guint i = 0; i < N_THIEVES; i++)
+    g_thread_join (thieves[i]);
+
+  for (guint i = 0; i < N_BURSTS * BURST; i++)
+    g_assert_cmpuint (counts[i], ==, 1);
+
+  /* With no thieves left, everything retired can be reclaimed */
+  dex_work_stealing_queue_trim (victim);
+  g_assert_cmpint (dex_work_stealing_queue_capacity (victim), ==, 4);
+  g_assert_cmpuint (victim->garbage->len, ==, 0);
+
+  g_clear_pointer (&counts, g_free);
+  g_clear_pointer (&victim, dex_work_stealing_queue_unref);
+}
+
+static void
+test_work_stealing_queue_trim (void)
+{
+  DexWorkStealingQueue *queue = dex_work_stealing_queue_new (8);
+  DexWorkItem work_item = { count_cb, NULL };
+  guint count = 0;
+
+  counts = g_new0 (guint, 1);
+  n_run = 0;
+
+  for (guint i = 0; i < 10000; i++)
+    dex_work_stealing_queue_push (queue, work_item);
+
+  g_assert_cmpint (dex_work_stealing_queue_capacity (queue), >=, 10000);
+
+  /* Growing reclaims right away when nobody is stealing */
+  g_assert_cmpuint (queue->garbage->len, ==, 0);
+
+  /* Trimming does nothing until the queue is empty */
+  dex_work_stealing_queue_trim (queue);
+  g_assert_cmpint (dex_work_stealing_queue_capacity (queue), >=, 10000);
+
+  while (dex_work_stealing_queue_pop (queue, &work_item))
+    count++;
+
+  g_assert_cmpuint (count, ==, 10000);
+
+  dex_work_stealing_queue_trim (queue);
+  g_assert_cmpint (dex_work_stealing_queue_capacity (queue), ==, 8);
+  g_assert_cmpuint (queue->garbage->len, ==, 0);
+
+  /* And it still works afterwards */
+  dex_work_stealing_queue_push (queue, work_item);
+  g_assert_true (dex_work_stealing_queue_pop (queue, &work_item));
+  g_assert_false (dex_work_stealing_queue_pop (queue, &work_item));
+
+  g_clear_pointer (&counts, g_free);
+  dex_work_stealing_queue_unref (queue);
+}
+
+static void
+test_work_stealing_queue_capacity (void)
+{
+  DexWorkStealingQueue *queue;
+  DexWorkItem work_item;
+
+  /* Indexing uses a mask so the capacity is rounded up */
+  queue = dex_work_stealing_queue_new (255);
+  g_assert_cmpint (dex_work_stealing_queue_capacity (queue), ==, 256);
+
+  for (guint i = 0; i < 200; i++)
+    {
+      work_item.func = count_cb;
+      work_item.func_data = GUINT_TO_POINTER (i);
+      dex_work_stealing_queue_push (queue, work_item);
+    }
+
+  for (guint i = 0; i < 200; i++)
+    {
+      g_assert_true (dex_work_stealing_queue_steal (queue, &work_item));
+      g_assert_cmpuint (GPOINTER_TO_UINT (work_item.func_data), ==, i);
+    }
+
+  dex_work_stealing_queue_unref (queue);
+}
+
+int
+main (int   argc,
+      char *argv[])
+{
+  dex_init ();
+  g_test_init (&argc, &argv, NULL);
+  g_test_add_func ("/Dex/TestSuite/WorkStealingQueue/capacity", test_work_stealing_queue_capacity);
+  g_test_add_func ("/Dex/TestSuite/WorkStealingQueue/trim", test_work_stealing_queue_trim);
+  g_test_add_func ("/Dex/TestSuite/WorkStealingQueue/stress", test_work_stealing_queue_stress);
+  return g_test_run ();
+}